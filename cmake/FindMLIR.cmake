@@ -10,6 +10,14 @@ find_package(LLVM REQUIRED CONFIG)
 message(STATUS "Found LLVM ${LLVM_PACKAGE_VERSION}")
 message(STATUS "Using LLVMConfig.cmake in: ${LLVM_DIR}")
 
+# MLIR is versioned with LLVM; an older install than the caller asked for
+# (find_package(MLIR <version>)) is reported as not found
+if(MLIR_FIND_VERSION AND LLVM_PACKAGE_VERSION VERSION_LESS MLIR_FIND_VERSION)
+    message(STATUS "LLVM ${LLVM_PACKAGE_VERSION} is older than the required ${MLIR_FIND_VERSION}")
+    set(MLIR_FOUND FALSE)
+    return()
+endif()
+
 # MLIR is typically installed alongside LLVM
 set(MLIR_DIR "${LLVM_DIR}/../mlir" CACHE PATH "Path to MLIR CMake files")
 
@@ -0,0 +1,55 @@
+#ifndef AUDIO_ALLOC_H
+#define AUDIO_ALLOC_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Alignment of every sample buffer (one cache line / one AVX-512 vector)
+#define AUDIO_ALLOC_ALIGNMENT 64
+
+// Allocations at least this large are 2 MiB aligned and tagged for
+// transparent huge pages to cut TLB misses on long buffers
+#define AUDIO_ALLOC_HUGE_THRESHOLD ((size_t)2 << 20)
+
+// Allocator statistics
+typedef struct {
+    size_t pool_hits;      // Requests served from the recycling pool
+    size_t pool_misses;    // Requests that needed fresh memory
+    size_t cached_blocks;  // Blocks currently held by the pool
+    size_t cached_bytes;   // Bytes currently held by the pool
+} AudioAllocStats;
+
+// Allocate `size` bytes aligned to AUDIO_ALLOC_ALIGNMENT
+// When the pool is enabled, a previously freed block of similar size is
+// reused so its pages are already faulted in. The pool keeps one free list
+// per NUMA node: blocks are taken from the calling thread's node, and fresh
+// blocks are left untouched so they are first-touched by their consumer.
+void* audio_alloc(size_t size);
+
+// Allocate for a NUMA node (index into audio_numa_topology()->nodes) other
+// than the caller's, e.g. a buffer a pinned worker will fill. Fresh blocks
+// are mbind-ed to the node. Returns NULL for a bad node index
+void* audio_alloc_on_node(size_t size, int node);
+
+// Free memory from audio_alloc (returns it to the pool of the node it was
+// allocated for, when enabled)
+void audio_free(void *ptr);
+
+// Enable the process-wide recycling pool, caching up to `max_cached_bytes`
+// of freed buffers. Intended for batch/server runs that process many files
+void audio_pool_enable(size_t max_cached_bytes);
+
+// Disable the pool and release all cached blocks
+void audio_pool_disable(void);
+
+// Snapshot allocator statistics
+void audio_alloc_stats(AudioAllocStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_ALLOC_H
@@ -37,6 +37,10 @@ typedef struct {
 // Audio format constants
 #define AUDIO_FORMAT_PCM    1
 #define AUDIO_FORMAT_FLOAT  3
+#define AUDIO_FORMAT_FLAC   0xF1AC  // Not a WAV tag: decoded by flac.c
+
+// Shared sample storage (see audio_view.h)
+typedef struct AudioStorage AudioStorage;
 
 // Audio buffer structure for float64 samples
 typedef struct {
@@ -45,6 +49,7 @@ typedef struct {
     int sample_rate;       // Sample rate in Hz
     int channels;          // Number of channels
     int bit_depth;         // Original bit depth (for writing back)
+    AudioStorage *storage; // Reference-counted owner of `data`
 } AudioBuffer;
 
 // PCM buffer structure for raw PCM data
@@ -66,14 +71,102 @@ typedef enum {
     AUDIO_ERROR_INVALID_PARAMETER = -7
 } AudioError;
 
+// Stream information parsed from a WAV (or FLAC) header
+// For FLAC, bit_depth, block_align and data_size describe the decoded PCM
+// and data_offset is the offset of the first frame
+typedef struct {
+    int sample_rate;       // Sample rate in Hz
+    int channels;          // Number of channels
+    int bit_depth;         // Bits per sample
+    int audio_format;      // AUDIO_FORMAT_PCM, _FLOAT or _FLAC
+    int block_align;       // Bytes per frame (all channels)
+    size_t frames;         // Number of frames in the data chunk
+    size_t data_size;      // Size of the data chunk in bytes
+    long data_offset;      // Byte offset of the first sample in the file
+} AudioFileInfo;
+
+// Streaming WAV/FLAC reader (opaque)
+typedef struct AudioReader AudioReader;
+
+// Streaming WAV/FLAC writer (opaque)
+typedef struct AudioWriter AudioWriter;
+
 // Function prototypes
+//
+// Readers accept FLAC as well as WAV, told apart by the file's magic.
+// Writers produce FLAC when the path ends in ".flac" (8/16/24-bit only).
 
 // Read WAV file and convert to float64 normalized samples
 AudioBuffer* read_wave(const char *filepath, AudioError *error);
 
+// Read WAV header only (no sample data is loaded)
+AudioError read_wave_info(const char *filepath, AudioFileInfo *info);
+
+// Read a range of frames, seeking directly to its offset in the data chunk
+// The range is clamped to the end of the file
+AudioBuffer* read_wave_region(const char *filepath, size_t start_frame,
+                              size_t num_frames, AudioError *error);
+
+// Streaming reader: decode interleaved float64 frames block by block
+AudioReader* audio_reader_open(const char *filepath, AudioError *error);
+const AudioFileInfo* audio_reader_info(const AudioReader *reader);
+AudioError audio_reader_seek(AudioReader *reader, size_t frame);
+// Returns the number of frames read (0 at end of data). A short count also
+// comes back when the data is corrupt or truncated, so check
+// audio_reader_status after one; reads return 0 once an error is set
+size_t audio_reader_read(AudioReader *reader, double *output, size_t frames);
+// First error seen by the reader (AUDIO_SUCCESS while the data is valid)
+AudioError audio_reader_status(const AudioReader *reader);
+void audio_reader_close(AudioReader *reader);
+
 // Convert normalized float64 to PCM and write WAV file
 AudioError write_wave(const char *filepath, AudioBuffer *buffer);
 
+// Write a FLAC file whatever the extension (e.g. to a temp path)
+AudioError write_flac(const char *filepath, AudioBuffer *buffer);
+
+// Nonzero if the path has a ".flac" extension (any case)
+int audio_path_is_flac(const char *filepath);
+
+// Streaming writer: encode interleaved float64 frames block by block
+// The header is written with an empty data chunk and its sizes are patched
+// by audio_writer_close, so the total length need not be known up front
+AudioWriter* audio_writer_open(const char *filepath, int sample_rate,
+                               int channels, int bit_depth, AudioError *error);
+// The same, always encoding FLAC
+AudioWriter* audio_writer_open_flac(const char *filepath, int sample_rate,
+                                    int channels, int bit_depth,
+                                    AudioError *error);
+AudioError audio_writer_write(AudioWriter *writer, const double *input,
+                              size_t frames);
+// Finalize the header and close; returns the first error seen by the writer
+AudioError audio_writer_close(AudioWriter *writer);
+
+// Large-file I/O mode (process-wide, off by default)
+// Readers and writers move data in windows of AUDIO_IO_WINDOW bytes and
+// drop each window from the page cache once it has been consumed (reads)
+// or written back (writes), so multi-GB files are not cached twice and do
+// not evict other data. Closing a writer waits for its tail to reach the
+// disk. read_wave and write_wave stream through a reader/writer, and
+// write_wave preallocates its output. Set before starting worker threads.
+#define AUDIO_IO_WINDOW ((size_t)8 << 20)
+void audio_io_set_large_files(int enable);
+int audio_io_large_files(void);
+
+// In large-file mode, allocate the output for `frames` frames up front in
+// one extent (it is trimmed to what was written on close). A no-op outside
+// the mode and for FLAC, whose size is not known in advance; filesystems
+// without fallocate are not an error
+AudioError audio_writer_reserve(AudioWriter *writer, size_t frames);
+
+// Raw PCM access, for integer processing paths that skip float conversion
+// read_wave_pcm fills `info` and returns the data chunk as-is
+// (WAV only: both return AUDIO_ERROR_UNSUPPORTED_FORMAT for FLAC)
+PCMBuffer* read_wave_pcm(const char *filepath, AudioFileInfo *info,
+                         AudioError *error);
+AudioError write_wave_pcm(const char *filepath, const PCMBuffer *pcm,
+                          int sample_rate, int channels);
+
 // Conversion utilities
 void pcm_to_float64(PCMBuffer *pcm, double *output, size_t sample_count);
 void float64_to_pcm(double *input, PCMBuffer *pcm, size_t sample_count);
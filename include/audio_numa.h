@@ -0,0 +1,48 @@
+#ifndef AUDIO_NUMA_H
+#define AUDIO_NUMA_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Maximum NUMA nodes tracked (kernel node ids must be below this)
+#define AUDIO_NUMA_MAX_NODES 64
+
+// One NUMA node with CPUs this process may run on
+typedef struct {
+    int id;                // Kernel node id (for mbind)
+    int num_cpus;
+    int *cpus;             // CPU ids, ascending
+} AudioNumaNode;
+
+// Machine topology, discovered once from /sys/devices/system/node and the
+// process affinity mask. Nodes without usable CPUs are left out. Machines
+// without NUMA information appear as a single node holding every CPU, so
+// callers never need a separate non-NUMA path.
+typedef struct {
+    int num_nodes;
+    AudioNumaNode nodes[AUDIO_NUMA_MAX_NODES];
+} AudioNumaTopology;
+
+// Process-wide topology (thread-safe, discovered on first use)
+const AudioNumaTopology* audio_numa_topology(void);
+
+// Index (into topology->nodes) of the node the calling thread runs on
+int audio_numa_current_node(void);
+
+// Restrict the calling thread to the CPUs of a node (index into nodes)
+// Returns 0 on success, -1 on a bad index or if the kernel refuses
+int audio_numa_pin_thread(int node);
+
+// Ask the kernel to place (and move already-touched) pages of a range on a
+// node. Advisory: returns -1 where mbind is unavailable, and 0 without a
+// system call on single-node machines
+int audio_numa_bind(void *addr, size_t size, int node);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_NUMA_H
@@ -0,0 +1,58 @@
+#ifndef AUDIO_VIEW_H
+#define AUDIO_VIEW_H
+
+#include "audio_io.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Reference-counted sample storage shared by AudioBuffers and views
+// The storage is freed when the last buffer or view releases it
+struct AudioStorage {
+    double *data;          // Sample memory
+    size_t length;         // Number of samples
+    int refcount;          // Updated atomically
+};
+
+// Non-owning window into shared storage: a frame range and channel subset
+// Sample (frame f, channel c) lives at data[f * stride + c]
+typedef struct {
+    AudioStorage *storage; // Retained storage (NULL for borrowed memory)
+    double *data;          // First sample of the view
+    size_t frames;         // Number of frames in the view
+    size_t stride;         // Samples between consecutive frames
+    int channels;          // Number of channels in the view
+    int first_channel;     // Source channel index of the view's channel 0
+    int sample_rate;       // Sample rate in Hz
+} AudioBufferView;
+
+// Storage management
+AudioStorage* audio_storage_create(size_t length);
+void audio_storage_retain(AudioStorage *storage);
+void audio_storage_release(AudioStorage *storage);
+
+// Create a view covering a whole buffer (retains the buffer's storage)
+AudioError audio_view_from_buffer(AudioBuffer *buffer, AudioBufferView *view);
+
+// Wrap caller-owned interleaved memory without reference counting
+void audio_view_wrap(AudioBufferView *view, double *data, size_t frames,
+                     int channels, int sample_rate);
+
+// Create a sub-view of `frames` frames starting at `offset` (clamped)
+AudioError audio_view_slice(const AudioBufferView *src, size_t offset,
+                            size_t frames, AudioBufferView *view);
+
+// Create a sub-view of `count` channels starting at channel `first`
+AudioError audio_view_select_channels(const AudioBufferView *src, int first,
+                                      int count, AudioBufferView *view);
+
+// Release the view's reference to its storage
+void audio_view_release(AudioBufferView *view);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_VIEW_H
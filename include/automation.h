@@ -0,0 +1,103 @@
+#ifndef AUTOMATION_H
+#define AUTOMATION_H
+
+#include "audio_view.h"
+#include "hpf.h"
+#include "lpf.h"
+#include "parametric.h"
+
+// Default maximum frames between coefficient updates while a ramp is active
+#define AUTOMATION_CONTROL_FRAMES 32
+
+// Automatable filter parameters
+typedef enum {
+    AUTOMATION_FREQUENCY,   // Cutoff/center frequency in Hz
+    AUTOMATION_GAIN_DB,     // Parametric gain in dB
+    AUTOMATION_Q,           // Parametric Q
+    AUTOMATION_NUM_PARAMS
+} AutomationParam;
+
+// How a parameter approaches a breakpoint
+typedef enum {
+    AUTOMATION_STEP,        // Jump to the value at the breakpoint frame
+    AUTOMATION_LINEAR,      // Linear ramp from the previous breakpoint
+    AUTOMATION_EXPONENTIAL  // Exponential ramp (linear in log value), for
+                            // frequencies; falls back to linear across zero
+} AutomationRamp;
+
+// One breakpoint: `value` is reached at absolute frame `frame`
+typedef struct {
+    size_t frame;
+    double value;
+    AutomationRamp ramp;
+} AutomationEvent;
+
+// Breakpoints of one parameter, sorted by frame
+typedef struct {
+    AutomationEvent *events;
+    size_t count;
+    size_t capacity;
+    double initial;         // Value at frame 0 (start of the first ramp)
+} AutomationLane;
+
+// Filter kinds the engine can drive
+typedef enum {
+    AUTOMATION_FILTER_HPF,
+    AUTOMATION_FILTER_LPF,
+    AUTOMATION_FILTER_PARAMETRIC
+} AutomationFilterType;
+
+// A filter plus its parameter timeline
+// Processing is split at every breakpoint, so steps land on the exact frame;
+// during ramps coefficients are redesigned from the interpolated parameters
+// on an absolute grid of `control_frames` frames. The filter is retuned in place
+// (see hpf_retune), so its state carries across every split and the fast
+// kernel (MLIR when available) runs on each sub-span.
+typedef struct {
+    AutomationFilterType type;
+    void *filter;           // HPFFilter/LPFFilter/ParametricFilter (borrowed)
+    double sample_rate;
+    AutomationLane lanes[AUTOMATION_NUM_PARAMS];
+    size_t position;        // Absolute frame of the next sample processed
+    size_t control_frames;  // Max frames per coefficient update in ramps
+} AutomatedFilter;
+
+// Attach a timeline to an initialized filter
+// The initial parameter values are taken from the filter itself
+// Parameters:
+//   af: Automation state to initialize
+//   type: Kind of `filter`
+//   filter: Pointer to an HPFFilter, LPFFilter or ParametricFilter
+//   sample_rate: Audio sample rate in Hz
+void automation_init(AutomatedFilter *af, AutomationFilterType type,
+                     void *filter, double sample_rate);
+
+// Free the event storage (the filter is not touched)
+void automation_free(AutomatedFilter *af);
+
+// Add a breakpoint; events may be added in any order
+// Adding an event at a frame that already has one replaces it
+// Returns 0 on success, -1 on invalid arguments or allocation failure
+int automation_add_event(AutomatedFilter *af, AutomationParam param,
+                         size_t frame, double value, AutomationRamp ramp);
+
+// Remove every event of every lane
+void automation_clear(AutomatedFilter *af);
+
+// Parameter value at an absolute frame
+double automation_value_at(const AutomatedFilter *af, AutomationParam param,
+                           size_t frame);
+
+// Move the timeline position (e.g. after seeking in the source)
+void automation_seek(AutomatedFilter *af, size_t frame);
+
+// Process the next view->frames frames of the timeline in place
+// Output is identical however the stream is split into blocks
+void automation_process_view(AutomatedFilter *af, const AudioBufferView *view);
+void automation_process_buffer(AutomatedFilter *af, AudioBuffer *buffer);
+
+// Chain stage adapter: audio_chain_add(chain, "automation",
+// automation_stage, af)
+void automation_stage(void *state, const AudioBufferView *tile);
+
+#endif // AUTOMATION_H
@@ -0,0 +1,94 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "audio_io.h"
+#include <stddef.h>
+
+// Coordinator-free batch processing over shared storage
+//
+// A manifest lists jobs, one per line: input and output paths separated by
+// a tab (blank lines and lines starting with '#' are ignored; relative paths
+// are relative to the manifest's directory). Any number of workers, on one
+// machine or many, run batch_run on the same manifest and split the jobs
+// between them through files in a shared lease directory:
+//
+//   job-N.lease   Claim, created with O_CREAT | O_EXCL. Its owner refreshes
+//                 the mtime every heartbeat interval; a lease whose mtime is
+//                 older than the lease timeout belongs to a crashed worker
+//                 and may be broken and reclaimed.
+//   job-N.done    Written after the output was committed.
+//   job-N.failed  Written when the job function failed (not retried until
+//                 the marker is removed).
+//
+// Outputs are written to a worker-unique temp file, fsynced and renamed
+// over the output path, so readers never see partial files. Leases give
+// best-effort exclusion: if two workers ever run the same job (a stalled
+// worker outliving its lease), both commit the same output and the result
+// is unchanged.
+
+// Default lease settings (seconds)
+#define BATCH_LEASE_TIMEOUT 60.0
+#define BATCH_HEARTBEAT_INTERVAL 10.0
+#define BATCH_POLL_INTERVAL 1.0
+
+// One manifest entry
+typedef struct {
+    char *input;           // Input path (resolved against the manifest)
+    char *output;          // Output path (resolved against the manifest)
+} BatchJob;
+
+// Parsed manifest
+typedef struct {
+    BatchJob *jobs;
+    size_t num_jobs;
+    char *lease_dir;       // Default lease directory: "<manifest>.leases"
+    size_t error_line;     // Line of the first parse error (1-based)
+} BatchManifest;
+
+// Worker settings
+typedef struct {
+    double lease_timeout;       // Seconds without a heartbeat before expiry
+    double heartbeat_interval;  // Seconds between lease refreshes
+    double poll_interval;       // Wait between scans while others hold jobs
+    const char *lease_dir;      // Overrides manifest->lease_dir when set
+    int threads;                // Worker threads in this process (<= 1: one)
+} BatchOptions;
+
+// Jobs handled by one batch_run call
+typedef struct {
+    size_t completed;      // Outputs committed by this worker
+    size_t failed;         // Jobs this worker marked failed
+    size_t skipped;        // Jobs already done or failed at the start
+} BatchStats;
+
+// Process one job: read job->input and write the result to temp_path
+// (not job->output; the commit is done by batch_run)
+typedef AudioError (*BatchJobFn)(void *user, const BatchJob *job,
+                                 const char *temp_path);
+
+// Load a manifest
+// Returns AUDIO_ERROR_INVALID_FORMAT (with error_line set) for a line
+// without a tab-separated output path
+AudioError batch_manifest_load(const char *filepath, BatchManifest *manifest);
+void batch_manifest_free(BatchManifest *manifest);
+
+// Default settings (BATCH_LEASE_TIMEOUT, BATCH_HEARTBEAT_INTERVAL, ...,
+// one thread)
+void batch_options_default(BatchOptions *options);
+
+// Run as one worker until every job is done or failed
+// Jobs leased by live workers are waited for, so a crashed worker's jobs
+// are picked up once its lease expires. The lease directory is created if
+// needed. Returns an error only when the lease directory cannot be used;
+// job failures are reported through the .failed markers and `stats`.
+//
+// With options->threads > 1 the process runs that many workers, each with
+// its own lease id, and `fn` must be thread-safe. On multi-socket machines
+// the threads are pinned round-robin to the NUMA nodes, so the buffers a
+// job allocates are first-touched on the node that filters them, and
+// recycled there when the caller has enabled the pool (audio_pool_enable;
+// audio-util does for --threads and --processes).
+AudioError batch_run(const BatchManifest *manifest, const BatchOptions *options,
+                     BatchJobFn fn, void *user, BatchStats *stats);
+
+#endif // BATCH_H
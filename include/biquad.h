@@ -1,6 +1,8 @@
 #ifndef BIQUAD_H
 #define BIQUAD_H
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -11,6 +13,14 @@ extern "C" {
 #define FLT_MIN_PLUS      1.175494351e-38  // min positive value
 #define FLT_MIN_MINUS     -1.175494351e-38 // min negative value
 
+// Residual level at which a filter's state is considered settled (well below
+// one LSB at 24-bit), used when sizing warm-up windows
+#define BIQUAD_SETTLE_THRESHOLD 1e-9
+
+// Channels with independent filter state in the HPF/LPF/PEQ filters
+// (left, right, then one BiQuad per further channel)
+#define BIQUAD_MAX_CHANNELS 16
+
 // BiQuad filter structure
 // Implements a modified biquad filter with wet (C0) and dry (D0) coefficients
 typedef struct {
@@ -35,12 +45,27 @@ void biquad_init(BiQuad *bq);
 // Call this when starting to process a new audio stream
 void biquad_flush_delays(BiQuad *bq);
 
+// Copy coefficients (a0-a2, b1-b2, c0, d0) from `src`, keeping the delay
+// state of `dst`. Used to retune a running filter without a discontinuity.
+void biquad_copy_coefficients(BiQuad *dst, const BiQuad *src);
+
 // Process a single sample through the biquad filter
 // Implements the difference equation:
 // y(n) = a0*x(n) + a1*x(n-1) + a2*x(n-2) - b1*y(n-1) - b2*y(n-2)
 // Returns the filtered output sample
 double biquad_process(BiQuad *bq, double input);
 
+// Process `frames` samples spaced `stride` apart in place, applying the
+// wet/dry mix: data[i*stride] = filtered*c0 + input*d0
+void biquad_process_strided(BiQuad *bq, double *data, size_t frames,
+                            size_t stride);
+
+// Estimate how many samples the impulse response needs to decay below
+// `threshold` (relative to its peak), from the pole radius of the feedback
+// section. Used to size warm-up windows that prime the filter state before
+// a region of interest. Returns (size_t)-1 for unstable/marginal filters.
+size_t biquad_decay_length(const BiQuad *bq, double threshold);
+
 #ifdef __cplusplus
 }
 #endif
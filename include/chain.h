@@ -0,0 +1,70 @@
+#ifndef CHAIN_H
+#define CHAIN_H
+
+#include "audio_io.h"
+#include "audio_view.h"
+#include "hpf.h"
+#include "lpf.h"
+#include "parametric.h"
+
+// Maximum number of stages in one chain
+#define AUDIO_CHAIN_MAX_STAGES 32
+
+// Maximum channels tracked by the meter stage
+#define AUDIO_METER_MAX_CHANNELS 16
+
+// Stage callback: process one tile (all channels of a frame range) in place
+// Stages keep their own state, so consecutive tiles continue seamlessly
+typedef void (*AudioStageFn)(void *state, const AudioBufferView *tile);
+
+// One stage of a processing chain
+typedef struct {
+    const char *name;      // For diagnostics
+    AudioStageFn process;  // Tile callback
+    void *state;           // Stage state (filter, meter, ...)
+} AudioStage;
+
+// Cache-blocked processing chain
+// Instead of streaming the whole buffer through memory once per stage, the
+// executor pushes one cache-sized tile through every stage while it is hot
+typedef struct {
+    AudioStage stages[AUDIO_CHAIN_MAX_STAGES];
+    int num_stages;
+    size_t tile_frames;    // Frames per tile (0 = autotune on first run)
+} AudioChain;
+
+// Peak/RMS meter stage state
+typedef struct {
+    double peak[AUDIO_METER_MAX_CHANNELS];         // Max |sample| per channel
+    double sum_squares[AUDIO_METER_MAX_CHANNELS];  // Running sum of squares
+    size_t frames;                                 // Frames metered
+} AudioMeter;
+
+// Initialize an empty chain (tile size autotuned)
+void audio_chain_init(AudioChain *chain);
+
+// Append a stage; returns 0 on success, -1 if the chain is full
+int audio_chain_add(AudioChain *chain, const char *name, AudioStageFn process,
+                    void *state);
+
+// Append built-in stages (the chain borrows the filter/meter)
+int audio_chain_add_hpf(AudioChain *chain, HPFFilter *hpf);
+int audio_chain_add_lpf(AudioChain *chain, LPFFilter *lpf);
+int audio_chain_add_parametric(AudioChain *chain, ParametricFilter *peq);
+int audio_chain_add_meter(AudioChain *chain, AudioMeter *meter);
+
+// Fix the tile size instead of autotuning
+void audio_chain_set_tile_frames(AudioChain *chain, size_t frames);
+
+// Run every stage over a buffer/view, tile by tile
+// On the first run with tile_frames == 0, the leading tiles are processed
+// with each candidate size and the fastest is kept for the rest of the run
+// and for later calls. Output is identical for every tile size.
+void audio_chain_process(AudioChain *chain, AudioBuffer *buffer);
+void audio_chain_process_view(AudioChain *chain, const AudioBufferView *view);
+
+// Meter helpers
+void audio_meter_reset(AudioMeter *meter);
+double audio_meter_rms(const AudioMeter *meter, int channel);
+
+#endif // CHAIN_H
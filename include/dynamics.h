@@ -0,0 +1,177 @@
+#ifndef DYNAMICS_H
+#define DYNAMICS_H
+
+#include "audio_io.h"
+#include "audio_view.h"
+#include "hpf.h"
+
+// Frames per detector block (the linked envelope is computed for a whole
+// block before any gain is applied)
+#define DYNAMICS_BLOCK_FRAMES 256
+
+// Maximum channels with independent gate state
+#define DYNAMICS_MAX_CHANNELS 16
+
+// Gain below which a hard gate is treated as fully closed (-100 dB)
+#define GATE_CLOSED_GAIN 1e-5
+
+// Feed-forward compressor
+// The detector is the stereo-linked peak: max |x| over all channels of a
+// frame, so every channel gets the same gain and the image does not shift.
+// Level and gain are handled in dB (fast log2/exp2 approximations, within
+// 0.001 dB) and the gain reduction is smoothed with separate attack and
+// release time constants.
+typedef struct {
+    double threshold_db;   // Level where compression starts
+    double ratio;          // Input dB change per output dB change above it
+    double knee_db;        // Soft-knee width centered on the threshold
+    double makeup_db;      // Gain added after compression
+    double attack_coeff;   // One-pole coefficients of the gain smoother
+    double release_coeff;
+    double envelope_db;    // Smoothed gain reduction (dB, <= 0)
+} Compressor;
+
+// Brickwall look-ahead limiter
+// Input is delayed by `lookahead` frames in a ring buffer. The gain needed
+// by each frame (ceiling / linked peak) goes through a sliding minimum and
+// a moving average of lookahead + 1 frames, so the gain has fully ramped
+// down by the time a peak leaves the delay line and the output never
+// exceeds the ceiling. Recovery is smoothed by the release time constant.
+typedef struct {
+    double ceiling;        // Output peak limit (linear)
+    double release_coeff;  // One-pole coefficient of the gain recovery
+    int channels;          // Channels per frame (fixed at init)
+    size_t lookahead;      // Latency in frames
+    size_t window;         // lookahead + 1
+    double *delay;         // lookahead frames of interleaved input
+    double *minimum;       // Sliding-minimum output ring (window entries)
+    double *deque_value;   // Monotonic deque of pending minima
+    size_t *deque_frame;
+    size_t deque_head;
+    size_t deque_count;
+    double sum;            // Sum of the minimum ring
+    double gain;           // Gain applied to the last frame
+    size_t position;       // Absolute frame counter
+} Limiter;
+
+// Per-channel gate state
+typedef struct {
+    double envelope;       // Peak detector (linear)
+    double gain;           // Current gain (linear)
+    int open;              // Hysteresis state
+    size_t hold;           // Frames left before an open gate may close
+    int frozen;            // Filter skipped since the gate fully closed
+} GateChannel;
+
+// Noise gate / downward expander with an optional fused high-pass filter
+// Each channel has its own detector and hysteresis: the gate opens when the
+// envelope reaches the open threshold and closes only after it has stayed
+// below the (lower) close threshold for the hold time. When `hpf` is set the
+// filter runs in the same loop and the detector sees its output, so an
+// HPF -> gate voice cleanup is one pass over the data.
+// A hard gate (floor 0, ratio 0) that has fully closed stops running the
+// filter: it writes zeros and keeps the filter state frozen, comparing the
+// raw input against the open threshold, until a sample reaches it. The
+// filter then restarts primed for a constant input at that sample, which
+// for a high-pass means no step from the stale state.
+typedef struct {
+    double open_threshold;   // Linear level that opens the gate
+    double close_threshold;  // Linear level below which it may close
+    double floor;            // Gain while closed (0 = silence)
+    double ratio;            // Expansion ratio below the close threshold
+                             // (0 = gate straight to the floor)
+    double attack_coeff;     // Gain smoothing while opening
+    double release_coeff;    // Gain smoothing while closing
+    double detector_coeff;   // Envelope decay per frame
+    size_t hold_frames;
+    HPFFilter *hpf;          // Fused filter (borrowed, may be NULL)
+    GateChannel channels[DYNAMICS_MAX_CHANNELS];
+} NoiseGate;
+
+// Initialize a compressor
+// knee_db defaults to 6 dB and makeup_db to 0 dB; both may be changed after
+// init
+// Parameters:
+//   comp: Pointer to Compressor structure
+//   sample_rate: Audio sample rate in Hz
+//   threshold_db: Threshold in dBFS (e.g., -20.0)
+//   ratio: Compression ratio (e.g., 4.0 for 4:1, >= 1)
+//   attack_ms: Attack time in milliseconds
+//   release_ms: Release time in milliseconds
+void compressor_init(Compressor *comp, double sample_rate, double threshold_db,
+                     double ratio, double attack_ms, double release_ms);
+
+// Clear the envelope
+void compressor_reset(Compressor *comp);
+
+// Compress a view/buffer in place (any number of channels)
+void compressor_process_view(Compressor *comp, const AudioBufferView *view);
+void compressor_process_buffer(Compressor *comp, AudioBuffer *buffer);
+
+// Initialize a hard gate (floor 0, ratio 0, no fused filter); floor, ratio
+// and hpf may be changed after init
+// Parameters:
+//   gate: Pointer to NoiseGate structure
+//   sample_rate: Audio sample rate in Hz
+//   open_db: Opening threshold in dBFS (e.g., -40.0)
+//   close_db: Closing threshold in dBFS, at most open_db (e.g., -46.0)
+//   attack_ms: Opening time in milliseconds
+//   hold_ms: Time the level must stay below close_db before closing
+//   release_ms: Closing time in milliseconds
+void gate_init(NoiseGate *gate, double sample_rate, double open_db,
+               double close_db, double attack_ms, double hold_ms,
+               double release_ms);
+
+// Close every channel and clear the detectors (the filter is not touched)
+void gate_reset(NoiseGate *gate);
+
+// Gate a view/buffer in place, running the fused filter first if set
+// Channels beyond DYNAMICS_MAX_CHANNELS are left untouched
+void gate_process_view(NoiseGate *gate, const AudioBufferView *view);
+void gate_process_buffer(NoiseGate *gate, AudioBuffer *buffer);
+
+// Initialize a limiter (allocates the delay line)
+// Parameters:
+//   lim: Pointer to Limiter structure
+//   sample_rate: Audio sample rate in Hz
+//   channels: Channels of every view the limiter will process
+//   ceiling_db: Output peak limit in dBFS (e.g., -1.0)
+//   lookahead_ms: Look-ahead (and latency) in milliseconds
+//   release_ms: Release time in milliseconds
+// Returns 0 on success, -1 on invalid parameters or allocation failure
+int limiter_init(Limiter *lim, double sample_rate, int channels,
+                 double ceiling_db, double lookahead_ms, double release_ms);
+
+// Free the delay line
+void limiter_free(Limiter *lim);
+
+// Clear the delay line and the gain state
+void limiter_reset(Limiter *lim);
+
+// Limit a view in place; output is delayed by lim->lookahead frames
+// Views with a channel count other than lim->channels are left untouched
+void limiter_process_view(Limiter *lim, const AudioBufferView *view);
+
+// Limit a whole buffer with the latency removed: each frame's gain is
+// applied in place to the frame `lookahead` frames back, then silence is
+// pushed through for the last frames. Expects a freshly reset limiter
+void limiter_process_buffer(Limiter *lim, AudioBuffer *buffer);
+
+// Apply the gains still owed to the last `lookahead` frames of a buffer
+// limited by limiter_buffer_stage
+void limiter_finish_buffer(Limiter *lim, AudioBuffer *buffer);
+
+// Chain stage adapters: audio_chain_add(chain, "compressor",
+// compressor_stage, comp), likewise gate_stage and limiter_stage. The
+// limiter's latency is not compensated inside a chain
+void compressor_stage(void *state, const AudioBufferView *tile);
+void gate_stage(void *state, const AudioBufferView *tile);
+void limiter_stage(void *state, const AudioBufferView *tile);
+
+// Latency-compensated limiter stage for one chain pass over a whole buffer
+// (the same output as limiter_process_buffer). It must be the chain's last
+// stage, the limiter freshly reset, and limiter_finish_buffer called after
+// the pass
+void limiter_buffer_stage(void *state, const AudioBufferView *tile);
+
+#endif // DYNAMICS_H
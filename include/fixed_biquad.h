@@ -0,0 +1,63 @@
+#ifndef FIXED_BIQUAD_H
+#define FIXED_BIQUAD_H
+
+#include "audio_io.h"
+#include "biquad.h"
+#include <stdint.h>
+
+// Fixed-point BiQuad for bit-exact PCM processing
+// Samples are Q1.23 in int32 (16-bit PCM is scaled up by 8 bits),
+// coefficients are int32 with `frac_bits` fractional bits (Q2.30 when every
+// coefficient is below 2 in magnitude) and the difference equation is summed
+// in int64. The fraction dropped when the accumulator is shifted back to
+// samples is fed into the next sample (first-order error feedback), which
+// pushes the truncation noise away from DC where low-frequency poles would
+// otherwise amplify it. Only integer arithmetic is used, so the output for
+// given integer coefficients is identical on every host and compiler.
+
+// Headroom above full scale for the internal output state (+24 dB)
+#define FIXED_BIQUAD_HEADROOM_BITS 4
+
+// Coefficient precision limits for fixed_biquad_init
+#define FIXED_BIQUAD_MAX_FRAC_BITS 30
+#define FIXED_BIQUAD_MIN_FRAC_BITS 16
+
+typedef struct {
+    int32_t a0, a1, a2; // Feedforward coefficients (wet/dry mix folded in)
+    int32_t b1, b2;     // Feedback coefficients
+    int frac_bits;      // Fractional bits of the coefficients
+    int32_t x1, x2;     // Input delays (Q1.23)
+    int32_t y1, y2;     // Output delays (Q1.23 with headroom)
+    int64_t error;      // Fraction dropped by the last output shift
+} FixedBiQuad;
+
+// Quantize a floating-point design
+// The c0/d0 wet/dry mix is folded into the feedforward coefficients. The
+// largest frac_bits (at most 30) that keeps every coefficient in int32 is
+// used. Quantization of the double coefficients is exact IEEE rounding, so
+// hosts that design the same doubles get the same integers.
+// Returns 0 on success, -1 if a coefficient needs fewer than 16 fractional
+// bits
+int fixed_biquad_init(FixedBiQuad *fb, const BiQuad *bq);
+
+// Use pre-quantized coefficients {a0, a1, a2, b1, b2} (e.g. a pinned table)
+void fixed_biquad_init_q(FixedBiQuad *fb, const int32_t coeffs[5],
+                         int frac_bits);
+
+// Zero the delays and the error feedback
+void fixed_biquad_reset(FixedBiQuad *fb);
+
+// Process one Q1.23 sample; the result saturates at the headroom limit
+int32_t fixed_biquad_process(FixedBiQuad *fb, int32_t input);
+
+// Filter interleaved 16- or 24-bit little-endian PCM in place
+// Parameters:
+//   filters: One filter per channel
+//   channels: Number of interleaved channels
+//   pcm: PCM data (pcm->length bytes, whole frames)
+// Output is rounded and saturated to the PCM range.
+// Returns AUDIO_ERROR_UNSUPPORTED_FORMAT for other bit depths
+AudioError fixed_biquad_process_pcm(FixedBiQuad *filters, int channels,
+                                    PCMBuffer *pcm);
+
+#endif // FIXED_BIQUAD_H
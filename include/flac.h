@@ -0,0 +1,75 @@
+#ifndef FLAC_H
+#define FLAC_H
+
+#include "audio_io.h"
+#include <stdint.h>
+#include <stdio.h>
+
+// Native FLAC decoding and encoding behind the streaming reader and writer
+//
+// The decoder handles every subframe type (constant, verbatim, fixed and
+// LPC up to order 32), both residual coding methods including escaped
+// partitions, wasted bits and all stereo decorrelation modes, and checks
+// the CRC-8 and CRC-16 of every frame. Input is read in large chunks and
+// decoded one frame at a time, so memory use does not depend on file size.
+//
+// The encoder is the fast end of the format: fixed predictors (order 0-4)
+// chosen per channel, the cheapest of the four stereo modes, and Rice
+// parameters chosen per partition, falling back to verbatim samples where
+// prediction does not pay. The MD5 signature is left unset (all zeros).
+//
+// These work on an open FILE; most code goes through audio_reader_open /
+// audio_writer_open, which pick FLAC by magic and by extension.
+
+// Frames per encoded block
+#define FLAC_BLOCK_SIZE 4096
+
+// Channels a FLAC stream can carry
+#define FLAC_MAX_CHANNELS 8
+
+typedef struct FlacDecoder FlacDecoder;
+typedef struct FlacEncoder FlacEncoder;
+
+// Nonzero if the file starts with the "fLaC" marker
+// The file position is left unchanged
+int flac_probe(FILE *file);
+
+// Parse the metadata of the stream at the start of `file` and fill `info`
+// (bit_depth is the container size: 8, 16 or 24; data_size is the size of
+// the decoded PCM). Streams deeper than 24 bits are unsupported.
+FlacDecoder* flac_decoder_open(FILE *file, AudioFileInfo *info,
+                               AudioError *error);
+
+// Decode up to `frames` interleaved frames, normalized like WAV input
+// Returns the number of frames decoded; a short count before the end of
+// the stream means the data is corrupt or truncated (see
+// flac_decoder_status)
+size_t flac_decoder_read(FlacDecoder *decoder, double *output, size_t frames);
+
+// Position at `frame` (clamped to the end of the stream). Uses the
+// stream's SEEKTABLE when there is one, otherwise decodes forward from the
+// current position or from the start.
+AudioError flac_decoder_seek(FlacDecoder *decoder, size_t frame);
+
+// First error seen by the decoder (AUDIO_SUCCESS while the data is valid)
+AudioError flac_decoder_status(const FlacDecoder *decoder);
+
+// Release the decoder (the file stays open)
+void flac_decoder_free(FlacDecoder *decoder);
+
+// Write the stream header; bit_depth must be 8, 16 or 24
+FlacEncoder* flac_encoder_open(FILE *file, int sample_rate, int channels,
+                               int bit_depth, AudioError *error);
+
+// Append interleaved frames (quantized like WAV output)
+AudioError flac_encoder_write(FlacEncoder *encoder, const double *input,
+                              size_t frames);
+
+// Encode the last partial block and patch the sample count and frame
+// sizes into STREAMINFO. Returns the first error seen by the encoder.
+AudioError flac_encoder_finish(FlacEncoder *encoder);
+
+// Release the encoder (the file stays open)
+void flac_encoder_free(FlacEncoder *encoder);
+
+#endif // FLAC_H
@@ -3,6 +3,7 @@
 
 #include "biquad.h"
 #include "audio_io.h"
+#include "audio_view.h"
 
 #ifdef USE_MLIR
 #include "mlir_biquad.h"
@@ -14,6 +15,7 @@
 typedef struct {
     BiQuad left;        // Left channel biquad filter
     BiQuad right;       // Right channel biquad filter
+    BiQuad extra[BIQUAD_MAX_CHANNELS - 2]; // Channels 2 and up
     double frequency;   // Cutoff frequency in Hz
 #ifdef USE_MLIR
     MLIRBiQuadJIT *left_jit;   // MLIR JIT context for left channel
@@ -37,10 +39,22 @@ void hpf_init(HPFFilter *hpf, double sample_rate, double freq);
 //   freq: New cutoff frequency in Hz
 void hpf_update_coefficients(HPFFilter *hpf, double sample_rate, double freq);
 
+// Retune to a new cutoff without resetting filter state
+// Unlike hpf_update_coefficients, the delay elements (and any MLIR JIT
+// handles, whose kernels take coefficients per call) are kept, so audio
+// continues without a click. Used by the automation engine.
+// Parameters:
+//   hpf: Pointer to HPFFilter structure
+//   sample_rate: Audio sample rate in Hz
+//   freq: New cutoff frequency in Hz
+void hpf_retune(HPFFilter *hpf, double sample_rate, double freq);
+
 // Process an audio buffer through the high-pass filter
 // Supports both mono and stereo processing
 // For mono: processes all samples with left filter
 // For stereo: alternates between left and right filters
+// For more channels: channel 2 and up use the `extra` filters; channels
+// beyond BIQUAD_MAX_CHANNELS are left untouched
 // Parameters:
 //   hpf: Pointer to HPFFilter structure
 //   buffer: Pointer to AudioBuffer containing audio data
@@ -55,4 +69,28 @@ void hpf_process_buffer(HPFFilter *hpf, AudioBuffer *buffer);
 //   channel: 0 for left, 1 for right
 void hpf_process_channel(HPFFilter *hpf, double *data, size_t length, int channel);
 
+// Process a view (frame range and channel subset) of an audio buffer in place
+// Each view channel keeps the filter state of its source channel (see
+// hpf_channel_filter), so this matches hpf_process_buffer for any
+// channel count and tiling
+// Parameters:
+//   hpf: Pointer to HPFFilter structure
+//   view: View to process (see audio_view.h)
+void hpf_process_view(HPFFilter *hpf, const AudioBufferView *view);
+
+// Filter state of a source channel: left for 0, right for 1, then `extra`
+// Returns NULL for channels at or beyond BIQUAD_MAX_CHANNELS
+// Parameters:
+//   hpf: Pointer to HPFFilter structure
+//   channel: Source channel index
+BiQuad *hpf_channel_filter(HPFFilter *hpf, int channel);
+
+// Number of frames needed to settle the filter state before a region
+// Processing this many frames ahead of a region start makes the region output
+// match a full-file render to within BIQUAD_SETTLE_THRESHOLD
+// Parameters:
+//   sample_rate: Audio sample rate in Hz
+//   freq: Cutoff frequency in Hz
+size_t hpf_warmup_frames(double sample_rate, double freq);
+
 #endif // HPF_H
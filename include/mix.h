@@ -0,0 +1,68 @@
+#ifndef MIX_H
+#define MIX_H
+
+#include "audio_io.h"
+#include "chain.h"
+
+// Maximum number of inputs summed by one mixer
+#define AUDIO_MIX_MAX_INPUTS 32
+
+// Default frames per block (4096 stereo frames = 64 KiB of float64)
+#define AUDIO_MIX_BLOCK_FRAMES 4096
+
+// One mixer input
+typedef struct {
+    AudioReader *reader;   // Borrowed streaming reader
+    AudioChain *chain;     // Optional per-input chain (borrowed, may be NULL)
+    double gain;           // Linear gain applied when summing
+} AudioMixInput;
+
+// Block-synchronous mixer
+// Every input is read once, one block at a time: each block is decoded,
+// run through the input's chain, scaled and accumulated into the mix
+// block. Memory is two blocks regardless of the input lengths. Inputs that
+// end early contribute silence, so the mix is as long as the longest input;
+// an input that fails to decode stops the mix with its error instead.
+typedef struct {
+    AudioMixInput inputs[AUDIO_MIX_MAX_INPUTS];
+    int num_inputs;
+    int sample_rate;       // Common sample rate (from the first input)
+    int channels;          // Common channel count (from the first input)
+    size_t block_frames;   // Frames per block
+    double *scratch;       // One decoded input block
+    double *mix;           // Accumulated output block
+    AudioError error;      // First read or allocation error
+} AudioMixer;
+
+// Initialize an empty mixer (block_frames == 0 uses AUDIO_MIX_BLOCK_FRAMES)
+void audio_mixer_init(AudioMixer *mixer, size_t block_frames);
+
+// Add an input
+// Parameters:
+//   mixer: Mixer to add to
+//   reader: Open reader, positioned where mixing should start
+//   gain_db: Input gain in dB
+//   chain: Chain applied to the input before summing (NULL for none)
+// Returns AUDIO_ERROR_UNSUPPORTED_FORMAT if the sample rate or channel count
+// differs from the first input
+AudioError audio_mixer_add_input(AudioMixer *mixer, AudioReader *reader,
+                                 double gain_db, AudioChain *chain);
+
+// Mix the next block
+// On return *block points at the mixer's interleaved output block, valid
+// until the next call. Returns the number of frames (0 once every input is
+// exhausted, or on an error, which is kept in mixer->error)
+size_t audio_mixer_process(AudioMixer *mixer, const double **block);
+
+// Mix every input to the end and stream the result to a writer
+// Returns the first error of the inputs, the mixer or the writer
+AudioError audio_mixer_run(AudioMixer *mixer, AudioWriter *writer);
+
+// Free the mixer's blocks (readers and chains stay with the caller)
+void audio_mixer_free(AudioMixer *mixer);
+
+// dst[i] += gain * src[i]
+void audio_mix_accumulate(double *restrict dst, const double *restrict src,
+                          double gain, size_t count);
+
+#endif // MIX_H
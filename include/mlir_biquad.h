@@ -18,6 +18,11 @@ extern "C" {
  * 
  * The MLIR implementation generates optimized IR for the BiQuad processing loop and
  * uses LLVM's JIT compiler for execution.
+ *
+ * Thread safety: mlir_biquad_jit_create() and mlir_biquad_jit_destroy() may
+ * be called concurrently from any number of threads. LLVM target setup runs
+ * once per process and all JIT contexts share one compile thread pool. A
+ * single handle must not be used by two threads at the same time.
  */
 
 /**
@@ -28,8 +33,12 @@ typedef struct MLIRBiQuadJIT MLIRBiQuadJIT;
 /**
  * @brief Initialize MLIR BiQuad JIT compiler
  * 
- * Creates a JIT-compiled function for BiQuad processing based on the provided
- * filter coefficients. This function should be called once per filter instance.
+ * Returns a handle to the JIT-compiled BiQuad kernels. Coefficients are passed
+ * at call time, so every handle shares one compiled copy of the code, freed
+ * with the last handle. Creation itself is cheap: each entry point
+ * (per-sample and buffer) is generated and compiled the first time any handle
+ * calls it, so buffer-only users never compile the per-sample kernel. No MLIR
+ * context is retained after compilation.
  * 
  * @param bq Pointer to BiQuad filter structure with initialized coefficients
  * @return Pointer to JIT context, or NULL on failure
@@ -65,6 +74,23 @@ void mlir_biquad_process_buffer(MLIRBiQuadJIT *jit, BiQuad *bq,
                                 const double *input, double *output, 
                                 size_t length);
 
+/**
+ * @brief Process a strided run of samples in place
+ *
+ * Processes `frames` samples spaced `stride` apart (e.g. one channel of an
+ * interleaved buffer view). Non-unit strides are gathered into a small
+ * contiguous block so the JIT buffer kernel still runs on each block.
+ * Applies the c0/d0 wet/dry mix, matching biquad_process_strided().
+ *
+ * @param jit Pointer to JIT context created by mlir_biquad_jit_create()
+ * @param bq Pointer to BiQuad filter structure (for state variables)
+ * @param data First sample
+ * @param frames Number of samples to process
+ * @param stride Distance between consecutive samples
+ */
+void mlir_biquad_process_strided(MLIRBiQuadJIT *jit, BiQuad *bq,
+                                 double *data, size_t frames, size_t stride);
+
 /**
  * @brief Destroy MLIR BiQuad JIT context and free resources
  * 
@@ -0,0 +1,243 @@
+#ifndef MLIR_DSP_H
+#define MLIR_DSP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "biquad.h"
+#include "chain.h"
+
+#ifdef USE_MLIR
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Whole-chain compilation through the MLIR "dsp" dialect
+ *
+ * A chain is described once as a list of stages and lowered to a per-sample
+ * function of `dsp` ops (dsp.biquad, dsp.cascade, dsp.gain, dsp.mix,
+ * dsp.meter, dsp.convert_pcm). Rewrite passes then optimize the chain as a whole:
+ *
+ *   - dsp-fold-gains:      merge gain chains, drop unit gains and fold gains
+ *                          into the feedforward coefficients of biquads
+ *   - dsp-fuse-sections:   fuse adjacent biquads/cascades into one cascade
+ *   - dsp-select-topology: pick Direct Form I or Transposed Direct Form II
+ *                          per cascade from its pole radii
+ *   - dsp-lower-to-loops:  lower to the same scf.for buffer loop used by
+ *                          mlir_biquad, with all section state carried in
+ *                          registers across iterations
+ *
+ * Coefficients are compile-time constants of the kernel, so a chain is
+ * compiled per coefficient set.
+ */
+
+/**
+ * @brief Stage kinds accepted by mlir_dsp_chain_create()
+ */
+typedef enum {
+    DSP_STAGE_BIQUAD,  /**< BiQuad section (uses c0/d0 wet/dry mix) */
+    DSP_STAGE_GAIN     /**< Linear gain */
+} DspStageType;
+
+/**
+ * @brief One stage of a chain description
+ */
+typedef struct {
+    DspStageType type;
+    BiQuad biquad;     /**< Coefficients for DSP_STAGE_BIQUAD */
+    double gain;       /**< Linear gain for DSP_STAGE_GAIN */
+} DspStageSpec;
+
+/**
+ * @brief Opaque handle to a compiled chain (owns its filter state)
+ */
+typedef struct MLIRDspChain MLIRDspChain;
+
+/**
+ * @brief Build, optimize and JIT-compile a chain
+ *
+ * @param stages Array of stage descriptions, applied in order
+ * @param num_stages Number of stages
+ * @return Compiled chain, or NULL on failure
+ */
+MLIRDspChain* mlir_dsp_chain_create(const DspStageSpec *stages,
+                                    int num_stages);
+
+/**
+ * @brief Run the whole chain over a buffer in one pass
+ *
+ * State carries over between calls, so a stream can be processed in blocks.
+ *
+ * @param chain Compiled chain
+ * @param input Input samples
+ * @param output Output samples (can be same as input)
+ * @param length Number of samples
+ */
+void mlir_dsp_chain_process(MLIRDspChain *chain, const double *input,
+                            double *output, size_t length);
+
+/**
+ * @brief Zero the chain's filter state
+ */
+void mlir_dsp_chain_reset(MLIRDspChain *chain);
+
+/**
+ * @brief Number of biquad sections left after fusion and folding
+ */
+int mlir_dsp_chain_num_sections(const MLIRDspChain *chain);
+
+/**
+ * @brief Destroy a compiled chain
+ */
+void mlir_dsp_chain_destroy(MLIRDspChain *chain);
+
+/**
+ * @brief Whole-pipeline description: PCM in, chain, meter, PCM out
+ *
+ * A pipeline compiles decode, every section and gain, metering, dither and
+ * quantization into a single loop over interleaved frames, so no
+ * intermediate float buffer is ever written.
+ */
+typedef struct {
+    const DspStageSpec *stages;  /**< Stages applied to every channel */
+    int num_stages;              /**< Number of stages */
+    int channels;                /**< Interleaved channels (own state each) */
+    int input_bits;              /**< Input PCM depth: 16, 24 or 32 */
+    int output_bits;             /**< Output PCM depth: 16, 24 or 32 */
+    int dither;                  /**< Non-zero: TPDF dither before quantizing */
+} DspPipelineSpec;
+
+/**
+ * @brief Opaque handle to a pipeline (shared compiled plan + own state)
+ */
+typedef struct MLIRDspPipeline MLIRDspPipeline;
+
+/**
+ * @brief Create a pipeline, reusing a compiled plan when one exists
+ *
+ * Plans are cached by a hash of the spec (coefficients, gains, channel count
+ * and formats), so pipelines with the same spec share one JIT-compiled
+ * kernel. A plan is freed with the last pipeline using it.
+ *
+ * @param spec Pipeline description (stages are copied into the plan)
+ * @return Pipeline, or NULL on failure or unsupported format
+ */
+MLIRDspPipeline* mlir_dsp_pipeline_create(const DspPipelineSpec *spec);
+
+/**
+ * @brief Run the pipeline over interleaved PCM frames
+ *
+ * Filter state, meters and dither state carry over between calls.
+ *
+ * @param pipeline Pipeline
+ * @param input Input PCM (input_bits, packed little-endian for 24-bit)
+ * @param output Output PCM (output_bits); may alias input if the depths match
+ * @param frames Number of frames
+ */
+void mlir_dsp_pipeline_process(MLIRDspPipeline *pipeline, const void *input,
+                               void *output, size_t frames);
+
+/**
+ * @brief Peak/RMS of the filtered signal (before dither) so far
+ */
+void mlir_dsp_pipeline_get_meter(const MLIRDspPipeline *pipeline,
+                                 AudioMeter *meter);
+
+/**
+ * @brief Zero filter state and meters and restart the dither sequence
+ */
+void mlir_dsp_pipeline_reset(MLIRDspPipeline *pipeline);
+
+/**
+ * @brief Hash of the plan the pipeline runs
+ */
+uint64_t mlir_dsp_pipeline_plan_hash(const MLIRDspPipeline *pipeline);
+
+/**
+ * @brief Number of compiled plans currently alive in the cache
+ */
+int mlir_dsp_plan_cache_size(void);
+
+/**
+ * @brief Destroy a pipeline (its plan is freed with the last user)
+ */
+void mlir_dsp_pipeline_destroy(MLIRDspPipeline *pipeline);
+
+/**
+ * @brief Kernel kinds a library can hold
+ */
+typedef enum {
+    DSP_KERNEL_CHAIN,     /**< f64 buffer kernel, as mlir_dsp_chain_create() */
+    DSP_KERNEL_PIPELINE   /**< PCM kernel, as mlir_dsp_pipeline_create() */
+} DspKernelKind;
+
+/**
+ * @brief One named kernel variant of a library
+ */
+typedef struct {
+    const char *name;          /**< Unique, non-empty lookup name */
+    DspKernelKind kind;        /**< Chain or pipeline */
+    DspPipelineSpec spec;      /**< Pipeline spec; chains use only the stages */
+} DspKernelSpec;
+
+/**
+ * @brief Opaque handle to a set of kernels compiled together
+ */
+typedef struct MLIRDspLibrary MLIRDspLibrary;
+
+/**
+ * @brief Compile many kernel variants into one module and one engine
+ *
+ * Every variant (channel count, PCM formats, dither, stage list) becomes a
+ * function of a single module, the dsp passes run once over all of them and
+ * a single ExecutionEngine compiles the lot. This shares one LLVM codegen
+ * session, symbol table and code mapping instead of paying for one per
+ * kernel, which matters when dozens of variants are needed at startup.
+ *
+ * Pipeline variants are also entered into the plan cache, so a later
+ * mlir_dsp_pipeline_create() with the same spec reuses them.
+ *
+ * @param kernels Kernel descriptions (need not outlive the call)
+ * @param num_kernels Number of kernels
+ * @return Library, or NULL on failure (missing or duplicate name, bad spec)
+ */
+MLIRDspLibrary* mlir_dsp_library_create(const DspKernelSpec *kernels,
+                                        int num_kernels);
+
+/**
+ * @brief Number of kernels in the library
+ */
+int mlir_dsp_library_size(const MLIRDspLibrary *library);
+
+/**
+ * @brief New chain instance running the DSP_KERNEL_CHAIN kernel `name`
+ *
+ * The instance has its own state and keeps the compiled code alive, so it
+ * may outlive the library handle.
+ *
+ * @return Chain, or NULL if there is no chain kernel called `name`
+ */
+MLIRDspChain* mlir_dsp_library_chain(MLIRDspLibrary *library,
+                                     const char *name);
+
+/**
+ * @brief New pipeline instance running the DSP_KERNEL_PIPELINE kernel `name`
+ *
+ * @return Pipeline, or NULL if there is no pipeline kernel called `name`
+ */
+MLIRDspPipeline* mlir_dsp_library_pipeline(MLIRDspLibrary *library,
+                                           const char *name);
+
+/**
+ * @brief Release the library handle (instances keep their kernels alive)
+ */
+void mlir_dsp_library_destroy(MLIRDspLibrary *library);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* USE_MLIR */
+
+#endif /* MLIR_DSP_H */
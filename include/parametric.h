@@ -3,6 +3,7 @@
 
 #include "biquad.h"
 #include "audio_io.h"
+#include "audio_view.h"
 
 #ifdef USE_MLIR
 #include "mlir_biquad.h"
@@ -14,6 +15,7 @@
 typedef struct {
     BiQuad left;        // Left channel biquad filter
     BiQuad right;       // Right channel biquad filter
+    BiQuad extra[BIQUAD_MAX_CHANNELS - 2]; // Channels 2 and up
     double frequency;   // Center frequency in Hz
     double gain;        // Gain in dB (positive = boost, negative = cut)
     double q;           // Q factor (bandwidth control, typically 0.5-10.0)
@@ -46,10 +48,25 @@ void parametric_init(ParametricFilter *peq, double sample_rate, double freq,
 void parametric_update_coefficients(ParametricFilter *peq, double sample_rate, 
                                    double freq, double gain, double q);
 
+// Retune to new parameters without resetting filter state
+// Unlike parametric_update_coefficients, the delay elements (and any MLIR
+// JIT handles, whose kernels take coefficients per call) are kept, so audio
+// continues without a click. Used by the automation engine.
+// Parameters:
+//   peq: Pointer to ParametricFilter structure
+//   sample_rate: Audio sample rate in Hz
+//   freq: New center frequency in Hz
+//   gain: New gain in dB
+//   q: New Q factor
+void parametric_retune(ParametricFilter *peq, double sample_rate, double freq,
+                       double gain, double q);
+
 // Process an audio buffer through the parametric EQ
 // Supports both mono and stereo processing
 // For mono: processes all samples with left filter
 // For stereo: alternates between left and right filters
+// For more channels: channel 2 and up use the `extra` filters; channels
+// beyond BIQUAD_MAX_CHANNELS are left untouched
 // Parameters:
 //   peq: Pointer to ParametricFilter structure
 //   buffer: Pointer to AudioBuffer containing audio data
@@ -64,4 +81,32 @@ void parametric_process_buffer(ParametricFilter *peq, AudioBuffer *buffer);
 //   channel: 0 for left, 1 for right
 void parametric_process_channel(ParametricFilter *peq, double *data, size_t length, int channel);
 
+// Process a view (frame range and channel subset) of an audio buffer in place
+// Each view channel keeps the filter state of its source channel (see
+// parametric_channel_filter), so this matches parametric_process_buffer for
+// any channel count and tiling
+// Parameters:
+//   peq: Pointer to ParametricFilter structure
+//   view: View to process (see audio_view.h)
+void parametric_process_view(ParametricFilter *peq,
+                             const AudioBufferView *view);
+
+// Filter state of a source channel: left for 0, right for 1, then `extra`
+// Returns NULL for channels at or beyond BIQUAD_MAX_CHANNELS
+// Parameters:
+//   peq: Pointer to ParametricFilter structure
+//   channel: Source channel index
+BiQuad *parametric_channel_filter(ParametricFilter *peq, int channel);
+
+// Number of frames needed to settle the filter state before a region
+// Processing this many frames ahead of a region start makes the region output
+// match a full-file render to within BIQUAD_SETTLE_THRESHOLD
+// Parameters:
+//   sample_rate: Audio sample rate in Hz
+//   freq: Center frequency in Hz
+//   gain: Gain in dB
+//   q: Q factor
+size_t parametric_warmup_frames(double sample_rate, double freq,
+                                double gain, double q);
+
 #endif // PARAMETRIC_H
@@ -0,0 +1,62 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "audio_io.h"
+#include "chain.h"
+
+// Maximum filter threads (channel groups) in one pipeline
+#define AUDIO_PIPELINE_MAX_GROUPS 16
+
+// Default frames per block
+#define AUDIO_PIPELINE_BLOCK_FRAMES 4096
+
+// Default blocks in flight between the decode and encode stages
+#define AUDIO_PIPELINE_RING_BLOCKS 8
+
+// Filter stage for a contiguous group of channels
+typedef struct {
+    int first_channel;     // First channel of the group
+    int channels;          // Channels in the group
+    AudioChain *chain;     // Borrowed; only the group's thread touches it
+} AudioPipelineGroup;
+
+// Per-stage busy time (excluding waits on the rings)
+// The stage with the most busy time is the one bounding the throughput
+typedef struct {
+    size_t frames;         // Frames written
+    size_t blocks;         // Blocks written
+    double wall_seconds;   // Whole run
+    double decode_seconds;
+    double encode_seconds;
+    double filter_seconds[AUDIO_PIPELINE_MAX_GROUPS];
+} AudioPipelineStats;
+
+// Staged streaming pipeline
+// A decode thread reads blocks from the reader, one filter thread per
+// channel group runs the group's chain over its channels of each block, and
+// the calling thread encodes the filtered blocks to the writer. The stages
+// are joined by bounded lock-free single-producer/single-consumer rings of
+// block indices over a fixed set of preallocated blocks: a block travels
+// decode -> every filter -> encode and back to decode, so a stage that gets
+// ahead waits for a free block (backpressure) and the throughput is that of
+// the slowest stage rather than the sum of all three. Groups touch disjoint
+// channels of the same block, so they need no copies; channels outside
+// every group pass through unchanged.
+//
+// Parameters:
+//   reader: Open reader, positioned where processing should start
+//   writer: Open writer with the reader's channel count
+//   groups: Non-overlapping channel groups (may be NULL when num_groups is 0)
+//   num_groups: Number of groups, at most AUDIO_PIPELINE_MAX_GROUPS
+//   block_frames: Frames per block (0 = AUDIO_PIPELINE_BLOCK_FRAMES)
+//   ring_blocks: Blocks in flight (0 = AUDIO_PIPELINE_RING_BLOCKS)
+//   stats: Receives the stage timings (may be NULL)
+// Returns AUDIO_ERROR_INVALID_PARAMETER for bad or overlapping groups, or
+// the first error raised by the reader (corrupt or truncated input) or the
+// writer; the output then stops at the last complete block
+AudioError audio_pipeline_run(AudioReader *reader, AudioWriter *writer,
+                              const AudioPipelineGroup *groups, int num_groups,
+                              size_t block_frames, size_t ring_blocks,
+                              AudioPipelineStats *stats);
+
+#endif // PIPELINE_H
@@ -0,0 +1,59 @@
+#ifndef PREFORK_H
+#define PREFORK_H
+
+#include "audio_io.h"
+#include <stddef.h>
+
+// Pre-forked worker processes sharing state built once by the parent
+//
+// The parent prepares everything that is expensive to build (designed
+// filters, compiled JIT kernels, lookup tables) and then forks. Workers
+// inherit it at the same addresses, so pointers, including function
+// pointers into JIT-compiled code, are valid as-is and the pages are
+// shared copy-on-write: adding a worker costs neither compile time nor a
+// copy of the tables. Tables placed in a sealed arena are mapped read-only,
+// so no worker can dirty (and thereby duplicate) one of their pages.
+
+// Maximum worker processes per run
+#define AUDIO_PREFORK_MAX_WORKERS 1024
+
+// Bump allocator over one shared memory mapping (memfd-backed where
+// available, otherwise anonymous shared memory). Mapped MAP_SHARED, so
+// while unsealed it can also carry results from workers back to the parent.
+typedef struct {
+    unsigned char *base;   // Start of the mapping (same in every worker)
+    size_t size;           // Mapped bytes
+    size_t used;           // Bytes handed out
+    int fd;                // Backing memfd (-1 for anonymous memory)
+    int sealed;            // Read-only since audio_shared_arena_seal
+} AudioSharedArena;
+
+// Map a zero-filled arena of at least `size` bytes (rounded up to pages)
+// `name` labels the memfd in /proc/<pid>/maps
+AudioError audio_shared_arena_create(AudioSharedArena *arena, const char *name,
+                                     size_t size);
+
+// Take `size` bytes, aligned to AUDIO_ALLOC_ALIGNMENT
+// Returns NULL once the arena is full or sealed
+void* audio_shared_arena_alloc(AudioSharedArena *arena, size_t size);
+
+// Make the whole arena read-only (and forbid resizing the memfd)
+// Call in the parent before forking; writes afterwards fault
+AudioError audio_shared_arena_seal(AudioSharedArena *arena);
+
+// Unmap the arena (only after every worker has exited)
+void audio_shared_arena_destroy(AudioSharedArena *arena);
+
+// Worker body, run in a forked child. The return value becomes the child's
+// exit status (0 = success)
+typedef int (*AudioWorkerFn)(void *user, int worker);
+
+// Fork `workers` processes running fn(user, 0..workers-1) and wait for all
+// of them. stdio buffers are flushed before forking so nothing is printed
+// twice. Returns AUDIO_ERROR_MEMORY_ERROR if a fork fails (the workers
+// already started are still waited for); *failed (may be NULL) receives
+// the number of workers that returned nonzero or were killed.
+AudioError audio_prefork_run(int workers, AudioWorkerFn fn, void *user,
+                             int *failed);
+
+#endif // PREFORK_H
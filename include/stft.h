@@ -0,0 +1,143 @@
+#ifndef STFT_H
+#define STFT_H
+
+#include "audio_io.h"
+#include <stdint.h>
+
+// Smallest and largest supported FFT sizes (powers of two)
+#define STFT_MIN_FFT_SIZE 16
+#define STFT_MAX_FFT_SIZE (1 << 20)
+
+// Maximum worker threads per engine
+#define STFT_MAX_THREADS 64
+
+// Analysis windows (periodic, so overlapped windows sum to a constant)
+typedef enum {
+    STFT_WINDOW_RECTANGULAR = 0,
+    STFT_WINDOW_HANN = 1,
+    STFT_WINDOW_HAMMING = 2,
+    STFT_WINDOW_BLACKMAN = 3
+} StftWindow;
+
+// Magnitude encodings of the spectrogram file
+typedef enum {
+    STFT_ENCODING_FLOAT32 = 0,  // Linear magnitude as float32
+    STFT_ENCODING_DB16 = 1      // int16 hundredths of a dB (floor -300 dB)
+} StftEncoding;
+
+// Spectrogram file header
+// Followed by `frames` records of channels * bins magnitudes (channel-major
+// within a frame). All fields are host byte order, like the WAV structs.
+#pragma pack(push, 1)
+typedef struct {
+    char magic[4];          // "STFT"
+    uint16_t version;       // STFT_FILE_VERSION
+    uint16_t encoding;      // StftEncoding
+    uint32_t sample_rate;   // Sample rate of the analyzed audio
+    uint16_t channels;
+    uint16_t window;        // StftWindow
+    uint32_t fft_size;
+    uint32_t hop;           // Frames between analysis frames
+    uint32_t bins;          // fft_size / 2 + 1
+    uint64_t frames;        // Number of analysis frames
+} StftFileHeader;
+#pragma pack(pop)
+
+#define STFT_FILE_VERSION 1
+
+// Precomputed real-input FFT of one size (opaque)
+// Plans are immutable and shared: fft_plan_get returns the same plan for
+// every request of a size from threads on the same NUMA node (each node
+// gets its own copy of the tables)
+typedef struct FFTPlan FFTPlan;
+
+// Get the cached plan for a power-of-two size, creating it on first use
+// Returns NULL for unsupported sizes or on allocation failure
+const FFTPlan* fft_plan_get(size_t size);
+
+// Forward FFT of `size` real samples into bins 0..size/2 (unnormalized)
+// re and im must hold size/2 + 1 values; input is not modified
+void fft_plan_execute(const FFTPlan *plan, const double *input, double *re,
+                      double *im);
+
+// Free every cached plan (no plan may be in use)
+void fft_plan_cache_clear(void);
+
+// STFT analysis settings
+typedef struct {
+    size_t fft_size;       // Power of two in [STFT_MIN_FFT_SIZE, STFT_MAX_FFT_SIZE]
+    size_t hop;            // Frames between analysis frames (> 0)
+    StftWindow window;
+    int threads;           // Worker threads (0 = online CPUs)
+} StftConfig;
+
+// Default settings: 2048-point Hann window, hop 512, all CPUs
+void stft_config_default(StftConfig *config);
+
+// Receives one analysis frame: channels * bins magnitudes, channel-major
+// Frames arrive in order. Return 0 to continue, nonzero to stop the analysis
+typedef int (*StftSink)(void *user, size_t frame, const float *magnitudes);
+
+// STFT engine (opaque)
+// Frame k covers samples [k * hop, k * hop + fft_size) of every channel,
+// zero-padded past the end, for k < ceil(samples / hop). Frames are
+// computed in batches split across worker threads, then handed to the sink
+// in order. The workers are started with the engine and stay parked
+// between batches until it is destroyed, so an engine must not be used by
+// two threads at once. Magnitudes are scaled so a full-scale sine reads 1.0
+// in its bin.
+typedef struct StftEngine StftEngine;
+
+// Create an engine for a channel count and sample rate
+StftEngine* stft_engine_create(const StftConfig *config, int channels,
+                               int sample_rate, AudioError *error);
+void stft_engine_destroy(StftEngine *engine);
+
+// Number of magnitude bins per channel (fft_size / 2 + 1)
+size_t stft_engine_bins(const StftEngine *engine);
+
+// Analyze a decoded buffer (channels and sample rate must match the engine)
+AudioError stft_process_buffer(StftEngine *engine, const AudioBuffer *buffer,
+                               StftSink sink, void *user);
+
+// Analyze from a streaming reader, holding only one batch of audio in memory
+// Returns the reader's error if the input turns out corrupt or truncated
+AudioError stft_process_reader(StftEngine *engine, AudioReader *reader,
+                               StftSink sink, void *user);
+
+// Spectrogram file writer; use stft_file_sink as the engine's sink
+typedef struct StftFile StftFile;
+
+StftFile* stft_file_open(const char *filepath, const StftEngine *engine,
+                         StftEncoding encoding, AudioError *error);
+int stft_file_sink(void *file, size_t frame, const float *magnitudes);
+// Patch the frame count into the header and close
+AudioError stft_file_close(StftFile *file);
+
+// Spectrogram loaded from a file (or collected with spectrogram_sink)
+typedef struct {
+    StftFileHeader header;
+    float *magnitudes;     // frames * channels * bins linear magnitudes
+    size_t capacity;       // Allocated frames
+} Spectrogram;
+
+// Read a spectrogram file (DB16 data is converted back to linear)
+Spectrogram* spectrogram_read(const char *filepath, AudioError *error);
+
+// Prepare an empty in-memory spectrogram for an engine's output
+AudioError spectrogram_init(Spectrogram *spec, const StftEngine *engine);
+int spectrogram_sink(void *spec, size_t frame, const float *magnitudes);
+
+// Magnitude of a bin (0 if out of range)
+float spectrogram_at(const Spectrogram *spec, size_t frame, int channel,
+                     size_t bin);
+
+// Free the magnitudes (and the struct itself for spectrogram_read results)
+void spectrogram_clear(Spectrogram *spec);
+void spectrogram_free(Spectrogram *spec);
+
+// Analyze a WAV file and write its spectrogram, streaming both ends
+AudioError stft_analyze_file(const char *wav_path, const char *output_path,
+                             const StftConfig *config, StftEncoding encoding);
+
+#endif // STFT_H
@@ -0,0 +1,189 @@
+#include "audio_alloc.h"
+#include "audio_numa.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+
+// Bookkeeping stored in the cache line in front of every allocation, so the
+// returned pointer keeps AUDIO_ALLOC_ALIGNMENT alignment
+typedef struct BlockHeader {
+  size_t capacity;          // Usable bytes after the header
+  struct BlockHeader *next; // Pool free-list link
+  int node;                 // NUMA node the pages were placed for
+} BlockHeader;
+
+#define HEADER_SIZE AUDIO_ALLOC_ALIGNMENT
+
+// Process-wide recycling pool, one free list per NUMA node
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static BlockHeader *pool_heads[AUDIO_NUMA_MAX_NODES];
+static size_t pool_limit = 0; // 0 = pool disabled
+static AudioAllocStats pool_stats = {0, 0, 0, 0};
+
+static size_t round_up(size_t value, size_t multiple) {
+  return (value + multiple - 1) / multiple * multiple;
+}
+
+// Allocate a fresh block from the system
+// The pages are not touched here (beyond the header), so they are placed on
+// the node of the first thread that writes them
+static BlockHeader *block_create(size_t size, int node) {
+  size_t total = HEADER_SIZE + size;
+  size_t alignment = AUDIO_ALLOC_ALIGNMENT;
+
+  if (total >= AUDIO_ALLOC_HUGE_THRESHOLD) {
+    // Whole huge pages: aligned start, rounded length
+    alignment = AUDIO_ALLOC_HUGE_THRESHOLD;
+    total = round_up(total, AUDIO_ALLOC_HUGE_THRESHOLD);
+  } else {
+    total = round_up(total, AUDIO_ALLOC_ALIGNMENT);
+  }
+
+  void *base = NULL;
+  if (posix_memalign(&base, alignment, total) != 0) {
+    return NULL;
+  }
+
+#ifdef MADV_HUGEPAGE
+  if (alignment == AUDIO_ALLOC_HUGE_THRESHOLD) {
+    // Advisory only; failure just means regular pages
+    madvise(base, total, MADV_HUGEPAGE);
+  }
+#endif
+
+  BlockHeader *block = (BlockHeader *)base;
+  block->capacity = total - HEADER_SIZE;
+  block->next = NULL;
+  block->node = node;
+  return block;
+}
+
+// Take the best-fitting cached block of a node (no more than 2x oversized)
+static BlockHeader *pool_take(size_t size, int node) {
+  BlockHeader **best = NULL;
+  for (BlockHeader **link = &pool_heads[node]; *link;
+       link = &(*link)->next) {
+    size_t capacity = (*link)->capacity;
+    if (capacity >= size && capacity / 2 <= size &&
+        (!best || capacity < (*best)->capacity)) {
+      best = link;
+    }
+  }
+
+  if (!best) {
+    return NULL;
+  }
+
+  BlockHeader *block = *best;
+  *best = block->next;
+  block->next = NULL;
+  pool_stats.cached_blocks--;
+  pool_stats.cached_bytes -= block->capacity;
+  return block;
+}
+
+// Allocate from a node's pool, or fresh memory placed for that node
+static void *alloc_for_node(size_t size, int node, int bind) {
+  BlockHeader *block = NULL;
+
+  pthread_mutex_lock(&pool_lock);
+  if (pool_limit > 0) {
+    block = pool_take(size, node);
+    if (block) {
+      pool_stats.pool_hits++;
+    } else {
+      pool_stats.pool_misses++;
+    }
+  }
+  pthread_mutex_unlock(&pool_lock);
+
+  if (!block) {
+    block = block_create(size, node);
+    if (!block) {
+      return NULL;
+    }
+    if (bind) {
+      audio_numa_bind(block, HEADER_SIZE + block->capacity, node);
+    }
+  }
+
+  return (uint8_t *)block + HEADER_SIZE;
+}
+
+// Allocate aligned memory for the calling thread's node
+void *audio_alloc(size_t size) {
+  return alloc_for_node(size, audio_numa_current_node(), 0);
+}
+
+// Allocate aligned memory bound to a node
+void *audio_alloc_on_node(size_t size, int node) {
+  if (node < 0 || node >= audio_numa_topology()->num_nodes) {
+    return NULL;
+  }
+  return alloc_for_node(size, node, 1);
+}
+
+// Free aligned memory, recycling it when the pool has room
+void audio_free(void *ptr) {
+  if (!ptr) {
+    return;
+  }
+
+  BlockHeader *block = (BlockHeader *)((uint8_t *)ptr - HEADER_SIZE);
+
+  pthread_mutex_lock(&pool_lock);
+  if (pool_limit > 0 &&
+      pool_stats.cached_bytes + block->capacity <= pool_limit) {
+    block->next = pool_heads[block->node];
+    pool_heads[block->node] = block;
+    pool_stats.cached_blocks++;
+    pool_stats.cached_bytes += block->capacity;
+    block = NULL;
+  }
+  pthread_mutex_unlock(&pool_lock);
+
+  free(block);
+}
+
+// Enable the recycling pool
+void audio_pool_enable(size_t max_cached_bytes) {
+  pthread_mutex_lock(&pool_lock);
+  pool_limit = max_cached_bytes;
+  pthread_mutex_unlock(&pool_lock);
+}
+
+// Disable the pool and release cached blocks
+void audio_pool_disable(void) {
+  BlockHeader *heads[AUDIO_NUMA_MAX_NODES];
+
+  pthread_mutex_lock(&pool_lock);
+  for (int node = 0; node < AUDIO_NUMA_MAX_NODES; node++) {
+    heads[node] = pool_heads[node];
+    pool_heads[node] = NULL;
+  }
+  pool_limit = 0;
+  pool_stats.cached_blocks = 0;
+  pool_stats.cached_bytes = 0;
+  pthread_mutex_unlock(&pool_lock);
+
+  for (int node = 0; node < AUDIO_NUMA_MAX_NODES; node++) {
+    BlockHeader *block = heads[node];
+    while (block) {
+      BlockHeader *next = block->next;
+      free(block);
+      block = next;
+    }
+  }
+}
+
+// Snapshot statistics
+void audio_alloc_stats(AudioAllocStats *stats) {
+  if (!stats) {
+    return;
+  }
+
+  pthread_mutex_lock(&pool_lock);
+  *stats = pool_stats;
+  pthread_mutex_unlock(&pool_lock);
+}
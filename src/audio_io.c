@@ -1,8 +1,17 @@
+#define _GNU_SOURCE
 #include "audio_io.h"
+#include "audio_alloc.h"
+#include "audio_view.h"
+#include "flac.h"
+#include <fcntl.h>
 #include <math.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+#include <sys/types.h>
+#include <unistd.h>
 
 // Helper function to read exact number of bytes
 static int read_exact(FILE *file, void *buffer, size_t size) {
@@ -16,6 +25,97 @@ static int write_exact(FILE *file, const void *buffer, size_t size) {
   return bytes_written == size ? 1 : 0;
 }
 
+// Set by audio_io_set_large_files
+static int large_files;
+
+void audio_io_set_large_files(int enable) {
+  __atomic_store_n(&large_files, enable != 0, __ATOMIC_RELEASE);
+}
+
+int audio_io_large_files(void) {
+  return __atomic_load_n(&large_files, __ATOMIC_ACQUIRE);
+}
+
+// Page cache bookkeeping of one stream in large-file mode
+typedef struct {
+  int fd;          // -1 when the mode was off at open
+  int writing;
+  off_t released;  // Pages before this offset have been dropped
+  off_t flushed;   // Writeback has been started up to here (writers)
+} CacheWindow;
+
+// Start (or, with `wait`, complete) writeback of a byte range
+static void write_back(int fd, off_t offset, off_t length, int wait) {
+#ifdef SYNC_FILE_RANGE_WRITE
+  unsigned int flags = SYNC_FILE_RANGE_WRITE;
+  if (wait)
+    flags |= SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WAIT_AFTER;
+  sync_file_range(fd, offset, length, flags);
+#else
+  (void)offset;
+  (void)length;
+  if (wait)
+    fdatasync(fd);
+#endif
+}
+
+static void cache_begin(CacheWindow *cache, FILE *file, int writing) {
+  cache->fd = -1;
+  cache->writing = writing;
+  cache->released = 0;
+  cache->flushed = 0;
+  if (!file || !audio_io_large_files())
+    return;
+
+  cache->fd = fileno(file);
+  if (!writing)
+    posix_fadvise(cache->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+}
+
+// Drop what the stream has moved past, a window at a time. Dirty pages
+// cannot be dropped, so a writer starts writeback of each new window and
+// drops the one before it once that has reached the disk.
+static void cache_advance(CacheWindow *cache, FILE *file) {
+  if (cache->fd < 0)
+    return;
+  off_t position = ftello(file);
+  if (position < 0)
+    return;
+
+  if (!cache->writing) {
+    if (position - cache->released >= (off_t)AUDIO_IO_WINDOW) {
+      posix_fadvise(cache->fd, cache->released, position - cache->released,
+                    POSIX_FADV_DONTNEED);
+      cache->released = position;
+    }
+    return;
+  }
+
+  if (position - cache->flushed < (off_t)AUDIO_IO_WINDOW || fflush(file) != 0)
+    return;
+  write_back(cache->fd, cache->flushed, position - cache->flushed, 0);
+  if (cache->flushed > cache->released) {
+    write_back(cache->fd, cache->released, cache->flushed - cache->released,
+               1);
+    posix_fadvise(cache->fd, cache->released,
+                  cache->flushed - cache->released, POSIX_FADV_DONTNEED);
+    cache->released = cache->flushed;
+  }
+  cache->flushed = position;
+}
+
+// Drop the whole file before it is closed (writers flush it first)
+static void cache_end(CacheWindow *cache, FILE *file) {
+  if (cache->fd < 0)
+    return;
+  if (cache->writing) {
+    if (fflush(file) != 0)
+      return;
+    write_back(cache->fd, 0, 0, 1);
+  }
+  posix_fadvise(cache->fd, 0, 0, POSIX_FADV_DONTNEED);
+}
+
 // Validate WAV header
 int validate_wav_header(RIFFHeader *riff, FmtChunk *fmt) {
   // Check RIFF header
@@ -158,42 +258,21 @@ void float64_to_pcm(double *input, PCMBuffer *pcm, size_t sample_count) {
   }
 }
 
-// Read WAV file
-AudioBuffer *read_wave(const char *filepath, AudioError *error) {
-  if (!filepath) {
-    if (error)
-      *error = AUDIO_ERROR_INVALID_PARAMETER;
-    return NULL;
-  }
-
-  FILE *file = fopen(filepath, "rb");
-  if (!file) {
-    if (error)
-      *error = AUDIO_ERROR_FILE_NOT_FOUND;
-    return NULL;
-  }
-
+// Parse the RIFF/fmt/data headers and leave the file positioned at the first
+// sample of the data chunk
+static AudioError parse_wav_header(FILE *file, AudioFileInfo *info) {
   // Read RIFF header
   RIFFHeader riff;
   if (!read_exact(file, &riff, sizeof(RIFFHeader))) {
-    fclose(file);
-    if (error)
-      *error = AUDIO_ERROR_READ_ERROR;
-    return NULL;
+    return AUDIO_ERROR_READ_ERROR;
   }
 
   // Validate RIFF header
   if (memcmp(riff.chunk_id, "RIFF", 4) != 0) {
-    fclose(file);
-    if (error)
-      *error = AUDIO_ERROR_INVALID_FORMAT;
-    return NULL;
+    return AUDIO_ERROR_INVALID_FORMAT;
   }
   if (memcmp(riff.format, "WAVE", 4) != 0) {
-    fclose(file);
-    if (error)
-      *error = AUDIO_ERROR_INVALID_FORMAT;
-    return NULL;
+    return AUDIO_ERROR_INVALID_FORMAT;
   }
 
   // Search for fmt chunk (there might be JUNK or other chunks before it)
@@ -206,10 +285,7 @@ AudioBuffer *read_wave(const char *filepath, AudioError *error) {
     uint32_t chunk_size;
 
     if (!read_exact(file, chunk_id, 4) || !read_exact(file, &chunk_size, 4)) {
-      fclose(file);
-      if (error)
-        *error = AUDIO_ERROR_INVALID_FORMAT;
-      return NULL;
+      return AUDIO_ERROR_INVALID_FORMAT;
     }
 
     if (memcmp(chunk_id, "fmt ", 4) == 0) {
@@ -217,10 +293,7 @@ AudioBuffer *read_wave(const char *filepath, AudioError *error) {
       // We already read the chunk_id and subchunk_size, so read remaining
       // fields
       if (!read_exact(file, &fmt.audio_format, sizeof(FmtChunk) - 8)) {
-        fclose(file);
-        if (error)
-          *error = AUDIO_ERROR_READ_ERROR;
-        return NULL;
+        return AUDIO_ERROR_READ_ERROR;
       }
 
       // Copy the chunk_id and size we already read
@@ -241,10 +314,7 @@ AudioBuffer *read_wave(const char *filepath, AudioError *error) {
 
   // Validate fmt chunk
   if (!validate_wav_header(&riff, &fmt)) {
-    fclose(file);
-    if (error)
-      *error = AUDIO_ERROR_INVALID_FORMAT;
-    return NULL;
+    return AUDIO_ERROR_INVALID_FORMAT;
   }
 
   // Find data chunk (there might be other chunks in between)
@@ -252,10 +322,7 @@ AudioBuffer *read_wave(const char *filepath, AudioError *error) {
   int found_data = 0;
   while (!found_data) {
     if (!read_exact(file, &data_header, sizeof(DataChunkHeader))) {
-      fclose(file);
-      if (error)
-        *error = AUDIO_ERROR_INVALID_FORMAT;
-      return NULL;
+      return AUDIO_ERROR_INVALID_FORMAT;
     }
 
     if (memcmp(data_header.subchunk_id, "data", 4) == 0) {
@@ -266,13 +333,67 @@ AudioBuffer *read_wave(const char *filepath, AudioError *error) {
     }
   }
 
+  info->sample_rate = fmt.sample_rate;
+  info->channels = fmt.num_channels;
+  info->bit_depth = fmt.bits_per_sample;
+  info->audio_format = fmt.audio_format;
+  info->block_align = fmt.block_align;
+  info->frames = data_header.subchunk_size / fmt.block_align;
+  info->data_offset = ftell(file);
+  info->data_size = data_header.subchunk_size;
+
+  return AUDIO_SUCCESS;
+}
+
+// Parse the header of a WAV or FLAC file; a FLAC stream gets a decoder
+static AudioError parse_header(FILE *file, AudioFileInfo *info,
+                               FlacDecoder **flac) {
+  *flac = NULL;
+  if (flac_probe(file)) {
+    AudioError status;
+    *flac = flac_decoder_open(file, info, &status);
+    return status;
+  }
+  return parse_wav_header(file, info);
+}
+
+// Read WAV file
+AudioBuffer *read_wave(const char *filepath, AudioError *error) {
+  if (!filepath) {
+    if (error)
+      *error = AUDIO_ERROR_INVALID_PARAMETER;
+    return NULL;
+  }
+
+  FILE *file = fopen(filepath, "rb");
+  if (!file) {
+    if (error)
+      *error = AUDIO_ERROR_FILE_NOT_FOUND;
+    return NULL;
+  }
+
+  // FLAC is decoded through the streaming reader, as is everything in
+  // large-file mode so the input can be dropped from the cache as it goes
+  if (flac_probe(file) || audio_io_large_files()) {
+    fclose(file);
+    return read_wave_region(filepath, 0, SIZE_MAX, error);
+  }
+
+  AudioFileInfo info;
+  AudioError status = parse_wav_header(file, &info);
+  if (status != AUDIO_SUCCESS) {
+    fclose(file);
+    if (error)
+      *error = status;
+    return NULL;
+  }
+
   // Calculate number of samples
-  size_t bytes_per_sample = fmt.bits_per_sample / 8;
-  size_t total_samples = data_header.subchunk_size / bytes_per_sample;
+  size_t bytes_per_sample = info.bit_depth / 8;
+  size_t total_samples = info.data_size / bytes_per_sample;
 
   // Create PCM buffer
-  PCMBuffer *pcm =
-      pcm_buffer_create(data_header.subchunk_size, fmt.bits_per_sample);
+  PCMBuffer *pcm = pcm_buffer_create(info.data_size, info.bit_depth);
   if (!pcm) {
     fclose(file);
     if (error)
@@ -281,7 +402,7 @@ AudioBuffer *read_wave(const char *filepath, AudioError *error) {
   }
 
   // Read PCM data
-  if (!read_exact(file, pcm->data, data_header.subchunk_size)) {
+  if (!read_exact(file, pcm->data, info.data_size)) {
     pcm_buffer_free(pcm);
     fclose(file);
     if (error)
@@ -292,8 +413,8 @@ AudioBuffer *read_wave(const char *filepath, AudioError *error) {
   fclose(file);
 
   // Create audio buffer
-  AudioBuffer *buffer = audio_buffer_create(
-      total_samples, fmt.sample_rate, fmt.num_channels, fmt.bits_per_sample);
+  AudioBuffer *buffer = audio_buffer_create(total_samples, info.sample_rate,
+                                            info.channels, info.bit_depth);
   if (!buffer) {
     pcm_buffer_free(pcm);
     if (error)
@@ -311,20 +432,247 @@ AudioBuffer *read_wave(const char *filepath, AudioError *error) {
   return buffer;
 }
 
-// Write WAV file
-AudioError write_wave(const char *filepath, AudioBuffer *buffer) {
-  if (!filepath || !buffer || !buffer->data) {
+// Read WAV header information without loading sample data
+AudioError read_wave_info(const char *filepath, AudioFileInfo *info) {
+  if (!filepath || !info) {
     return AUDIO_ERROR_INVALID_PARAMETER;
   }
 
-  FILE *file = fopen(filepath, "wb");
+  FILE *file = fopen(filepath, "rb");
   if (!file) {
-    return AUDIO_ERROR_WRITE_ERROR;
+    return AUDIO_ERROR_FILE_NOT_FOUND;
   }
 
-  // Calculate sizes
-  size_t bytes_per_sample = buffer->bit_depth / 8;
-  size_t data_size = buffer->length * bytes_per_sample;
+  FlacDecoder *flac;
+  AudioError status = parse_header(file, info, &flac);
+  flac_decoder_free(flac);
+  fclose(file);
+  return status;
+}
+
+// Streaming reader state
+struct AudioReader {
+  FILE *file;
+  AudioFileInfo info;
+  size_t position;  // Current frame position
+  PCMBuffer *pcm;   // Scratch buffer for one block of raw PCM
+  FlacDecoder *flac; // Set for FLAC files
+  CacheWindow cache; // Large-file mode state
+  AudioError status; // First error, see audio_reader_status
+};
+
+// Open a WAV or FLAC file for streaming reads
+AudioReader *audio_reader_open(const char *filepath, AudioError *error) {
+  if (!filepath) {
+    if (error)
+      *error = AUDIO_ERROR_INVALID_PARAMETER;
+    return NULL;
+  }
+
+  AudioReader *reader = (AudioReader *)calloc(1, sizeof(AudioReader));
+  if (!reader) {
+    if (error)
+      *error = AUDIO_ERROR_MEMORY_ERROR;
+    return NULL;
+  }
+  reader->cache.fd = -1;
+
+  reader->file = fopen(filepath, "rb");
+  if (!reader->file) {
+    free(reader);
+    if (error)
+      *error = AUDIO_ERROR_FILE_NOT_FOUND;
+    return NULL;
+  }
+
+  AudioError status =
+      parse_header(reader->file, &reader->info, &reader->flac);
+  if (status != AUDIO_SUCCESS) {
+    audio_reader_close(reader);
+    if (error)
+      *error = status;
+    return NULL;
+  }
+
+  cache_begin(&reader->cache, reader->file, 0);
+  if (error)
+    *error = AUDIO_SUCCESS;
+  return reader;
+}
+
+// Get stream information for an open reader
+const AudioFileInfo *audio_reader_info(const AudioReader *reader) {
+  return reader ? &reader->info : NULL;
+}
+
+// Seek directly to a frame inside the data chunk
+AudioError audio_reader_seek(AudioReader *reader, size_t frame) {
+  if (!reader) {
+    return AUDIO_ERROR_INVALID_PARAMETER;
+  }
+  if (frame > reader->info.frames) {
+    frame = reader->info.frames;
+  }
+
+  if (reader->flac) {
+    AudioError status = flac_decoder_seek(reader->flac, frame);
+    if (status == AUDIO_SUCCESS) {
+      reader->position = frame;
+    }
+    return status;
+  }
+
+  long offset =
+      reader->info.data_offset + (long)(frame * reader->info.block_align);
+  if (fseek(reader->file, offset, SEEK_SET) != 0) {
+    return AUDIO_ERROR_READ_ERROR;
+  }
+
+  reader->position = frame;
+  return AUDIO_SUCCESS;
+}
+
+// Read up to `frames` frames of the WAV data chunk
+static size_t read_pcm_frames(AudioReader *reader, double *output,
+                              size_t frames) {
+  size_t bytes = frames * reader->info.block_align;
+  if (!reader->pcm || reader->pcm->length < bytes) {
+    pcm_buffer_free(reader->pcm);
+    reader->pcm = pcm_buffer_create(bytes, reader->info.bit_depth);
+    if (!reader->pcm) {
+      reader->status = AUDIO_ERROR_MEMORY_ERROR;
+      return 0;
+    }
+  }
+
+  // A short read means the data chunk is truncated; decode what we got
+  size_t bytes_read = fread(reader->pcm->data, 1, bytes, reader->file);
+  frames = bytes_read / reader->info.block_align;
+
+  pcm_to_float64(reader->pcm, output, frames * reader->info.channels);
+  return frames;
+}
+
+// Read up to `frames` interleaved frames as float64
+size_t audio_reader_read(AudioReader *reader, double *output, size_t frames) {
+  if (!reader || !output || reader->status != AUDIO_SUCCESS) {
+    return 0;
+  }
+
+  if (!reader->flac) {
+    size_t remaining = reader->info.frames - reader->position;
+    if (frames > remaining) {
+      frames = remaining;
+    }
+  }
+
+  // In large-file mode, read a window at a time so each can be dropped
+  size_t chunk = frames;
+  if (reader->cache.fd >= 0) {
+    size_t window = AUDIO_IO_WINDOW / reader->info.block_align;
+    if (chunk > window) {
+      chunk = window;
+    }
+  }
+
+  size_t done = 0;
+  while (done < frames) {
+    size_t want = frames - done < chunk ? frames - done : chunk;
+    double *out = output + done * reader->info.channels;
+    size_t got = reader->flac ? flac_decoder_read(reader->flac, out, want)
+                              : read_pcm_frames(reader, out, want);
+    done += got;
+    cache_advance(&reader->cache, reader->file);
+    if (got < want) {
+      // Stopping short of the end of the data is an error, not EOF
+      if (reader->flac) {
+        reader->status = flac_decoder_status(reader->flac);
+      }
+      if (reader->status == AUDIO_SUCCESS &&
+          reader->position + done < reader->info.frames) {
+        reader->status = AUDIO_ERROR_READ_ERROR;
+      }
+      break;
+    }
+  }
+
+  reader->position += done;
+  return done;
+}
+
+// First error seen by a streaming reader
+AudioError audio_reader_status(const AudioReader *reader) {
+  return reader ? reader->status : AUDIO_ERROR_INVALID_PARAMETER;
+}
+
+// Close a streaming reader
+void audio_reader_close(AudioReader *reader) {
+  if (reader) {
+    flac_decoder_free(reader->flac);
+    if (reader->file) {
+      cache_end(&reader->cache, reader->file);
+      fclose(reader->file);
+    }
+    pcm_buffer_free(reader->pcm);
+    free(reader);
+  }
+}
+
+// Read a frame range of a WAV or FLAC file, seeking straight to its data
+// offset (or FLAC seek point)
+AudioBuffer *read_wave_region(const char *filepath, size_t start_frame,
+                              size_t num_frames, AudioError *error) {
+  AudioReader *reader = audio_reader_open(filepath, error);
+  if (!reader) {
+    return NULL;
+  }
+
+  const AudioFileInfo *info = &reader->info;
+  if (start_frame > info->frames) {
+    start_frame = info->frames;
+  }
+  if (num_frames > info->frames - start_frame) {
+    num_frames = info->frames - start_frame;
+  }
+
+  AudioError status = audio_reader_seek(reader, start_frame);
+  if (status != AUDIO_SUCCESS) {
+    audio_reader_close(reader);
+    if (error)
+      *error = status;
+    return NULL;
+  }
+
+  AudioBuffer *buffer =
+      audio_buffer_create(num_frames * info->channels, info->sample_rate,
+                          info->channels, info->bit_depth);
+  if (!buffer) {
+    audio_reader_close(reader);
+    if (error)
+      *error = AUDIO_ERROR_MEMORY_ERROR;
+    return NULL;
+  }
+
+  if (audio_reader_read(reader, buffer->data, num_frames) != num_frames) {
+    status = audio_reader_status(reader);
+    audio_buffer_free(buffer);
+    audio_reader_close(reader);
+    if (error)
+      *error = status != AUDIO_SUCCESS ? status : AUDIO_ERROR_READ_ERROR;
+    return NULL;
+  }
+
+  audio_reader_close(reader);
+  if (error)
+    *error = AUDIO_SUCCESS;
+  return buffer;
+}
+
+// Write WAV file
+// Write RIFF, fmt and data chunk headers for `data_size` bytes of PCM
+static int write_wav_header(FILE *file, int sample_rate, int channels,
+                            int bit_depth, size_t data_size) {
+  size_t bytes_per_sample = bit_depth / 8;
 
   // Prepare RIFF header
   RIFFHeader riff;
@@ -337,21 +685,84 @@ AudioError write_wave(const char *filepath, AudioBuffer *buffer) {
   memcpy(fmt.subchunk_id, "fmt ", 4);
   fmt.subchunk_size = 16;
   fmt.audio_format = AUDIO_FORMAT_PCM;
-  fmt.num_channels = buffer->channels;
-  fmt.sample_rate = buffer->sample_rate;
-  fmt.byte_rate = buffer->sample_rate * buffer->channels * bytes_per_sample;
-  fmt.block_align = buffer->channels * bytes_per_sample;
-  fmt.bits_per_sample = buffer->bit_depth;
+  fmt.num_channels = channels;
+  fmt.sample_rate = sample_rate;
+  fmt.byte_rate = sample_rate * channels * bytes_per_sample;
+  fmt.block_align = channels * bytes_per_sample;
+  fmt.bits_per_sample = bit_depth;
 
   // Prepare data chunk header
   DataChunkHeader data_header;
   memcpy(data_header.subchunk_id, "data", 4);
   data_header.subchunk_size = data_size;
 
+  return write_exact(file, &riff, sizeof(RIFFHeader)) &&
+         write_exact(file, &fmt, sizeof(FmtChunk)) &&
+         write_exact(file, &data_header, sizeof(DataChunkHeader));
+}
+
+// Nonzero if the path ends in ".flac"
+int audio_path_is_flac(const char *filepath) {
+  if (!filepath) {
+    return 0;
+  }
+  size_t length = strlen(filepath);
+  return length >= 5 && strcasecmp(filepath + length - 5, ".flac") == 0;
+}
+
+static AudioWriter *writer_open(const char *filepath, int sample_rate,
+                                int channels, int bit_depth, int flac,
+                                AudioError *error);
+
+// Write a whole buffer through a streaming writer
+static AudioError write_streamed(const char *filepath, AudioBuffer *buffer,
+                                 int flac) {
+  if (!filepath || !buffer || !buffer->data || buffer->channels < 1) {
+    return AUDIO_ERROR_INVALID_PARAMETER;
+  }
+
+  AudioError error;
+  AudioWriter *writer =
+      writer_open(filepath, buffer->sample_rate, buffer->channels,
+                  buffer->bit_depth, flac, &error);
+  if (!writer) {
+    return error;
+  }
+  size_t frames = buffer->length / buffer->channels;
+  audio_writer_reserve(writer, frames);
+  audio_writer_write(writer, buffer->data, frames);
+  return audio_writer_close(writer);
+}
+
+// Encode a whole buffer through a FLAC writer
+AudioError write_flac(const char *filepath, AudioBuffer *buffer) {
+  return write_streamed(filepath, buffer, 1);
+}
+
+AudioError write_wave(const char *filepath, AudioBuffer *buffer) {
+  if (!filepath || !buffer || !buffer->data) {
+    return AUDIO_ERROR_INVALID_PARAMETER;
+  }
+  if (audio_path_is_flac(filepath)) {
+    return write_flac(filepath, buffer);
+  }
+  // Preallocated and written back window by window
+  if (audio_io_large_files()) {
+    return write_streamed(filepath, buffer, 0);
+  }
+
+  FILE *file = fopen(filepath, "wb");
+  if (!file) {
+    return AUDIO_ERROR_WRITE_ERROR;
+  }
+
+  // Calculate sizes
+  size_t bytes_per_sample = buffer->bit_depth / 8;
+  size_t data_size = buffer->length * bytes_per_sample;
+
   // Write headers
-  if (!write_exact(file, &riff, sizeof(RIFFHeader)) ||
-      !write_exact(file, &fmt, sizeof(FmtChunk)) ||
-      !write_exact(file, &data_header, sizeof(DataChunkHeader))) {
+  if (!write_wav_header(file, buffer->sample_rate, buffer->channels,
+                        buffer->bit_depth, data_size)) {
     fclose(file);
     return AUDIO_ERROR_WRITE_ERROR;
   }
@@ -379,6 +790,278 @@ AudioError write_wave(const char *filepath, AudioBuffer *buffer) {
   return AUDIO_SUCCESS;
 }
 
+// Streaming writer state
+struct AudioWriter {
+  FILE *file;
+  int sample_rate;
+  int channels;
+  int bit_depth;
+  size_t data_size;  // PCM bytes written so far
+  AudioError status; // First error, reported again by audio_writer_close
+  PCMBuffer *pcm;    // Scratch buffer for one block of raw PCM
+  FlacEncoder *flac; // Set when encoding FLAC
+  CacheWindow cache; // Large-file mode state
+  off_t reserved;    // File size preallocated by audio_writer_reserve
+};
+
+// Create a WAV or FLAC file for streaming writes
+static AudioWriter *writer_open(const char *filepath, int sample_rate,
+                                int channels, int bit_depth, int flac,
+                                AudioError *error) {
+  if (!filepath || sample_rate <= 0 || channels < 1 || channels > 16 ||
+      (bit_depth != 8 && bit_depth != 16 && bit_depth != 24 &&
+       bit_depth != 32)) {
+    if (error)
+      *error = AUDIO_ERROR_INVALID_PARAMETER;
+    return NULL;
+  }
+
+  AudioWriter *writer = (AudioWriter *)calloc(1, sizeof(AudioWriter));
+  if (!writer) {
+    if (error)
+      *error = AUDIO_ERROR_MEMORY_ERROR;
+    return NULL;
+  }
+  writer->cache.fd = -1;
+
+  writer->sample_rate = sample_rate;
+  writer->channels = channels;
+  writer->bit_depth = bit_depth;
+  writer->status = AUDIO_SUCCESS;
+
+  writer->file = fopen(filepath, "wb");
+  if (writer->file && flac) {
+    AudioError status;
+    writer->flac = flac_encoder_open(writer->file, sample_rate, channels,
+                                     bit_depth, &status);
+    if (!writer->flac) {
+      writer->status = status;
+      audio_writer_close(writer);
+      if (error)
+        *error = status;
+      return NULL;
+    }
+  } else if (!writer->file || !write_wav_header(writer->file, sample_rate,
+                                                channels, bit_depth, 0)) {
+    audio_writer_close(writer);
+    if (error)
+      *error = AUDIO_ERROR_WRITE_ERROR;
+    return NULL;
+  }
+
+  cache_begin(&writer->cache, writer->file, 1);
+  if (error)
+    *error = AUDIO_SUCCESS;
+  return writer;
+}
+
+AudioWriter *audio_writer_open(const char *filepath, int sample_rate,
+                               int channels, int bit_depth, AudioError *error) {
+  return writer_open(filepath, sample_rate, channels, bit_depth,
+                     audio_path_is_flac(filepath), error);
+}
+
+AudioWriter *audio_writer_open_flac(const char *filepath, int sample_rate,
+                                    int channels, int bit_depth,
+                                    AudioError *error) {
+  return writer_open(filepath, sample_rate, channels, bit_depth, 1, error);
+}
+
+// Size of the WAV headers written by write_wav_header
+#define WAV_HEADER_SIZE \
+  (sizeof(RIFFHeader) + sizeof(FmtChunk) + sizeof(DataChunkHeader))
+
+// Preallocate the output in large-file mode
+AudioError audio_writer_reserve(AudioWriter *writer, size_t frames) {
+  if (!writer) {
+    return AUDIO_ERROR_INVALID_PARAMETER;
+  }
+  if (writer->status != AUDIO_SUCCESS || writer->flac ||
+      writer->cache.fd < 0) {
+    return writer->status;
+  }
+
+  off_t size = (off_t)(WAV_HEADER_SIZE + frames * writer->channels *
+                                             (writer->bit_depth / 8));
+  if (size > writer->reserved && fallocate(writer->cache.fd, 0, 0, size) == 0) {
+    writer->reserved = size;
+  }
+  return AUDIO_SUCCESS;
+}
+
+// Convert and write `frames` frames to the WAV data chunk
+static AudioError write_pcm_frames(AudioWriter *writer, const double *input,
+                                   size_t frames) {
+  size_t samples = frames * writer->channels;
+  size_t bytes = samples * (writer->bit_depth / 8);
+  if (!writer->pcm || writer->pcm->length < bytes) {
+    pcm_buffer_free(writer->pcm);
+    writer->pcm = pcm_buffer_create(bytes, writer->bit_depth);
+    if (!writer->pcm) {
+      writer->status = AUDIO_ERROR_MEMORY_ERROR;
+      return writer->status;
+    }
+  }
+
+  float64_to_pcm((double *)input, writer->pcm, samples);
+  if (!write_exact(writer->file, writer->pcm->data, bytes)) {
+    writer->status = AUDIO_ERROR_WRITE_ERROR;
+    return writer->status;
+  }
+
+  writer->data_size += bytes;
+  return AUDIO_SUCCESS;
+}
+
+// Append `frames` interleaved frames
+AudioError audio_writer_write(AudioWriter *writer, const double *input,
+                              size_t frames) {
+  if (!writer || !input) {
+    return AUDIO_ERROR_INVALID_PARAMETER;
+  }
+  if (writer->status != AUDIO_SUCCESS) {
+    return writer->status;
+  }
+
+  // In large-file mode, write a window at a time so each can be dropped
+  size_t chunk = frames;
+  if (writer->cache.fd >= 0) {
+    size_t window =
+        AUDIO_IO_WINDOW / ((size_t)writer->channels * (writer->bit_depth / 8));
+    if (chunk > window) {
+      chunk = window;
+    }
+  }
+
+  for (size_t done = 0; done < frames; done += chunk) {
+    size_t count = frames - done < chunk ? frames - done : chunk;
+    const double *in = input + done * writer->channels;
+    if (writer->flac) {
+      writer->status = flac_encoder_write(writer->flac, in, count);
+    } else {
+      write_pcm_frames(writer, in, count);
+    }
+    if (writer->status != AUDIO_SUCCESS) {
+      return writer->status;
+    }
+    cache_advance(&writer->cache, writer->file);
+  }
+  return AUDIO_SUCCESS;
+}
+
+// Patch the RIFF and data chunk sizes and close the file
+AudioError audio_writer_close(AudioWriter *writer) {
+  if (!writer) {
+    return AUDIO_ERROR_INVALID_PARAMETER;
+  }
+
+  AudioError status = writer->status;
+  if (writer->flac) {
+    if (status == AUDIO_SUCCESS) {
+      status = flac_encoder_finish(writer->flac);
+    }
+    flac_encoder_free(writer->flac);
+  } else if (writer->file) {
+    if (status == AUDIO_SUCCESS &&
+        (fseek(writer->file, 0, SEEK_SET) != 0 ||
+         !write_wav_header(writer->file, writer->sample_rate, writer->channels,
+                           writer->bit_depth, writer->data_size))) {
+      status = AUDIO_ERROR_WRITE_ERROR;
+    }
+
+    // Trim a reservation that was not filled
+    off_t size = (off_t)(WAV_HEADER_SIZE + writer->data_size);
+    if (status == AUDIO_SUCCESS && writer->reserved > size &&
+        (fflush(writer->file) != 0 ||
+         ftruncate(fileno(writer->file), size) != 0)) {
+      status = AUDIO_ERROR_WRITE_ERROR;
+    }
+  }
+  if (writer->file) {
+    cache_end(&writer->cache, writer->file);
+  }
+  if (writer->file && fclose(writer->file) != 0 && status == AUDIO_SUCCESS) {
+    status = AUDIO_ERROR_WRITE_ERROR;
+  }
+
+  pcm_buffer_free(writer->pcm);
+  free(writer);
+  return status;
+}
+
+// Read the raw PCM data chunk of a WAV file
+PCMBuffer *read_wave_pcm(const char *filepath, AudioFileInfo *info,
+                         AudioError *error) {
+  if (!filepath || !info) {
+    if (error)
+      *error = AUDIO_ERROR_INVALID_PARAMETER;
+    return NULL;
+  }
+
+  FILE *file = fopen(filepath, "rb");
+  if (!file) {
+    if (error)
+      *error = AUDIO_ERROR_FILE_NOT_FOUND;
+    return NULL;
+  }
+
+  AudioError status = flac_probe(file) ? AUDIO_ERROR_UNSUPPORTED_FORMAT
+                                       : parse_wav_header(file, info);
+  if (status != AUDIO_SUCCESS) {
+    fclose(file);
+    if (error)
+      *error = status;
+    return NULL;
+  }
+
+  PCMBuffer *pcm = pcm_buffer_create(info->data_size, info->bit_depth);
+  if (!pcm) {
+    fclose(file);
+    if (error)
+      *error = AUDIO_ERROR_MEMORY_ERROR;
+    return NULL;
+  }
+
+  if (!read_exact(file, pcm->data, info->data_size)) {
+    pcm_buffer_free(pcm);
+    fclose(file);
+    if (error)
+      *error = AUDIO_ERROR_READ_ERROR;
+    return NULL;
+  }
+
+  fclose(file);
+  if (error)
+    *error = AUDIO_SUCCESS;
+  return pcm;
+}
+
+// Write raw PCM bytes as a WAV file
+AudioError write_wave_pcm(const char *filepath, const PCMBuffer *pcm,
+                          int sample_rate, int channels) {
+  if (!filepath || !pcm || !pcm->data || channels < 1) {
+    return AUDIO_ERROR_INVALID_PARAMETER;
+  }
+  if (audio_path_is_flac(filepath)) {
+    return AUDIO_ERROR_UNSUPPORTED_FORMAT;
+  }
+
+  FILE *file = fopen(filepath, "wb");
+  if (!file) {
+    return AUDIO_ERROR_WRITE_ERROR;
+  }
+
+  if (!write_wav_header(file, sample_rate, channels, pcm->bit_depth,
+                        pcm->length) ||
+      !write_exact(file, pcm->data, pcm->length)) {
+    fclose(file);
+    return AUDIO_ERROR_WRITE_ERROR;
+  }
+
+  fclose(file);
+  return AUDIO_SUCCESS;
+}
+
 // Create audio buffer
 AudioBuffer *audio_buffer_create(size_t length, int sample_rate, int channels,
                                  int bit_depth) {
@@ -387,12 +1070,14 @@ AudioBuffer *audio_buffer_create(size_t length, int sample_rate, int channels,
     return NULL;
   }
 
-  buffer->data = (double *)malloc(length * sizeof(double));
-  if (!buffer->data) {
+  buffer->storage = audio_storage_create(length);
+  if (!buffer->storage) {
     free(buffer);
     return NULL;
   }
 
+  buffer->data = buffer->storage->data;
+
   buffer->length = length;
   buffer->sample_rate = sample_rate;
   buffer->channels = channels;
@@ -401,10 +1086,12 @@ AudioBuffer *audio_buffer_create(size_t length, int sample_rate, int channels,
   return buffer;
 }
 
-// Free audio buffer
+// Free audio buffer (views keep the shared storage alive)
 void audio_buffer_free(AudioBuffer *buffer) {
   if (buffer) {
-    if (buffer->data) {
+    if (buffer->storage) {
+      audio_storage_release(buffer->storage);
+    } else if (buffer->data) {
       free(buffer->data);
     }
     free(buffer);
@@ -418,7 +1105,7 @@ PCMBuffer *pcm_buffer_create(size_t length, int bit_depth) {
     return NULL;
   }
 
-  buffer->data = (uint8_t *)malloc(length);
+  buffer->data = (uint8_t *)audio_alloc(length);
   if (!buffer->data) {
     free(buffer);
     return NULL;
@@ -434,7 +1121,7 @@ PCMBuffer *pcm_buffer_create(size_t length, int bit_depth) {
 void pcm_buffer_free(PCMBuffer *buffer) {
   if (buffer) {
     if (buffer->data) {
-      free(buffer->data);
+      audio_free(buffer->data);
     }
     free(buffer);
   }
@@ -0,0 +1,191 @@
+#define _GNU_SOURCE
+#include "audio_numa.h"
+#include <dirent.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// mbind(2) constants from linux/mempolicy.h
+#define NUMA_MPOL_PREFERRED 1
+#define NUMA_MPOL_MF_MOVE (1 << 1)
+
+#define NODE_SYSFS "/sys/devices/system/node"
+
+static AudioNumaTopology topology;
+static int *cpu_to_node = NULL;   // Node index per CPU id (-1 = unknown)
+static int max_cpu = 0;           // Size of cpu_to_node
+static pthread_once_t topology_once = PTHREAD_ONCE_INIT;
+
+static void add_cpu(AudioNumaNode *node, int cpu) {
+  int *grown = realloc(node->cpus, (node->num_cpus + 1) * sizeof(int));
+  if (!grown)
+    return;
+  node->cpus = grown;
+  node->cpus[node->num_cpus++] = cpu;
+}
+
+// Parse a sysfs CPU list ("0-3,8,10-11") into a node, keeping only CPUs in
+// the affinity mask
+static void parse_cpulist(const char *list, const cpu_set_t *allowed,
+                          AudioNumaNode *node) {
+  const char *p = list;
+  while (*p) {
+    char *end;
+    long first = strtol(p, &end, 10);
+    if (end == p)
+      break;
+    long last = first;
+    p = end;
+    if (*p == '-') {
+      last = strtol(p + 1, &end, 10);
+      p = end;
+    }
+    for (long cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, allowed))
+        add_cpu(node, (int)cpu);
+    }
+    if (*p == ',')
+      p++;
+    else
+      break;
+  }
+}
+
+static int compare_nodes(const void *a, const void *b) {
+  return ((const AudioNumaNode *)a)->id - ((const AudioNumaNode *)b)->id;
+}
+
+static void discover_topology(void) {
+  cpu_set_t allowed;
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+    CPU_ZERO(&allowed);
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    for (long cpu = 0; cpu < count && cpu < CPU_SETSIZE; cpu++)
+      CPU_SET(cpu, &allowed);
+  }
+
+  DIR *dir = opendir(NODE_SYSFS);
+  struct dirent *entry;
+  while (dir && (entry = readdir(dir)) != NULL) {
+    int id;
+    char tail;
+    if (sscanf(entry->d_name, "node%d%c", &id, &tail) != 1 || id < 0 ||
+        id >= AUDIO_NUMA_MAX_NODES ||
+        topology.num_nodes == AUDIO_NUMA_MAX_NODES)
+      continue;
+
+    char path[sizeof(NODE_SYSFS) + sizeof(entry->d_name) + 16], list[4096];
+    snprintf(path, sizeof(path), NODE_SYSFS "/%s/cpulist", entry->d_name);
+    FILE *file = fopen(path, "r");
+    if (!file)
+      continue;
+    if (fgets(list, sizeof(list), file)) {
+      AudioNumaNode *node = &topology.nodes[topology.num_nodes];
+      node->id = id;
+      parse_cpulist(list, &allowed, node);
+      if (node->num_cpus > 0)
+        topology.num_nodes++;
+      else
+        free(node->cpus);
+    }
+    fclose(file);
+  }
+  if (dir)
+    closedir(dir);
+
+  // No NUMA information: one node with every allowed CPU
+  if (topology.num_nodes == 0) {
+    AudioNumaNode *node = &topology.nodes[0];
+    node->id = 0;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &allowed))
+        add_cpu(node, cpu);
+    }
+    topology.num_nodes = 1;
+  }
+
+  qsort(topology.nodes, topology.num_nodes, sizeof(AudioNumaNode),
+        compare_nodes);
+
+  for (int n = 0; n < topology.num_nodes; n++) {
+    const AudioNumaNode *node = &topology.nodes[n];
+    for (int c = 0; c < node->num_cpus; c++) {
+      if (node->cpus[c] >= max_cpu)
+        max_cpu = node->cpus[c] + 1;
+    }
+  }
+  cpu_to_node = malloc((max_cpu > 0 ? max_cpu : 1) * sizeof(int));
+  if (!cpu_to_node) {
+    max_cpu = 0;
+    return;
+  }
+  for (int cpu = 0; cpu < max_cpu; cpu++)
+    cpu_to_node[cpu] = -1;
+  for (int n = 0; n < topology.num_nodes; n++) {
+    const AudioNumaNode *node = &topology.nodes[n];
+    for (int c = 0; c < node->num_cpus; c++)
+      cpu_to_node[node->cpus[c]] = n;
+  }
+}
+
+const AudioNumaTopology *audio_numa_topology(void) {
+  pthread_once(&topology_once, discover_topology);
+  return &topology;
+}
+
+int audio_numa_current_node(void) {
+  const AudioNumaTopology *topo = audio_numa_topology();
+  if (topo->num_nodes == 1)
+    return 0;
+
+  int cpu = sched_getcpu();
+  if (cpu < 0 || cpu >= max_cpu || cpu_to_node[cpu] < 0)
+    return 0;
+  return cpu_to_node[cpu];
+}
+
+int audio_numa_pin_thread(int node) {
+  const AudioNumaTopology *topo = audio_numa_topology();
+  if (node < 0 || node >= topo->num_nodes)
+    return -1;
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  const AudioNumaNode *target = &topo->nodes[node];
+  for (int c = 0; c < target->num_cpus; c++)
+    CPU_SET(target->cpus[c], &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0 ? 0
+                                                                        : -1;
+}
+
+int audio_numa_bind(void *addr, size_t size, int node) {
+  const AudioNumaTopology *topo = audio_numa_topology();
+  if (!addr || node < 0 || node >= topo->num_nodes)
+    return -1;
+  if (topo->num_nodes == 1 || size == 0)
+    return 0;
+
+#ifdef SYS_mbind
+  // mbind works on whole pages
+  uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+  uintptr_t start = (uintptr_t)addr & ~(page - 1);
+  uintptr_t end = ((uintptr_t)addr + size + page - 1) & ~(page - 1);
+
+  unsigned long mask[(AUDIO_NUMA_MAX_NODES + 63) / 64] = {0};
+  int id = topo->nodes[node].id;
+  mask[id / 64] |= 1UL << (id % 64);
+  long result = syscall(SYS_mbind, (void *)start, (unsigned long)(end - start),
+                        NUMA_MPOL_PREFERRED, mask,
+                        (unsigned long)AUDIO_NUMA_MAX_NODES + 1,
+                        NUMA_MPOL_MF_MOVE);
+  return result == 0 ? 0 : -1;
+#else
+  return -1;
+#endif
+}
@@ -1,7 +1,17 @@
 #include "audio_io.h"
+#include "audio_alloc.h"
+#include "audio_numa.h"
+#include "batch.h"
+#include "chain.h"
+#include "dynamics.h"
+#include "fixed_biquad.h"
 #include "hpf.h"
 #include "lpf.h"
+#include "mix.h"
 #include "parametric.h"
+#include "pipeline.h"
+#include "prefork.h"
+#include "stft.h"
 #include <getopt.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -10,9 +20,41 @@
 #define VERSION "1.0.0"
 #define PROGRAM_NAME "audio-util"
 
+// Brickwall limiter settings for --limit
+#define LIMITER_LOOKAHEAD_MS 1.5
+#define LIMITER_RELEASE_MS 50.0
+
+// Noise gate settings for --gate (the close threshold is relative to the
+// open threshold given on the command line)
+#define GATE_HYSTERESIS_DB 6.0
+#define GATE_ATTACK_MS 1.0
+#define GATE_HOLD_MS 50.0
+#define GATE_RELEASE_MS 100.0
+
+// Recycling pool budget per batch worker thread (room for the buffers of a
+// few decoded files)
+#define BATCH_POOL_BYTES_PER_THREAD ((size_t)256 << 20)
+
 // Filter types
 typedef enum { FILTER_NONE, FILTER_HPF, FILTER_LPF, FILTER_PEQ } FilterType;
 
+// Filter designed by the parent of a pre-forked batch for one sample rate,
+// shared read-only with every worker process
+typedef struct {
+  int sample_rate;
+  HPFFilter hpf;
+  LPFFilter lpf;
+  ParametricFilter peq;
+} FilterTemplate;
+
+// Sample rates designed ahead for pre-forked batches (other rates are
+// designed by the job)
+static const int template_rates[] = {8000,  11025, 16000, 22050,
+                                     32000, 44100, 48000, 88200,
+                                     96000, 176400, 192000};
+#define NUM_TEMPLATE_RATES                                                     \
+  ((int)(sizeof(template_rates) / sizeof(template_rates[0])))
+
 // Configuration structure
 typedef struct {
   char *input_path;
@@ -21,6 +63,25 @@ typedef struct {
   double frequency;
   double gain; // For parametric EQ (dB)
   double q;    // For parametric EQ (Q factor)
+  int region;      // Process only [start, start + duration)
+  double start;    // Region start (seconds)
+  double duration; // Region length (seconds, <= 0 means to end of file)
+  int fixed;       // Bit-exact fixed-point processing of the PCM data
+  const char *mix_paths[AUDIO_MIX_MAX_INPUTS]; // Extra inputs to sum
+  double mix_gains[AUDIO_MIX_MAX_INPUTS];      // Their gains (dB)
+  int num_mix;
+  int limit;       // Brickwall-limit the filtered output
+  double limit_db; // Limiter ceiling (dBFS)
+  int gate;        // Noise-gate the filtered output
+  double gate_db;  // Gate open threshold (dBFS)
+  const char *spectrogram_path; // Spectrogram of the written output
+  const char *batch_path;       // Manifest of a shared batch run
+  int threads;                  // Batch worker threads in this process
+  int pipeline;                 // Stream through decode/filter/encode threads
+  int processes;                // Pre-forked batch worker processes
+  int large_io;                 // Drop-behind caching, preallocated outputs
+  const FilterTemplate *templates; // Filters designed before forking
+  int num_templates;
 } Config;
 
 // Print usage information
@@ -28,13 +89,41 @@ void print_usage(const char *program_name) {
   printf("Usage: %s [OPTIONS]\n\n", program_name);
   printf("Audio processing utility with support for various filters.\n\n");
   printf("Required Options:\n");
-  printf("  --input PATH      Input WAV file path\n");
-  printf("  --output PATH     Output WAV file path\n");
+  printf("  --input PATH      Input WAV or FLAC file path\n");
+  printf("  --output PATH     Output file path (FLAC if it ends in .flac, "
+         "else WAV)\n");
   printf("  --filter TYPE     Filter type (hpf, lpf, peq)\n");
   printf("  --freq HZ         Filter frequency parameter (Hz)\n\n");
   printf("Optional:\n");
   printf("  --gain DB         Gain in dB for parametric EQ (default: 0.0)\n");
   printf("  --q FACTOR        Q factor for parametric EQ (default: 1.0)\n");
+  printf("  --start SEC       Process only from this time (seconds)\n");
+  printf("  --duration SEC    Process only this many seconds\n");
+  printf("  --fixed           Bit-exact fixed-point processing (16/24-bit "
+         "WAV)\n");
+  printf("  --mix PATH[@DB]   Sum another input with optional gain "
+         "(repeatable)\n");
+  printf("  --limit DB        Brickwall-limit the output to this ceiling "
+         "(dBFS)\n");
+  printf("  --gate DB         Noise gate opening at this level (dBFS); fused "
+         "with hpf\n");
+  printf("  --spectrogram PATH  Write the output's spectrogram (2048-point "
+         "STFT)\n");
+  printf("  --batch MANIFEST  Work through a shared manifest of "
+         "\"input<TAB>output\"\n");
+  printf("                    lines (run on any number of machines)\n");
+  printf("  --threads N       Batch worker threads, spread over NUMA nodes "
+         "(default: 1)\n");
+  printf("  --processes N     Pre-forked batch worker processes sharing the "
+         "parent's\n");
+  printf("                    filter designs and compiled kernels (default: "
+         "1)\n");
+  printf("  --pipeline        Stream with separate decode, filter (per "
+         "channel pair)\n");
+  printf("                    and encode threads\n");
+  printf("  --large-io        Keep multi-GB files out of the page cache and "
+         "preallocate\n");
+  printf("                    outputs\n");
   printf("  -h, --help        Show this help message\n");
   printf("  -v, --version     Show version information\n\n");
   printf("Supported Filters:\n");
@@ -58,6 +147,51 @@ void print_usage(const char *program_name) {
   printf("  %s --input audio.wav --filter peq --freq 1000 --gain 6.0 --q 1.0 "
          "--output boosted.wav\n\n",
          program_name);
+  printf("  # High-pass a FLAC master straight to FLAC (no WAV on disk)\n");
+  printf("  %s --input master.flac --filter hpf --freq 30 --output "
+         "master-hp.flac\n\n",
+         program_name);
+  printf("  # Bit-exact, platform-independent 80 Hz high-pass\n");
+  printf("  %s --input master.wav --filter hpf --freq 80 --fixed "
+         "--output master-hp.wav\n\n",
+         program_name);
+  printf("  # +6 dB at 100 Hz, then a -1 dBFS brickwall limiter\n");
+  printf("  %s --input audio.wav --filter peq --freq 100 --gain 6 --limit -1 "
+         "--output loud.wav\n\n",
+         program_name);
+  printf("  # Voice cleanup: 80 Hz high-pass and a -45 dBFS gate in one pass\n");
+  printf("  %s --input voice.wav --filter hpf --freq 80 --gate -45 "
+         "--output voice-clean.wav\n\n",
+         program_name);
+  printf("  # High-pass and keep a spectrogram of the result for QA\n");
+  printf("  %s --input audio.wav --filter hpf --freq 100 --spectrogram "
+         "audio-out.stft --output audio-out.wav\n\n",
+         program_name);
+  printf("  # Filter a long multichannel file on decode, filter and encode "
+         "threads\n");
+  printf("  %s --input stems.wav --filter hpf --freq 40 --pipeline "
+         "--output stems-hp.wav\n\n",
+         program_name);
+  printf("  # The same for a multi-GB file, without flooding the page "
+         "cache\n");
+  printf("  %s --input stems.wav --filter hpf --freq 40 --pipeline "
+         "--large-io --output stems-hp.wav\n\n",
+         program_name);
+  printf("  # Share a batch between workers (start one per machine/core)\n");
+  printf("  %s --batch /shared/archive/manifest.txt --filter hpf --freq 80\n\n",
+         program_name);
+  printf("  # The same, with one worker per core of a two-socket machine\n");
+  printf("  %s --batch /shared/archive/manifest.txt --threads 32 --filter hpf "
+         "--freq 80\n\n",
+         program_name);
+  printf("  # Sum three stems, high-passing each, bass 3 dB down\n");
+  printf("  %s --mix drums.wav --mix bass.wav@-3 --mix keys.wav "
+         "--filter hpf --freq 30 --output mix.wav\n\n",
+         program_name);
+  printf("  # Preview 10 seconds starting at 1:30 of a long file\n");
+  printf("  %s --input long.wav --filter hpf --freq 80 --start 90 "
+         "--duration 10 --output preview.wav\n\n",
+         program_name);
 }
 
 // Print version information
@@ -88,7 +222,52 @@ FilterType parse_filter_type(const char *filter_str) {
 
 // Validate configuration
 int validate_config(const Config *config) {
-  if (config->input_path == NULL) {
+  if (config->threads < 1) {
+    fprintf(stderr, "Error: --threads must be at least 1\n");
+    return 0;
+  }
+  if (config->threads > 1 && config->batch_path == NULL) {
+    fprintf(stderr, "Error: --threads requires --batch\n");
+    return 0;
+  }
+  if (config->processes < 1 ||
+      config->processes > AUDIO_PREFORK_MAX_WORKERS) {
+    fprintf(stderr, "Error: --processes must be between 1 and %d\n",
+            AUDIO_PREFORK_MAX_WORKERS);
+    return 0;
+  }
+  if (config->processes > 1 && config->batch_path == NULL) {
+    fprintf(stderr, "Error: --processes requires --batch\n");
+    return 0;
+  }
+
+  // A batch takes its inputs and outputs from the manifest
+  if (config->batch_path != NULL) {
+    if (config->input_path != NULL || config->output_path != NULL ||
+        config->num_mix > 0 || config->fixed || config->region ||
+        config->spectrogram_path != NULL || config->pipeline) {
+      fprintf(stderr, "Error: --batch does not support --input, --output, "
+                      "--mix, --fixed, --start/--duration, --spectrogram "
+                      "or --pipeline\n");
+      return 0;
+    }
+    if (config->filter == FILTER_NONE) {
+      fprintf(stderr, "Error: --filter is required\n");
+      return 0;
+    }
+    if (config->frequency <= 0.0) {
+      fprintf(stderr, "Error: --freq must be positive\n");
+      return 0;
+    }
+    if (config->filter == FILTER_PEQ && config->q <= 0.0) {
+      fprintf(stderr, "Error: --q must be positive\n");
+      return 0;
+    }
+    return 1;
+  }
+
+  // With --mix, --input is optional (it becomes the first mix input)
+  if (config->input_path == NULL && config->num_mix == 0) {
     fprintf(stderr, "Error: --input is required\n");
     return 0;
   }
@@ -98,12 +277,13 @@ int validate_config(const Config *config) {
     return 0;
   }
 
-  if (config->filter == FILTER_NONE) {
+  // A mix may be a plain sum without filtering
+  if (config->filter == FILTER_NONE && config->num_mix == 0) {
     fprintf(stderr, "Error: --filter is required\n");
     return 0;
   }
 
-  if (config->frequency <= 0.0) {
+  if (config->filter != FILTER_NONE && config->frequency <= 0.0) {
     fprintf(stderr, "Error: --freq must be positive\n");
     return 0;
   }
@@ -116,19 +296,101 @@ int validate_config(const Config *config) {
     }
   }
 
-  // Validate input file exists
-  FILE *test = fopen(config->input_path, "rb");
-  if (test == NULL) {
-    fprintf(stderr, "Error: Cannot open input file: %s\n", config->input_path);
+  if (config->region) {
+    if (config->start < 0.0) {
+      fprintf(stderr, "Error: --start must not be negative\n");
+      return 0;
+    }
+    if (config->fixed) {
+      fprintf(stderr, "Error: --fixed does not support --start/--duration\n");
+      return 0;
+    }
+  }
+
+  if (config->limit && (config->fixed || config->num_mix > 0)) {
+    fprintf(stderr, "Error: --limit does not support --fixed or --mix\n");
+    return 0;
+  }
+
+  if (config->gate && (config->fixed || config->num_mix > 0)) {
+    fprintf(stderr, "Error: --gate does not support --fixed or --mix\n");
+    return 0;
+  }
+
+  if (config->num_mix > 0 && (config->fixed || config->region)) {
+    fprintf(stderr,
+            "Error: --mix does not support --fixed or --start/--duration\n");
     return 0;
   }
-  fclose(test);
+
+  if (config->fixed && audio_path_is_flac(config->output_path)) {
+    fprintf(stderr, "Error: --fixed writes WAV only\n");
+    return 0;
+  }
+
+  if (config->pipeline && (config->fixed || config->num_mix > 0 ||
+                           config->region || config->gate || config->limit)) {
+    fprintf(stderr, "Error: --pipeline does not support --fixed, --mix, "
+                    "--start/--duration, --gate or --limit\n");
+    return 0;
+  }
+
+  // Validate input file exists
+  if (config->input_path != NULL) {
+    FILE *test = fopen(config->input_path, "rb");
+    if (test == NULL) {
+      fprintf(stderr, "Error: Cannot open input file: %s\n",
+              config->input_path);
+      return 0;
+    }
+    fclose(test);
+  }
 
   return 1;
 }
 
-// Apply high-pass filter
-int apply_hpf(AudioBuffer *buffer, double frequency) {
+#ifdef USE_MLIR
+// Give a copy of a shared filter template JIT handles of its own, since a
+// handle must not be used by two threads at once (batch threads share the
+// templates). Cheap: the kernels the parent compiled are reused, not
+// rebuilt.
+static void own_jit_handles(MLIRBiQuadJIT **left_jit,
+                            MLIRBiQuadJIT **right_jit, const BiQuad *left,
+                            const BiQuad *right) {
+  if (*left_jit) {
+    *left_jit = mlir_biquad_jit_create(left);
+  }
+  if (*right_jit) {
+    *right_jit = mlir_biquad_jit_create(right);
+  }
+}
+
+static void release_jit_handles(MLIRBiQuadJIT *left_jit,
+                                MLIRBiQuadJIT *right_jit) {
+  if (left_jit) {
+    mlir_biquad_jit_destroy(left_jit);
+  }
+  if (right_jit) {
+    mlir_biquad_jit_destroy(right_jit);
+  }
+}
+#endif
+
+// Append the stages of `post` to a chain holding the filter stage and run
+// it over the buffer, so the dynamics share the filter's tiled pass
+static void run_fused_pass(AudioChain *chain, const AudioChain *post,
+                           AudioBuffer *buffer) {
+  for (int s = 0; s < post->num_stages; s++) {
+    audio_chain_add(chain, post->stages[s].name, post->stages[s].process,
+                    post->stages[s].state);
+  }
+  audio_chain_process(chain, buffer);
+}
+
+// Apply high-pass filter, followed in the same pass by the stages of `post`
+// (may be NULL)
+int apply_hpf(AudioBuffer *buffer, double frequency,
+              const FilterTemplate *shared, const AudioChain *post) {
   printf("Applying high-pass filter:\n");
   printf("  Cutoff frequency: %.1f Hz\n", frequency);
   printf("  Sample rate: %d Hz\n", buffer->sample_rate);
@@ -144,17 +406,38 @@ int apply_hpf(AudioBuffer *buffer, double frequency) {
     return 0;
   }
 
-  // Initialize and apply HPF
+  // Initialize (or copy the shared design) and apply HPF
   HPFFilter hpf;
-  hpf_init(&hpf, buffer->sample_rate, frequency);
-  hpf_process_buffer(&hpf, buffer);
+  if (shared != NULL) {
+    hpf = shared->hpf;
+#ifdef USE_MLIR
+    own_jit_handles(&hpf.left_jit, &hpf.right_jit, &hpf.left, &hpf.right);
+#endif
+  } else {
+    hpf_init(&hpf, buffer->sample_rate, frequency);
+  }
+  if (post != NULL && post->num_stages > 0) {
+    AudioChain chain;
+    audio_chain_init(&chain);
+    audio_chain_add_hpf(&chain, &hpf);
+    run_fused_pass(&chain, post, buffer);
+  } else {
+    hpf_process_buffer(&hpf, buffer);
+  }
+#ifdef USE_MLIR
+  if (shared != NULL) {
+    release_jit_handles(hpf.left_jit, hpf.right_jit);
+  }
+#endif
 
   printf("  ✓ Filter applied successfully\n");
   return 1;
 }
 
-// Apply low-pass filter
-int apply_lpf(AudioBuffer *buffer, double frequency) {
+// Apply low-pass filter, followed in the same pass by the stages of `post`
+// (may be NULL)
+int apply_lpf(AudioBuffer *buffer, double frequency,
+              const FilterTemplate *shared, const AudioChain *post) {
   printf("Applying low-pass filter:\n");
   printf("  Cutoff frequency: %.1f Hz\n", frequency);
   printf("  Sample rate: %d Hz\n", buffer->sample_rate);
@@ -170,17 +453,38 @@ int apply_lpf(AudioBuffer *buffer, double frequency) {
     return 0;
   }
 
-  // Initialize and apply LPF
+  // Initialize (or copy the shared design) and apply LPF
   LPFFilter lpf;
-  lpf_init(&lpf, buffer->sample_rate, frequency);
-  lpf_process_buffer(&lpf, buffer);
+  if (shared != NULL) {
+    lpf = shared->lpf;
+#ifdef USE_MLIR
+    own_jit_handles(&lpf.left_jit, &lpf.right_jit, &lpf.left, &lpf.right);
+#endif
+  } else {
+    lpf_init(&lpf, buffer->sample_rate, frequency);
+  }
+  if (post != NULL && post->num_stages > 0) {
+    AudioChain chain;
+    audio_chain_init(&chain);
+    audio_chain_add_lpf(&chain, &lpf);
+    run_fused_pass(&chain, post, buffer);
+  } else {
+    lpf_process_buffer(&lpf, buffer);
+  }
+#ifdef USE_MLIR
+  if (shared != NULL) {
+    release_jit_handles(lpf.left_jit, lpf.right_jit);
+  }
+#endif
 
   printf("  ✓ Filter applied successfully\n");
   return 1;
 }
 
-// Apply parametric EQ
-int apply_peq(AudioBuffer *buffer, double frequency, double gain, double q) {
+// Apply parametric EQ, followed in the same pass by the stages of `post`
+// (may be NULL)
+int apply_peq(AudioBuffer *buffer, double frequency, double gain, double q,
+              const FilterTemplate *shared, const AudioChain *post) {
   printf("Applying parametric EQ:\n");
   printf("  Center frequency: %.1f Hz\n", frequency);
   printf("  Gain: %.1f dB\n", gain);
@@ -200,57 +504,885 @@ int apply_peq(AudioBuffer *buffer, double frequency, double gain, double q) {
 
   // Initialize and apply parametric EQ
   ParametricFilter peq;
-  parametric_init(&peq, buffer->sample_rate, frequency, gain, q);
-  parametric_process_buffer(&peq, buffer);
+  if (shared != NULL) {
+    peq = shared->peq;
+#ifdef USE_MLIR
+    own_jit_handles(&peq.left_jit, &peq.right_jit, &peq.left, &peq.right);
+#endif
+  } else {
+    parametric_init(&peq, buffer->sample_rate, frequency, gain, q);
+  }
+  if (post != NULL && post->num_stages > 0) {
+    AudioChain chain;
+    audio_chain_init(&chain);
+    audio_chain_add_parametric(&chain, &peq);
+    run_fused_pass(&chain, post, buffer);
+  } else {
+    parametric_process_buffer(&peq, buffer);
+  }
+#ifdef USE_MLIR
+  if (shared != NULL) {
+    release_jit_handles(peq.left_jit, peq.right_jit);
+  }
+#endif
 
   printf("  ✓ Filter applied successfully\n");
   return 1;
 }
 
-// Main processing function
-int process_audio(const Config *config) {
+// Set up the noise gate, running the high-pass filter in the same loop when
+// one is given
+int init_gate(NoiseGate *gate, const AudioBuffer *buffer, double open_db,
+              HPFFilter *hpf) {
+  printf("Applying noise gate%s:\n", hpf ? " (fused with high-pass)" : "");
+  printf("  Open/close: %.1f / %.1f dBFS\n", open_db,
+         open_db - GATE_HYSTERESIS_DB);
+
+  if (buffer->channels > DYNAMICS_MAX_CHANNELS) {
+    fprintf(stderr, "Error: The gate supports at most %d channels\n",
+            DYNAMICS_MAX_CHANNELS);
+    return 0;
+  }
+
+  gate_init(gate, buffer->sample_rate, open_db, open_db - GATE_HYSTERESIS_DB,
+            GATE_ATTACK_MS, GATE_HOLD_MS, GATE_RELEASE_MS);
+  gate->hpf = hpf;
+  return 1;
+}
+
+// High-pass filter fused with the gate (one pass), followed in the same
+// pass by the stages of `post` (may be NULL)
+int apply_hpf_gate(AudioBuffer *buffer, double frequency, double open_db,
+                   const FilterTemplate *shared, const AudioChain *post) {
+  printf("Applying high-pass filter:\n");
+  printf("  Cutoff frequency: %.1f Hz\n", frequency);
+
+  double nyquist = buffer->sample_rate / 2.0;
+  if (frequency >= nyquist) {
+    fprintf(stderr,
+            "Error: Frequency %.1f Hz exceeds Nyquist limit (%.1f Hz)\n",
+            frequency, nyquist);
+    return 0;
+  }
+
+  HPFFilter hpf;
+  if (shared != NULL) {
+    hpf = shared->hpf;
+#ifdef USE_MLIR
+    own_jit_handles(&hpf.left_jit, &hpf.right_jit, &hpf.left, &hpf.right);
+#endif
+  } else {
+    hpf_init(&hpf, buffer->sample_rate, frequency);
+  }
+
+  NoiseGate gate;
+  int success = init_gate(&gate, buffer, open_db, &hpf);
+  if (success) {
+    AudioChain chain;
+    audio_chain_init(&chain);
+    audio_chain_add(&chain, "gate", gate_stage, &gate);
+    if (post != NULL) {
+      run_fused_pass(&chain, post, buffer);
+    } else {
+      audio_chain_process(&chain, buffer);
+    }
+    printf("  ✓ Gate applied successfully\n");
+  }
+#ifdef USE_MLIR
+  if (shared != NULL) {
+    release_jit_handles(hpf.left_jit, hpf.right_jit);
+  }
+#endif
+  return success;
+}
+
+// Set up the brickwall limiter as a latency-compensated stage for one pass
+// over `buffer` (limiter_finish_buffer completes it)
+int init_limiter(Limiter *lim, const AudioBuffer *buffer, double ceiling_db) {
+  printf("Applying limiter:\n");
+  printf("  Ceiling: %.1f dBFS\n", ceiling_db);
+  printf("  Look-ahead: %.1f ms, release: %.1f ms\n", LIMITER_LOOKAHEAD_MS,
+         LIMITER_RELEASE_MS);
+
+  if (limiter_init(lim, buffer->sample_rate, buffer->channels, ceiling_db,
+                   LIMITER_LOOKAHEAD_MS, LIMITER_RELEASE_MS) != 0) {
+    fprintf(stderr, "Error: Cannot initialize limiter\n");
+    return 0;
+  }
+  return 1;
+}
+
+// Coefficients of the configured filter (one channel)
+BiQuad filter_design(const Config *config, int sample_rate) {
+  BiQuad design;
+  biquad_init(&design);
+
+  switch (config->filter) {
+  case FILTER_HPF: {
+    HPFFilter hpf;
+    hpf_init(&hpf, sample_rate, config->frequency);
+    design = hpf.left;
+    break;
+  }
+  case FILTER_LPF: {
+    LPFFilter lpf;
+    lpf_init(&lpf, sample_rate, config->frequency);
+    design = lpf.left;
+    break;
+  }
+  case FILTER_PEQ: {
+    ParametricFilter peq;
+    parametric_init(&peq, sample_rate, config->frequency, config->gain,
+                    config->q);
+    design = peq.left;
+    break;
+  }
+  default:
+    break;
+  }
+  return design;
+}
+
+// Filter the PCM data in place with the fixed-point kernel, skipping the
+// float conversion entirely, so the output is identical on every host
+int process_fixed(const Config *config) {
+  AudioFileInfo info;
   AudioError error;
 
-  // Read input file
   printf("Reading input file: %s\n", config->input_path);
-  AudioBuffer *buffer = read_wave(config->input_path, &error);
-
-  if (buffer == NULL) {
+  PCMBuffer *pcm = read_wave_pcm(config->input_path, &info, &error);
+  if (pcm == NULL) {
     fprintf(stderr, "Error reading input file: %s\n",
             audio_error_string(error));
     return 1;
   }
 
-  printf("  Sample rate: %d Hz\n", buffer->sample_rate);
-  printf("  Channels: %d\n", buffer->channels);
-  printf("  Bit depth: %d bits\n", buffer->bit_depth);
-  printf("  Duration: %.2f seconds\n",
-         (double)buffer->length / buffer->channels / buffer->sample_rate);
-  printf("  Samples: %zu\n", buffer->length);
+  printf("  Sample rate: %d Hz\n", info.sample_rate);
+  printf("  Channels: %d\n", info.channels);
+  printf("  Bit depth: %d bits\n", info.bit_depth);
+  printf("  Frames: %zu\n", info.frames);
 
-  // Apply filter
-  int success = 1;
+  if (info.audio_format != AUDIO_FORMAT_PCM ||
+      (info.bit_depth != 16 && info.bit_depth != 24)) {
+    fprintf(stderr, "Error: --fixed requires 16- or 24-bit PCM input\n");
+    pcm_buffer_free(pcm);
+    return 1;
+  }
+
+  double nyquist = info.sample_rate / 2.0;
+  if (config->frequency >= nyquist) {
+    fprintf(stderr,
+            "Error: Frequency %.1f Hz exceeds Nyquist limit (%.1f Hz)\n",
+            config->frequency, nyquist);
+    pcm_buffer_free(pcm);
+    return 1;
+  }
+
+  BiQuad design = filter_design(config, info.sample_rate);
+  FixedBiQuad *filters = malloc(info.channels * sizeof(FixedBiQuad));
+  int ok = filters != NULL;
+  for (int c = 0; ok && c < info.channels; c++) {
+    ok = fixed_biquad_init(&filters[c], &design) == 0;
+  }
+  if (!ok) {
+    fprintf(stderr, "Error: Filter coefficients out of fixed-point range\n");
+    free(filters);
+    pcm_buffer_free(pcm);
+    return 1;
+  }
+
+  printf("Applying fixed-point filter (Q%d.%d coefficients)\n",
+         32 - filters[0].frac_bits, filters[0].frac_bits);
+  fixed_biquad_process_pcm(filters, info.channels, pcm);
+  free(filters);
+
+  printf("Writing output file: %s\n", config->output_path);
+  error = write_wave_pcm(config->output_path, pcm, info.sample_rate,
+                         info.channels);
+  pcm_buffer_free(pcm);
+  if (error != AUDIO_SUCCESS) {
+    fprintf(stderr, "Error writing output file: %s\n",
+            audio_error_string(error));
+    return 1;
+  }
+
+  printf("  ✓ Output file written successfully\n");
+  printf("\n✓ Processing complete!\n");
+  return 0;
+}
+
+// Parse a --mix argument: PATH or PATH@GAIN_DB
+int parse_mix_spec(char *spec, Config *config) {
+  if (config->num_mix == AUDIO_MIX_MAX_INPUTS) {
+    fprintf(stderr, "Error: At most %d --mix inputs are supported\n",
+            AUDIO_MIX_MAX_INPUTS);
+    return 0;
+  }
+
+  double gain = 0.0;
+  char *at = strrchr(spec, '@');
+  if (at != NULL) {
+    char *end;
+    gain = strtod(at + 1, &end);
+    if (end == at + 1 || *end != '\0') {
+      fprintf(stderr, "Error: Invalid mix gain '%s'\n", at + 1);
+      return 0;
+    }
+    *at = '\0';
+  }
+
+  config->mix_paths[config->num_mix] = spec;
+  config->mix_gains[config->num_mix] = gain;
+  config->num_mix++;
+  return 1;
+}
+
+// Per-input filter state for the mixer
+typedef struct {
+  HPFFilter hpf;
+  LPFFilter lpf;
+  ParametricFilter peq;
+  AudioChain chain;
+} MixInputFilter;
+
+// Build a one-stage chain running the configured filter
+void mix_filter_init(MixInputFilter *mf, const Config *config,
+                     int sample_rate) {
+  audio_chain_init(&mf->chain);
   switch (config->filter) {
   case FILTER_HPF:
-    success = apply_hpf(buffer, config->frequency);
+    hpf_init(&mf->hpf, sample_rate, config->frequency);
+    audio_chain_add_hpf(&mf->chain, &mf->hpf);
     break;
   case FILTER_LPF:
-    success = apply_lpf(buffer, config->frequency);
+    lpf_init(&mf->lpf, sample_rate, config->frequency);
+    audio_chain_add_lpf(&mf->chain, &mf->lpf);
     break;
   case FILTER_PEQ:
-    success = apply_peq(buffer, config->frequency, config->gain, config->q);
+    parametric_init(&mf->peq, sample_rate, config->frequency, config->gain,
+                    config->q);
+    audio_chain_add_parametric(&mf->chain, &mf->peq);
     break;
   default:
-    fprintf(stderr, "Error: Unknown filter type\n");
-    success = 0;
     break;
   }
+}
+
+// Open every input, attach its filter and add it to the mixer
+// Returns the bit depth of the first input, or 0 on error
+int open_mix_inputs(const Config *config, const char **paths,
+                    const double *gains, int count, AudioReader **readers,
+                    MixInputFilter *filters, AudioMixer *mixer) {
+  int bit_depth = 0;
+  for (int i = 0; i < count; i++) {
+    AudioError error;
+    printf("Opening mix input: %s (%+.1f dB)\n", paths[i], gains[i]);
+    readers[i] = audio_reader_open(paths[i], &error);
+    if (readers[i] == NULL) {
+      fprintf(stderr, "Error reading input file: %s\n",
+              audio_error_string(error));
+      return 0;
+    }
+
+    const AudioFileInfo *info = audio_reader_info(readers[i]);
+    printf("  %d Hz, %d channels, %d bits, %zu frames\n", info->sample_rate,
+           info->channels, info->bit_depth, info->frames);
+    if (i == 0) {
+      bit_depth = info->bit_depth;
+    }
+
+    AudioChain *chain = NULL;
+    if (config->filter != FILTER_NONE) {
+      double nyquist = info->sample_rate / 2.0;
+      if (config->frequency >= nyquist) {
+        fprintf(stderr,
+                "Error: Frequency %.1f Hz exceeds Nyquist limit (%.1f Hz)\n",
+                config->frequency, nyquist);
+        return 0;
+      }
+      mix_filter_init(&filters[i], config, info->sample_rate);
+      chain = &filters[i].chain;
+    }
+
+    error = audio_mixer_add_input(mixer, readers[i], gains[i], chain);
+    if (error != AUDIO_SUCCESS) {
+      fprintf(stderr, "Error: Cannot mix %s: %s\n", paths[i],
+              error == AUDIO_ERROR_UNSUPPORTED_FORMAT
+                  ? "sample rate or channel count differs from first input"
+                  : audio_error_string(error));
+      return 0;
+    }
+  }
+  return bit_depth;
+}
+
+// Run the mixer into the output file
+int write_mix(const Config *config, AudioMixer *mixer, int bit_depth) {
+  AudioError error;
+  printf("Writing output file: %s\n", config->output_path);
+  AudioWriter *writer =
+      audio_writer_open(config->output_path, mixer->sample_rate,
+                        mixer->channels, bit_depth, &error);
+  if (writer != NULL) {
+    error = audio_mixer_run(mixer, writer);
+    AudioError close_error = audio_writer_close(writer);
+    if (error == AUDIO_SUCCESS) {
+      error = close_error;
+    }
+  }
+
+  if (error != AUDIO_SUCCESS) {
+    fprintf(stderr, "Error %s: %s\n",
+            mixer->error != AUDIO_SUCCESS ? "mixing inputs"
+                                          : "writing output file",
+            audio_error_string(error));
+    return 0;
+  }
+  return 1;
+}
+
+// Stream every input through its own filter and sum them into one output,
+// reading each file once, block by block
+int process_mix(const Config *config) {
+  const char *paths[AUDIO_MIX_MAX_INPUTS + 1];
+  double gains[AUDIO_MIX_MAX_INPUTS + 1];
+  int count = 0;
+  if (config->input_path != NULL) {
+    paths[count] = config->input_path;
+    gains[count++] = 0.0;
+  }
+  for (int i = 0; i < config->num_mix; i++) {
+    paths[count] = config->mix_paths[i];
+    gains[count++] = config->mix_gains[i];
+  }
+
+  AudioReader *readers[AUDIO_MIX_MAX_INPUTS + 1] = {0};
+  MixInputFilter *filters = calloc(count, sizeof(MixInputFilter));
+  if (filters == NULL) {
+    fprintf(stderr, "Error: %s\n",
+            audio_error_string(AUDIO_ERROR_MEMORY_ERROR));
+    return 1;
+  }
+
+  AudioMixer mixer;
+  audio_mixer_init(&mixer, 0);
+  int bit_depth = open_mix_inputs(config, paths, gains, count, readers,
+                                  filters, &mixer);
+  int success = bit_depth > 0 && write_mix(config, &mixer, bit_depth);
+
+  audio_mixer_free(&mixer);
+  for (int i = 0; i < count; i++) {
+    audio_reader_close(readers[i]);
+  }
+  free(filters);
 
+  if (!success) {
+    return 1;
+  }
+
+  printf("  ✓ Mixed %d inputs\n", count);
+  printf("\n✓ Processing complete!\n");
+  return 0;
+}
+
+// Stream the input through decode, per-channel-pair filter and encode
+// threads, so each stage overlaps the others
+int process_pipeline(const Config *config) {
+  AudioError error;
+  printf("Reading input file: %s\n", config->input_path);
+  AudioReader *reader = audio_reader_open(config->input_path, &error);
+  if (reader == NULL) {
+    fprintf(stderr, "Error reading input file: %s\n",
+            audio_error_string(error));
+    return 1;
+  }
+
+  const AudioFileInfo *info = audio_reader_info(reader);
+  printf("  %d Hz, %d channels, %d bits, %zu frames\n", info->sample_rate,
+         info->channels, info->bit_depth, info->frames);
+
+  // The stereo filters keep state for one channel pair, so each pair
+  // gets its own filter and thread
+  int num_groups = (info->channels + 1) / 2;
+  double nyquist = info->sample_rate / 2.0;
+  if (num_groups > AUDIO_PIPELINE_MAX_GROUPS) {
+    fprintf(stderr, "Error: --pipeline supports at most %d channels\n",
+            2 * AUDIO_PIPELINE_MAX_GROUPS);
+    audio_reader_close(reader);
+    return 1;
+  }
+  if (config->frequency >= nyquist) {
+    fprintf(stderr,
+            "Error: Frequency %.1f Hz exceeds Nyquist limit (%.1f Hz)\n",
+            config->frequency, nyquist);
+    audio_reader_close(reader);
+    return 1;
+  }
+
+  MixInputFilter *filters = calloc(num_groups, sizeof(MixInputFilter));
+  AudioPipelineGroup groups[AUDIO_PIPELINE_MAX_GROUPS];
+  if (filters == NULL) {
+    fprintf(stderr, "Error: %s\n",
+            audio_error_string(AUDIO_ERROR_MEMORY_ERROR));
+    audio_reader_close(reader);
+    return 1;
+  }
+  for (int g = 0; g < num_groups; g++) {
+    mix_filter_init(&filters[g], config, info->sample_rate);
+    groups[g].first_channel = 2 * g;
+    groups[g].channels = 2 * g + 1 < info->channels ? 2 : 1;
+    groups[g].chain = &filters[g].chain;
+  }
+
+  printf("Writing output file: %s\n", config->output_path);
+  AudioPipelineStats stats;
+  AudioWriter *writer =
+      audio_writer_open(config->output_path, info->sample_rate,
+                        info->channels, info->bit_depth, &error);
+  if (writer != NULL) {
+    audio_writer_reserve(writer, info->frames);
+    error = audio_pipeline_run(reader, writer, groups, num_groups, 0, 0,
+                               &stats);
+    AudioError close_error = audio_writer_close(writer);
+    if (error == AUDIO_SUCCESS) {
+      error = close_error;
+    }
+  }
+  int input_failed = audio_reader_status(reader) != AUDIO_SUCCESS;
+  audio_reader_close(reader);
+  free(filters);
+
+  if (error != AUDIO_SUCCESS) {
+    fprintf(stderr, "Error %s: %s\n",
+            input_failed ? "reading input file" : "writing output file",
+            audio_error_string(error));
+    return 1;
+  }
+
+  double slowest = stats.filter_seconds[0];
+  for (int g = 1; g < num_groups; g++) {
+    if (stats.filter_seconds[g] > slowest) {
+      slowest = stats.filter_seconds[g];
+    }
+  }
+  printf("  Stages (busy): decode %.3f s, filter %.3f s (slowest of %d), "
+         "encode %.3f s; wall %.3f s\n",
+         stats.decode_seconds, slowest, num_groups, stats.encode_seconds,
+         stats.wall_seconds);
+  printf("  ✓ Streamed %zu frames\n", stats.frames);
+  printf("\n✓ Processing complete!\n");
+  return 0;
+}
+
+// Number of frames needed to settle the configured filter
+size_t filter_warmup_frames(const Config *config, int sample_rate) {
+  switch (config->filter) {
+  case FILTER_HPF:
+    return hpf_warmup_frames(sample_rate, config->frequency);
+  case FILTER_LPF:
+    return lpf_warmup_frames(sample_rate, config->frequency);
+  case FILTER_PEQ:
+    return parametric_warmup_frames(sample_rate, config->frequency,
+                                    config->gain, config->q);
+  default:
+    return 0;
+  }
+}
+
+// Read only the requested region, preceded by a warm-up window that primes
+// the filter state so the region matches a full-file render
+AudioBuffer *read_region(const Config *config, size_t *warmup,
+                         AudioError *error) {
+  AudioFileInfo info;
+  *error = read_wave_info(config->input_path, &info);
+  if (*error != AUDIO_SUCCESS) {
+    return NULL;
+  }
+
+  size_t start = (size_t)(config->start * info.sample_rate);
+  size_t frames = info.frames;
+  if (config->duration > 0.0) {
+    frames = (size_t)(config->duration * info.sample_rate);
+  }
+  if (start > info.frames) {
+    start = info.frames;
+  }
+
+  // Warm-up is bounded by the file start; an unstable design settles from 0
+  *warmup = filter_warmup_frames(config, info.sample_rate);
+  if (*warmup > start) {
+    *warmup = start;
+  }
+
+  printf("  Region: frames %zu-%zu of %zu (warm-up: %zu frames)\n", start,
+         start + frames, info.frames, *warmup);
+
+  return read_wave_region(config->input_path, start - *warmup,
+                          frames + *warmup, error);
+}
+
+// Drop leading frames from a buffer in place
+void trim_leading_frames(AudioBuffer *buffer, size_t frames) {
+  size_t samples = frames * buffer->channels;
+  if (samples == 0) {
+    return;
+  }
+  if (samples > buffer->length) {
+    samples = buffer->length;
+  }
+  memmove(buffer->data, buffer->data + samples,
+          (buffer->length - samples) * sizeof(double));
+  buffer->length -= samples;
+}
+
+// Filter designed before forking for a sample rate, if any
+const FilterTemplate *find_template(const Config *config, int sample_rate) {
+  for (int i = 0; i < config->num_templates; i++) {
+    if (config->templates[i].sample_rate == sample_rate) {
+      return &config->templates[i];
+    }
+  }
+  return NULL;
+}
+
+// Run the configured filter, gate and limiter over a buffer
+// The gate and limiter are stages of the filter's tiled pass (the limiter
+// last, latency compensated), so the buffer is traversed once
+int apply_processing(const Config *config, AudioBuffer *buffer) {
+  const FilterTemplate *shared = find_template(config, buffer->sample_rate);
+  int success = 1;
+
+  AudioChain post;
+  audio_chain_init(&post);
+  NoiseGate gate;
+  if (config->gate && config->filter != FILTER_HPF) {
+    success = init_gate(&gate, buffer, config->gate_db, NULL);
+    if (success) {
+      audio_chain_add(&post, "gate", gate_stage, &gate);
+    }
+  }
+  Limiter lim;
+  int limited = 0;
+  if (success && config->limit) {
+    success = limited = init_limiter(&lim, buffer, config->limit_db);
+    if (limited) {
+      audio_chain_add(&post, "limiter", limiter_buffer_stage, &lim);
+    }
+  }
+
+  if (success) {
+    switch (config->filter) {
+    case FILTER_HPF:
+      success = config->gate
+                    ? apply_hpf_gate(buffer, config->frequency,
+                                     config->gate_db, shared, &post)
+                    : apply_hpf(buffer, config->frequency, shared, &post);
+      break;
+    case FILTER_LPF:
+      success = apply_lpf(buffer, config->frequency, shared, &post);
+      break;
+    case FILTER_PEQ:
+      success = apply_peq(buffer, config->frequency, config->gain, config->q,
+                          shared, &post);
+      break;
+    default:
+      fprintf(stderr, "Error: Unknown filter type\n");
+      success = 0;
+      break;
+    }
+  }
+
+  if (success && config->gate && config->filter != FILTER_HPF) {
+    printf("  ✓ Gate applied successfully\n");
+  }
+  if (limited) {
+    if (success) {
+      limiter_finish_buffer(&lim, buffer);
+      printf("  ✓ Limiter applied successfully\n");
+    }
+    limiter_free(&lim);
+  }
+
+  return success;
+}
+
+// Process one manifest job into the temp file the batch runner commits
+AudioError batch_job(void *user, const BatchJob *job, const char *temp_path) {
+  const Config *config = (const Config *)user;
+  AudioError error;
+
+  printf("\nBatch job: %s -> %s\n", job->input, job->output);
+  AudioBuffer *buffer = read_wave(job->input, &error);
+  if (buffer == NULL) {
+    fprintf(stderr, "Error reading %s: %s\n", job->input,
+            audio_error_string(error));
+    return error;
+  }
+
+  // The temp path hides the extension, so pick the format from the output
+  if (!apply_processing(config, buffer)) {
+    error = AUDIO_ERROR_INVALID_PARAMETER;
+  } else if (audio_path_is_flac(job->output)) {
+    error = write_flac(temp_path, buffer);
+  } else {
+    error = write_wave(temp_path, buffer);
+  }
+  audio_buffer_free(buffer);
+  return error;
+}
+
+// Design the filter for every common sample rate into a sealed shared
+// arena before forking. Each design is run once on a copy, so any JIT
+// kernels behind it are compiled here instead of in every worker (which
+// copy a design and take JIT handles of their own).
+int share_filter_templates(Config *config, AudioSharedArena *arena) {
+  size_t size = NUM_TEMPLATE_RATES * sizeof(FilterTemplate);
+  if (audio_shared_arena_create(arena, "audio-util-filters", size) !=
+      AUDIO_SUCCESS) {
+    return 0;
+  }
+  FilterTemplate *templates = audio_shared_arena_alloc(arena, size);
+
+  int count = 0;
+  for (int i = 0; i < NUM_TEMPLATE_RATES; i++) {
+    int rate = template_rates[i];
+    if (config->frequency >= rate / 2.0) {
+      continue;
+    }
+
+    FilterTemplate *shared = &templates[count++];
+    shared->sample_rate = rate;
+    AudioBuffer *warmup = audio_buffer_create(2 * 256, rate, 2, 24);
+    if (warmup == NULL) {
+      audio_shared_arena_destroy(arena);
+      return 0;
+    }
+    // Silence: uninitialized samples could be NaNs or denormals
+    memset(warmup->data, 0, warmup->length * sizeof(double));
+    switch (config->filter) {
+    case FILTER_HPF: {
+      hpf_init(&shared->hpf, rate, config->frequency);
+      HPFFilter copy = shared->hpf;
+      hpf_process_buffer(&copy, warmup);
+      break;
+    }
+    case FILTER_LPF: {
+      lpf_init(&shared->lpf, rate, config->frequency);
+      LPFFilter copy = shared->lpf;
+      lpf_process_buffer(&copy, warmup);
+      break;
+    }
+    case FILTER_PEQ: {
+      parametric_init(&shared->peq, rate, config->frequency, config->gain,
+                      config->q);
+      ParametricFilter copy = shared->peq;
+      parametric_process_buffer(&copy, warmup);
+      break;
+    }
+    default:
+      break;
+    }
+    audio_buffer_free(warmup);
+  }
+
+  if (audio_shared_arena_seal(arena) != AUDIO_SUCCESS) {
+    audio_shared_arena_destroy(arena);
+    return 0;
+  }
+  config->templates = templates;
+  config->num_templates = count;
+  return 1;
+}
+
+// State shared by the processes of a pre-forked batch
+typedef struct {
+  const Config *config;
+  const BatchManifest *manifest;
+  const BatchOptions *options;
+  BatchStats *stats;             // One slot per process (shared, writable)
+} BatchProcesses;
+
+int batch_process_main(void *user, int worker) {
+  BatchProcesses *batch = (BatchProcesses *)user;
+  AudioError error = batch_run(batch->manifest, batch->options, batch_job,
+                               (void *)batch->config, &batch->stats[worker]);
+  if (error != AUDIO_SUCCESS) {
+    fprintf(stderr, "Error: Cannot use the lease directory: %s\n",
+            audio_error_string(error));
+    return 1;
+  }
+  return 0;
+}
+
+// Fork the batch workers after preparing what they share
+int run_batch_processes(const Config *config, const BatchManifest *manifest,
+                        const BatchOptions *options, BatchStats *stats) {
+  Config shared = *config;
+  AudioSharedArena filters, results;
+  if (!share_filter_templates(&shared, &filters)) {
+    fprintf(stderr, "Error: Cannot map shared memory\n");
+    return 0;
+  }
+  if (audio_shared_arena_create(&results, "audio-util-stats",
+                                config->processes * sizeof(BatchStats)) !=
+      AUDIO_SUCCESS) {
+    fprintf(stderr, "Error: Cannot map shared memory\n");
+    audio_shared_arena_destroy(&filters);
+    return 0;
+  }
+  printf("  Processes: %d (filter designed for %d sample rates)\n",
+         config->processes, shared.num_templates);
+
+  BatchProcesses batch = {&shared, manifest, options,
+                          audio_shared_arena_alloc(
+                              &results, config->processes * sizeof(BatchStats))};
+  int failed = 0;
+  AudioError error = audio_prefork_run(config->processes, batch_process_main,
+                                       &batch, &failed);
+
+  // Every process counts the jobs finished when it started; the earliest
+  // count is the one that excludes this run's own work
+  memset(stats, 0, sizeof(BatchStats));
+  stats->skipped = batch.stats[0].skipped;
+  for (int w = 0; w < config->processes; w++) {
+    stats->completed += batch.stats[w].completed;
+    stats->failed += batch.stats[w].failed;
+    if (batch.stats[w].skipped < stats->skipped) {
+      stats->skipped = batch.stats[w].skipped;
+    }
+  }
+  audio_shared_arena_destroy(&results);
+  audio_shared_arena_destroy(&filters);
+
+  if (error != AUDIO_SUCCESS || failed > 0) {
+    fprintf(stderr, "Error: %d of %d worker processes failed\n",
+            error != AUDIO_SUCCESS ? config->processes : failed,
+            config->processes);
+    return 0;
+  }
+  return 1;
+}
+
+// Work through a shared manifest alongside any other workers
+int process_batch(const Config *config) {
+  BatchManifest manifest;
+  AudioError error = batch_manifest_load(config->batch_path, &manifest);
+  if (error != AUDIO_SUCCESS) {
+    if (error == AUDIO_ERROR_INVALID_FORMAT) {
+      fprintf(stderr, "Error: %s:%zu: expected \"input<TAB>output\"\n",
+              config->batch_path, manifest.error_line);
+    } else {
+      fprintf(stderr, "Error reading manifest %s: %s\n", config->batch_path,
+              audio_error_string(error));
+    }
+    return 1;
+  }
+
+  printf("Batch manifest: %s (%zu jobs)\n", config->batch_path,
+         manifest.num_jobs);
+  printf("  Leases: %s\n", manifest.lease_dir);
+
+  BatchOptions options;
+  batch_options_default(&options);
+  options.threads = config->threads;
+  if (config->threads > 1) {
+    printf("  Threads: %d over %d NUMA node(s)\n", config->threads,
+           audio_numa_topology()->num_nodes);
+  }
+
+  // Parallel workers recycle each other's already-faulted buffers, per
+  // NUMA node; forked workers inherit the setting (each with its own pool)
+  size_t pool_bytes = 0;
+  if (config->threads > 1 || config->processes > 1) {
+    pool_bytes = (size_t)config->threads * BATCH_POOL_BYTES_PER_THREAD;
+    audio_pool_enable(pool_bytes);
+    printf("  Buffer pool: %zu MiB per process\n", pool_bytes >> 20);
+  }
+
+  BatchStats stats;
+  if (config->processes > 1) {
+    int success = run_batch_processes(config, &manifest, &options, &stats);
+    batch_manifest_free(&manifest);
+    if (!success) {
+      return 1;
+    }
+    error = AUDIO_SUCCESS;
+  } else {
+    error = batch_run(&manifest, &options, batch_job, (void *)config, &stats);
+    batch_manifest_free(&manifest);
+  }
+  if (error != AUDIO_SUCCESS) {
+    fprintf(stderr, "Error: Cannot use the lease directory: %s\n",
+            audio_error_string(error));
+    return 1;
+  }
+
+  printf("\nBatch finished: %zu completed, %zu failed here, %zu already "
+         "finished\n",
+         stats.completed, stats.failed, stats.skipped);
+  if (pool_bytes > 0 && config->processes == 1) {
+    AudioAllocStats pool;
+    audio_alloc_stats(&pool);
+    printf("  Buffer pool: %zu allocations reused, %zu fresh\n",
+           pool.pool_hits, pool.pool_misses);
+  }
+  audio_pool_disable();
+  return stats.failed > 0 ? 1 : 0;
+}
+
+// Analyze the written output into a spectrogram file
+int write_spectrogram(const Config *config) {
+  StftConfig stft;
+  stft_config_default(&stft);
+
+  printf("Writing spectrogram: %s\n", config->spectrogram_path);
+  AudioError error = stft_analyze_file(config->output_path,
+                                       config->spectrogram_path, &stft,
+                                       STFT_ENCODING_FLOAT32);
+  if (error != AUDIO_SUCCESS) {
+    fprintf(stderr, "Error writing spectrogram: %s\n",
+            audio_error_string(error));
+    return 1;
+  }
+
+  printf("  ✓ Spectrogram written (%zu-point FFT, hop %zu)\n", stft.fft_size,
+         stft.hop);
+  return 0;
+}
+
+// Filter a single input file
+int process_single(const Config *config) {
+  AudioError error;
+
+  // Read input file
+  printf("Reading input file: %s\n", config->input_path);
+  size_t warmup = 0;
+  AudioBuffer *buffer = config->region
+                            ? read_region(config, &warmup, &error)
+                            : read_wave(config->input_path, &error);
+
+  if (buffer == NULL) {
+    fprintf(stderr, "Error reading input file: %s\n",
+            audio_error_string(error));
+    return 1;
+  }
+
+  printf("  Sample rate: %d Hz\n", buffer->sample_rate);
+  printf("  Channels: %d\n", buffer->channels);
+  printf("  Bit depth: %d bits\n", buffer->bit_depth);
+  printf("  Duration: %.2f seconds\n",
+         (double)buffer->length / buffer->channels / buffer->sample_rate);
+  printf("  Samples: %zu\n", buffer->length);
+
+  int success = apply_processing(config, buffer);
   if (!success) {
     audio_buffer_free(buffer);
     return 1;
   }
 
+  // Discard the warm-up window now that it has primed the filter
+  trim_leading_frames(buffer, warmup);
+
   // Write output file
   printf("Writing output file: %s\n", config->output_path);
   error = write_wave(config->output_path, buffer);
@@ -271,13 +1403,51 @@ int process_audio(const Config *config) {
   return 0;
 }
 
+// Main processing function
+int process_audio(const Config *config) {
+  int status;
+  if (config->batch_path != NULL) {
+    status = process_batch(config);
+  } else if (config->fixed) {
+    status = process_fixed(config);
+  } else if (config->num_mix > 0) {
+    status = process_mix(config);
+  } else if (config->pipeline) {
+    status = process_pipeline(config);
+  } else {
+    status = process_single(config);
+  }
+
+  if (status == 0 && config->spectrogram_path != NULL) {
+    status = write_spectrogram(config);
+  }
+  return status;
+}
+
 int main(int argc, char *argv[]) {
   Config config = {.input_path = NULL,
                    .output_path = NULL,
                    .filter = FILTER_NONE,
                    .frequency = 0.0,
                    .gain = 0.0,
-                   .q = 1.0};
+                   .q = 1.0,
+                   .region = 0,
+                   .start = 0.0,
+                   .duration = 0.0,
+                   .fixed = 0,
+                   .num_mix = 0,
+                   .limit = 0,
+                   .limit_db = 0.0,
+                   .gate = 0,
+                   .gate_db = 0.0,
+                   .spectrogram_path = NULL,
+                   .batch_path = NULL,
+                   .threads = 1,
+                   .pipeline = 0,
+                   .processes = 1,
+                   .large_io = 0,
+                   .templates = NULL,
+                   .num_templates = 0};
 
   // Define long options
   static struct option long_options[] = {{"input", required_argument, 0, 'i'},
@@ -286,6 +1456,22 @@ int main(int argc, char *argv[]) {
                                          {"freq", required_argument, 0, 'r'},
                                          {"gain", required_argument, 0, 'g'},
                                          {"q", required_argument, 0, 'q'},
+                                         {"start", required_argument, 0, 's'},
+                                         {"duration", required_argument, 0,
+                                          'd'},
+                                         {"fixed", no_argument, 0, 'x'},
+                                         {"mix", required_argument, 0, 'm'},
+                                         {"limit", required_argument, 0, 'l'},
+                                         {"gate", required_argument, 0, 't'},
+                                         {"spectrogram", required_argument, 0,
+                                          'p'},
+                                         {"batch", required_argument, 0, 'b'},
+                                         {"threads", required_argument, 0,
+                                          'j'},
+                                         {"pipeline", no_argument, 0, 'e'},
+                                         {"processes", required_argument, 0,
+                                          'k'},
+                                         {"large-io", no_argument, 0, 'L'},
                                          {"help", no_argument, 0, 'h'},
                                          {"version", no_argument, 0, 'v'},
                                          {0, 0, 0, 0}};
@@ -294,7 +1480,7 @@ int main(int argc, char *argv[]) {
   int opt;
   int option_index = 0;
 
-  while ((opt = getopt_long(argc, argv, "i:o:f:r:g:q:hv", long_options,
+  while ((opt = getopt_long(argc, argv, "i:o:f:r:g:q:s:d:xm:l:t:p:b:j:ek:Lhv", long_options,
                             &option_index)) != -1) {
     switch (opt) {
     case 'i':
@@ -320,6 +1506,48 @@ int main(int argc, char *argv[]) {
     case 'q':
       config.q = atof(optarg);
       break;
+    case 's':
+      config.start = atof(optarg);
+      config.region = 1;
+      break;
+    case 'd':
+      config.duration = atof(optarg);
+      config.region = 1;
+      break;
+    case 'x':
+      config.fixed = 1;
+      break;
+    case 'm':
+      if (!parse_mix_spec(optarg, &config)) {
+        return 1;
+      }
+      break;
+    case 'l':
+      config.limit_db = atof(optarg);
+      config.limit = 1;
+      break;
+    case 't':
+      config.gate_db = atof(optarg);
+      config.gate = 1;
+      break;
+    case 'p':
+      config.spectrogram_path = optarg;
+      break;
+    case 'b':
+      config.batch_path = optarg;
+      break;
+    case 'j':
+      config.threads = atoi(optarg);
+      break;
+    case 'e':
+      config.pipeline = 1;
+      break;
+    case 'k':
+      config.processes = atoi(optarg);
+      break;
+    case 'L':
+      config.large_io = 1;
+      break;
     case 'h':
       print_usage(argv[0]);
       return 0;
@@ -349,6 +1577,11 @@ int main(int argc, char *argv[]) {
     return 1;
   }
 
+  // Before any batch workers start
+  if (config.large_io) {
+    audio_io_set_large_files(1);
+  }
+
   // Process audio
   printf("\n=== %s v%s ===\n\n", PROGRAM_NAME, VERSION);
   return process_audio(&config);
@@ -0,0 +1,119 @@
+#include "audio_view.h"
+#include "audio_alloc.h"
+#include <stdlib.h>
+
+// Create reference-counted storage (refcount starts at 1)
+AudioStorage *audio_storage_create(size_t length) {
+  AudioStorage *storage = (AudioStorage *)malloc(sizeof(AudioStorage));
+  if (!storage) {
+    return NULL;
+  }
+
+  storage->data = (double *)audio_alloc(length * sizeof(double));
+  if (!storage->data) {
+    free(storage);
+    return NULL;
+  }
+
+  storage->length = length;
+  storage->refcount = 1;
+  return storage;
+}
+
+// Take an additional reference
+void audio_storage_retain(AudioStorage *storage) {
+  if (storage) {
+    __atomic_fetch_add(&storage->refcount, 1, __ATOMIC_RELAXED);
+  }
+}
+
+// Drop a reference, freeing the storage with the last one
+void audio_storage_release(AudioStorage *storage) {
+  if (!storage) {
+    return;
+  }
+  if (__atomic_sub_fetch(&storage->refcount, 1, __ATOMIC_ACQ_REL) == 0) {
+    audio_free(storage->data);
+    free(storage);
+  }
+}
+
+// View covering a whole buffer
+AudioError audio_view_from_buffer(AudioBuffer *buffer, AudioBufferView *view) {
+  if (!buffer || !buffer->data || !view || buffer->channels < 1) {
+    return AUDIO_ERROR_INVALID_PARAMETER;
+  }
+
+  view->storage = buffer->storage;
+  audio_storage_retain(view->storage);
+  view->data = buffer->data;
+  view->frames = buffer->length / buffer->channels;
+  view->stride = buffer->channels;
+  view->channels = buffer->channels;
+  view->first_channel = 0;
+  view->sample_rate = buffer->sample_rate;
+  return AUDIO_SUCCESS;
+}
+
+// View over borrowed interleaved memory
+void audio_view_wrap(AudioBufferView *view, double *data, size_t frames,
+                     int channels, int sample_rate) {
+  if (!view) {
+    return;
+  }
+
+  view->storage = NULL;
+  view->data = data;
+  view->frames = frames;
+  view->stride = channels;
+  view->channels = channels;
+  view->first_channel = 0;
+  view->sample_rate = sample_rate;
+}
+
+// Frame range sub-view
+AudioError audio_view_slice(const AudioBufferView *src, size_t offset,
+                            size_t frames, AudioBufferView *view) {
+  if (!src || !view) {
+    return AUDIO_ERROR_INVALID_PARAMETER;
+  }
+
+  if (offset > src->frames) {
+    offset = src->frames;
+  }
+  if (frames > src->frames - offset) {
+    frames = src->frames - offset;
+  }
+
+  *view = *src;
+  audio_storage_retain(view->storage);
+  view->data = src->data + offset * src->stride;
+  view->frames = frames;
+  return AUDIO_SUCCESS;
+}
+
+// Channel subset sub-view
+AudioError audio_view_select_channels(const AudioBufferView *src, int first,
+                                      int count, AudioBufferView *view) {
+  if (!src || !view || first < 0 || count < 1 ||
+      first + count > src->channels) {
+    return AUDIO_ERROR_INVALID_PARAMETER;
+  }
+
+  *view = *src;
+  audio_storage_retain(view->storage);
+  view->data = src->data + first;
+  view->channels = count;
+  view->first_channel = src->first_channel + first;
+  return AUDIO_SUCCESS;
+}
+
+// Release a view
+void audio_view_release(AudioBufferView *view) {
+  if (view) {
+    audio_storage_release(view->storage);
+    view->storage = NULL;
+    view->data = NULL;
+    view->frames = 0;
+  }
+}
@@ -0,0 +1,883 @@
+// CPython extension module: filters, chains and WAV I/O
+// Samples cross the boundary through the buffer protocol (NumPy arrays,
+// memoryviews, array.array, Buffer objects) without copying, and processing
+// runs with the GIL released.
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "audio_io.h"
+#include "audio_view.h"
+#include "chain.h"
+#include "hpf.h"
+#include "lpf.h"
+#include "parametric.h"
+#include <stdint.h>
+#include <string.h>
+
+#define MODULE_VERSION "1.0.0"
+
+// Default bit depth for write_wave of plain arrays
+#define DEFAULT_BIT_DEPTH 24
+
+//
+// Errors and buffers
+//
+
+// Raise the Python exception matching an AudioError
+static PyObject *raise_audio_error(AudioError error, const char *path) {
+  PyObject *type;
+  switch (error) {
+  case AUDIO_ERROR_FILE_NOT_FOUND:
+    type = PyExc_FileNotFoundError;
+    break;
+  case AUDIO_ERROR_INVALID_FORMAT:
+  case AUDIO_ERROR_UNSUPPORTED_FORMAT:
+  case AUDIO_ERROR_INVALID_PARAMETER:
+    type = PyExc_ValueError;
+    break;
+  case AUDIO_ERROR_MEMORY_ERROR:
+    return PyErr_NoMemory();
+  default:
+    type = PyExc_OSError;
+    break;
+  }
+  PyErr_Format(type, "%s: %s", path, audio_error_string(error));
+  return NULL;
+}
+
+// Borrow a C-contiguous float64 buffer as interleaved frames
+// 2-D buffers are (frames, channels); 1-D buffers use `channels` (0 = mono).
+// On success the caller must PyBuffer_Release(buf).
+static int acquire_samples(PyObject *obj, int channels, int writable,
+                           Py_buffer *buf, size_t *frames, int *out_channels) {
+  int flags = PyBUF_FORMAT | PyBUF_C_CONTIGUOUS;
+  if (writable)
+    flags |= PyBUF_WRITABLE;
+  if (PyObject_GetBuffer(obj, buf, flags) < 0)
+    return -1;
+
+  const char *format = buf->format ? buf->format : "B";
+  if (buf->itemsize != sizeof(double) ||
+      (strcmp(format, "d") != 0 && strcmp(format, "@d") != 0 &&
+       strcmp(format, "=d") != 0)) {
+    PyErr_Format(PyExc_TypeError, "expected float64 samples, got format '%s'",
+                 format);
+    PyBuffer_Release(buf);
+    return -1;
+  }
+
+  if (buf->ndim > 2) {
+    PyErr_SetString(PyExc_ValueError,
+                    "expected a 1-D or (frames, channels) buffer");
+    PyBuffer_Release(buf);
+    return -1;
+  }
+  if (buf->ndim == 2) {
+    if (channels != 0 && channels != buf->shape[1]) {
+      PyErr_Format(PyExc_ValueError, "channels=%d but the buffer has %zd",
+                   channels, buf->shape[1]);
+      PyBuffer_Release(buf);
+      return -1;
+    }
+    channels = (int)buf->shape[1];
+  }
+  if (channels == 0)
+    channels = 1;
+
+  size_t samples = (size_t)buf->len / sizeof(double);
+  if (channels < 0 || samples % channels != 0) {
+    PyErr_Format(PyExc_ValueError,
+                 "%zu samples do not divide into %d channels", samples,
+                 channels);
+    PyBuffer_Release(buf);
+    return -1;
+  }
+
+  *frames = samples / channels;
+  *out_channels = channels;
+  return 0;
+}
+
+// Mark an object as in use by a call running without the GIL
+// The flag is tested and set while holding the GIL, so it cannot race
+static int claim(int *busy, const char *what) {
+  if (*busy) {
+    PyErr_Format(PyExc_RuntimeError, "%s is in use by another thread", what);
+    return -1;
+  }
+  *busy = 1;
+  return 0;
+}
+
+//
+// Filters (HPF, LPF, PEQ share one object layout)
+//
+
+typedef enum { KIND_HPF, KIND_LPF, KIND_PEQ } FilterKind;
+
+typedef struct {
+  PyObject_HEAD
+  FilterKind kind;
+  double sample_rate;
+  int busy;
+  union {
+    HPFFilter hpf;
+    LPFFilter lpf;
+    ParametricFilter peq;
+  } f;
+} FilterObject;
+
+static PyTypeObject HPFType;
+static PyTypeObject LPFType;
+static PyTypeObject PEQType;
+
+static int is_filter(PyObject *obj) {
+  return PyObject_TypeCheck(obj, &HPFType) ||
+         PyObject_TypeCheck(obj, &LPFType) ||
+         PyObject_TypeCheck(obj, &PEQType);
+}
+
+static int check_design(double sample_rate, double frequency) {
+  if (sample_rate <= 0.0 || frequency <= 0.0 ||
+      frequency >= sample_rate / 2.0) {
+    PyErr_SetString(PyExc_ValueError,
+                    "need sample_rate > 0 and 0 < frequency < sample_rate / 2");
+    return -1;
+  }
+  return 0;
+}
+
+// Free the JIT handles of the current filter (no-op without USE_MLIR)
+// Safe on a never-initialized object: tp_new zeroes the union
+static void filter_release(FilterObject *self) {
+#ifdef USE_MLIR
+  MLIRBiQuadJIT **left = NULL, **right = NULL;
+  switch (self->kind) {
+  case KIND_HPF:
+    left = &self->f.hpf.left_jit;
+    right = &self->f.hpf.right_jit;
+    break;
+  case KIND_LPF:
+    left = &self->f.lpf.left_jit;
+    right = &self->f.lpf.right_jit;
+    break;
+  case KIND_PEQ:
+    left = &self->f.peq.left_jit;
+    right = &self->f.peq.right_jit;
+    break;
+  }
+  mlir_biquad_jit_destroy(*left);
+  mlir_biquad_jit_destroy(*right);
+  *left = NULL;
+  *right = NULL;
+#else
+  (void)self;
+#endif
+}
+
+static void filter_dealloc(FilterObject *self) {
+  filter_release(self);
+  Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static int hpf_object_init(FilterObject *self, PyObject *args,
+                           PyObject *kwds) {
+  static char *kwlist[] = {"sample_rate", "frequency", NULL};
+  double sample_rate, frequency;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "dd:HPF", kwlist, &sample_rate,
+                                   &frequency) ||
+      check_design(sample_rate, frequency) < 0)
+    return -1;
+
+  if (claim(&self->busy, "filter") < 0)
+    return -1;
+  filter_release(self);
+
+  self->kind = KIND_HPF;
+  self->sample_rate = sample_rate;
+  hpf_init(&self->f.hpf, sample_rate, frequency);
+  self->busy = 0;
+  return 0;
+}
+
+static int lpf_object_init(FilterObject *self, PyObject *args,
+                           PyObject *kwds) {
+  static char *kwlist[] = {"sample_rate", "frequency", NULL};
+  double sample_rate, frequency;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "dd:LPF", kwlist, &sample_rate,
+                                   &frequency) ||
+      check_design(sample_rate, frequency) < 0)
+    return -1;
+
+  if (claim(&self->busy, "filter") < 0)
+    return -1;
+  filter_release(self);
+
+  self->kind = KIND_LPF;
+  self->sample_rate = sample_rate;
+  lpf_init(&self->f.lpf, sample_rate, frequency);
+  self->busy = 0;
+  return 0;
+}
+
+static int peq_object_init(FilterObject *self, PyObject *args,
+                           PyObject *kwds) {
+  static char *kwlist[] = {"sample_rate", "frequency", "gain", "q", NULL};
+  double sample_rate, frequency, gain = 0.0, q = 1.0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "dd|dd:PEQ", kwlist,
+                                   &sample_rate, &frequency, &gain, &q) ||
+      check_design(sample_rate, frequency) < 0)
+    return -1;
+  if (q <= 0.0) {
+    PyErr_SetString(PyExc_ValueError, "q must be positive");
+    return -1;
+  }
+
+  if (claim(&self->busy, "filter") < 0)
+    return -1;
+  filter_release(self);
+
+  self->kind = KIND_PEQ;
+  self->sample_rate = sample_rate;
+  parametric_init(&self->f.peq, sample_rate, frequency, gain, q);
+  self->busy = 0;
+  return 0;
+}
+
+// Filter state of one source channel
+static BiQuad *filter_channel(FilterObject *self, int channel) {
+  switch (self->kind) {
+  case KIND_HPF:
+    return hpf_channel_filter(&self->f.hpf, channel);
+  case KIND_LPF:
+    return lpf_channel_filter(&self->f.lpf, channel);
+  case KIND_PEQ:
+    return parametric_channel_filter(&self->f.peq, channel);
+  }
+  return NULL;
+}
+
+static void filter_run(FilterObject *self, const AudioBufferView *view) {
+  switch (self->kind) {
+  case KIND_HPF:
+    hpf_process_view(&self->f.hpf, view);
+    break;
+  case KIND_LPF:
+    lpf_process_view(&self->f.lpf, view);
+    break;
+  case KIND_PEQ:
+    parametric_process_view(&self->f.peq, view);
+    break;
+  }
+}
+
+PyDoc_STRVAR(filter_process_doc,
+             "process(data, channels=0) -> data\n\n"
+             "Filter float64 samples in place and return `data`. A 2-D buffer "
+             "is\n(frames, channels); a 1-D buffer is interleaved with "
+             "`channels`\n(default mono). State carries over between calls.");
+
+static PyObject *filter_process(FilterObject *self, PyObject *args,
+                                PyObject *kwds) {
+  static char *kwlist[] = {"data", "channels", NULL};
+  PyObject *data;
+  int channels = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|i:process", kwlist, &data,
+                                   &channels))
+    return NULL;
+
+  Py_buffer buf;
+  size_t frames;
+  if (acquire_samples(data, channels, 1, &buf, &frames, &channels) < 0)
+    return NULL;
+  if (claim(&self->busy, "filter") < 0) {
+    PyBuffer_Release(&buf);
+    return NULL;
+  }
+
+  AudioBufferView view;
+  audio_view_wrap(&view, (double *)buf.buf, frames, channels,
+                  (int)self->sample_rate);
+  Py_BEGIN_ALLOW_THREADS
+  filter_run(self, &view);
+  Py_END_ALLOW_THREADS
+
+  self->busy = 0;
+  PyBuffer_Release(&buf);
+  Py_INCREF(data);
+  return data;
+}
+
+PyDoc_STRVAR(filter_reset_doc, "reset()\n\nClear the filter state.");
+
+static PyObject *filter_reset(FilterObject *self, PyObject *Py_UNUSED(arg)) {
+  if (claim(&self->busy, "filter") < 0)
+    return NULL;
+
+  for (int c = 0; c < BIQUAD_MAX_CHANNELS; c++) {
+    biquad_flush_delays(filter_channel(self, c));
+  }
+
+  self->busy = 0;
+  Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(filter_retune_doc,
+             "retune(frequency, gain=None, q=None)\n\n"
+             "Move the filter without resetting its state (no click). gain "
+             "and q\napply to PEQ only.");
+
+static PyObject *filter_retune(FilterObject *self, PyObject *args,
+                               PyObject *kwds) {
+  static char *kwlist[] = {"frequency", "gain", "q", NULL};
+  double frequency;
+  double gain = self->kind == KIND_PEQ ? self->f.peq.gain : 0.0;
+  double q = self->kind == KIND_PEQ ? self->f.peq.q : 1.0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "d|dd:retune", kwlist,
+                                   &frequency, &gain, &q) ||
+      check_design(self->sample_rate, frequency) < 0)
+    return NULL;
+  if (q <= 0.0) {
+    PyErr_SetString(PyExc_ValueError, "q must be positive");
+    return NULL;
+  }
+  if (claim(&self->busy, "filter") < 0)
+    return NULL;
+
+  switch (self->kind) {
+  case KIND_HPF:
+    hpf_retune(&self->f.hpf, self->sample_rate, frequency);
+    break;
+  case KIND_LPF:
+    lpf_retune(&self->f.lpf, self->sample_rate, frequency);
+    break;
+  case KIND_PEQ:
+    parametric_retune(&self->f.peq, self->sample_rate, frequency, gain, q);
+    break;
+  }
+
+  self->busy = 0;
+  Py_RETURN_NONE;
+}
+
+static PyObject *filter_get_frequency(FilterObject *self,
+                                      void *Py_UNUSED(closure)) {
+  switch (self->kind) {
+  case KIND_HPF:
+    return PyFloat_FromDouble(self->f.hpf.frequency);
+  case KIND_LPF:
+    return PyFloat_FromDouble(self->f.lpf.frequency);
+  case KIND_PEQ:
+    return PyFloat_FromDouble(self->f.peq.frequency);
+  }
+  Py_RETURN_NONE;
+}
+
+static PyObject *filter_get_sample_rate(FilterObject *self,
+                                        void *Py_UNUSED(closure)) {
+  return PyFloat_FromDouble(self->sample_rate);
+}
+
+static PyMethodDef filter_methods[] = {
+    {"process", (PyCFunction)(void (*)(void))filter_process,
+     METH_VARARGS | METH_KEYWORDS, filter_process_doc},
+    {"reset", (PyCFunction)filter_reset, METH_NOARGS, filter_reset_doc},
+    {"retune", (PyCFunction)(void (*)(void))filter_retune,
+     METH_VARARGS | METH_KEYWORDS, filter_retune_doc},
+    {NULL, NULL, 0, NULL}};
+
+static PyGetSetDef filter_getset[] = {
+    {"frequency", (getter)filter_get_frequency, NULL, "Frequency in Hz",
+     NULL},
+    {"sample_rate", (getter)filter_get_sample_rate, NULL,
+     "Sample rate in Hz", NULL},
+    {NULL, NULL, NULL, NULL, NULL}};
+
+#define FILTER_TYPE(NAME, INIT, DOC)                                          \
+  {                                                                           \
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "audiofilter." NAME,             \
+    .tp_basicsize = sizeof(FilterObject),                                     \
+    .tp_flags = Py_TPFLAGS_DEFAULT, .tp_doc = PyDoc_STR(DOC),                 \
+    .tp_methods = filter_methods, .tp_getset = filter_getset,                 \
+    .tp_init = (initproc)INIT, .tp_new = PyType_GenericNew,                   \
+    .tp_dealloc = (destructor)filter_dealloc,                                 \
+  }
+
+static PyTypeObject HPFType =
+    FILTER_TYPE("HPF", hpf_object_init,
+                "HPF(sample_rate, frequency)\n\n"
+                "Butterworth 2nd-order high-pass filter.");
+static PyTypeObject LPFType =
+    FILTER_TYPE("LPF", lpf_object_init,
+                "LPF(sample_rate, frequency)\n\n"
+                "Butterworth 2nd-order low-pass filter.");
+static PyTypeObject PEQType =
+    FILTER_TYPE("PEQ", peq_object_init,
+                "PEQ(sample_rate, frequency, gain=0.0, q=1.0)\n\n"
+                "Constant-Q parametric EQ (gain in dB).");
+
+//
+// Chain
+//
+
+typedef struct {
+  PyObject_HEAD
+  AudioChain chain;
+  PyObject *stages;      // Filters referenced by the chain (kept alive)
+  int busy;
+} ChainObject;
+
+static int chain_object_init(ChainObject *self, PyObject *args,
+                             PyObject *kwds) {
+  static char *kwlist[] = {"tile_frames", NULL};
+  Py_ssize_t tile_frames = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "|n:Chain", kwlist,
+                                   &tile_frames))
+    return -1;
+  if (tile_frames < 0) {
+    PyErr_SetString(PyExc_ValueError, "tile_frames must not be negative");
+    return -1;
+  }
+
+  PyObject *stages = PyList_New(0);
+  if (!stages)
+    return -1;
+  Py_XSETREF(self->stages, stages);
+
+  audio_chain_init(&self->chain);
+  if (tile_frames > 0)
+    audio_chain_set_tile_frames(&self->chain, (size_t)tile_frames);
+  return 0;
+}
+
+static void chain_dealloc(ChainObject *self) {
+  Py_XDECREF(self->stages);
+  Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+PyDoc_STRVAR(chain_add_doc,
+             "add(filter) -> self\n\n"
+             "Append an HPF, LPF or PEQ stage. The chain keeps a reference, "
+             "and the\nfilter's state is shared with direct process() "
+             "calls.");
+
+static PyObject *chain_add(ChainObject *self, PyObject *stage) {
+  if (!is_filter(stage)) {
+    PyErr_SetString(PyExc_TypeError, "expected an HPF, LPF or PEQ filter");
+    return NULL;
+  }
+  if (self->busy) {
+    PyErr_SetString(PyExc_RuntimeError, "chain is in use by another thread");
+    return NULL;
+  }
+
+  FilterObject *filter = (FilterObject *)stage;
+  int result = -1;
+  switch (filter->kind) {
+  case KIND_HPF:
+    result = audio_chain_add_hpf(&self->chain, &filter->f.hpf);
+    break;
+  case KIND_LPF:
+    result = audio_chain_add_lpf(&self->chain, &filter->f.lpf);
+    break;
+  case KIND_PEQ:
+    result = audio_chain_add_parametric(&self->chain, &filter->f.peq);
+    break;
+  }
+  if (result != 0) {
+    PyErr_Format(PyExc_ValueError, "chain is full (%d stages)",
+                 AUDIO_CHAIN_MAX_STAGES);
+    return NULL;
+  }
+  if (PyList_Append(self->stages, stage) < 0) {
+    self->chain.num_stages--;
+    return NULL;
+  }
+
+  Py_INCREF(self);
+  return (PyObject *)self;
+}
+
+// Whether stage i repeats an earlier stage of the chain
+static int repeated_stage(ChainObject *self, Py_ssize_t i) {
+  PyObject *stage = PyList_GET_ITEM(self->stages, i);
+  for (Py_ssize_t j = 0; j < i; j++) {
+    if (PyList_GET_ITEM(self->stages, j) == stage)
+      return 1;
+  }
+  return 0;
+}
+
+// Claim the chain and every stage, or none of them
+static int claim_chain(ChainObject *self) {
+  if (claim(&self->busy, "chain") < 0)
+    return -1;
+
+  Py_ssize_t count = PyList_GET_SIZE(self->stages);
+  for (Py_ssize_t i = 0; i < count; i++) {
+    FilterObject *filter = (FilterObject *)PyList_GET_ITEM(self->stages, i);
+    if (repeated_stage(self, i))
+      continue;
+    if (claim(&filter->busy, "chain stage") < 0) {
+      for (Py_ssize_t j = 0; j < i; j++)
+        ((FilterObject *)PyList_GET_ITEM(self->stages, j))->busy = 0;
+      self->busy = 0;
+      return -1;
+    }
+  }
+  return 0;
+}
+
+static void release_chain(ChainObject *self) {
+  Py_ssize_t count = PyList_GET_SIZE(self->stages);
+  for (Py_ssize_t i = 0; i < count; i++)
+    ((FilterObject *)PyList_GET_ITEM(self->stages, i))->busy = 0;
+  self->busy = 0;
+}
+
+PyDoc_STRVAR(chain_process_doc,
+             "process(data, channels=0) -> data\n\n"
+             "Run every stage over the samples in place, one cache-sized "
+             "tile at a\ntime, and return `data`.");
+
+static PyObject *chain_process(ChainObject *self, PyObject *args,
+                               PyObject *kwds) {
+  static char *kwlist[] = {"data", "channels", NULL};
+  PyObject *data;
+  int channels = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|i:process", kwlist, &data,
+                                   &channels))
+    return NULL;
+  if (!self->stages) {
+    PyErr_SetString(PyExc_RuntimeError, "chain is not initialized");
+    return NULL;
+  }
+
+  Py_buffer buf;
+  size_t frames;
+  if (acquire_samples(data, channels, 1, &buf, &frames, &channels) < 0)
+    return NULL;
+  if (claim_chain(self) < 0) {
+    PyBuffer_Release(&buf);
+    return NULL;
+  }
+
+  AudioBufferView view;
+  audio_view_wrap(&view, (double *)buf.buf, frames, channels, 0);
+  Py_BEGIN_ALLOW_THREADS
+  audio_chain_process_view(&self->chain, &view);
+  Py_END_ALLOW_THREADS
+
+  release_chain(self);
+  PyBuffer_Release(&buf);
+  Py_INCREF(data);
+  return data;
+}
+
+static PyObject *chain_get_stages(ChainObject *self,
+                                  void *Py_UNUSED(closure)) {
+  return self->stages ? PyList_AsTuple(self->stages) : PyTuple_New(0);
+}
+
+static PyObject *chain_get_tile_frames(ChainObject *self,
+                                       void *Py_UNUSED(closure)) {
+  return PyLong_FromSize_t(self->chain.tile_frames);
+}
+
+static PyMethodDef chain_methods[] = {
+    {"add", (PyCFunction)chain_add, METH_O, chain_add_doc},
+    {"process", (PyCFunction)(void (*)(void))chain_process,
+     METH_VARARGS | METH_KEYWORDS, chain_process_doc},
+    {NULL, NULL, 0, NULL}};
+
+static PyGetSetDef chain_getset[] = {
+    {"stages", (getter)chain_get_stages, NULL, "Tuple of stage filters",
+     NULL},
+    {"tile_frames", (getter)chain_get_tile_frames, NULL,
+     "Frames per tile (0 until autotuned)", NULL},
+    {NULL, NULL, NULL, NULL, NULL}};
+
+static PyTypeObject ChainType = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "audiofilter.Chain",
+    .tp_basicsize = sizeof(ChainObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = PyDoc_STR("Chain(tile_frames=0)\n\n"
+                        "Cache-blocked filter chain (tile size autotuned "
+                        "when 0)."),
+    .tp_methods = chain_methods,
+    .tp_getset = chain_getset,
+    .tp_init = (initproc)chain_object_init,
+    .tp_new = PyType_GenericNew,
+    .tp_dealloc = (destructor)chain_dealloc,
+};
+
+//
+// Buffer: an AudioBuffer exported as a (frames, channels) float64 buffer
+//
+
+typedef struct {
+  PyObject_HEAD
+  AudioBuffer *buffer;
+  Py_ssize_t shape[2];
+  Py_ssize_t strides[2];
+} BufferObject;
+
+static PyTypeObject BufferType;
+
+static PyObject *buffer_wrap(AudioBuffer *buffer) {
+  BufferObject *self = PyObject_New(BufferObject, &BufferType);
+  if (!self) {
+    audio_buffer_free(buffer);
+    return NULL;
+  }
+
+  self->buffer = buffer;
+  self->shape[0] = (Py_ssize_t)(buffer->length / buffer->channels);
+  self->shape[1] = buffer->channels;
+  self->strides[0] = (Py_ssize_t)(buffer->channels * sizeof(double));
+  self->strides[1] = sizeof(double);
+  return (PyObject *)self;
+}
+
+static PyObject *buffer_new(PyTypeObject *Py_UNUSED(type), PyObject *args,
+                            PyObject *kwds) {
+  static char *kwlist[] = {"frames", "channels", "sample_rate", "bit_depth",
+                           NULL};
+  Py_ssize_t frames;
+  int channels, sample_rate, bit_depth = DEFAULT_BIT_DEPTH;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "nii|i:Buffer", kwlist,
+                                   &frames, &channels, &sample_rate,
+                                   &bit_depth))
+    return NULL;
+  if (frames < 0 || channels < 1 || sample_rate <= 0) {
+    PyErr_SetString(PyExc_ValueError,
+                    "need frames >= 0, channels >= 1 and sample_rate > 0");
+    return NULL;
+  }
+
+  AudioBuffer *buffer =
+      audio_buffer_create((size_t)frames * channels, sample_rate, channels,
+                          bit_depth);
+  if (!buffer)
+    return PyErr_NoMemory();
+  memset(buffer->data, 0, buffer->length * sizeof(double));
+  return buffer_wrap(buffer);
+}
+
+static void buffer_dealloc(BufferObject *self) {
+  audio_buffer_free(self->buffer);
+  Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static int buffer_getbuffer(BufferObject *self, Py_buffer *view, int flags) {
+  view->obj = (PyObject *)self;
+  Py_INCREF(self);
+  view->buf = self->buffer->data;
+  view->len = (Py_ssize_t)(self->buffer->length * sizeof(double));
+  view->readonly = 0;
+  view->itemsize = sizeof(double);
+  view->format = (flags & PyBUF_FORMAT) ? "d" : NULL;
+  view->ndim = 2;
+  view->shape = (flags & PyBUF_ND) ? self->shape : NULL;
+  view->strides = (flags & PyBUF_STRIDES) ? self->strides : NULL;
+  view->suboffsets = NULL;
+  view->internal = NULL;
+  return 0;
+}
+
+static PyBufferProcs buffer_as_buffer = {
+    .bf_getbuffer = (getbufferproc)buffer_getbuffer,
+    .bf_releasebuffer = NULL,
+};
+
+static PyObject *buffer_get_frames(BufferObject *self,
+                                   void *Py_UNUSED(closure)) {
+  return PyLong_FromSsize_t(self->shape[0]);
+}
+
+static PyObject *buffer_get_channels(BufferObject *self,
+                                     void *Py_UNUSED(closure)) {
+  return PyLong_FromLong(self->buffer->channels);
+}
+
+static PyObject *buffer_get_sample_rate(BufferObject *self,
+                                        void *Py_UNUSED(closure)) {
+  return PyLong_FromLong(self->buffer->sample_rate);
+}
+
+static PyObject *buffer_get_bit_depth(BufferObject *self,
+                                      void *Py_UNUSED(closure)) {
+  return PyLong_FromLong(self->buffer->bit_depth);
+}
+
+static PyGetSetDef buffer_getset[] = {
+    {"frames", (getter)buffer_get_frames, NULL, "Number of frames", NULL},
+    {"channels", (getter)buffer_get_channels, NULL, "Number of channels",
+     NULL},
+    {"sample_rate", (getter)buffer_get_sample_rate, NULL,
+     "Sample rate in Hz", NULL},
+    {"bit_depth", (getter)buffer_get_bit_depth, NULL,
+     "Bit depth used by write_wave", NULL},
+    {NULL, NULL, NULL, NULL, NULL}};
+
+static PyTypeObject BufferType = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "audiofilter.Buffer",
+    .tp_basicsize = sizeof(BufferObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = PyDoc_STR("Buffer(frames, channels, sample_rate, bit_depth=24)"
+                        "\n\nZeroed float64 audio exported as a (frames, "
+                        "channels) buffer;\nnumpy.asarray() and memoryview() "
+                        "share its memory."),
+    .tp_getset = buffer_getset,
+    .tp_as_buffer = &buffer_as_buffer,
+    .tp_new = buffer_new,
+    .tp_dealloc = (destructor)buffer_dealloc,
+};
+
+//
+// WAV I/O
+//
+
+PyDoc_STRVAR(read_wave_doc,
+             "read_wave(path, start=0, frames=-1) -> Buffer\n\n"
+             "Decode a WAV file (or a frame range of it) to float64.");
+
+static PyObject *module_read_wave(PyObject *Py_UNUSED(module), PyObject *args,
+                                  PyObject *kwds) {
+  static char *kwlist[] = {"path", "start", "frames", NULL};
+  PyObject *path_obj;
+  Py_ssize_t start = 0, frames = -1;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&|nn:read_wave", kwlist,
+                                   PyUnicode_FSConverter, &path_obj, &start,
+                                   &frames))
+    return NULL;
+  if (start < 0) {
+    Py_DECREF(path_obj);
+    PyErr_SetString(PyExc_ValueError, "start must not be negative");
+    return NULL;
+  }
+
+  const char *path = PyBytes_AS_STRING(path_obj);
+  AudioError error = AUDIO_SUCCESS;
+  AudioBuffer *buffer;
+  Py_BEGIN_ALLOW_THREADS
+  if (start == 0 && frames < 0) {
+    buffer = read_wave(path, &error);
+  } else {
+    size_t count = frames < 0 ? SIZE_MAX : (size_t)frames;
+    buffer = read_wave_region(path, (size_t)start, count, &error);
+  }
+  Py_END_ALLOW_THREADS
+
+  PyObject *result =
+      buffer ? buffer_wrap(buffer) : raise_audio_error(error, path);
+  Py_DECREF(path_obj);
+  return result;
+}
+
+PyDoc_STRVAR(write_wave_doc,
+             "write_wave(path, data, sample_rate=0, channels=0, "
+             "bit_depth=0)\n\n"
+             "Encode float64 samples as PCM. Settings default to those of a "
+             "Buffer;\nplain arrays need sample_rate and default to 24-bit.");
+
+static PyObject *module_write_wave(PyObject *Py_UNUSED(module), PyObject *args,
+                                   PyObject *kwds) {
+  static char *kwlist[] = {"path",     "data",      "sample_rate",
+                           "channels", "bit_depth", NULL};
+  PyObject *path_obj, *data;
+  int sample_rate = 0, channels = 0, bit_depth = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&O|iii:write_wave", kwlist,
+                                   PyUnicode_FSConverter, &path_obj, &data,
+                                   &sample_rate, &channels, &bit_depth))
+    return NULL;
+
+  if (PyObject_TypeCheck(data, &BufferType)) {
+    const AudioBuffer *source = ((BufferObject *)data)->buffer;
+    if (sample_rate == 0)
+      sample_rate = source->sample_rate;
+    if (channels == 0)
+      channels = source->channels;
+    if (bit_depth == 0)
+      bit_depth = source->bit_depth;
+  }
+  if (bit_depth == 0)
+    bit_depth = DEFAULT_BIT_DEPTH;
+  if (sample_rate <= 0) {
+    Py_DECREF(path_obj);
+    PyErr_SetString(PyExc_ValueError, "sample_rate is required");
+    return NULL;
+  }
+
+  Py_buffer buf;
+  size_t frames;
+  if (acquire_samples(data, channels, 0, &buf, &frames, &channels) < 0) {
+    Py_DECREF(path_obj);
+    return NULL;
+  }
+
+  // Borrowed samples: write_wave only reads them
+  AudioBuffer buffer = {.data = (double *)buf.buf,
+                        .length = frames * channels,
+                        .sample_rate = sample_rate,
+                        .channels = channels,
+                        .bit_depth = bit_depth,
+                        .storage = NULL};
+  const char *path = PyBytes_AS_STRING(path_obj);
+  AudioError error;
+  Py_BEGIN_ALLOW_THREADS
+  error = write_wave(path, &buffer);
+  Py_END_ALLOW_THREADS
+
+  PyBuffer_Release(&buf);
+  if (error != AUDIO_SUCCESS)
+    raise_audio_error(error, path);
+  Py_DECREF(path_obj);
+  if (error != AUDIO_SUCCESS)
+    return NULL;
+  Py_RETURN_NONE;
+}
+
+static PyMethodDef module_methods[] = {
+    {"read_wave", (PyCFunction)(void (*)(void))module_read_wave,
+     METH_VARARGS | METH_KEYWORDS, read_wave_doc},
+    {"write_wave", (PyCFunction)(void (*)(void))module_write_wave,
+     METH_VARARGS | METH_KEYWORDS, write_wave_doc},
+    {NULL, NULL, 0, NULL}};
+
+static struct PyModuleDef audiofilter_module = {
+    PyModuleDef_HEAD_INIT,
+    .m_name = "audiofilter",
+    .m_doc = "Audio filters, chains and WAV I/O over the buffer protocol.",
+    .m_size = -1,
+    .m_methods = module_methods,
+};
+
+PyMODINIT_FUNC PyInit_audiofilter(void) {
+  PyTypeObject *types[] = {&HPFType, &LPFType, &PEQType, &ChainType,
+                           &BufferType};
+  const char *names[] = {"HPF", "LPF", "PEQ", "Chain", "Buffer"};
+
+  for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+    if (PyType_Ready(types[i]) < 0)
+      return NULL;
+  }
+
+  PyObject *module = PyModule_Create(&audiofilter_module);
+  if (!module)
+    return NULL;
+
+  for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+    Py_INCREF(types[i]);
+    if (PyModule_AddObject(module, names[i], (PyObject *)types[i]) < 0) {
+      Py_DECREF(types[i]);
+      Py_DECREF(module);
+      return NULL;
+    }
+  }
+  if (PyModule_AddStringConstant(module, "__version__", MODULE_VERSION) < 0) {
+    Py_DECREF(module);
+    return NULL;
+  }
+  return module;
+}
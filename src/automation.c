@@ -0,0 +1,272 @@
+#include "automation.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Initial capacity of a lane's event array
+#define INITIAL_EVENT_CAPACITY 16
+
+// Current parameter values of the filter
+static void filter_parameters(const AutomatedFilter *af,
+                              double values[AUTOMATION_NUM_PARAMS]) {
+  values[AUTOMATION_FREQUENCY] = 0.0;
+  values[AUTOMATION_GAIN_DB] = 0.0;
+  values[AUTOMATION_Q] = 0.0;
+
+  switch (af->type) {
+  case AUTOMATION_FILTER_HPF:
+    values[AUTOMATION_FREQUENCY] = ((HPFFilter *)af->filter)->frequency;
+    break;
+  case AUTOMATION_FILTER_LPF:
+    values[AUTOMATION_FREQUENCY] = ((LPFFilter *)af->filter)->frequency;
+    break;
+  case AUTOMATION_FILTER_PARAMETRIC: {
+    ParametricFilter *peq = (ParametricFilter *)af->filter;
+    values[AUTOMATION_FREQUENCY] = peq->frequency;
+    values[AUTOMATION_GAIN_DB] = peq->gain;
+    values[AUTOMATION_Q] = peq->q;
+    break;
+  }
+  }
+}
+
+// Redesign coefficients for the given parameters, keeping state
+static void retune_filter(AutomatedFilter *af,
+                          const double values[AUTOMATION_NUM_PARAMS]) {
+  switch (af->type) {
+  case AUTOMATION_FILTER_HPF:
+    hpf_retune((HPFFilter *)af->filter, af->sample_rate,
+               values[AUTOMATION_FREQUENCY]);
+    break;
+  case AUTOMATION_FILTER_LPF:
+    lpf_retune((LPFFilter *)af->filter, af->sample_rate,
+               values[AUTOMATION_FREQUENCY]);
+    break;
+  case AUTOMATION_FILTER_PARAMETRIC:
+    parametric_retune((ParametricFilter *)af->filter, af->sample_rate,
+                      values[AUTOMATION_FREQUENCY], values[AUTOMATION_GAIN_DB],
+                      values[AUTOMATION_Q]);
+    break;
+  }
+}
+
+static void process_filter(AutomatedFilter *af, const AudioBufferView *view) {
+  switch (af->type) {
+  case AUTOMATION_FILTER_HPF:
+    hpf_process_view((HPFFilter *)af->filter, view);
+    break;
+  case AUTOMATION_FILTER_LPF:
+    lpf_process_view((LPFFilter *)af->filter, view);
+    break;
+  case AUTOMATION_FILTER_PARAMETRIC:
+    parametric_process_view((ParametricFilter *)af->filter, view);
+    break;
+  }
+}
+
+// Initialize automation for a filter
+void automation_init(AutomatedFilter *af, AutomationFilterType type,
+                     void *filter, double sample_rate) {
+  if (!af)
+    return;
+
+  memset(af, 0, sizeof(AutomatedFilter));
+  af->type = type;
+  af->filter = filter;
+  af->sample_rate = sample_rate;
+  af->control_frames = AUTOMATION_CONTROL_FRAMES;
+
+  if (filter) {
+    double values[AUTOMATION_NUM_PARAMS];
+    filter_parameters(af, values);
+    for (int p = 0; p < AUTOMATION_NUM_PARAMS; p++) {
+      af->lanes[p].initial = values[p];
+    }
+  }
+}
+
+// Free event storage
+void automation_free(AutomatedFilter *af) {
+  if (!af)
+    return;
+
+  for (int p = 0; p < AUTOMATION_NUM_PARAMS; p++) {
+    free(af->lanes[p].events);
+    af->lanes[p].events = NULL;
+    af->lanes[p].count = 0;
+    af->lanes[p].capacity = 0;
+  }
+}
+
+// Insert an event, keeping the lane sorted by frame
+int automation_add_event(AutomatedFilter *af, AutomationParam param,
+                         size_t frame, double value, AutomationRamp ramp) {
+  if (!af || (int)param < 0 || param >= AUTOMATION_NUM_PARAMS)
+    return -1;
+
+  AutomationLane *lane = &af->lanes[param];
+
+  // Find the insertion point (replace an event at the same frame)
+  size_t index = lane->count;
+  while (index > 0 && lane->events[index - 1].frame > frame)
+    index--;
+  if (index > 0 && lane->events[index - 1].frame == frame) {
+    lane->events[index - 1].value = value;
+    lane->events[index - 1].ramp = ramp;
+    return 0;
+  }
+
+  if (lane->count == lane->capacity) {
+    size_t capacity =
+        lane->capacity ? lane->capacity * 2 : INITIAL_EVENT_CAPACITY;
+    AutomationEvent *events =
+        realloc(lane->events, capacity * sizeof(AutomationEvent));
+    if (!events)
+      return -1;
+    lane->events = events;
+    lane->capacity = capacity;
+  }
+
+  memmove(&lane->events[index + 1], &lane->events[index],
+          (lane->count - index) * sizeof(AutomationEvent));
+  lane->events[index].frame = frame;
+  lane->events[index].value = value;
+  lane->events[index].ramp = ramp;
+  lane->count++;
+  return 0;
+}
+
+// Remove all events
+void automation_clear(AutomatedFilter *af) {
+  if (!af)
+    return;
+
+  for (int p = 0; p < AUTOMATION_NUM_PARAMS; p++) {
+    af->lanes[p].count = 0;
+  }
+}
+
+// Interpolate between two breakpoints
+static double ramp_value(double v0, double v1, double t, AutomationRamp ramp) {
+  if (ramp == AUTOMATION_EXPONENTIAL && v0 * v1 > 0.0)
+    return v0 * pow(v1 / v0, t);
+  return v0 + (v1 - v0) * t;
+}
+
+// Number of events at or before `frame`
+static size_t events_before(const AutomationLane *lane, size_t frame) {
+  size_t lo = 0, hi = lane->count;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (lane->events[mid].frame <= frame)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+// Value of a lane at a frame
+static double lane_value(const AutomationLane *lane, size_t frame) {
+  size_t k = events_before(lane, frame);
+  size_t prev_frame = k > 0 ? lane->events[k - 1].frame : 0;
+  double prev_value = k > 0 ? lane->events[k - 1].value : lane->initial;
+
+  if (k == lane->count || lane->events[k].ramp == AUTOMATION_STEP)
+    return prev_value;
+
+  const AutomationEvent *next = &lane->events[k];
+  double t = (double)(frame - prev_frame) / (double)(next->frame - prev_frame);
+  return ramp_value(prev_value, next->value, t, next->ramp);
+}
+
+// True if the lane is ramping at `frame`
+static int lane_ramping(const AutomationLane *lane, size_t frame) {
+  size_t k = events_before(lane, frame);
+  return k < lane->count && lane->events[k].ramp != AUTOMATION_STEP;
+}
+
+// First breakpoint strictly after `frame` (or SIZE_MAX)
+static size_t lane_next_event(const AutomationLane *lane, size_t frame) {
+  size_t k = events_before(lane, frame);
+  return k < lane->count ? lane->events[k].frame : (size_t)-1;
+}
+
+double automation_value_at(const AutomatedFilter *af, AutomationParam param,
+                           size_t frame) {
+  if (!af || (int)param < 0 || param >= AUTOMATION_NUM_PARAMS)
+    return 0.0;
+
+  return lane_value(&af->lanes[param], frame);
+}
+
+void automation_seek(AutomatedFilter *af, size_t frame) {
+  if (af)
+    af->position = frame;
+}
+
+// Process a view, splitting at breakpoints and control-rate boundaries
+void automation_process_view(AutomatedFilter *af, const AudioBufferView *view) {
+  if (!af || !af->filter || !view || !view->data)
+    return;
+
+  size_t control = af->control_frames ? af->control_frames : 1;
+  size_t offset = 0;
+
+  while (offset < view->frames) {
+    size_t frame = af->position;
+
+    // The sub-span ends at the next breakpoint of any lane, and at the next
+    // multiple of `control` while a ramp is running. The control grid is
+    // absolute, so block boundaries never change where coefficients update
+    size_t end = frame + (view->frames - offset);
+    size_t control_end = (frame / control + 1) * control;
+
+    // Parameters are sampled at the start of the segment containing `frame`
+    // (the later of the last grid point and the last breakpoint), not at the
+    // block start, so a segment cut by a block boundary keeps its coefficients
+    size_t anchor = frame - frame % control;
+    for (int p = 0; p < AUTOMATION_NUM_PARAMS; p++) {
+      const AutomationLane *lane = &af->lanes[p];
+      size_t k = events_before(lane, frame);
+      if (k > 0 && lane->events[k - 1].frame > anchor)
+        anchor = lane->events[k - 1].frame;
+    }
+
+    double values[AUTOMATION_NUM_PARAMS];
+    for (int p = 0; p < AUTOMATION_NUM_PARAMS; p++) {
+      const AutomationLane *lane = &af->lanes[p];
+      values[p] = lane_value(lane, anchor);
+
+      size_t next = lane_next_event(lane, frame);
+      if (next < end)
+        end = next;
+      if (lane_ramping(lane, frame) && control_end < end)
+        end = control_end;
+    }
+
+    retune_filter(af, values);
+
+    AudioBufferView span = *view;
+    span.storage = NULL; // Borrowed for the duration of the call
+    span.data = view->data + offset * view->stride;
+    span.frames = end - frame;
+    process_filter(af, &span);
+
+    offset += span.frames;
+    af->position = end;
+  }
+}
+
+void automation_process_buffer(AutomatedFilter *af, AudioBuffer *buffer) {
+  AudioBufferView view;
+  if (audio_view_from_buffer(buffer, &view) != AUDIO_SUCCESS)
+    return;
+
+  automation_process_view(af, &view);
+  audio_view_release(&view);
+}
+
+void automation_stage(void *state, const AudioBufferView *tile) {
+  automation_process_view((AutomatedFilter *)state, tile);
+}
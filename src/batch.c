@@ -0,0 +1,521 @@
+#include "batch.h"
+#include "audio_numa.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BATCH_HOST_MAX 256
+#define BATCH_MAX_THREADS 256
+
+// Join a manifest-relative path onto the manifest's directory
+static char *resolve_path(const char *dir, const char *path) {
+  if (path[0] == '/' || dir[0] == '\0')
+    return strdup(path);
+
+  size_t length = strlen(dir) + strlen(path) + 2;
+  char *joined = malloc(length);
+  if (joined)
+    snprintf(joined, length, "%s/%s", dir, path);
+  return joined;
+}
+
+AudioError batch_manifest_load(const char *filepath, BatchManifest *manifest) {
+  if (!filepath || !manifest)
+    return AUDIO_ERROR_INVALID_PARAMETER;
+
+  memset(manifest, 0, sizeof(BatchManifest));
+  FILE *file = fopen(filepath, "r");
+  if (!file)
+    return AUDIO_ERROR_FILE_NOT_FOUND;
+
+  size_t length = strlen(filepath);
+  manifest->lease_dir = malloc(length + sizeof(".leases"));
+  char *dir = strdup(filepath);
+  if (!manifest->lease_dir || !dir) {
+    fclose(file);
+    free(dir);
+    batch_manifest_free(manifest);
+    return AUDIO_ERROR_MEMORY_ERROR;
+  }
+  snprintf(manifest->lease_dir, length + sizeof(".leases"), "%s.leases",
+           filepath);
+  char *slash = strrchr(dir, '/');
+  if (slash)
+    *slash = '\0';
+  else
+    dir[0] = '\0';
+
+  AudioError status = AUDIO_SUCCESS;
+  size_t capacity = 0, number = 0;
+  char *line = NULL;
+  size_t line_size = 0;
+  while (status == AUDIO_SUCCESS && getline(&line, &line_size, file) != -1) {
+    number++;
+    line[strcspn(line, "\r\n")] = '\0';
+    if (line[0] == '\0' || line[0] == '#')
+      continue;
+
+    char *tab = strchr(line, '\t');
+    if (!tab || tab == line || tab[1] == '\0') {
+      manifest->error_line = number;
+      status = AUDIO_ERROR_INVALID_FORMAT;
+      break;
+    }
+    *tab = '\0';
+
+    if (manifest->num_jobs == capacity) {
+      capacity = capacity ? capacity * 2 : 64;
+      BatchJob *grown = realloc(manifest->jobs, capacity * sizeof(BatchJob));
+      if (!grown) {
+        status = AUDIO_ERROR_MEMORY_ERROR;
+        break;
+      }
+      manifest->jobs = grown;
+    }
+
+    BatchJob *job = &manifest->jobs[manifest->num_jobs];
+    job->input = resolve_path(dir, line);
+    job->output = resolve_path(dir, tab + 1);
+    manifest->num_jobs++;
+    if (!job->input || !job->output)
+      status = AUDIO_ERROR_MEMORY_ERROR;
+  }
+
+  free(line);
+  free(dir);
+  fclose(file);
+  if (status != AUDIO_SUCCESS) {
+    size_t error_line = manifest->error_line;
+    batch_manifest_free(manifest);
+    manifest->error_line = error_line;
+  }
+  return status;
+}
+
+void batch_manifest_free(BatchManifest *manifest) {
+  if (!manifest)
+    return;
+
+  for (size_t i = 0; i < manifest->num_jobs; i++) {
+    free(manifest->jobs[i].input);
+    free(manifest->jobs[i].output);
+  }
+  free(manifest->jobs);
+  free(manifest->lease_dir);
+  memset(manifest, 0, sizeof(BatchManifest));
+}
+
+void batch_options_default(BatchOptions *options) {
+  if (!options)
+    return;
+
+  options->lease_timeout = BATCH_LEASE_TIMEOUT;
+  options->heartbeat_interval = BATCH_HEARTBEAT_INTERVAL;
+  options->poll_interval = BATCH_POLL_INTERVAL;
+  options->lease_dir = NULL;
+  options->threads = 1;
+}
+
+static void sleep_seconds(double seconds) {
+  struct timespec delay;
+  delay.tv_sec = (time_t)seconds;
+  delay.tv_nsec = (long)((seconds - (double)delay.tv_sec) * 1e9);
+  while (nanosleep(&delay, &delay) != 0 && errno == EINTR) {
+  }
+}
+
+// Lease refresher: touches the current lease every interval
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+  double interval;
+  int fd;                // Current lease (-1 when idle)
+  int stop;
+} Heartbeat;
+
+static void *heartbeat_main(void *arg) {
+  Heartbeat *beat = (Heartbeat *)arg;
+
+  pthread_mutex_lock(&beat->lock);
+  while (!beat->stop) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    double next = deadline.tv_nsec / 1e9 + beat->interval;
+    deadline.tv_sec += (time_t)next;
+    deadline.tv_nsec = (long)((next - (double)(time_t)next) * 1e9);
+    pthread_cond_timedwait(&beat->wake, &beat->lock, &deadline);
+    if (!beat->stop && beat->fd >= 0)
+      futimens(beat->fd, NULL);
+  }
+  pthread_mutex_unlock(&beat->lock);
+  return NULL;
+}
+
+static void heartbeat_set(Heartbeat *beat, int fd) {
+  pthread_mutex_lock(&beat->lock);
+  beat->fd = fd;
+  pthread_mutex_unlock(&beat->lock);
+}
+
+// Per-worker state of one batch_run (one per thread)
+typedef struct {
+  const BatchManifest *manifest;
+  const BatchOptions *options;
+  const char *lease_dir;
+  BatchJobFn fn;
+  void *user;
+  int node;              // NUMA node to pin to (-1 = keep the affinity)
+  char id[BATCH_HOST_MAX + 48];  // "host-pid[-thread]", unique among workers
+  Heartbeat heartbeat;
+  size_t path_size;
+  char *lease;           // Scratch paths for the current job
+  char *aside;
+  char *marker;
+  char *temp;
+  BatchStats stats;
+  AudioError status;
+} Worker;
+
+static void job_path(const Worker *worker, char *path, size_t index,
+                     const char *suffix) {
+  snprintf(path, worker->path_size, "%s/job-%zu.%s", worker->lease_dir, index,
+           suffix);
+}
+
+static int file_exists(const char *path) {
+  struct stat st;
+  return stat(path, &st) == 0;
+}
+
+static int marker_exists(const char *lease_dir, char *path, size_t path_size,
+                         size_t index) {
+  snprintf(path, path_size, "%s/job-%zu.done", lease_dir, index);
+  if (file_exists(path))
+    return 1;
+  snprintf(path, path_size, "%s/job-%zu.failed", lease_dir, index);
+  return file_exists(path);
+}
+
+static int job_finished(Worker *worker, size_t index) {
+  return marker_exists(worker->lease_dir, worker->marker, worker->path_size,
+                       index);
+}
+
+// Whether a lease has gone a whole timeout without a heartbeat
+static int lease_expired(const char *path, double timeout) {
+  struct stat st;
+  if (stat(path, &st) != 0)
+    return errno == ENOENT;
+
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  double age = (double)(now.tv_sec - st.st_mtim.tv_sec) +
+               (now.tv_nsec - st.st_mtim.tv_nsec) / 1e9;
+  return age > timeout;
+}
+
+// Break an expired lease: move it aside atomically (only one worker wins the
+// rename), then check that the lease moved is still expired. A worker that
+// looked at an old lease may have renamed a fresh one that replaced it; that
+// one is linked back unless the job has been claimed yet again.
+static void break_lease(Worker *worker) {
+  snprintf(worker->aside, worker->path_size, "%s.broken-%s", worker->lease,
+           worker->id);
+  if (rename(worker->lease, worker->aside) != 0)
+    return;
+  if (!lease_expired(worker->aside, worker->options->lease_timeout))
+    link(worker->aside, worker->lease);
+  unlink(worker->aside);
+}
+
+// Write a small marker file
+static void write_marker(const char *path, const char *text) {
+  int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    return;
+  ssize_t written = write(fd, text, strlen(text));
+  (void)written;
+  close(fd);
+}
+
+// Flush a committed file's data before it is renamed into place
+static void sync_file(const char *path) {
+  int fd = open(path, O_RDONLY);
+  if (fd >= 0) {
+    fsync(fd);
+    close(fd);
+  }
+}
+
+typedef enum {
+  CLAIM_ACQUIRED,
+  CLAIM_FINISHED,        // Done or failed already
+  CLAIM_HELD,            // Leased by a live worker
+  CLAIM_ERROR
+} ClaimResult;
+
+static ClaimResult claim_job(Worker *worker, size_t index, int *lease_fd) {
+  if (job_finished(worker, index))
+    return CLAIM_FINISHED;
+
+  job_path(worker, worker->lease, index, "lease");
+  for (int attempt = 0; attempt < 2; attempt++) {
+    int fd = open(worker->lease, O_WRONLY | O_CREAT | O_EXCL, 0644);
+    if (fd >= 0) {
+      // The job may have finished between the marker check and the create
+      if (job_finished(worker, index)) {
+        close(fd);
+        unlink(worker->lease);
+        return CLAIM_FINISHED;
+      }
+      char owner[sizeof(worker->id) + 1];
+      snprintf(owner, sizeof(owner), "%s\n", worker->id);
+      ssize_t written = write(fd, owner, strlen(owner));
+      (void)written;
+      *lease_fd = fd;
+      return CLAIM_ACQUIRED;
+    }
+    if (errno != EEXIST)
+      return CLAIM_ERROR;
+    if (!lease_expired(worker->lease, worker->options->lease_timeout))
+      return CLAIM_HELD;
+    break_lease(worker);
+  }
+  return CLAIM_HELD;
+}
+
+// Drop a lease, unless it was broken and the path now belongs to another
+// worker
+static void release_lease(Worker *worker, int fd) {
+  struct stat mine, current;
+  if (fstat(fd, &mine) == 0 && stat(worker->lease, &current) == 0 &&
+      mine.st_ino == current.st_ino && mine.st_dev == current.st_dev)
+    unlink(worker->lease);
+  close(fd);
+}
+
+static void run_job(Worker *worker, size_t index, int lease_fd, BatchJobFn fn,
+                    void *user, BatchStats *stats) {
+  const BatchJob *job = &worker->manifest->jobs[index];
+  heartbeat_set(&worker->heartbeat, lease_fd);
+
+  snprintf(worker->temp, worker->path_size, "%s.tmp-%s", job->output,
+           worker->id);
+  AudioError error = fn(user, job, worker->temp);
+  if (error == AUDIO_SUCCESS) {
+    sync_file(worker->temp);
+    if (rename(worker->temp, job->output) != 0)
+      error = AUDIO_ERROR_WRITE_ERROR;
+  }
+
+  if (error == AUDIO_SUCCESS) {
+    job_path(worker, worker->marker, index, "done");
+    write_marker(worker->marker, worker->id);
+    stats->completed++;
+  } else {
+    unlink(worker->temp);
+    char text[sizeof(worker->id) + 64];
+    snprintf(text, sizeof(text), "%s: %s\n", worker->id,
+             audio_error_string(error));
+    job_path(worker, worker->marker, index, "failed");
+    write_marker(worker->marker, text);
+    stats->failed++;
+  }
+
+  heartbeat_set(&worker->heartbeat, -1);
+  release_lease(worker, lease_fd);
+}
+
+// Scan the jobs starting at a worker-specific offset until none is left
+static AudioError run_worker(Worker *worker, BatchJobFn fn, void *user,
+                             BatchStats *stats) {
+  size_t count = worker->manifest->num_jobs;
+  if (count == 0)
+    return AUDIO_SUCCESS;
+
+  // Spread concurrent workers over the manifest
+  size_t start = 0;
+  for (const char *c = worker->id; *c; c++)
+    start = start * 31 + (unsigned char)*c;
+  start %= count;
+
+  for (;;) {
+    size_t held = 0, ran = 0;
+    for (size_t k = 0; k < count; k++) {
+      size_t index = (start + k) % count;
+      int lease_fd = -1;
+      switch (claim_job(worker, index, &lease_fd)) {
+      case CLAIM_ACQUIRED:
+        run_job(worker, index, lease_fd, fn, user, stats);
+        ran++;
+        break;
+      case CLAIM_FINISHED:
+        break;
+      case CLAIM_HELD:
+        held++;
+        break;
+      case CLAIM_ERROR:
+        return AUDIO_ERROR_WRITE_ERROR;
+      }
+    }
+    if (held == 0)
+      return AUDIO_SUCCESS;
+    if (ran == 0)
+      sleep_seconds(worker->options->poll_interval);
+  }
+}
+
+// Thread entry: pin to the worker's node first, so the scratch paths, the
+// heartbeat thread and every buffer the job function allocates are placed
+// on that node
+static void *worker_main(void *arg) {
+  Worker *worker = (Worker *)arg;
+  if (worker->node >= 0)
+    audio_numa_pin_thread(worker->node);
+
+  worker->status = AUDIO_ERROR_MEMORY_ERROR;
+  worker->lease = malloc(worker->path_size);
+  worker->aside = malloc(worker->path_size);
+  worker->marker = malloc(worker->path_size);
+  worker->temp = malloc(worker->path_size);
+
+  if (worker->lease && worker->aside && worker->marker && worker->temp) {
+    Heartbeat *beat = &worker->heartbeat;
+    pthread_mutex_init(&beat->lock, NULL);
+    pthread_cond_init(&beat->wake, NULL);
+    beat->interval = worker->options->heartbeat_interval;
+    beat->fd = -1;
+    beat->stop = 0;
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, heartbeat_main, beat) == 0) {
+      worker->status =
+          run_worker(worker, worker->fn, worker->user, &worker->stats);
+
+      pthread_mutex_lock(&beat->lock);
+      beat->stop = 1;
+      pthread_cond_signal(&beat->wake);
+      pthread_mutex_unlock(&beat->lock);
+      pthread_join(thread, NULL);
+    }
+    pthread_cond_destroy(&beat->wake);
+    pthread_mutex_destroy(&beat->lock);
+  }
+
+  free(worker->lease);
+  free(worker->aside);
+  free(worker->marker);
+  free(worker->temp);
+  return NULL;
+}
+
+AudioError batch_run(const BatchManifest *manifest, const BatchOptions *options,
+                     BatchJobFn fn, void *user, BatchStats *stats) {
+  if (!manifest || !fn)
+    return AUDIO_ERROR_INVALID_PARAMETER;
+
+  BatchOptions defaults;
+  if (!options) {
+    batch_options_default(&defaults);
+    options = &defaults;
+  }
+  BatchStats local;
+  if (!stats)
+    stats = &local;
+  memset(stats, 0, sizeof(BatchStats));
+
+  const char *lease_dir = options->lease_dir ? options->lease_dir
+                                             : manifest->lease_dir;
+  if (!lease_dir)
+    return AUDIO_ERROR_INVALID_PARAMETER;
+  if (mkdir(lease_dir, 0755) != 0 && errno != EEXIST)
+    return AUDIO_ERROR_WRITE_ERROR;
+
+  int threads = options->threads > 1 ? options->threads : 1;
+  if (threads > BATCH_MAX_THREADS)
+    threads = BATCH_MAX_THREADS;
+  Worker *workers = calloc(threads, sizeof(Worker));
+  if (!workers)
+    return AUDIO_ERROR_MEMORY_ERROR;
+
+  char host[BATCH_HOST_MAX];
+  if (gethostname(host, sizeof(host)) != 0)
+    snprintf(host, sizeof(host), "localhost");
+  host[sizeof(host) - 1] = '\0';
+
+  // Room for the longest output path plus the temp suffix
+  size_t longest = strlen(lease_dir) + 64;
+  for (size_t i = 0; i < manifest->num_jobs; i++) {
+    size_t length = strlen(manifest->jobs[i].output) + 8;
+    if (length > longest)
+      longest = length;
+  }
+
+  // Jobs already finished when the run starts
+  char *path = malloc(longest + 32);
+  if (!path) {
+    free(workers);
+    return AUDIO_ERROR_MEMORY_ERROR;
+  }
+  for (size_t i = 0; i < manifest->num_jobs; i++)
+    stats->skipped += marker_exists(lease_dir, path, longest + 32, i);
+  free(path);
+
+  // Threads are dealt round-robin over the NUMA nodes; a single thread
+  // keeps the caller's affinity
+  const AudioNumaTopology *topology = audio_numa_topology();
+  for (int t = 0; t < threads; t++) {
+    Worker *worker = &workers[t];
+    worker->manifest = manifest;
+    worker->options = options;
+    worker->lease_dir = lease_dir;
+    worker->fn = fn;
+    worker->user = user;
+    worker->node =
+        threads > 1 && topology->num_nodes > 1 ? t % topology->num_nodes : -1;
+    if (threads > 1)
+      snprintf(worker->id, sizeof(worker->id), "%s-%ld-%d", host,
+               (long)getpid(), t);
+    else
+      snprintf(worker->id, sizeof(worker->id), "%s-%ld", host,
+               (long)getpid());
+    worker->path_size = longest + 2 * sizeof(worker->id);
+  }
+
+  pthread_t handles[BATCH_MAX_THREADS];
+  int started[BATCH_MAX_THREADS] = {0};
+  if (threads == 1) {
+    worker_main(&workers[0]);
+  } else {
+    for (int t = 0; t < threads; t++) {
+      started[t] =
+          pthread_create(&handles[t], NULL, worker_main, &workers[t]) == 0;
+    }
+    // Without its thread a worker runs here, unpinned, after the others
+    for (int t = 0; t < threads; t++) {
+      if (started[t]) {
+        pthread_join(handles[t], NULL);
+      } else {
+        workers[t].node = -1;
+        worker_main(&workers[t]);
+      }
+    }
+  }
+
+  AudioError status = AUDIO_SUCCESS;
+  for (int t = 0; t < threads; t++) {
+    stats->completed += workers[t].stats.completed;
+    stats->failed += workers[t].stats.failed;
+    if (status == AUDIO_SUCCESS)
+      status = workers[t].status;
+  }
+  free(workers);
+  return status;
+}
+
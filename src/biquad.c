@@ -1,4 +1,5 @@
 #include "biquad.h"
+#include <math.h>
 #include <string.h>
 
 // Initialize a BiQuad filter to default state
@@ -32,6 +33,20 @@ void biquad_flush_delays(BiQuad *bq) {
   bq->yz2 = 0.0;
 }
 
+// Copy coefficients, keeping state
+void biquad_copy_coefficients(BiQuad *dst, const BiQuad *src) {
+  if (!dst || !src)
+    return;
+
+  dst->a0 = src->a0;
+  dst->a1 = src->a1;
+  dst->a2 = src->a2;
+  dst->b1 = src->b1;
+  dst->b2 = src->b2;
+  dst->c0 = src->c0;
+  dst->d0 = src->d0;
+}
+
 // Process a single sample through the biquad filter
 double biquad_process(BiQuad *bq, double input) {
   if (!bq)
@@ -61,3 +76,44 @@ double biquad_process(BiQuad *bq, double input) {
 
   return yn;
 }
+
+// Process a strided run of samples in place
+void biquad_process_strided(BiQuad *bq, double *data, size_t frames,
+                            size_t stride) {
+  if (!bq || !data)
+    return;
+
+  for (size_t i = 0; i < frames; i++) {
+    double input = data[i * stride];
+    double filtered = biquad_process(bq, input);
+    data[i * stride] = filtered * bq->c0 + input * bq->d0;
+  }
+}
+
+// Estimate impulse response decay length from the pole radius
+size_t biquad_decay_length(const BiQuad *bq, double threshold) {
+  if (!bq || threshold <= 0.0 || threshold >= 1.0)
+    return 0;
+
+  // Poles are the roots of z^2 + b1*z + b2
+  double disc = bq->b1 * bq->b1 - 4.0 * bq->b2;
+  double radius;
+  if (disc < 0.0) {
+    // Complex conjugate pair: |p|^2 = b2
+    radius = sqrt(bq->b2);
+  } else {
+    double root = sqrt(disc);
+    radius = fmax(fabs((-bq->b1 + root) * 0.5), fabs((-bq->b1 - root) * 0.5));
+  }
+
+  // Two samples always suffice to fill the feedforward delay line
+  if (radius < 1e-12)
+    return 2;
+  if (radius >= 1.0)
+    return (size_t)-1;
+
+  // r^n < threshold; double the estimate to cover the n*r^n envelope of
+  // (nearly) repeated poles
+  double n = 2.0 * log(threshold) / log(radius);
+  return (size_t)ceil(n) + 2;
+}
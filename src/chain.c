@@ -0,0 +1,202 @@
+#include "chain.h"
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+// Tile sizes tried by the autotuner, in bytes of interleaved float64 data
+// (from well inside L1 up to a typical per-core L2)
+static const size_t tile_candidate_bytes[] = {8 << 10,  16 << 10,  32 << 10,
+                                              64 << 10, 128 << 10, 256 << 10,
+                                              512 << 10};
+#define NUM_TILE_CANDIDATES                                                    \
+  (sizeof(tile_candidate_bytes) / sizeof(tile_candidate_bytes[0]))
+
+// Tiles timed per candidate (the fastest one counts)
+#define AUTOTUNE_TRIALS 3
+
+// Fallback tile when there is too little data to autotune
+#define DEFAULT_TILE_BYTES (32 << 10)
+
+// Smallest tile, so per-tile call overhead stays negligible
+#define MIN_TILE_FRAMES 64
+
+static double now_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static size_t bytes_to_frames(size_t bytes, int channels) {
+  size_t frames = bytes / (sizeof(double) * (size_t)channels);
+  return frames < MIN_TILE_FRAMES ? MIN_TILE_FRAMES : frames;
+}
+
+// Built-in stage adapters
+static void hpf_stage(void *state, const AudioBufferView *tile) {
+  hpf_process_view((HPFFilter *)state, tile);
+}
+
+static void lpf_stage(void *state, const AudioBufferView *tile) {
+  lpf_process_view((LPFFilter *)state, tile);
+}
+
+static void parametric_stage(void *state, const AudioBufferView *tile) {
+  parametric_process_view((ParametricFilter *)state, tile);
+}
+
+static void meter_stage(void *state, const AudioBufferView *tile) {
+  AudioMeter *meter = (AudioMeter *)state;
+  for (int c = 0; c < tile->channels; c++) {
+    int channel = tile->first_channel + c;
+    if (channel >= AUDIO_METER_MAX_CHANNELS)
+      break;
+
+    double peak = meter->peak[channel];
+    double sum = 0.0;
+    for (size_t i = 0; i < tile->frames; i++) {
+      double x = tile->data[i * tile->stride + c];
+      peak = fmax(peak, fabs(x));
+      sum += x * x;
+    }
+    meter->peak[channel] = peak;
+    meter->sum_squares[channel] += sum;
+  }
+  meter->frames += tile->frames;
+}
+
+// Initialize an empty chain
+void audio_chain_init(AudioChain *chain) {
+  if (!chain)
+    return;
+
+  memset(chain, 0, sizeof(AudioChain));
+}
+
+// Append a stage
+int audio_chain_add(AudioChain *chain, const char *name, AudioStageFn process,
+                    void *state) {
+  if (!chain || !process || chain->num_stages >= AUDIO_CHAIN_MAX_STAGES)
+    return -1;
+
+  AudioStage *stage = &chain->stages[chain->num_stages++];
+  stage->name = name;
+  stage->process = process;
+  stage->state = state;
+  return 0;
+}
+
+int audio_chain_add_hpf(AudioChain *chain, HPFFilter *hpf) {
+  return audio_chain_add(chain, "hpf", hpf_stage, hpf);
+}
+
+int audio_chain_add_lpf(AudioChain *chain, LPFFilter *lpf) {
+  return audio_chain_add(chain, "lpf", lpf_stage, lpf);
+}
+
+int audio_chain_add_parametric(AudioChain *chain, ParametricFilter *peq) {
+  return audio_chain_add(chain, "peq", parametric_stage, peq);
+}
+
+int audio_chain_add_meter(AudioChain *chain, AudioMeter *meter) {
+  return audio_chain_add(chain, "meter", meter_stage, meter);
+}
+
+// Fix the tile size
+void audio_chain_set_tile_frames(AudioChain *chain, size_t frames) {
+  if (chain)
+    chain->tile_frames = frames;
+}
+
+// Push one tile through every stage
+static void run_tile(AudioChain *chain, const AudioBufferView *view,
+                     size_t offset, size_t frames) {
+  AudioBufferView tile = *view;
+  tile.storage = NULL; // Borrowed for the duration of the call
+  tile.data = view->data + offset * view->stride;
+  tile.frames = frames;
+
+  for (int s = 0; s < chain->num_stages; s++) {
+    chain->stages[s].process(chain->stages[s].state, &tile);
+  }
+}
+
+// Process the leading tiles with each candidate size and keep the fastest
+// Returns the number of frames consumed
+static size_t autotune_tiles(AudioChain *chain, const AudioBufferView *view) {
+  size_t offset = 0;
+  size_t best_frames = 0;
+  double best_cost = 0.0;
+
+  for (size_t c = 0; c < NUM_TILE_CANDIDATES; c++) {
+    size_t frames = bytes_to_frames(tile_candidate_bytes[c], view->channels);
+    if (view->frames - offset < frames * AUTOTUNE_TRIALS)
+      break;
+
+    double cost = 0.0;
+    for (int trial = 0; trial < AUTOTUNE_TRIALS; trial++) {
+      double start = now_seconds();
+      run_tile(chain, view, offset, frames);
+      double elapsed = (now_seconds() - start) / frames;
+      if (trial == 0 || elapsed < cost)
+        cost = elapsed;
+      offset += frames;
+    }
+
+    if (best_frames == 0 || cost < best_cost) {
+      best_frames = frames;
+      best_cost = cost;
+    }
+  }
+
+  // Only persist a choice that was actually measured
+  if (best_frames > 0)
+    chain->tile_frames = best_frames;
+  return offset;
+}
+
+// Run the chain over a view
+void audio_chain_process_view(AudioChain *chain, const AudioBufferView *view) {
+  if (!chain || !view || !view->data || view->channels < 1)
+    return;
+
+  size_t offset = 0;
+  if (chain->tile_frames == 0)
+    offset = autotune_tiles(chain, view);
+
+  size_t tile_frames = chain->tile_frames;
+  if (tile_frames == 0)
+    tile_frames = bytes_to_frames(DEFAULT_TILE_BYTES, view->channels);
+
+  while (offset < view->frames) {
+    size_t frames = view->frames - offset;
+    if (frames > tile_frames)
+      frames = tile_frames;
+    run_tile(chain, view, offset, frames);
+    offset += frames;
+  }
+}
+
+// Run the chain over a whole buffer
+void audio_chain_process(AudioChain *chain, AudioBuffer *buffer) {
+  AudioBufferView view;
+  if (audio_view_from_buffer(buffer, &view) != AUDIO_SUCCESS)
+    return;
+
+  audio_chain_process_view(chain, &view);
+  audio_view_release(&view);
+}
+
+// Reset meter state
+void audio_meter_reset(AudioMeter *meter) {
+  if (meter)
+    memset(meter, 0, sizeof(AudioMeter));
+}
+
+// RMS level of one channel
+double audio_meter_rms(const AudioMeter *meter, int channel) {
+  if (!meter || meter->frames == 0 || channel < 0 ||
+      channel >= AUDIO_METER_MAX_CHANNELS)
+    return 0.0;
+
+  return sqrt(meter->sum_squares[channel] / meter->frames);
+}
@@ -0,0 +1,537 @@
+#include "dynamics.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// dB per octave of amplitude (20 * log10(2)) and its inverse
+#define DB_PER_LOG2 6.020599913279624
+#define LOG2_PER_DB 0.16609640474436813
+
+// Detector floor: quieter frames are treated as -120 dBFS
+#define DETECTOR_FLOOR 1e-6
+#define DETECTOR_FLOOR_DB -120.0
+
+// Decay time of the gate's peak detector (long enough to ride over the
+// zero crossings of low voice fundamentals)
+#define GATE_DETECTOR_MS 20.0
+
+// log2(x) for x > 0 from the exponent bits plus an odd series in
+// t = (m - 1) / (m + 1) on a mantissa centered around 1 (|t| < 0.172,
+// error below 2e-6)
+static inline double fast_log2(double x) {
+  uint64_t bits;
+  memcpy(&bits, &x, sizeof(bits));
+  int exponent = (int)((bits >> 52) & 0x7FF) - 1023;
+  bits = (bits & 0x000FFFFFFFFFFFFFULL) | 0x3FF0000000000000ULL;
+  double m;
+  memcpy(&m, &bits, sizeof(m));
+  if (m > M_SQRT2) {
+    m *= 0.5;
+    exponent++;
+  }
+
+  double t = (m - 1.0) / (m + 1.0);
+  double t2 = t * t;
+  double series = t * (1.0 + t2 * (1.0 / 3.0 + t2 * (1.0 / 5.0)));
+  return exponent + 2.0 * M_LOG2E * series;
+}
+
+// 2^x from an integer exponent built in the bits times a Taylor series of
+// 2^f around f = 1/2 (relative error below 3e-6)
+static inline double fast_exp2(double x) {
+  if (x < -1000.0)
+    x = -1000.0;
+  if (x > 1000.0)
+    x = 1000.0;
+
+  double n = floor(x);
+  double g = (x - n - 0.5) * M_LN2;
+  double poly =
+      1.0 +
+      g * (1.0 + g * (0.5 + g * (1.0 / 6.0 + g * (1.0 / 24.0 + g / 120.0))));
+
+  uint64_t bits = (uint64_t)((int64_t)n + 1023) << 52;
+  double scale;
+  memcpy(&scale, &bits, sizeof(scale));
+  return scale * M_SQRT2 * poly;
+}
+
+// One-pole smoothing coefficient for a time constant
+static double time_coeff(double sample_rate, double ms) {
+  if (ms <= 0.0 || sample_rate <= 0.0)
+    return 0.0;
+  return exp(-1.0 / (ms * 0.001 * sample_rate));
+}
+
+// Stereo-linked peak of each frame: max |x| across the channels
+// Detection runs over a whole block before the serial gain loop; the
+// compare-select (rather than fmax, whose NaN rules block vectorization)
+// lets the compiler use packed max instructions
+static void linked_peaks(const AudioBufferView *view, size_t offset,
+                         size_t frames, double *peaks) {
+  for (size_t i = 0; i < frames; i++) {
+    const double *frame = view->data + (offset + i) * view->stride;
+    double peak = 0.0;
+    for (int c = 0; c < view->channels; c++) {
+      double magnitude = fabs(frame[c]);
+      peak = magnitude > peak ? magnitude : peak;
+    }
+    peaks[i] = peak;
+  }
+}
+
+void compressor_init(Compressor *comp, double sample_rate, double threshold_db,
+                     double ratio, double attack_ms, double release_ms) {
+  if (!comp)
+    return;
+
+  comp->threshold_db = threshold_db;
+  comp->ratio = ratio < 1.0 ? 1.0 : ratio;
+  comp->knee_db = 6.0;
+  comp->makeup_db = 0.0;
+  comp->attack_coeff = time_coeff(sample_rate, attack_ms);
+  comp->release_coeff = time_coeff(sample_rate, release_ms);
+  compressor_reset(comp);
+}
+
+void compressor_reset(Compressor *comp) {
+  if (comp)
+    comp->envelope_db = 0.0;
+}
+
+// Static gain curve with a quadratic soft knee (dB in, dB change out)
+static double compressor_curve(const Compressor *comp, double level_db) {
+  double over = level_db - comp->threshold_db;
+  double slope = 1.0 / comp->ratio - 1.0;
+  double half_knee = 0.5 * comp->knee_db;
+
+  if (over <= -half_knee)
+    return 0.0;
+  if (over < half_knee) {
+    double x = over + half_knee;
+    return slope * x * x / (2.0 * comp->knee_db);
+  }
+  return slope * over;
+}
+
+void compressor_process_view(Compressor *comp, const AudioBufferView *view) {
+  if (!comp || !view || !view->data)
+    return;
+
+  double peaks[DYNAMICS_BLOCK_FRAMES];
+  for (size_t offset = 0; offset < view->frames;
+       offset += DYNAMICS_BLOCK_FRAMES) {
+    size_t frames = view->frames - offset;
+    if (frames > DYNAMICS_BLOCK_FRAMES)
+      frames = DYNAMICS_BLOCK_FRAMES;
+
+    linked_peaks(view, offset, frames, peaks);
+
+    // Turn each peak into a gain, smoothing the reduction in dB
+    double envelope = comp->envelope_db;
+    for (size_t i = 0; i < frames; i++) {
+      double level_db = peaks[i] > DETECTOR_FLOOR
+                            ? DB_PER_LOG2 * fast_log2(peaks[i])
+                            : DETECTOR_FLOOR_DB;
+      double target = compressor_curve(comp, level_db);
+      double coeff =
+          target < envelope ? comp->attack_coeff : comp->release_coeff;
+      envelope = target + (envelope - target) * coeff;
+      peaks[i] = fast_exp2((envelope + comp->makeup_db) * LOG2_PER_DB);
+    }
+    comp->envelope_db = envelope;
+
+    for (size_t i = 0; i < frames; i++) {
+      double *frame = view->data + (offset + i) * view->stride;
+      for (int c = 0; c < view->channels; c++) {
+        frame[c] *= peaks[i];
+      }
+    }
+  }
+}
+
+void compressor_process_buffer(Compressor *comp, AudioBuffer *buffer) {
+  AudioBufferView view;
+  if (audio_view_from_buffer(buffer, &view) != AUDIO_SUCCESS)
+    return;
+
+  compressor_process_view(comp, &view);
+  audio_view_release(&view);
+}
+
+void gate_init(NoiseGate *gate, double sample_rate, double open_db,
+               double close_db, double attack_ms, double hold_ms,
+               double release_ms) {
+  if (!gate)
+    return;
+
+  memset(gate, 0, sizeof(NoiseGate));
+  if (close_db > open_db)
+    close_db = open_db;
+  gate->open_threshold = pow(10.0, open_db / 20.0);
+  gate->close_threshold = pow(10.0, close_db / 20.0);
+  gate->floor = 0.0;
+  gate->ratio = 0.0;
+  gate->attack_coeff = time_coeff(sample_rate, attack_ms);
+  gate->release_coeff = time_coeff(sample_rate, release_ms);
+  gate->detector_coeff = time_coeff(sample_rate, GATE_DETECTOR_MS);
+  gate->hold_frames = (size_t)(hold_ms * 0.001 * sample_rate + 0.5);
+  gate->hpf = NULL;
+  gate_reset(gate);
+}
+
+void gate_reset(NoiseGate *gate) {
+  if (!gate)
+    return;
+
+  for (int c = 0; c < DYNAMICS_MAX_CHANNELS; c++) {
+    gate->channels[c].envelope = 0.0;
+    gate->channels[c].gain = gate->floor;
+    gate->channels[c].open = 0;
+    gate->channels[c].hold = 0;
+    gate->channels[c].frozen = 0;
+  }
+}
+
+// Gain a closed channel heads for: the floor, or downward expansion
+static double gate_closed_target(const NoiseGate *gate, double envelope) {
+  if (gate->ratio <= 1.0)
+    return gate->floor;
+  if (envelope <= DETECTOR_FLOOR)
+    return gate->floor;
+
+  double expanded = fast_exp2((gate->ratio - 1.0) *
+                              fast_log2(envelope / gate->close_threshold));
+  return fmin(1.0, fmax(gate->floor, expanded));
+}
+
+// Restart a frozen filter as if the input had been constant at `x`, so a
+// slowly varying input (rumble) does not produce a step transient
+static void prime_filter(BiQuad *filter, double x) {
+  double dc_gain =
+      (filter->a0 + filter->a1 + filter->a2) / (1.0 + filter->b1 + filter->b2);
+  filter->xz1 = filter->xz2 = x;
+  filter->yz1 = filter->yz2 = x * dc_gain;
+}
+
+// Filter (if fused), detect and gate one channel spaced `stride` apart
+static void gate_channel(const NoiseGate *gate, GateChannel *state,
+                         BiQuad *filter, double *data, size_t frames,
+                         size_t stride) {
+  int hard = gate->floor == 0.0 && gate->ratio <= 1.0;
+  double envelope = state->envelope;
+  double gain = state->gain;
+  int open = state->open;
+  size_t hold = state->hold;
+  int frozen = state->frozen;
+
+  for (size_t i = 0; i < frames; i++) {
+    double x = data[i * stride];
+
+    // Fully closed hard gate: the output is silence whatever the filter
+    // does, so skip it (state frozen) until the raw input could open it
+    if (hard && gain == 0.0 && fabs(x) < gate->open_threshold) {
+      data[i * stride] = 0.0;
+      frozen = 1;
+      continue;
+    }
+
+    double y = x;
+    if (filter) {
+      if (frozen)
+        prime_filter(filter, x);
+      y = biquad_process(filter, x) * filter->c0 + x * filter->d0;
+    }
+    frozen = 0;
+
+    double level = fabs(y);
+    envelope = level > envelope ? level : envelope * gate->detector_coeff;
+
+    // Hysteresis: open at the upper threshold, close after `hold` frames
+    // below the lower one
+    if (open) {
+      if (envelope >= gate->close_threshold)
+        hold = gate->hold_frames;
+      else if (hold > 0)
+        hold--;
+      else
+        open = 0;
+    } else if (envelope >= gate->open_threshold) {
+      open = 1;
+      hold = gate->hold_frames;
+    }
+
+    double target = open ? 1.0 : gate_closed_target(gate, envelope);
+    double coeff = target > gain ? gate->attack_coeff : gate->release_coeff;
+    gain = target + (gain - target) * coeff;
+    if (hard && !open && gain < GATE_CLOSED_GAIN)
+      gain = 0.0;
+
+    data[i * stride] = y * gain;
+  }
+
+  state->envelope = envelope;
+  state->gain = gain;
+  state->open = open;
+  state->hold = hold;
+  state->frozen = frozen;
+}
+
+void gate_process_view(NoiseGate *gate, const AudioBufferView *view) {
+  if (!gate || !view || !view->data)
+    return;
+
+  for (int c = 0; c < view->channels; c++) {
+    int channel = view->first_channel + c;
+    if (channel >= DYNAMICS_MAX_CHANNELS)
+      break;
+
+    // Same per-channel filter state as hpf_process_view
+    BiQuad *filter = NULL;
+    if (gate->hpf)
+      filter = hpf_channel_filter(gate->hpf, channel);
+
+    gate_channel(gate, &gate->channels[channel], filter, view->data + c,
+                 view->frames, view->stride);
+  }
+}
+
+void gate_process_buffer(NoiseGate *gate, AudioBuffer *buffer) {
+  AudioBufferView view;
+  if (audio_view_from_buffer(buffer, &view) != AUDIO_SUCCESS)
+    return;
+
+  gate_process_view(gate, &view);
+  audio_view_release(&view);
+}
+
+int limiter_init(Limiter *lim, double sample_rate, int channels,
+                 double ceiling_db, double lookahead_ms, double release_ms) {
+  if (!lim)
+    return -1;
+
+  memset(lim, 0, sizeof(Limiter));
+  if (channels < 1 || sample_rate <= 0.0 || lookahead_ms < 0.0)
+    return -1;
+
+  lim->ceiling = pow(10.0, ceiling_db / 20.0);
+  lim->release_coeff = time_coeff(sample_rate, release_ms);
+  lim->channels = channels;
+  lim->lookahead = (size_t)(lookahead_ms * 0.001 * sample_rate + 0.5);
+  lim->window = lim->lookahead + 1;
+
+  lim->delay = malloc((lim->lookahead * channels + 1) * sizeof(double));
+  lim->minimum = malloc(lim->window * sizeof(double));
+  lim->deque_value = malloc(lim->window * sizeof(double));
+  lim->deque_frame = malloc(lim->window * sizeof(size_t));
+  if (!lim->delay || !lim->minimum || !lim->deque_value ||
+      !lim->deque_frame) {
+    limiter_free(lim);
+    return -1;
+  }
+
+  limiter_reset(lim);
+  return 0;
+}
+
+void limiter_free(Limiter *lim) {
+  if (!lim)
+    return;
+
+  free(lim->delay);
+  free(lim->minimum);
+  free(lim->deque_value);
+  free(lim->deque_frame);
+  lim->delay = NULL;
+  lim->minimum = NULL;
+  lim->deque_value = NULL;
+  lim->deque_frame = NULL;
+}
+
+void limiter_reset(Limiter *lim) {
+  if (!lim || !lim->delay)
+    return;
+
+  memset(lim->delay, 0, lim->lookahead * lim->channels * sizeof(double));
+  for (size_t i = 0; i < lim->window; i++) {
+    lim->minimum[i] = 1.0;
+  }
+  lim->sum = (double)lim->window;
+  lim->deque_head = 0;
+  lim->deque_count = 0;
+  lim->gain = 1.0;
+  lim->position = 0;
+}
+
+// Gain for the frame leaving the delay line, given the gain the newest frame
+// needs
+static double limiter_gain(Limiter *lim, double required) {
+  size_t n = lim->position;
+  size_t w = lim->window;
+
+  // Sliding minimum over the last `window` frames (monotonic deque): drop
+  // the expired front, then dominated entries at the back
+  if (lim->deque_count > 0 && lim->deque_frame[lim->deque_head] + w <= n) {
+    lim->deque_head = (lim->deque_head + 1) % w;
+    lim->deque_count--;
+  }
+  while (lim->deque_count > 0) {
+    size_t back = (lim->deque_head + lim->deque_count - 1) % w;
+    if (lim->deque_value[back] < required)
+      break;
+    lim->deque_count--;
+  }
+  size_t tail = (lim->deque_head + lim->deque_count) % w;
+  lim->deque_value[tail] = required;
+  lim->deque_frame[tail] = n;
+  lim->deque_count++;
+  double minimum = lim->deque_value[lim->deque_head];
+
+  // Moving average of the minimum: every frame in the window is covered by
+  // all `window` minima averaged once it reaches the end of the delay line.
+  // The running sum is rebuilt once per window so rounding cannot drift
+  size_t slot = n % w;
+  lim->sum += minimum - lim->minimum[slot];
+  lim->minimum[slot] = minimum;
+  if (slot == w - 1) {
+    lim->sum = 0.0;
+    for (size_t i = 0; i < w; i++) {
+      lim->sum += lim->minimum[i];
+    }
+  }
+  double target = fmin(lim->sum / (double)w, 1.0);
+
+  // Attack is instant (the averaging already ramps it); release is smoothed
+  // and can only stay below the target
+  if (target < lim->gain)
+    lim->gain = target;
+  else
+    lim->gain = target + (lim->gain - target) * lim->release_coeff;
+
+  lim->position++;
+  return lim->gain;
+}
+
+void limiter_process_view(Limiter *lim, const AudioBufferView *view) {
+  if (!lim || !lim->delay || !view || !view->data ||
+      view->channels != lim->channels)
+    return;
+
+  int channels = lim->channels;
+  double peaks[DYNAMICS_BLOCK_FRAMES];
+  for (size_t offset = 0; offset < view->frames;
+       offset += DYNAMICS_BLOCK_FRAMES) {
+    size_t frames = view->frames - offset;
+    if (frames > DYNAMICS_BLOCK_FRAMES)
+      frames = DYNAMICS_BLOCK_FRAMES;
+
+    linked_peaks(view, offset, frames, peaks);
+
+    for (size_t i = 0; i < frames; i++) {
+      double required = peaks[i] > lim->ceiling ? lim->ceiling / peaks[i] : 1.0;
+      double gain = limiter_gain(lim, required);
+
+      // Swap the new frame into the delay line and emit the oldest one
+      double *frame = view->data + (offset + i) * view->stride;
+      if (lim->lookahead == 0) {
+        for (int c = 0; c < channels; c++) {
+          frame[c] *= gain;
+        }
+        continue;
+      }
+      double *slot =
+          lim->delay + ((lim->position - 1) % lim->lookahead) * channels;
+      for (int c = 0; c < channels; c++) {
+        double delayed = slot[c];
+        slot[c] = frame[c];
+        frame[c] = delayed * gain;
+      }
+    }
+  }
+}
+
+// Limit a view in place without latency: each frame's gain goes to the frame
+// leaving the delay line, which is still unlimited input lookahead frames
+// back in the same memory. Only valid when the view continues the frames the
+// limiter processed before it, starting at frame 0 of one buffer.
+static void limiter_process_in_place(Limiter *lim,
+                                     const AudioBufferView *view) {
+  if (!lim || !lim->delay || !view || !view->data ||
+      view->channels != lim->channels)
+    return;
+
+  int channels = lim->channels;
+  size_t back = lim->lookahead * view->stride;
+  double peaks[DYNAMICS_BLOCK_FRAMES];
+  for (size_t offset = 0; offset < view->frames;
+       offset += DYNAMICS_BLOCK_FRAMES) {
+    size_t frames = view->frames - offset;
+    if (frames > DYNAMICS_BLOCK_FRAMES)
+      frames = DYNAMICS_BLOCK_FRAMES;
+
+    linked_peaks(view, offset, frames, peaks);
+
+    for (size_t i = 0; i < frames; i++) {
+      double required = peaks[i] > lim->ceiling ? lim->ceiling / peaks[i] : 1.0;
+      size_t position = lim->position;
+      double gain = limiter_gain(lim, required);
+      if (position < lim->lookahead)
+        continue; // The initially silent delay line
+
+      double *frame = view->data + (offset + i) * view->stride;
+      frame -= back;
+      for (int c = 0; c < channels; c++) {
+        frame[c] *= gain;
+      }
+    }
+  }
+}
+
+void limiter_finish_buffer(Limiter *lim, AudioBuffer *buffer) {
+  if (!lim || !lim->delay || !buffer || !buffer->data ||
+      buffer->channels != lim->channels)
+    return;
+
+  // Push silence through, so the last `lookahead` frames get their gains
+  int channels = lim->channels;
+  size_t frames = buffer->length / channels;
+  for (size_t i = 0; i < lim->lookahead; i++) {
+    size_t position = lim->position;
+    double gain = limiter_gain(lim, 1.0);
+    if (position < lim->lookahead || position - lim->lookahead >= frames)
+      continue;
+
+    double *frame = buffer->data + (position - lim->lookahead) * channels;
+    for (int c = 0; c < channels; c++) {
+      frame[c] *= gain;
+    }
+  }
+}
+
+void limiter_process_buffer(Limiter *lim, AudioBuffer *buffer) {
+  if (!lim || !buffer || !buffer->data || buffer->channels != lim->channels)
+    return;
+
+  AudioBufferView view;
+  if (audio_view_from_buffer(buffer, &view) != AUDIO_SUCCESS)
+    return;
+  limiter_process_in_place(lim, &view);
+  audio_view_release(&view);
+  limiter_finish_buffer(lim, buffer);
+}
+
+void compressor_stage(void *state, const AudioBufferView *tile) {
+  compressor_process_view((Compressor *)state, tile);
+}
+
+void gate_stage(void *state, const AudioBufferView *tile) {
+  gate_process_view((NoiseGate *)state, tile);
+}
+
+void limiter_stage(void *state, const AudioBufferView *tile) {
+  limiter_process_view((Limiter *)state, tile);
+}
+
+void limiter_buffer_stage(void *state, const AudioBufferView *tile) {
+  limiter_process_in_place((Limiter *)state, tile);
+}
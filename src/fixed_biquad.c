@@ -0,0 +1,148 @@
+#include "fixed_biquad.h"
+#include <math.h>
+#include <string.h>
+
+// Saturation limits of the internal output state
+#define STATE_MAX ((INT32_C(1) << (23 + FIXED_BIQUAD_HEADROOM_BITS)) - 1)
+#define STATE_MIN (-(INT32_C(1) << (23 + FIXED_BIQUAD_HEADROOM_BITS)))
+
+// floor(value / 2^bits) without relying on signed right shifts
+static inline int64_t shift_floor(int64_t value, int bits) {
+  return value >= 0 ? value >> bits : -((-value - 1) >> bits) - 1;
+}
+
+static inline int32_t clamp32(int64_t value, int32_t lo, int32_t hi) {
+  return value < lo ? lo : value > hi ? hi : (int32_t)value;
+}
+
+int fixed_biquad_init(FixedBiQuad *fb, const BiQuad *bq) {
+  if (!fb || !bq)
+    return -1;
+
+  // y_mix = c0 * A/B x + d0 x = (c0 A + d0 B)/B x
+  double coeffs[5] = {bq->c0 * bq->a0 + bq->d0,
+                      bq->c0 * bq->a1 + bq->d0 * bq->b1,
+                      bq->c0 * bq->a2 + bq->d0 * bq->b2, bq->b1, bq->b2};
+
+  // Most fractional bits that keep every coefficient inside int32
+  for (int frac = FIXED_BIQUAD_MAX_FRAC_BITS;
+       frac >= FIXED_BIQUAD_MIN_FRAC_BITS; frac--) {
+    double scale = ldexp(1.0, frac);
+    int fits = 1;
+    for (int k = 0; k < 5 && fits; k++) {
+      double scaled = nearbyint(coeffs[k] * scale);
+      fits = scaled >= (double)INT32_MIN && scaled <= (double)INT32_MAX;
+    }
+    if (!fits)
+      continue;
+
+    int32_t quantized[5];
+    for (int k = 0; k < 5; k++) {
+      quantized[k] = (int32_t)nearbyint(coeffs[k] * scale);
+    }
+    fixed_biquad_init_q(fb, quantized, frac);
+    return 0;
+  }
+
+  return -1;
+}
+
+void fixed_biquad_init_q(FixedBiQuad *fb, const int32_t coeffs[5],
+                         int frac_bits) {
+  if (!fb || !coeffs)
+    return;
+
+  fb->a0 = coeffs[0];
+  fb->a1 = coeffs[1];
+  fb->a2 = coeffs[2];
+  fb->b1 = coeffs[3];
+  fb->b2 = coeffs[4];
+  fb->frac_bits = frac_bits;
+  fixed_biquad_reset(fb);
+}
+
+void fixed_biquad_reset(FixedBiQuad *fb) {
+  if (!fb)
+    return;
+
+  fb->x1 = fb->x2 = 0;
+  fb->y1 = fb->y2 = 0;
+  fb->error = 0;
+}
+
+int32_t fixed_biquad_process(FixedBiQuad *fb, int32_t input) {
+  // Coefficients are at most 2^31 and the state at most 2^27 in magnitude,
+  // so the five products and the feedback term fit in int64 with room left
+  int64_t acc = (int64_t)fb->a0 * input + (int64_t)fb->a1 * fb->x1 +
+                (int64_t)fb->a2 * fb->x2 - (int64_t)fb->b1 * fb->y1 -
+                (int64_t)fb->b2 * fb->y2 + fb->error;
+
+  int64_t y = shift_floor(acc, fb->frac_bits);
+  fb->error = acc - y * ((int64_t)1 << fb->frac_bits);
+
+  int32_t yn = clamp32(y, STATE_MIN, STATE_MAX);
+  fb->x2 = fb->x1;
+  fb->x1 = input;
+  fb->y2 = fb->y1;
+  fb->y1 = yn;
+  return yn;
+}
+
+// Little-endian PCM sample access, independent of host byte order
+static inline int32_t load_pcm16(const uint8_t *p) {
+  return (int16_t)(uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline int32_t load_pcm24(const uint8_t *p) {
+  uint32_t raw =
+      (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+  return (int32_t)(raw ^ 0x800000u) - 0x800000;
+}
+
+static inline void store_pcm16(uint8_t *p, int32_t value) {
+  p[0] = (uint8_t)(value & 0xFF);
+  p[1] = (uint8_t)((value >> 8) & 0xFF);
+}
+
+static inline void store_pcm24(uint8_t *p, int32_t value) {
+  p[0] = (uint8_t)(value & 0xFF);
+  p[1] = (uint8_t)((value >> 8) & 0xFF);
+  p[2] = (uint8_t)((value >> 16) & 0xFF);
+}
+
+AudioError fixed_biquad_process_pcm(FixedBiQuad *filters, int channels,
+                                    PCMBuffer *pcm) {
+  if (!filters || channels < 1 || !pcm || !pcm->data)
+    return AUDIO_ERROR_INVALID_PARAMETER;
+  if (pcm->bit_depth != 16 && pcm->bit_depth != 24)
+    return AUDIO_ERROR_UNSUPPORTED_FORMAT;
+
+  size_t bytes = pcm->bit_depth / 8;
+  size_t frames = pcm->length / (bytes * channels);
+
+  // Frame-major with the channel loop innermost: each channel's recursion
+  // is independent, so the channel loop is the one that can use SIMD lanes
+  if (bytes == 2) {
+    for (size_t f = 0; f < frames; f++) {
+      uint8_t *frame = pcm->data + f * 2 * channels;
+      for (int c = 0; c < channels; c++) {
+        int32_t x = load_pcm16(frame + 2 * c) * 256;
+        int32_t y = fixed_biquad_process(&filters[c], x);
+        // Round to 16 bits (half up) and saturate
+        int64_t out = shift_floor((int64_t)y + 128, 8);
+        store_pcm16(frame + 2 * c, clamp32(out, INT16_MIN, INT16_MAX));
+      }
+    }
+  } else {
+    for (size_t f = 0; f < frames; f++) {
+      uint8_t *frame = pcm->data + f * 3 * channels;
+      for (int c = 0; c < channels; c++) {
+        int32_t x = load_pcm24(frame + 3 * c);
+        int32_t y = fixed_biquad_process(&filters[c], x);
+        store_pcm24(frame + 3 * c, clamp32(y, -0x800000, 0x7FFFFF));
+      }
+    }
+  }
+
+  return AUDIO_SUCCESS;
+}
@@ -0,0 +1,1317 @@
+#include "flac.h"
+#include "audio_alloc.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Input is read in chunks of at least this many bytes
+#define READ_CHUNK (256 * 1024)
+
+// Readable bytes kept past the end of the input buffer. The bit reader
+// loads 8 bytes at a time and checks its position against the end of the
+// data only between fields, so it may look this far beyond it.
+#define INPUT_SLACK 256
+
+// Highest Rice partition order the encoder tries
+#define MAX_PARTITION_ORDER 8
+
+// Metadata block types
+#define BLOCK_STREAMINFO 0
+#define BLOCK_SEEKTABLE 3
+#define STREAMINFO_SIZE 34
+
+// Seek point sample number of a placeholder
+#define SEEK_PLACEHOLDER 0xFFFFFFFFFFFFFFFFull
+
+// Channel assignments beyond independent channels
+#define LEFT_SIDE 8
+#define RIGHT_SIDE 9
+#define MID_SIDE 10
+
+// CRC-8 (poly 0x07) of frame headers and CRC-16 (poly 0x8005) of frames
+static uint8_t crc8_table[256];
+static uint16_t crc16_table[256];
+static pthread_once_t crc_once = PTHREAD_ONCE_INIT;
+
+static void crc_init(void) {
+  for (int i = 0; i < 256; i++) {
+    uint8_t c8 = (uint8_t)i;
+    uint16_t c16 = (uint16_t)(i << 8);
+    for (int bit = 0; bit < 8; bit++) {
+      c8 = (uint8_t)((c8 & 0x80) ? (c8 << 1) ^ 0x07 : c8 << 1);
+      c16 = (uint16_t)((c16 & 0x8000) ? (c16 << 1) ^ 0x8005 : c16 << 1);
+    }
+    crc8_table[i] = c8;
+    crc16_table[i] = c16;
+  }
+}
+
+static uint8_t crc8(const uint8_t *data, size_t size) {
+  uint8_t crc = 0;
+  for (size_t i = 0; i < size; i++)
+    crc = crc8_table[crc ^ data[i]];
+  return crc;
+}
+
+static uint16_t crc16(const uint8_t *data, size_t size) {
+  uint16_t crc = 0;
+  for (size_t i = 0; i < size; i++)
+    crc = (uint16_t)((crc << 8) ^ crc16_table[(crc >> 8) ^ data[i]]);
+  return crc;
+}
+
+// Big-endian fields of metadata blocks
+static uint32_t be_read(const uint8_t *bytes, int count) {
+  uint32_t value = 0;
+  for (int i = 0; i < count; i++)
+    value = (value << 8) | bytes[i];
+  return value;
+}
+
+static void be_write(uint8_t *bytes, uint64_t value, int count) {
+  for (int i = count - 1; i >= 0; i--) {
+    bytes[i] = (uint8_t)value;
+    value >>= 8;
+  }
+}
+
+int flac_probe(FILE *file) {
+  if (!file)
+    return 0;
+
+  long start = ftell(file);
+  char magic[4];
+  int found = fread(magic, 1, 4, file) == 4 && memcmp(magic, "fLaC", 4) == 0;
+  fseek(file, start, SEEK_SET);
+  return found;
+}
+
+// ---------------------------------------------------------------------------
+// Decoder
+
+// MSB-first reader over an in-memory frame; positions are in bits
+typedef struct {
+  const uint8_t *data;
+  size_t pos;
+  size_t limit;          // End of the valid data
+} BitReader;
+
+// The next 64 bits; at least the top 57 are valid
+static inline uint64_t br_peek(const BitReader *br) {
+  uint64_t word;
+  memcpy(&word, br->data + (br->pos >> 3), sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  word = __builtin_bswap64(word);
+#endif
+  return word << (br->pos & 7);
+}
+
+// Read `n` (0-32) bits as unsigned
+static inline uint32_t br_bits(BitReader *br, int n) {
+  if (n == 0)
+    return 0;
+  uint32_t value = (uint32_t)(br_peek(br) >> (64 - n));
+  br->pos += n;
+  return value;
+}
+
+// Read `n` (1-32) bits as two's complement
+static inline int32_t br_signed(BitReader *br, int n) {
+  return (int32_t)(br_bits(br, n) << (32 - n)) >> (32 - n);
+}
+
+// Count zero bits up to and including the next one bit
+static inline uint32_t br_unary(BitReader *br) {
+  uint32_t zeros = 0;
+  for (;;) {
+    uint64_t word = br_peek(br);
+    if (word >> 8) {
+      int count = __builtin_clzll(word);
+      br->pos += count + 1;
+      return zeros + count;
+    }
+    zeros += 56;
+    br->pos += 56;
+    if (br->pos > br->limit)
+      return zeros;
+  }
+}
+
+// Decode `count` Rice codes with parameter k. The common case, a code that
+// fits in one 64-bit load, takes a single count-leading-zeros and shift.
+static int read_rice(BitReader *br, int32_t *out, size_t count, int k) {
+  const size_t limit = br->limit;
+  for (size_t i = 0; i < count; i++) {
+    uint64_t word = br_peek(br);
+    uint32_t value;
+    int zeros = word ? __builtin_clzll(word) : 64;
+    if (zeros + 1 + k <= 57) {
+      uint64_t rest = word << (zeros + 1);
+      value = ((uint32_t)zeros << k) | (uint32_t)((rest >> (63 - k)) >> 1);
+      br->pos += zeros + 1 + k;
+    } else {
+      uint32_t quotient = br_unary(br);
+      value = (quotient << k) | br_bits(br, k);
+    }
+    out[i] = (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+    if (br->pos > limit)
+      return 0;
+  }
+  return 1;
+}
+
+// Decode the residual of a predicted subframe into s[order..n)
+static int read_residual(BitReader *br, int32_t *s, size_t n, int order) {
+  uint32_t method = br_bits(br, 2);
+  if (method > 1)
+    return 0;
+  int param_bits = method ? 5 : 4;
+  uint32_t escape = method ? 31 : 15;
+
+  int partition_order = (int)br_bits(br, 4);
+  size_t partition_size = n >> partition_order;
+  if ((partition_size << partition_order) != n ||
+      partition_size < (size_t)order)
+    return 0;
+
+  int32_t *out = s + order;
+  for (size_t p = 0; p < ((size_t)1 << partition_order); p++) {
+    size_t count = p == 0 ? partition_size - order : partition_size;
+    uint32_t param = br_bits(br, param_bits);
+    if (param == escape) {
+      // Escaped partition: fixed-width samples
+      int width = (int)br_bits(br, 5);
+      if (br->pos + count * width > br->limit)
+        return 0;
+      for (size_t i = 0; i < count; i++)
+        out[i] = width ? br_signed(br, width) : 0;
+    } else if (!read_rice(br, out, count, (int)param)) {
+      return 0;
+    }
+    out += count;
+  }
+  return br->pos <= br->limit;
+}
+
+// Undo a fixed predictor in place
+static void fixed_restore(int32_t *s, size_t n, int order) {
+  switch (order) {
+  case 1:
+    for (size_t i = 1; i < n; i++)
+      s[i] = (int32_t)((int64_t)s[i] + s[i - 1]);
+    break;
+  case 2:
+    for (size_t i = 2; i < n; i++)
+      s[i] = (int32_t)((int64_t)s[i] + 2 * (int64_t)s[i - 1] - s[i - 2]);
+    break;
+  case 3:
+    for (size_t i = 3; i < n; i++)
+      s[i] = (int32_t)((int64_t)s[i] + 3 * ((int64_t)s[i - 1] - s[i - 2]) +
+                       s[i - 3]);
+    break;
+  case 4:
+    for (size_t i = 4; i < n; i++)
+      s[i] = (int32_t)((int64_t)s[i] + 4 * ((int64_t)s[i - 1] + s[i - 3]) -
+                       6 * (int64_t)s[i - 2] - s[i - 4]);
+    break;
+  }
+}
+
+// Undo an LPC predictor in place when the prediction fits in 32 bits.
+// Coefficients are reversed (rc[order - 1] applies to the newest sample),
+// so each prediction is a dot product over contiguous history that the
+// compiler vectorizes; unsigned arithmetic keeps corrupt input defined.
+static inline void lpc_restore32(int32_t *restrict s, size_t n,
+                                 const int32_t *restrict rc, int order,
+                                 int shift) {
+  for (size_t i = order; i < n; i++) {
+    const int32_t *history = s + i - order;
+    uint32_t sum = 0;
+    for (int j = 0; j < order; j++)
+      sum += (uint32_t)rc[j] * (uint32_t)history[j];
+    s[i] = (int32_t)((uint32_t)s[i] + (uint32_t)((int32_t)sum >> shift));
+  }
+}
+
+// The same with 64-bit accumulation, for deep samples or coefficients
+static void lpc_restore64(int32_t *restrict s, size_t n,
+                          const int32_t *restrict rc, int order, int shift) {
+  for (size_t i = order; i < n; i++) {
+    const int32_t *history = s + i - order;
+    int64_t sum = 0;
+    for (int j = 0; j < order; j++)
+      sum += (int64_t)rc[j] * history[j];
+    s[i] = (int32_t)(s[i] + (sum >> shift));
+  }
+}
+
+// Orders up to 12 (everything the common encoder presets produce) get a
+// copy of the loop with a constant trip count, which the compiler unrolls
+// into straight-line vector multiply-adds
+#define LPC_ORDER(N)                                                           \
+  case N:                                                                      \
+    lpc_restore32(s, n, rc, N, shift);                                         \
+    break;
+
+static void lpc_restore(int32_t *s, size_t n, const int32_t *coefs, int order,
+                        int precision, int shift, int bps) {
+  int32_t rc[32];
+  for (int j = 0; j < order; j++)
+    rc[j] = coefs[order - 1 - j];
+
+  // |sum| < order * 2^(bps - 1) * 2^(precision - 1)
+  int order_bits = order > 1 ? 32 - __builtin_clz((unsigned)order - 1) : 0;
+  if (bps + precision + order_bits > 32) {
+    lpc_restore64(s, n, rc, order, shift);
+    return;
+  }
+
+  switch (order) {
+    LPC_ORDER(1)
+    LPC_ORDER(2)
+    LPC_ORDER(3)
+    LPC_ORDER(4)
+    LPC_ORDER(5)
+    LPC_ORDER(6)
+    LPC_ORDER(7)
+    LPC_ORDER(8)
+    LPC_ORDER(9)
+    LPC_ORDER(10)
+    LPC_ORDER(11)
+    LPC_ORDER(12)
+  default:
+    lpc_restore32(s, n, rc, order, shift);
+    break;
+  }
+}
+
+// Decode one subframe of `n` samples at `bps` bits into s
+static int decode_subframe(BitReader *br, int32_t *s, size_t n, int bps) {
+  if (br_bits(br, 1) != 0)
+    return 0;
+  uint32_t type = br_bits(br, 6);
+  int wasted = 0;
+  if (br_bits(br, 1)) {
+    wasted = (int)br_unary(br) + 1;
+    if (wasted >= bps)
+      return 0;
+    bps -= wasted;
+  }
+  if (br->pos > br->limit)
+    return 0;
+
+  if (type == 0) {
+    int32_t value = br_signed(br, bps);
+    for (size_t i = 0; i < n; i++)
+      s[i] = value;
+  } else if (type == 1) {
+    if (br->pos + n * bps > br->limit)
+      return 0;
+    for (size_t i = 0; i < n; i++)
+      s[i] = br_signed(br, bps);
+  } else if (type >= 8 && type <= 12) {
+    int order = (int)type - 8;
+    if ((size_t)order > n)
+      return 0;
+    for (int i = 0; i < order; i++)
+      s[i] = br_signed(br, bps);
+    if (!read_residual(br, s, n, order))
+      return 0;
+    fixed_restore(s, n, order);
+  } else if (type >= 32) {
+    int order = (int)(type & 31) + 1;
+    if ((size_t)order > n)
+      return 0;
+    for (int i = 0; i < order; i++)
+      s[i] = br_signed(br, bps);
+    int precision = (int)br_bits(br, 4) + 1;
+    int shift = br_signed(br, 5);
+    if (precision == 16 || shift < 0)
+      return 0;
+    int32_t coefs[32];
+    for (int j = 0; j < order; j++)
+      coefs[j] = br_signed(br, precision);
+    if (br->pos > br->limit || !read_residual(br, s, n, order))
+      return 0;
+    lpc_restore(s, n, coefs, order, precision, shift, bps);
+  } else {
+    return 0;
+  }
+
+  if (wasted) {
+    for (size_t i = 0; i < n; i++)
+      s[i] = (int32_t)((uint32_t)s[i] << wasted);
+  }
+  return br->pos <= br->limit;
+}
+
+typedef struct {
+  uint64_t sample;       // First sample of the target frame
+  uint64_t offset;       // Byte offset from the first frame
+} SeekPoint;
+
+struct FlacDecoder {
+  FILE *file;
+  int channels;
+  int bps;               // Bits per sample of the stream
+  double scale;          // 2^-(bps - 1)
+  size_t max_block;      // Samples per channel of the largest block
+  size_t frame_bound;    // Bytes a frame may take
+  uint64_t total;        // Samples per channel (0 = unknown)
+  long first_frame;      // File offset of the first frame
+  SeekPoint *seek_points;
+  size_t num_seek_points;
+
+  uint8_t *input;        // Buffered file data (+ INPUT_SLACK)
+  size_t capacity;
+  size_t length;         // Valid bytes in input
+  size_t next;           // Start of the next frame in input
+  int eof;
+
+  int32_t *block;        // Decoded block, one max_block run per channel
+  size_t block_frames;   // Frames in the decoded block
+  size_t block_used;     // Frames of it already returned
+  uint64_t position;     // Next frame returned by flac_decoder_read
+  AudioError status;
+};
+
+// Make sure a whole frame is buffered (unless the file ends first)
+static int fill_input(FlacDecoder *dec) {
+  size_t available = dec->length - dec->next;
+  if (available >= dec->frame_bound || dec->eof)
+    return 1;
+
+  memmove(dec->input, dec->input + dec->next, available);
+  dec->length = available;
+  dec->next = 0;
+  size_t wanted = dec->capacity - available;
+  size_t got = fread(dec->input + available, 1, wanted, dec->file);
+  dec->length += got;
+  if (got < wanted) {
+    if (ferror(dec->file))
+      return 0;
+    dec->eof = 1;
+  }
+  return 1;
+}
+
+// Drop buffered input, e.g. after seeking the file
+static void reset_input(FlacDecoder *dec) {
+  dec->length = 0;
+  dec->next = 0;
+  dec->eof = 0;
+  dec->block_frames = 0;
+  dec->block_used = 0;
+  dec->status = AUDIO_SUCCESS;
+}
+
+static int fail(FlacDecoder *dec, AudioError error) {
+  if (dec->status == AUDIO_SUCCESS)
+    dec->status = error;
+  return -1;
+}
+
+// Parse the frame header; returns the block size or 0 if it is invalid
+static size_t parse_frame_header(FlacDecoder *dec, BitReader *br,
+                                 int *assignment) {
+  const uint8_t *start = br->data + (br->pos >> 3);
+  if (br_bits(br, 15) != 0x7FFC)
+    return 0;
+  br_bits(br, 1); // Blocking strategy: positions are counted, not parsed
+
+  uint32_t size_code = br_bits(br, 4);
+  uint32_t rate_code = br_bits(br, 4);
+  *assignment = (int)br_bits(br, 4);
+  uint32_t depth_code = br_bits(br, 3);
+  if (br_bits(br, 1) != 0)
+    return 0;
+
+  // Frame or sample number, UTF-8 style
+  uint32_t lead = br_bits(br, 8);
+  int extra = 0;
+  while (extra < 7 && (lead << extra) & 0x80)
+    extra++;
+  if (extra == 1 || lead == 0xFF)
+    return 0;
+  for (int i = 1; i < extra; i++) {
+    if ((br_bits(br, 8) & 0xC0) != 0x80)
+      return 0;
+  }
+
+  size_t block_size;
+  if (size_code == 0)
+    return 0;
+  else if (size_code == 1)
+    block_size = 192;
+  else if (size_code <= 5)
+    block_size = (size_t)576 << (size_code - 2);
+  else if (size_code == 6)
+    block_size = br_bits(br, 8) + 1;
+  else if (size_code == 7)
+    block_size = br_bits(br, 16) + 1;
+  else
+    block_size = (size_t)256 << (size_code - 8);
+
+  // The rate of every frame is the one in STREAMINFO
+  if (rate_code == 12)
+    br_bits(br, 8);
+  else if (rate_code == 13 || rate_code == 14)
+    br_bits(br, 16);
+  else if (rate_code == 15)
+    return 0;
+
+  static const int depths[8] = {0, 8, 12, -1, 16, 20, 24, 32};
+  int depth = depths[depth_code];
+  if (depth < 0 || (depth != 0 && depth != dec->bps))
+    return 0;
+
+  int channels = *assignment < LEFT_SIDE ? *assignment + 1 : 2;
+  if (*assignment > MID_SIDE || channels != dec->channels ||
+      block_size > dec->max_block)
+    return 0;
+
+  const uint8_t *end = br->data + (br->pos >> 3);
+  if (br->pos > br->limit || crc8(start, end - start) != br_bits(br, 8))
+    return 0;
+  return block_size;
+}
+
+// Undo stereo decorrelation
+static void decorrelate(int32_t *restrict a, int32_t *restrict b, size_t n,
+                        int assignment) {
+  switch (assignment) {
+  case LEFT_SIDE: // a = left, b = side
+    for (size_t i = 0; i < n; i++)
+      b[i] = (int32_t)((int64_t)a[i] - b[i]);
+    break;
+  case RIGHT_SIDE: // a = side, b = right
+    for (size_t i = 0; i < n; i++)
+      a[i] = (int32_t)((int64_t)a[i] + b[i]);
+    break;
+  case MID_SIDE: // a = mid, b = side
+    for (size_t i = 0; i < n; i++) {
+      int64_t mid = ((int64_t)a[i] * 2) | (b[i] & 1);
+      a[i] = (int32_t)((mid + b[i]) >> 1);
+      b[i] = (int32_t)((mid - b[i]) >> 1);
+    }
+    break;
+  }
+}
+
+// Decode the next frame into the block buffer
+// Returns 1 on success, 0 at the end of the stream and -1 on error
+static int decode_frame(FlacDecoder *dec) {
+  if (dec->status != AUDIO_SUCCESS)
+    return -1;
+  // Stop at the advertised length; anything after it (e.g. tags) is ignored
+  if (dec->total && dec->position >= dec->total)
+    return 0;
+  if (!fill_input(dec))
+    return fail(dec, AUDIO_ERROR_READ_ERROR);
+  if (dec->next == dec->length)
+    return dec->total ? fail(dec, AUDIO_ERROR_READ_ERROR) : 0;
+
+  BitReader br = {dec->input, dec->next * 8, dec->length * 8};
+  int assignment;
+  size_t n = parse_frame_header(dec, &br, &assignment);
+  if (n == 0)
+    return fail(dec, AUDIO_ERROR_INVALID_FORMAT);
+
+  for (int c = 0; c < dec->channels; c++) {
+    int side = (assignment == LEFT_SIDE && c == 1) ||
+               (assignment == RIGHT_SIDE && c == 0) ||
+               (assignment == MID_SIDE && c == 1);
+    if (!decode_subframe(&br, dec->block + c * dec->max_block, n,
+                         dec->bps + side))
+      return fail(dec, br.pos > br.limit ? AUDIO_ERROR_READ_ERROR
+                                         : AUDIO_ERROR_INVALID_FORMAT);
+  }
+
+  // Byte-aligned CRC-16 footer over the whole frame
+  br.pos = (br.pos + 7) & ~(size_t)7;
+  size_t end = br.pos >> 3;
+  if (br.pos + 16 > br.limit)
+    return fail(dec, AUDIO_ERROR_READ_ERROR);
+  if (crc16(dec->input + dec->next, end - dec->next) != br_bits(&br, 16))
+    return fail(dec, AUDIO_ERROR_INVALID_FORMAT);
+
+  if (assignment >= LEFT_SIDE)
+    decorrelate(dec->block, dec->block + dec->max_block, n, assignment);
+
+  dec->next = end + 2;
+  dec->block_frames = n;
+  dec->block_used = 0;
+  if (dec->total && n > dec->total - dec->position)
+    dec->block_frames = (size_t)(dec->total - dec->position);
+  return 1;
+}
+
+// Read the metadata blocks that follow the "fLaC" marker
+static AudioError read_metadata(FlacDecoder *dec, FILE *file,
+                                AudioFileInfo *info) {
+  uint8_t magic[4];
+  if (fread(magic, 1, 4, file) != 4 || memcmp(magic, "fLaC", 4) != 0)
+    return AUDIO_ERROR_INVALID_FORMAT;
+
+  int have_info = 0;
+  int last = 0;
+  unsigned max_frame = 0;
+  int sample_rate = 0;
+  while (!last) {
+    uint8_t header[4];
+    if (fread(header, 1, 4, file) != 4)
+      return AUDIO_ERROR_INVALID_FORMAT;
+    last = header[0] >> 7;
+    int type = header[0] & 0x7F;
+    uint32_t size = be_read(header + 1, 3);
+
+    if (!have_info) {
+      // STREAMINFO comes first
+      uint8_t si[STREAMINFO_SIZE];
+      if (type != BLOCK_STREAMINFO || size != STREAMINFO_SIZE ||
+          fread(si, 1, STREAMINFO_SIZE, file) != STREAMINFO_SIZE)
+        return AUDIO_ERROR_INVALID_FORMAT;
+      dec->max_block = be_read(si + 2, 2);
+      max_frame = be_read(si + 7, 3);
+      sample_rate = (int)(be_read(si + 10, 3) >> 4);
+      dec->channels = ((si[12] >> 1) & 7) + 1;
+      dec->bps = (((si[12] & 1) << 4) | (si[13] >> 4)) + 1;
+      dec->total = ((uint64_t)(si[13] & 0x0F) << 32) | be_read(si + 14, 4);
+      have_info = 1;
+    } else if (type == BLOCK_SEEKTABLE && size % 18 == 0 &&
+               !dec->seek_points) {
+      size_t count = size / 18;
+      dec->seek_points = (SeekPoint *)malloc(count * sizeof(SeekPoint) + 1);
+      if (!dec->seek_points)
+        return AUDIO_ERROR_MEMORY_ERROR;
+      for (size_t i = 0; i < count; i++) {
+        uint8_t point[18];
+        if (fread(point, 1, 18, file) != 18)
+          return AUDIO_ERROR_INVALID_FORMAT;
+        uint64_t sample = ((uint64_t)be_read(point, 4) << 32) |
+                          be_read(point + 4, 4);
+        if (sample == SEEK_PLACEHOLDER)
+          continue;
+        SeekPoint *sp = &dec->seek_points[dec->num_seek_points++];
+        sp->sample = sample;
+        sp->offset = ((uint64_t)be_read(point + 8, 4) << 32) |
+                     be_read(point + 12, 4);
+      }
+    } else if (type == 127 || fseek(file, size, SEEK_CUR) != 0) {
+      return AUDIO_ERROR_INVALID_FORMAT;
+    }
+  }
+
+  if (sample_rate == 0 || dec->max_block < 16)
+    return AUDIO_ERROR_INVALID_FORMAT;
+  if (dec->bps < 4 || dec->bps > 24)
+    return AUDIO_ERROR_UNSUPPORTED_FORMAT;
+  dec->first_frame = ftell(file);
+
+  // Worst case of a valid frame: verbatim subframes plus headers
+  size_t verbatim = dec->max_block * dec->channels * (dec->bps + 1) / 8;
+  dec->frame_bound = (verbatim > max_frame ? verbatim : max_frame) +
+                     64 * dec->channels + 64;
+
+  int container = (dec->bps + 7) / 8 * 8;
+  info->sample_rate = sample_rate;
+  info->channels = dec->channels;
+  info->bit_depth = container;
+  info->audio_format = AUDIO_FORMAT_FLAC;
+  info->block_align = dec->channels * container / 8;
+  info->frames = (size_t)dec->total;
+  info->data_size = info->frames * info->block_align;
+  info->data_offset = dec->first_frame;
+  return AUDIO_SUCCESS;
+}
+
+FlacDecoder *flac_decoder_open(FILE *file, AudioFileInfo *info,
+                               AudioError *error) {
+  if (!file || !info) {
+    if (error)
+      *error = AUDIO_ERROR_INVALID_PARAMETER;
+    return NULL;
+  }
+  pthread_once(&crc_once, crc_init);
+
+  FlacDecoder *dec = (FlacDecoder *)calloc(1, sizeof(FlacDecoder));
+  if (!dec) {
+    if (error)
+      *error = AUDIO_ERROR_MEMORY_ERROR;
+    return NULL;
+  }
+  dec->file = file;
+
+  AudioError status = read_metadata(dec, file, info);
+  if (status == AUDIO_SUCCESS) {
+    dec->scale = 1.0 / (double)(1u << (dec->bps - 1));
+    dec->capacity = 2 * dec->frame_bound;
+    if (dec->capacity < READ_CHUNK)
+      dec->capacity = READ_CHUNK;
+    dec->input = (uint8_t *)audio_alloc(dec->capacity + INPUT_SLACK);
+    dec->block = (int32_t *)audio_alloc(dec->channels * dec->max_block *
+                                        sizeof(int32_t));
+    if (!dec->input || !dec->block)
+      status = AUDIO_ERROR_MEMORY_ERROR;
+    else
+      memset(dec->input + dec->capacity, 0, INPUT_SLACK);
+  }
+
+  // Streams written without knowing their length (e.g. from a pipe) leave
+  // the total at zero; count it by decoding once
+  if (status == AUDIO_SUCCESS && dec->total == 0) {
+    uint64_t frames = 0;
+    int result;
+    while ((result = decode_frame(dec)) > 0)
+      frames += dec->block_frames;
+    if (result < 0)
+      status = dec->status;
+    else if (fseek(file, dec->first_frame, SEEK_SET) != 0)
+      status = AUDIO_ERROR_READ_ERROR;
+    reset_input(dec);
+    dec->total = frames;
+    info->frames = (size_t)frames;
+    info->data_size = info->frames * info->block_align;
+  }
+
+  if (status != AUDIO_SUCCESS) {
+    flac_decoder_free(dec);
+    if (error)
+      *error = status;
+    return NULL;
+  }
+
+  if (error)
+    *error = AUDIO_SUCCESS;
+  return dec;
+}
+
+size_t flac_decoder_read(FlacDecoder *dec, double *output, size_t frames) {
+  if (!dec || !output)
+    return 0;
+
+  const int channels = dec->channels;
+  const double scale = dec->scale;
+  size_t done = 0;
+  while (done < frames) {
+    if (dec->block_used == dec->block_frames && decode_frame(dec) <= 0)
+      break;
+
+    size_t count = dec->block_frames - dec->block_used;
+    if (count > frames - done)
+      count = frames - done;
+    for (int c = 0; c < channels; c++) {
+      const int32_t *src = dec->block + c * dec->max_block + dec->block_used;
+      double *dst = output + done * channels + c;
+      for (size_t i = 0; i < count; i++)
+        dst[i * channels] = src[i] * scale;
+    }
+    dec->block_used += count;
+    dec->position += count;
+    done += count;
+  }
+  return done;
+}
+
+AudioError flac_decoder_seek(FlacDecoder *dec, size_t frame) {
+  if (!dec)
+    return AUDIO_ERROR_INVALID_PARAMETER;
+  if (dec->total && frame > dec->total)
+    frame = (size_t)dec->total;
+
+  // Inside the decoded block
+  uint64_t block_start = dec->position - dec->block_used;
+  if (dec->status == AUDIO_SUCCESS && frame >= block_start &&
+      frame < block_start + dec->block_frames) {
+    dec->block_used = (size_t)(frame - block_start);
+    dec->position = frame;
+    return AUDIO_SUCCESS;
+  }
+
+  // Restart from the closest seek point (or the first frame) unless
+  // decoding forward from here is closer
+  SeekPoint restart = {0, 0};
+  for (size_t i = 0; i < dec->num_seek_points; i++) {
+    const SeekPoint *sp = &dec->seek_points[i];
+    if (sp->sample <= frame && sp->sample >= restart.sample)
+      restart = *sp;
+  }
+  if (dec->status != AUDIO_SUCCESS || frame < dec->position ||
+      restart.sample > dec->position) {
+    if (fseek(dec->file, dec->first_frame + (long)restart.offset,
+              SEEK_SET) != 0)
+      return AUDIO_ERROR_READ_ERROR;
+    reset_input(dec);
+    dec->position = restart.sample;
+  } else {
+    // Skip the rest of the current block
+    dec->position += dec->block_frames - dec->block_used;
+    dec->block_used = dec->block_frames;
+  }
+
+  // Decode whole frames until the one holding the target
+  while (dec->position < frame) {
+    int result = decode_frame(dec);
+    if (result < 0)
+      return dec->status;
+    if (result == 0)
+      break;
+    if (frame - dec->position < dec->block_frames) {
+      dec->block_used = (size_t)(frame - dec->position);
+      dec->position = frame;
+      return AUDIO_SUCCESS;
+    }
+    dec->position += dec->block_frames;
+    dec->block_used = dec->block_frames;
+  }
+  return dec->position == frame ? AUDIO_SUCCESS : AUDIO_ERROR_READ_ERROR;
+}
+
+AudioError flac_decoder_status(const FlacDecoder *dec) {
+  return dec ? dec->status : AUDIO_ERROR_INVALID_PARAMETER;
+}
+
+void flac_decoder_free(FlacDecoder *dec) {
+  if (!dec)
+    return;
+  audio_free(dec->input);
+  audio_free(dec->block);
+  free(dec->seek_points);
+  free(dec);
+}
+
+// ---------------------------------------------------------------------------
+// Encoder
+
+// MSB-first writer into a buffer sized for the worst-case frame
+typedef struct {
+  uint8_t *data;
+  size_t length;         // Whole bytes written
+  uint64_t acc;          // Pending bits (fewer than 8 between calls)
+  int bits;
+} BitWriter;
+
+// Append the low `n` (0-32) bits of value
+static inline void bw_put(BitWriter *bw, uint32_t value, int n) {
+  if (n == 0)
+    return;
+  bw->acc = (bw->acc << n) | (value & (0xFFFFFFFFu >> (32 - n)));
+  bw->bits += n;
+  while (bw->bits >= 8) {
+    bw->bits -= 8;
+    bw->data[bw->length++] = (uint8_t)(bw->acc >> bw->bits);
+  }
+}
+
+// Pad with zeros to a byte boundary
+static void bw_align(BitWriter *bw) {
+  if (bw->bits)
+    bw_put(bw, 0, 8 - bw->bits);
+}
+
+static inline uint32_t zigzag(int32_t value) {
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static inline int ilog2(uint64_t value) {
+  return value ? 63 - __builtin_clzll(value) : 0;
+}
+
+// Rice parameter for `count` values summing to `sum`, and its cost in bits
+// (estimated: sum >> k undercounts the quotients by less than count)
+static int rice_parameter(uint64_t sum, size_t count, uint64_t *bits) {
+  int k = count ? ilog2(sum / count) : 0;
+  if (k > 30)
+    k = 30;
+  uint64_t best = count * (uint64_t)(k + 1) + (sum >> k);
+  if (k > 0) {
+    uint64_t lower = count * (uint64_t)k + (sum >> (k - 1));
+    if (lower < best) {
+      best = lower;
+      k--;
+    }
+  }
+  *bits = best;
+  return k;
+}
+
+// Pick the fixed predictor order (0 to 4) with the smallest residual;
+// *bits receives an estimate of the coded size. Blocks of four samples or
+// fewer are left to order 0.
+static int best_fixed_order(const int32_t *x, size_t n, uint64_t *bits) {
+  uint64_t sums[5] = {0, 0, 0, 0, 0};
+
+  // Too short to warm up the predictors (a file's final block can be a few
+  // frames): code the samples as they are
+  if (n <= 4) {
+    for (size_t i = 0; i < n; i++)
+      sums[0] += (uint64_t)llabs(x[i]);
+    rice_parameter(2 * sums[0], n, bits);
+    return 0;
+  }
+
+  int max_order = 4;
+  for (size_t i = max_order; i < n; i++) {
+    int64_t e0 = x[i];
+    int64_t e1 = e0 - x[i - 1];
+    int64_t e2 = e1 - ((int64_t)x[i - 1] - x[i - 2]);
+    int64_t e3 = e2 - ((int64_t)x[i - 1] - 2 * (int64_t)x[i - 2] + x[i - 3]);
+    int64_t e4 = e3 - ((int64_t)x[i - 1] - 3 * (int64_t)x[i - 2] +
+                       3 * (int64_t)x[i - 3] - x[i - 4]);
+    sums[0] += (uint64_t)llabs(e0);
+    sums[1] += (uint64_t)llabs(e1);
+    sums[2] += (uint64_t)llabs(e2);
+    sums[3] += (uint64_t)llabs(e3);
+    sums[4] += (uint64_t)llabs(e4);
+  }
+
+  int best = 0;
+  for (int order = 1; order <= max_order; order++) {
+    if (sums[order] < sums[best])
+      best = order;
+  }
+  // Zigzag coding doubles magnitudes
+  rice_parameter(2 * sums[best], n - max_order, bits);
+  return best;
+}
+
+// Residual of a fixed predictor for s[order..n)
+static void fixed_residual(const int32_t *restrict x, int32_t *restrict r,
+                           size_t n, int order) {
+  switch (order) {
+  case 0:
+    for (size_t i = 0; i < n; i++)
+      r[i] = x[i];
+    break;
+  case 1:
+    for (size_t i = 1; i < n; i++)
+      r[i] = x[i] - x[i - 1];
+    break;
+  case 2:
+    for (size_t i = 2; i < n; i++)
+      r[i] = x[i] - 2 * x[i - 1] + x[i - 2];
+    break;
+  case 3:
+    for (size_t i = 3; i < n; i++)
+      r[i] = x[i] - 3 * (x[i - 1] - x[i - 2]) - x[i - 3];
+    break;
+  case 4:
+    for (size_t i = 4; i < n; i++)
+      r[i] = x[i] - 4 * (x[i - 1] + x[i - 3]) + 6 * x[i - 2] + x[i - 4];
+    break;
+  }
+}
+
+struct FlacEncoder {
+  FILE *file;
+  int sample_rate;
+  int channels;
+  int bps;
+  int32_t *pending;      // Planar block being filled, FLAC_BLOCK_SIZE apart
+  size_t pending_frames;
+  int32_t *signals;      // Mid and side of a stereo block
+  int32_t *residual;
+  uint8_t *frame;        // Encoded frame
+  uint64_t total;        // Frames encoded
+  uint32_t frame_number;
+  uint32_t min_frame;
+  uint32_t max_frame;
+  AudioError status;
+};
+
+// Worst-case frame: verbatim subframes plus headers
+static size_t frame_capacity(int channels, int bps) {
+  return (size_t)FLAC_BLOCK_SIZE * channels * (bps + 1) / 8 +
+         64 * channels + 64;
+}
+
+// Residual partitioning chosen for one subframe
+typedef struct {
+  int order;             // Partition order
+  int method;            // 0 = 4-bit parameters, 1 = 5-bit
+  int params[1 << MAX_PARTITION_ORDER];
+} Partitioning;
+
+// Choose the partition order and Rice parameters for r[predictor..n)
+// Returns the exact size of the coded residual in bits
+static uint64_t choose_partitioning(const int32_t *r, size_t n, int predictor,
+                                    Partitioning *out) {
+  int max_order = 0;
+  while (max_order < MAX_PARTITION_ORDER && (n >> (max_order + 1)) > 0 &&
+         ((n >> (max_order + 1)) << (max_order + 1)) == n &&
+         (n >> (max_order + 1)) > (size_t)predictor)
+    max_order++;
+
+  // Sums of the finest partitioning, merged pairwise for coarser ones
+  uint64_t sums[1 << MAX_PARTITION_ORDER];
+  size_t size = n >> max_order;
+  for (size_t p = 0; p < ((size_t)1 << max_order); p++) {
+    size_t start = p == 0 ? (size_t)predictor : p * size;
+    uint64_t sum = 0;
+    for (size_t i = start; i < (p + 1) * size; i++)
+      sum += zigzag(r[i]);
+    sums[p] = sum;
+  }
+
+  uint64_t best_bits = UINT64_MAX;
+  for (int order = max_order; order >= 0; order--) {
+    size_t parts = (size_t)1 << order;
+    size_t part_size = n >> order;
+    if (order < max_order) {
+      for (size_t p = 0; p < parts; p++)
+        sums[p] = sums[2 * p] + sums[2 * p + 1];
+    }
+
+    int params[1 << MAX_PARTITION_ORDER];
+    int max_param = 0;
+    uint64_t bits = 0;
+    for (size_t p = 0; p < parts; p++) {
+      size_t count = p == 0 ? part_size - predictor : part_size;
+      uint64_t part_bits;
+      params[p] = rice_parameter(sums[p], count, &part_bits);
+      if (params[p] > max_param)
+        max_param = params[p];
+      bits += part_bits;
+    }
+    int method = max_param > 14;
+    bits += parts * (method ? 5 : 4);
+    if (bits < best_bits) {
+      best_bits = bits;
+      out->order = order;
+      out->method = method;
+      memcpy(out->params, params, parts * sizeof(int));
+    }
+  }
+
+  // Exact size, so the verbatim fallback bounds the frame
+  uint64_t bits = 6;
+  size_t parts = (size_t)1 << out->order;
+  size_t part_size = n >> out->order;
+  const int32_t *part = r + predictor;
+  for (size_t p = 0; p < parts; p++) {
+    size_t count = p == 0 ? part_size - predictor : part_size;
+    int k = out->params[p];
+    bits += (out->method ? 5 : 4) + count * (uint64_t)(k + 1);
+    for (size_t i = 0; i < count; i++)
+      bits += zigzag(part[i]) >> k;
+    part += count;
+  }
+  return bits;
+}
+
+static void write_residual(BitWriter *bw, const int32_t *r, size_t n,
+                           int predictor, const Partitioning *partitioning) {
+  bw_put(bw, (uint32_t)partitioning->method, 2);
+  bw_put(bw, (uint32_t)partitioning->order, 4);
+  size_t parts = (size_t)1 << partitioning->order;
+  size_t part_size = n >> partitioning->order;
+  const int32_t *part = r + predictor;
+  for (size_t p = 0; p < parts; p++) {
+    size_t count = p == 0 ? part_size - predictor : part_size;
+    int k = partitioning->params[p];
+    bw_put(bw, (uint32_t)k, partitioning->method ? 5 : 4);
+    for (size_t i = 0; i < count; i++) {
+      uint32_t value = zigzag(part[i]);
+      uint32_t quotient = value >> k;
+      // Unary quotient, stop bit and remainder, in one put when they fit
+      if (quotient + 1 + k <= 32) {
+        bw_put(bw, (1u << k) | (value & ((1u << k) - 1)),
+               (int)quotient + 1 + k);
+      } else {
+        for (; quotient >= 32; quotient -= 32)
+          bw_put(bw, 0, 32);
+        bw_put(bw, 0, (int)quotient);
+        bw_put(bw, 1, 1);
+        bw_put(bw, value, k);
+      }
+    }
+    part += count;
+  }
+}
+
+// Encode one channel of n samples at bps bits as the cheapest subframe
+static void encode_subframe(FlacEncoder *enc, BitWriter *bw, const int32_t *x,
+                            size_t n, int bps, int order) {
+  int constant = 1;
+  for (size_t i = 1; i < n && constant; i++)
+    constant = x[i] == x[0];
+  if (constant) {
+    bw_put(bw, 0x00, 8);
+    bw_put(bw, (uint32_t)x[0], bps);
+    return;
+  }
+
+  Partitioning partitioning;
+  fixed_residual(x, enc->residual, n, order);
+  uint64_t bits = 8 + (uint64_t)order * bps +
+                  choose_partitioning(enc->residual, n, order, &partitioning);
+  if (bits >= 8 + (uint64_t)n * bps) {
+    bw_put(bw, 0x02, 8);
+    for (size_t i = 0; i < n; i++)
+      bw_put(bw, (uint32_t)x[i], bps);
+    return;
+  }
+
+  bw_put(bw, (uint32_t)(8 + order) << 1, 8);
+  for (int i = 0; i < order; i++)
+    bw_put(bw, (uint32_t)x[i], bps);
+  write_residual(bw, enc->residual, n, order, &partitioning);
+}
+
+// Header codes for the common sample rates (0 = as in STREAMINFO)
+static uint32_t rate_code(int sample_rate) {
+  static const int rates[12] = {0,     88200, 176400, 192000, 8000,  16000,
+                                22050, 24000, 32000,  44100,  48000, 96000};
+  for (uint32_t code = 1; code < 12; code++) {
+    if (rates[code] == sample_rate)
+      return code;
+  }
+  return 0;
+}
+
+// Encode and write the pending block
+static int encode_frame(FlacEncoder *enc) {
+  size_t n = enc->pending_frames;
+  BitWriter bw = {enc->frame, 0, 0, 0};
+
+  // Stereo: code the cheapest pair of left, right, mid and side
+  const int32_t *signals[FLAC_MAX_CHANNELS];
+  int orders[FLAC_MAX_CHANNELS];
+  int side_channel = -1;
+  int assignment = enc->channels - 1;
+  if (enc->channels == 2) {
+    const int32_t *left = enc->pending;
+    const int32_t *right = enc->pending + FLAC_BLOCK_SIZE;
+    int32_t *mid = enc->signals;
+    int32_t *side = enc->signals + FLAC_BLOCK_SIZE;
+    for (size_t i = 0; i < n; i++) {
+      mid[i] = (left[i] + right[i]) >> 1;
+      side[i] = left[i] - right[i];
+    }
+
+    uint64_t bits[4];
+    int best[4];
+    const int32_t *candidates[4] = {left, right, mid, side};
+    for (int s = 0; s < 4; s++) {
+      // A channel never costs more than its verbatim samples
+      uint64_t verbatim = (uint64_t)n * (enc->bps + (s == 3));
+      best[s] = best_fixed_order(candidates[s], n, &bits[s]);
+      if (bits[s] > verbatim)
+        bits[s] = verbatim;
+    }
+
+    // Pairs in channel assignment order: independent, L/S, R/S, M/S
+    static const int pairs[4][2] = {{0, 1}, {0, 3}, {3, 1}, {2, 3}};
+    static const int codes[4] = {1, LEFT_SIDE, RIGHT_SIDE, MID_SIDE};
+    int choice = 0;
+    for (int p = 1; p < 4; p++) {
+      if (bits[pairs[p][0]] + bits[pairs[p][1]] <
+          bits[pairs[choice][0]] + bits[pairs[choice][1]])
+        choice = p;
+    }
+    for (int c = 0; c < 2; c++) {
+      signals[c] = candidates[pairs[choice][c]];
+      orders[c] = best[pairs[choice][c]];
+    }
+    assignment = codes[choice];
+    if (choice > 0)
+      side_channel = pairs[choice][0] == 3 ? 0 : 1;
+  } else {
+    for (int c = 0; c < enc->channels; c++) {
+      uint64_t bits;
+      signals[c] = enc->pending + c * FLAC_BLOCK_SIZE;
+      orders[c] = best_fixed_order(signals[c], n, &bits);
+    }
+  }
+
+  // Frame header
+  static const uint32_t depth_codes[25] = {[8] = 1, [16] = 4, [24] = 6};
+  bw_put(&bw, 0xFFF8, 16);
+  if (n == FLAC_BLOCK_SIZE)
+    bw_put(&bw, 12, 4); // 256 << 4
+  else
+    bw_put(&bw, 7, 4);  // 16-bit size at the end of the header
+  bw_put(&bw, rate_code(enc->sample_rate), 4);
+  bw_put(&bw, (uint32_t)assignment, 4);
+  bw_put(&bw, depth_codes[enc->bps], 3);
+  bw_put(&bw, 0, 1);
+
+  // Frame number, UTF-8 style
+  uint32_t number = enc->frame_number;
+  if (number < 0x80) {
+    bw_put(&bw, number, 8);
+  } else {
+    int extra = 1;
+    while (extra < 5 && number >= (1u << (5 * extra + 6)))
+      extra++;
+    bw_put(&bw, (0xFF00u >> (extra + 1)) | (number >> (6 * extra)), 8);
+    for (int i = extra - 1; i >= 0; i--)
+      bw_put(&bw, 0x80 | ((number >> (6 * i)) & 0x3F), 8);
+  }
+  if (n != FLAC_BLOCK_SIZE)
+    bw_put(&bw, (uint32_t)n - 1, 16);
+  bw_put(&bw, crc8(bw.data, bw.length), 8);
+
+  for (int c = 0; c < enc->channels; c++)
+    encode_subframe(enc, &bw, signals[c], n, enc->bps + (c == side_channel),
+                    orders[c]);
+
+  bw_align(&bw);
+  uint16_t crc = crc16(bw.data, bw.length);
+  bw_put(&bw, crc, 16);
+
+  if (fwrite(bw.data, 1, bw.length, enc->file) != bw.length) {
+    enc->status = AUDIO_ERROR_WRITE_ERROR;
+    return 0;
+  }
+  if (enc->frame_number == 0 || bw.length < enc->min_frame)
+    enc->min_frame = (uint32_t)bw.length;
+  if (bw.length > enc->max_frame)
+    enc->max_frame = (uint32_t)bw.length;
+  enc->frame_number++;
+  enc->total += n;
+  enc->pending_frames = 0;
+  return 1;
+}
+
+// The "fLaC" marker and a STREAMINFO block for the frames written so far
+static int write_stream_header(FlacEncoder *enc) {
+  uint8_t header[8 + STREAMINFO_SIZE];
+  memcpy(header, "fLaC", 4);
+  header[4] = 0x80 | BLOCK_STREAMINFO; // Last metadata block
+  be_write(header + 5, STREAMINFO_SIZE, 3);
+
+  uint8_t *si = header + 8;
+  memset(si, 0, STREAMINFO_SIZE);
+  be_write(si, FLAC_BLOCK_SIZE, 2);
+  be_write(si + 2, FLAC_BLOCK_SIZE, 2);
+  be_write(si + 4, enc->min_frame, 3);
+  be_write(si + 7, enc->max_frame, 3);
+  // Rate (20 bits), channels - 1 (3), bits - 1 (5), total samples (36)
+  uint64_t packed = ((uint64_t)enc->sample_rate << 44) |
+                    ((uint64_t)(enc->channels - 1) << 41) |
+                    ((uint64_t)(enc->bps - 1) << 36) |
+                    (enc->total & 0xFFFFFFFFFull);
+  be_write(si + 10, packed, 8);
+  // MD5 signature left zero: unknown
+
+  return fwrite(header, 1, sizeof(header), enc->file) == sizeof(header);
+}
+
+FlacEncoder *flac_encoder_open(FILE *file, int sample_rate, int channels,
+                               int bit_depth, AudioError *error) {
+  if (!file || sample_rate <= 0 || sample_rate >= (1 << 20) || channels < 1 ||
+      channels > FLAC_MAX_CHANNELS) {
+    if (error)
+      *error = AUDIO_ERROR_INVALID_PARAMETER;
+    return NULL;
+  }
+  if (bit_depth != 8 && bit_depth != 16 && bit_depth != 24) {
+    if (error)
+      *error = AUDIO_ERROR_UNSUPPORTED_FORMAT;
+    return NULL;
+  }
+  pthread_once(&crc_once, crc_init);
+
+  FlacEncoder *enc = (FlacEncoder *)calloc(1, sizeof(FlacEncoder));
+  if (!enc) {
+    if (error)
+      *error = AUDIO_ERROR_MEMORY_ERROR;
+    return NULL;
+  }
+  enc->file = file;
+  enc->sample_rate = sample_rate;
+  enc->channels = channels;
+  enc->bps = bit_depth;
+  enc->status = AUDIO_SUCCESS;
+
+  size_t block_bytes = FLAC_BLOCK_SIZE * sizeof(int32_t);
+  enc->pending = (int32_t *)audio_alloc(channels * block_bytes);
+  enc->signals = (int32_t *)audio_alloc(2 * block_bytes);
+  enc->residual = (int32_t *)audio_alloc(block_bytes);
+  enc->frame = (uint8_t *)audio_alloc(frame_capacity(channels, bit_depth));
+  if (!enc->pending || !enc->signals || !enc->residual || !enc->frame) {
+    flac_encoder_free(enc);
+    if (error)
+      *error = AUDIO_ERROR_MEMORY_ERROR;
+    return NULL;
+  }
+
+  if (!write_stream_header(enc)) {
+    flac_encoder_free(enc);
+    if (error)
+      *error = AUDIO_ERROR_WRITE_ERROR;
+    return NULL;
+  }
+
+  if (error)
+    *error = AUDIO_SUCCESS;
+  return enc;
+}
+
+AudioError flac_encoder_write(FlacEncoder *enc, const double *input,
+                              size_t frames) {
+  if (!enc || !input)
+    return AUDIO_ERROR_INVALID_PARAMETER;
+  if (enc->status != AUDIO_SUCCESS)
+    return enc->status;
+
+  // Same quantization as float64_to_pcm
+  const int channels = enc->channels;
+  const double scale = (double)((1 << (enc->bps - 1)) - 1);
+  while (frames > 0) {
+    size_t count = FLAC_BLOCK_SIZE - enc->pending_frames;
+    if (count > frames)
+      count = frames;
+
+    for (int c = 0; c < channels; c++) {
+      int32_t *dst = enc->pending + c * FLAC_BLOCK_SIZE + enc->pending_frames;
+      const double *src = input + c;
+      if (enc->bps == 8) {
+        // Unsigned 8-bit WAV samples are offset by 128 before truncation
+        for (size_t i = 0; i < count; i++) {
+          double clamped = fmax(-1.0, fmin(1.0, src[i * channels]));
+          int32_t value = (int32_t)(clamped * 128.0 + 128.0) - 128;
+          dst[i] = value > 127 ? 127 : value;
+        }
+      } else {
+        for (size_t i = 0; i < count; i++) {
+          double clamped = fmax(-1.0, fmin(1.0, src[i * channels]));
+          dst[i] = (int32_t)(clamped * scale);
+        }
+      }
+    }
+
+    input += count * channels;
+    frames -= count;
+    enc->pending_frames += count;
+    if (enc->pending_frames == FLAC_BLOCK_SIZE && !encode_frame(enc))
+      return enc->status;
+  }
+  return AUDIO_SUCCESS;
+}
+
+AudioError flac_encoder_finish(FlacEncoder *enc) {
+  if (!enc)
+    return AUDIO_ERROR_INVALID_PARAMETER;
+  if (enc->status != AUDIO_SUCCESS)
+    return enc->status;
+
+  if (enc->pending_frames > 0 && !encode_frame(enc))
+    return enc->status;
+  if (fseek(enc->file, 0, SEEK_SET) != 0 || !write_stream_header(enc) ||
+      fseek(enc->file, 0, SEEK_END) != 0)
+    enc->status = AUDIO_ERROR_WRITE_ERROR;
+  return enc->status;
+}
+
+void flac_encoder_free(FlacEncoder *enc) {
+  if (!enc)
+    return;
+  audio_free(enc->pending);
+  audio_free(enc->signals);
+  audio_free(enc->residual);
+  audio_free(enc->frame);
+  free(enc);
+}
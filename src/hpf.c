@@ -34,6 +34,13 @@ static void calculate_butterworth_coefficients(BiQuad *bq, double sample_rate,
   biquad_flush_delays(bq);
 }
 
+// Give the channels beyond stereo the (freshly flushed) left filter
+static void reset_extra_channels(HPFFilter *hpf) {
+  for (int c = 0; c < BIQUAD_MAX_CHANNELS - 2; c++) {
+    hpf->extra[c] = hpf->left;
+  }
+}
+
 // Initialize HPF filter
 void hpf_init(HPFFilter *hpf, double sample_rate, double freq) {
   if (!hpf)
@@ -49,6 +56,7 @@ void hpf_init(HPFFilter *hpf, double sample_rate, double freq) {
   // Calculate and set coefficients for both channels
   calculate_butterworth_coefficients(&hpf->left, sample_rate, freq);
   calculate_butterworth_coefficients(&hpf->right, sample_rate, freq);
+  reset_extra_channels(hpf);
 
 #ifdef USE_MLIR
   // Create MLIR JIT contexts for optimized processing
@@ -70,6 +78,7 @@ void hpf_update_coefficients(HPFFilter *hpf, double sample_rate, double freq) {
   hpf->frequency = freq;
   calculate_butterworth_coefficients(&hpf->left, sample_rate, freq);
   calculate_butterworth_coefficients(&hpf->right, sample_rate, freq);
+  reset_extra_channels(hpf);
 
 #ifdef USE_MLIR
   // Recreate JIT contexts with new coefficients
@@ -84,6 +93,23 @@ void hpf_update_coefficients(HPFFilter *hpf, double sample_rate, double freq) {
 #endif
 }
 
+// Retune without touching filter state
+void hpf_retune(HPFFilter *hpf, double sample_rate, double freq) {
+  if (!hpf)
+    return;
+
+  BiQuad design;
+  biquad_init(&design);
+  calculate_butterworth_coefficients(&design, sample_rate, freq);
+
+  hpf->frequency = freq;
+  biquad_copy_coefficients(&hpf->left, &design);
+  biquad_copy_coefficients(&hpf->right, &design);
+  for (int c = 0; c < BIQUAD_MAX_CHANNELS - 2; c++) {
+    biquad_copy_coefficients(&hpf->extra[c], &design);
+  }
+}
+
 // Process a single channel of audio
 void hpf_process_channel(HPFFilter *hpf, double *data, size_t length,
                          int channel) {
@@ -176,13 +202,58 @@ void hpf_process_buffer(HPFFilter *hpf, AudioBuffer *buffer) {
       }
     }
   } else {
-    // Multi-channel: alternate between left and right filters
+    // Multi-channel: one filter per channel
     for (size_t i = 0; i < buffer->length; i++) {
-      int channel = i % buffer->channels;
-      BiQuad *filter = (channel % 2 == 0) ? &hpf->left : &hpf->right;
+      BiQuad *filter = hpf_channel_filter(hpf, (int)(i % buffer->channels));
+      if (!filter)
+        continue;
       double input = buffer->data[i];
       double filtered = biquad_process(filter, input);
       buffer->data[i] = filtered * filter->c0 + input * filter->d0;
     }
   }
 }
+
+// Process a view of an audio buffer
+void hpf_process_view(HPFFilter *hpf, const AudioBufferView *view) {
+  if (!hpf || !view || !view->data)
+    return;
+
+  for (int c = 0; c < view->channels; c++) {
+    int channel = view->first_channel + c;
+    BiQuad *filter = hpf_channel_filter(hpf, channel);
+    if (!filter)
+      break;
+
+#ifdef USE_MLIR
+    // Kernels take the state per call, so the pair serves every channel
+    MLIRBiQuadJIT *jit = (channel % 2 == 0) ? hpf->left_jit : hpf->right_jit;
+    if (jit) {
+      mlir_biquad_process_strided(jit, filter, view->data + c, view->frames,
+                                  view->stride);
+      continue;
+    }
+#endif
+
+    biquad_process_strided(filter, view->data + c, view->frames, view->stride);
+  }
+}
+
+// Filter state of a source channel
+BiQuad *hpf_channel_filter(HPFFilter *hpf, int channel) {
+  if (!hpf || channel < 0 || channel >= BIQUAD_MAX_CHANNELS)
+    return NULL;
+  if (channel == 0)
+    return &hpf->left;
+  if (channel == 1)
+    return &hpf->right;
+  return &hpf->extra[channel - 2];
+}
+
+// Frames needed to settle the filter state
+size_t hpf_warmup_frames(double sample_rate, double freq) {
+  BiQuad bq;
+  biquad_init(&bq);
+  calculate_butterworth_coefficients(&bq, sample_rate, freq);
+  return biquad_decay_length(&bq, BIQUAD_SETTLE_THRESHOLD);
+}
@@ -34,6 +34,13 @@ static void calculate_butterworth_coefficients(BiQuad *bq, double sample_rate,
   biquad_flush_delays(bq);
 }
 
+// Give the channels beyond stereo the (freshly flushed) left filter
+static void reset_extra_channels(LPFFilter *lpf) {
+  for (int c = 0; c < BIQUAD_MAX_CHANNELS - 2; c++) {
+    lpf->extra[c] = lpf->left;
+  }
+}
+
 // Initialize LPF filter
 void lpf_init(LPFFilter *lpf, double sample_rate, double freq) {
   if (!lpf)
@@ -49,6 +56,7 @@ void lpf_init(LPFFilter *lpf, double sample_rate, double freq) {
   // Calculate and set coefficients for both channels
   calculate_butterworth_coefficients(&lpf->left, sample_rate, freq);
   calculate_butterworth_coefficients(&lpf->right, sample_rate, freq);
+  reset_extra_channels(lpf);
 
 #ifdef USE_MLIR
   // Create MLIR JIT contexts for optimized processing
@@ -70,6 +78,7 @@ void lpf_update_coefficients(LPFFilter *lpf, double sample_rate, double freq) {
   lpf->frequency = freq;
   calculate_butterworth_coefficients(&lpf->left, sample_rate, freq);
   calculate_butterworth_coefficients(&lpf->right, sample_rate, freq);
+  reset_extra_channels(lpf);
 
 #ifdef USE_MLIR
   // Recreate JIT contexts with new coefficients
@@ -84,6 +93,23 @@ void lpf_update_coefficients(LPFFilter *lpf, double sample_rate, double freq) {
 #endif
 }
 
+// Retune without touching filter state
+void lpf_retune(LPFFilter *lpf, double sample_rate, double freq) {
+  if (!lpf)
+    return;
+
+  BiQuad design;
+  biquad_init(&design);
+  calculate_butterworth_coefficients(&design, sample_rate, freq);
+
+  lpf->frequency = freq;
+  biquad_copy_coefficients(&lpf->left, &design);
+  biquad_copy_coefficients(&lpf->right, &design);
+  for (int c = 0; c < BIQUAD_MAX_CHANNELS - 2; c++) {
+    biquad_copy_coefficients(&lpf->extra[c], &design);
+  }
+}
+
 // Process a single channel of audio
 void lpf_process_channel(LPFFilter *lpf, double *data, size_t length,
                          int channel) {
@@ -173,13 +199,58 @@ void lpf_process_buffer(LPFFilter *lpf, AudioBuffer *buffer) {
       }
     }
   } else {
-    // Multi-channel: alternate between left and right filters
+    // Multi-channel: one filter per channel
     for (size_t i = 0; i < buffer->length; i++) {
-      int channel = i % buffer->channels;
-      BiQuad *filter = (channel % 2 == 0) ? &lpf->left : &lpf->right;
+      BiQuad *filter = lpf_channel_filter(lpf, (int)(i % buffer->channels));
+      if (!filter)
+        continue;
       double input = buffer->data[i];
       double filtered = biquad_process(filter, input);
       buffer->data[i] = filtered * filter->c0 + input * filter->d0;
     }
   }
 }
+
+// Process a view of an audio buffer
+void lpf_process_view(LPFFilter *lpf, const AudioBufferView *view) {
+  if (!lpf || !view || !view->data)
+    return;
+
+  for (int c = 0; c < view->channels; c++) {
+    int channel = view->first_channel + c;
+    BiQuad *filter = lpf_channel_filter(lpf, channel);
+    if (!filter)
+      break;
+
+#ifdef USE_MLIR
+    // Kernels take the state per call, so the pair serves every channel
+    MLIRBiQuadJIT *jit = (channel % 2 == 0) ? lpf->left_jit : lpf->right_jit;
+    if (jit) {
+      mlir_biquad_process_strided(jit, filter, view->data + c, view->frames,
+                                  view->stride);
+      continue;
+    }
+#endif
+
+    biquad_process_strided(filter, view->data + c, view->frames, view->stride);
+  }
+}
+
+// Filter state of a source channel
+BiQuad *lpf_channel_filter(LPFFilter *lpf, int channel) {
+  if (!lpf || channel < 0 || channel >= BIQUAD_MAX_CHANNELS)
+    return NULL;
+  if (channel == 0)
+    return &lpf->left;
+  if (channel == 1)
+    return &lpf->right;
+  return &lpf->extra[channel - 2];
+}
+
+// Frames needed to settle the filter state
+size_t lpf_warmup_frames(double sample_rate, double freq) {
+  BiQuad bq;
+  biquad_init(&bq);
+  calculate_butterworth_coefficients(&bq, sample_rate, freq);
+  return biquad_decay_length(&bq, BIQUAD_SETTLE_THRESHOLD);
+}
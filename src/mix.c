@@ -0,0 +1,125 @@
+#include "mix.h"
+#include "audio_alloc.h"
+#include "audio_view.h"
+#include <math.h>
+#include <string.h>
+
+// Initialize an empty mixer
+void audio_mixer_init(AudioMixer *mixer, size_t block_frames) {
+  if (!mixer)
+    return;
+
+  memset(mixer, 0, sizeof(AudioMixer));
+  mixer->block_frames = block_frames ? block_frames : AUDIO_MIX_BLOCK_FRAMES;
+  mixer->error = AUDIO_SUCCESS;
+}
+
+// Add an input; the first one fixes the mix format
+AudioError audio_mixer_add_input(AudioMixer *mixer, AudioReader *reader,
+                                 double gain_db, AudioChain *chain) {
+  if (!mixer || !reader)
+    return AUDIO_ERROR_INVALID_PARAMETER;
+  if (mixer->num_inputs == AUDIO_MIX_MAX_INPUTS)
+    return AUDIO_ERROR_INVALID_PARAMETER;
+
+  const AudioFileInfo *info = audio_reader_info(reader);
+  if (mixer->num_inputs == 0) {
+    mixer->sample_rate = info->sample_rate;
+    mixer->channels = info->channels;
+  } else if (info->sample_rate != mixer->sample_rate ||
+             info->channels != mixer->channels) {
+    return AUDIO_ERROR_UNSUPPORTED_FORMAT;
+  }
+
+  AudioMixInput *input = &mixer->inputs[mixer->num_inputs++];
+  input->reader = reader;
+  input->chain = chain;
+  input->gain = pow(10.0, gain_db / 20.0);
+  return AUDIO_SUCCESS;
+}
+
+// Written as a flat loop over restrict pointers so the compiler vectorizes
+// the multiply-add across SIMD lanes
+void audio_mix_accumulate(double *restrict dst, const double *restrict src,
+                          double gain, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    dst[i] += gain * src[i];
+  }
+}
+
+size_t audio_mixer_process(AudioMixer *mixer, const double **block) {
+  if (!mixer || mixer->num_inputs == 0 || mixer->error != AUDIO_SUCCESS)
+    return 0;
+
+  size_t samples = mixer->block_frames * mixer->channels;
+  if (!mixer->mix) {
+    mixer->mix = audio_alloc(samples * sizeof(double));
+    mixer->scratch = audio_alloc(samples * sizeof(double));
+    if (!mixer->mix || !mixer->scratch) {
+      audio_mixer_free(mixer);
+      mixer->error = AUDIO_ERROR_MEMORY_ERROR;
+      return 0;
+    }
+  }
+
+  memset(mixer->mix, 0, samples * sizeof(double));
+
+  // The block is as long as the longest input still running; shorter reads
+  // leave the tail of the mix block untouched (silence for that input)
+  size_t frames = 0;
+  for (int i = 0; i < mixer->num_inputs; i++) {
+    AudioMixInput *input = &mixer->inputs[i];
+    size_t read = audio_reader_read(input->reader, mixer->scratch,
+                                    mixer->block_frames);
+    // Only a clean end of input becomes silence
+    AudioError error = audio_reader_status(input->reader);
+    if (error != AUDIO_SUCCESS) {
+      mixer->error = error;
+      return 0;
+    }
+    if (read == 0)
+      continue;
+
+    if (input->chain) {
+      AudioBufferView view;
+      audio_view_wrap(&view, mixer->scratch, read, mixer->channels,
+                      mixer->sample_rate);
+      audio_chain_process_view(input->chain, &view);
+    }
+
+    audio_mix_accumulate(mixer->mix, mixer->scratch, input->gain,
+                         read * mixer->channels);
+    if (read > frames)
+      frames = read;
+  }
+
+  if (block)
+    *block = mixer->mix;
+  return frames;
+}
+
+AudioError audio_mixer_run(AudioMixer *mixer, AudioWriter *writer) {
+  if (!mixer || !writer || mixer->num_inputs == 0)
+    return AUDIO_ERROR_INVALID_PARAMETER;
+
+  const double *block;
+  size_t frames;
+  while ((frames = audio_mixer_process(mixer, &block)) > 0) {
+    AudioError error = audio_writer_write(writer, block, frames);
+    if (error != AUDIO_SUCCESS)
+      return error;
+  }
+
+  // So does a failed read or block allocation
+  return mixer->error;
+}
+
+void audio_mixer_free(AudioMixer *mixer) {
+  if (!mixer)
+    return;
+
+  audio_free(mixer->mix);
+  audio_free(mixer->scratch);
+  mixer->mix = NULL;
+  mixer->scratch = NULL;
+}
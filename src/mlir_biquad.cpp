@@ -1,8 +1,10 @@
 #include "mlir_biquad.h"
+#include "mlir_jit.h"
 
 #include <mlir/IR/Builders.h>
 #include <mlir/IR/BuiltinOps.h>
 #include <mlir/IR/MLIRContext.h>
+#include <mlir/IR/Verifier.h>
 #include <mlir/Dialect/Func/IR/FuncOps.h>
 #include <mlir/Dialect/Arith/IR/Arith.h>
 #include <mlir/Dialect/SCF/IR/SCF.h>
@@ -19,17 +21,36 @@
 #include <mlir/Transforms/Passes.h>
 #include <mlir/Dialect/Affine/Passes.h>
 
+#include <llvm/Config/llvm-config.h>
 #include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/ThreadPool.h>
 
+// llvm::DefaultThreadPool and ThreadPoolInterface are new in LLVM 19
+#if LLVM_VERSION_MAJOR < 19
+#error "The shared JIT compile pool needs LLVM/MLIR 19 or newer"
+#endif
+
+#include <algorithm>
 #include <memory>
+#include <mutex>
 
 using namespace mlir;
 
-// JIT context structure
-struct MLIRBiQuadJIT {
-    std::unique_ptr<MLIRContext> context;
+// One JIT entry point, compiled on first use
+struct JitEntryPoint {
+    std::once_flag once;
     std::unique_ptr<ExecutionEngine> engine;
+    void *fn = nullptr;
+};
 
+// Compiled BiQuad kernels
+// Coefficients and state are runtime arguments, so the generated code never
+// depends on the filter: one copy serves every MLIRBiQuadJIT handle. Each
+// entry point is generated and compiled separately the first time any
+// handle calls it, so buffer-only users never pay for the per-sample
+// kernel. Only the ExecutionEngine (the JIT-linked machine code) is kept;
+// the MLIR context and module are freed as soon as compilation finishes.
+struct BiQuadKernels {
     // Function pointer for single sample processing
     // Signature: (a0, a1, a2, b1, b2, input, xz1, xz2, yz1, yz2) -> yn
     typedef double (*BiQuadProcessFn)(double a0, double a1, double a2,
@@ -37,7 +58,7 @@ struct MLIRBiQuadJIT {
                                       double input,
                                       double xz1, double xz2,
                                       double yz1, double yz2);
-    BiQuadProcessFn process_fn;
+    JitEntryPoint process;
 
     // Function pointer for buffer processing
     // Signature: (input_ptr, output_ptr, length, a0, a1, a2, b1, b2,
@@ -47,20 +68,25 @@ struct MLIRBiQuadJIT {
                                           double a0, double a1, double a2,
                                           double b1, double b2,
                                           double *state);
-    BiQuadProcessBufferFn process_buffer_fn;
+    JitEntryPoint buffer;
+};
+
+// JIT handle: a reference to the shared kernels plus the entry points it
+// has resolved so far
+struct MLIRBiQuadJIT {
+    std::shared_ptr<BiQuadKernels> kernels;
+    BiQuadKernels::BiQuadProcessFn process_fn;
+    BiQuadKernels::BiQuadProcessBufferFn process_buffer_fn;
 
-    MLIRBiQuadJIT() : context(nullptr), engine(nullptr),
-                      process_fn(nullptr), process_buffer_fn(nullptr) {}
+    MLIRBiQuadJIT() : kernels(nullptr), process_fn(nullptr),
+                      process_buffer_fn(nullptr) {}
 };
 
 // Generate MLIR IR for BiQuad difference equation
 // yn = a0*input + a1*xz1 + a2*xz2 - b1*yz1 - b2*yz2
-static OwningOpRef<ModuleOp> createBiQuadModule(MLIRContext *context) {
+static void addProcessFunction(ModuleOp module, MLIRContext *context) {
     OpBuilder builder(context);
     auto loc = builder.getUnknownLoc();
-
-    // Create module
-    auto module = ModuleOp::create(loc);
     builder.setInsertionPointToEnd(module.getBody());
 
     // Build function type: (f64, f64, f64, f64, f64, f64, f64, f64, f64, f64) -> f64
@@ -111,8 +137,6 @@ static OwningOpRef<ModuleOp> createBiQuadModule(MLIRContext *context) {
 
     // Return output
     builder.create<func::ReturnOp>(loc, yn.getResult());
-
-    return module;
 }
 
 // Generate MLIR IR for buffer-level BiQuad processing
@@ -229,8 +253,48 @@ static void addBufferProcessFunction(ModuleOp module, MLIRContext *context) {
     builder.create<func::ReturnOp>(loc);
 }
 
+// Register LLVM IR translations and load the dialects used by JIT kernels
+static void loadJitDialects(MLIRContext *context) {
+    // Register all dialect translations FIRST
+    DialectRegistry registry;
+    registerAllToLLVMIRTranslations(registry);
+    context->appendDialectRegistry(registry);
+
+    // Now load required dialects
+    context->getOrLoadDialect<func::FuncDialect>();
+    context->getOrLoadDialect<arith::ArithDialect>();
+    context->getOrLoadDialect<scf::SCFDialect>();
+    context->getOrLoadDialect<LLVM::LLVMDialect>();
+}
+
+// LLVM native target registration is global state: do it exactly once
+static std::once_flag llvmTargetsOnce;
+
+static void initializeNativeTargets() {
+    std::call_once(llvmTargetsOnce, [] {
+        llvm::InitializeNativeTarget();
+        llvm::InitializeNativeTargetAsmPrinter();
+        llvm::InitializeNativeTargetAsmParser();
+    });
+}
+
+// Compile thread pool shared by every JIT context, so creating many kernels
+// concurrently does not spawn a pool of threads per context
+static llvm::ThreadPoolInterface &jitThreadPool() {
+    static llvm::DefaultThreadPool pool;
+    return pool;
+}
+
+std::unique_ptr<MLIRContext> createJitContext() {
+    auto context =
+        std::make_unique<MLIRContext>(MLIRContext::Threading::DISABLED);
+    context->setThreadPool(jitThreadPool());
+    loadJitDialects(context.get());
+    return context;
+}
+
 // Lower MLIR to LLVM dialect and create execution engine
-static std::unique_ptr<ExecutionEngine> createExecutionEngine(
+std::unique_ptr<ExecutionEngine> createExecutionEngine(
     OwningOpRef<ModuleOp> &module, MLIRContext *context) {
 
     // Create pass manager for lowering (translations already registered)
@@ -259,10 +323,8 @@ static std::unique_ptr<ExecutionEngine> createExecutionEngine(
     // fprintf(stderr, "After lowering:\n");
     // module->dump();
 
-    // Initialize LLVM targets for JIT
-    llvm::InitializeNativeTarget();
-    llvm::InitializeNativeTargetAsmPrinter();
-    llvm::InitializeNativeTargetAsmParser();
+    // Initialize LLVM targets for JIT (first caller only)
+    initializeNativeTargets();
 
     // Create execution engine with optimization level 3
     ExecutionEngineOptions options;
@@ -281,88 +343,112 @@ static std::unique_ptr<ExecutionEngine> createExecutionEngine(
     return std::move(*engine);
 }
 
-extern "C" {
-
-MLIRBiQuadJIT* mlir_biquad_jit_create(const BiQuad *bq) {
-    if (!bq) {
-        return nullptr;
-    }
-
-    auto jit = new MLIRBiQuadJIT();
-
-    // Create MLIR context
-    jit->context = std::make_unique<MLIRContext>();
-
-    // Register all dialect translations FIRST
-    DialectRegistry registry;
-    registerAllToLLVMIRTranslations(registry);
-    jit->context->appendDialectRegistry(registry);
-
-    // Now load required dialects
-    jit->context->getOrLoadDialect<func::FuncDialect>();
-    jit->context->getOrLoadDialect<arith::ArithDialect>();
-    jit->context->getOrLoadDialect<scf::SCFDialect>();
-    jit->context->getOrLoadDialect<LLVM::LLVMDialect>();
-
-    // Generate MLIR module for BiQuad processing
-    auto module = createBiQuadModule(jit->context.get());
-
-    // Add buffer processing function
-    addBufferProcessFunction(module.get(), jit->context.get());
-
-    // Verify module
-    if (module->verify().failed()) {
+// Generate, lower and JIT-compile a module holding a single entry point
+static void compileEntryPoint(JitEntryPoint &entry, const char *name,
+                              void (*addFunction)(ModuleOp, MLIRContext *)) {
+    // The context only lives for the duration of the compile
+    std::unique_ptr<MLIRContext> context = createJitContext();
+    OwningOpRef<ModuleOp> module =
+        ModuleOp::create(UnknownLoc::get(context.get()));
+    addFunction(module.get(), context.get());
+
+    // Verify module (and every op in it)
+    if (failed(mlir::verify(module->getOperation()))) {
         fprintf(stderr, "Module verification failed\n");
-        delete jit;
-        return nullptr;
+        return;
     }
 
     // Debug: Print module before lowering
     // module->dump();
 
     // Create execution engine and JIT compile
-    jit->engine = createExecutionEngine(module, jit->context.get());
-    if (!jit->engine) {
-        delete jit;
-        return nullptr;
+    auto engine = createExecutionEngine(module, context.get());
+    if (!engine) {
+        return;
     }
 
-    // Lookup JIT-compiled function
     // Use lookup (not lookupPacked) for proper C calling convention
-    auto maybeFn = jit->engine->lookup("biquad_process");
+    auto maybeFn = engine->lookup(name);
     if (!maybeFn) {
-        fprintf(stderr, "Failed to lookup biquad_process function\n");
-        delete jit;
-        return nullptr;
+        fprintf(stderr, "Failed to lookup %s function\n", name);
+        return;
     }
 
-    jit->process_fn = reinterpret_cast<MLIRBiQuadJIT::BiQuadProcessFn>(*maybeFn);
+    entry.engine = std::move(engine);
+    entry.fn = *maybeFn;
+}
+
+// Address of an entry point, compiling it on the first call from any handle
+// (concurrent first calls wait for a single compile)
+static void *resolveEntryPoint(JitEntryPoint &entry, const char *name,
+                               void (*addFunction)(ModuleOp, MLIRContext *)) {
+    std::call_once(entry.once,
+                   [&] { compileEntryPoint(entry, name, addFunction); });
+    return entry.fn;
+}
 
+static BiQuadKernels::BiQuadProcessFn processFn(MLIRBiQuadJIT *jit) {
     if (!jit->process_fn) {
-        fprintf(stderr, "JIT function pointer is null\n");
-        delete jit;
-        return nullptr;
+        jit->process_fn = reinterpret_cast<BiQuadKernels::BiQuadProcessFn>(
+            resolveEntryPoint(jit->kernels->process, "biquad_process",
+                              addProcessFunction));
     }
+    return jit->process_fn;
+}
 
-    // Lookup buffer processing function
-    auto maybeBufferFn = jit->engine->lookup("biquad_process_buffer");
-    if (maybeBufferFn) {
-        jit->process_buffer_fn = reinterpret_cast<MLIRBiQuadJIT::BiQuadProcessBufferFn>(*maybeBufferFn);
-    } else {
-        fprintf(stderr, "Warning: Buffer processing function not found, falling back to per-sample\n");
+static BiQuadKernels::BiQuadProcessBufferFn processBufferFn(
+    MLIRBiQuadJIT *jit) {
+    if (!jit->process_buffer_fn) {
+        jit->process_buffer_fn =
+            reinterpret_cast<BiQuadKernels::BiQuadProcessBufferFn>(
+                resolveEntryPoint(jit->kernels->buffer,
+                                  "biquad_process_buffer",
+                                  addBufferProcessFunction));
+    }
+    return jit->process_buffer_fn;
+}
+
+// Kernels shared by all live handles; freed with the last handle
+static std::mutex sharedKernelsMutex;
+static std::weak_ptr<BiQuadKernels> sharedKernels;
+
+static std::shared_ptr<BiQuadKernels> acquireKernels() {
+    std::lock_guard<std::mutex> lock(sharedKernelsMutex);
+    std::shared_ptr<BiQuadKernels> kernels = sharedKernels.lock();
+    if (!kernels) {
+        kernels = std::make_shared<BiQuadKernels>();
+        sharedKernels = kernels;
     }
+    return kernels;
+}
 
+extern "C" {
+
+MLIRBiQuadJIT* mlir_biquad_jit_create(const BiQuad *bq) {
+    if (!bq) {
+        return nullptr;
+    }
+
+    // Nothing is compiled here: entry points are built on first use
+    auto jit = new MLIRBiQuadJIT();
+    jit->kernels = acquireKernels();
     return jit;
 }
 
 double mlir_biquad_process(MLIRBiQuadJIT *jit, BiQuad *bq, double input) {
-    if (!jit || !jit->process_fn || !bq) {
+    if (!jit || !bq) {
         fprintf(stderr, "mlir_biquad_process: null pointer check failed\n");
         return 0.0;
     }
 
+    // Compile the per-sample kernel on first use; C if that failed
+    BiQuadKernels::BiQuadProcessFn process_fn = processFn(jit);
+    if (!process_fn) {
+        return biquad_process(bq, input);
+    }
+
     // Call JIT-compiled function with current coefficients and state
-    double yn = jit->process_fn(
+    double yn = process_fn(
         bq->a0, bq->a1, bq->a2,
         bq->b1, bq->b2,
         input,
@@ -390,15 +476,17 @@ void mlir_biquad_process_buffer(MLIRBiQuadJIT *jit, BiQuad *bq,
         return;
     }
 
-    // Use JIT-compiled buffer processing if available
-    if (jit->process_buffer_fn) {
+    // Use JIT-compiled buffer processing if available (compiled on first use)
+    BiQuadKernels::BiQuadProcessBufferFn process_buffer_fn =
+        processBufferFn(jit);
+    if (process_buffer_fn) {
         // Pack state into array for JIT function
         double state[4] = {bq->xz1, bq->xz2, bq->yz1, bq->yz2};
 
         // Call JIT-compiled buffer processing
-        jit->process_buffer_fn(input, output, (int64_t)length,
-                              bq->a0, bq->a1, bq->a2, bq->b1, bq->b2,
-                              state);
+        process_buffer_fn(input, output, (int64_t)length,
+                          bq->a0, bq->a1, bq->a2, bq->b1, bq->b2,
+                          state);
 
         // Update BiQuad state from array
         bq->xz1 = state[0];
@@ -417,6 +505,37 @@ void mlir_biquad_process_buffer(MLIRBiQuadJIT *jit, BiQuad *bq,
     }
 }
 
+void mlir_biquad_process_strided(MLIRBiQuadJIT *jit, BiQuad *bq,
+                                 double *data, size_t frames, size_t stride) {
+    if (!jit || !bq || !data) {
+        return;
+    }
+
+    // Wet/dry mix, as in biquad_process_strided
+    bool mix = bq->c0 != 1.0 || bq->d0 != 0.0;
+    if (stride == 1 && !mix) {
+        mlir_biquad_process_buffer(jit, bq, data, data, frames);
+        return;
+    }
+
+    // Gather into an L1-resident block, run the kernel, scatter back
+    constexpr size_t kBlock = 1024;
+    double block[kBlock];
+    double dry[kBlock];
+    for (size_t start = 0; start < frames; start += kBlock) {
+        size_t n = std::min(kBlock, frames - start);
+        double *src = data + start * stride;
+        for (size_t i = 0; i < n; i++) {
+            dry[i] = src[i * stride];
+        }
+        mlir_biquad_process_buffer(jit, bq, dry, block, n);
+        for (size_t i = 0; i < n; i++) {
+            src[i * stride] = mix ? block[i] * bq->c0 + dry[i] * bq->d0
+                                  : block[i];
+        }
+    }
+}
+
 void mlir_biquad_jit_destroy(MLIRBiQuadJIT *jit) {
     if (jit) {
         delete jit;
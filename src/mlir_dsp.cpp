@@ -0,0 +1,1671 @@
+// MLIR "dsp" dialect: chain-level ops, rewrite passes and loop lowering
+// Ops are defined directly in C++ (no TableGen) so the project keeps its
+// plain CMake build against the installed MLIR libraries.
+
+#include "mlir_dsp.h"
+#include "mlir_jit.h"
+
+#include <mlir/IR/Builders.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/Dialect.h>
+#include <mlir/IR/IRMapping.h>
+#include <mlir/IR/MLIRContext.h>
+#include <mlir/IR/OpDefinition.h>
+#include <mlir/IR/PatternMatch.h>
+#include <mlir/IR/Verifier.h>
+#include <mlir/Dialect/Func/IR/FuncOps.h>
+#include <mlir/Dialect/Arith/IR/Arith.h>
+#include <mlir/Dialect/SCF/IR/SCF.h>
+#include <mlir/Dialect/LLVMIR/LLVMDialect.h>
+#include <mlir/Pass/Pass.h>
+#include <mlir/Pass/PassManager.h>
+#include <mlir/Support/TypeID.h>
+#include <mlir/Transforms/GreedyPatternRewriteDriver.h>
+#include <llvm/Config/llvm-config.h>
+
+// applyPatternsGreedily replaced applyPatternsAndFoldGreedily in LLVM 20
+#if LLVM_VERSION_MAJOR < 20
+#error "The dsp dialect passes need LLVM/MLIR 20 or newer"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace mlir;
+
+namespace {
+
+// Coefficients per biquad section: [a0, a1, a2, b1, b2]
+constexpr size_t kSectionCoeffs = 5;
+
+// State slots per section: DF1 uses [xz1, xz2, yz1, yz2], TDF2 [s1, s2, -, -]
+constexpr int kStateSlots = 4;
+
+// Pole radius above which a section keeps Direct Form I (lowest round-off
+// noise for poles hugging the unit circle, e.g. low-frequency HPFs)
+constexpr double kDf1PoleRadius = 0.999;
+
+// dsp.biquad: one biquad section, y = biquad(x)
+class BiquadOp : public Op<BiquadOp, OpTrait::OneResult, OpTrait::OneOperand,
+                           OpTrait::ZeroRegions, OpTrait::ZeroSuccessors> {
+public:
+    using Op::Op;
+    MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(BiquadOp)
+
+    static constexpr llvm::StringLiteral getOperationName() {
+        return llvm::StringLiteral("dsp.biquad");
+    }
+    static ArrayRef<StringRef> getAttributeNames() {
+        static StringRef names[] = {"coeffs", "topology"};
+        return names;
+    }
+
+    static void build(OpBuilder &builder, OperationState &state, Value input,
+                      ArrayRef<double> coeffs) {
+        state.addOperands(input);
+        state.addAttribute("coeffs", builder.getDenseF64ArrayAttr(coeffs));
+        state.addTypes(input.getType());
+    }
+
+    Value getInput() { return getOperation()->getOperand(0); }
+    ArrayRef<double> getCoeffs() {
+        return cast<DenseF64ArrayAttr>(getOperation()->getAttr("coeffs"))
+            .asArrayRef();
+    }
+
+    LogicalResult verify() {
+        auto coeffs = dyn_cast_or_null<DenseF64ArrayAttr>(
+            getOperation()->getAttr("coeffs"));
+        if (!coeffs || coeffs.size() != (int64_t)kSectionCoeffs) {
+            return emitOpError("requires coeffs = [a0, a1, a2, b1, b2]");
+        }
+        if (!getInput().getType().isF64()) {
+            return emitOpError("operates on f64 samples");
+        }
+        return success();
+    }
+};
+
+// dsp.cascade: N biquad sections in series, coeffs holds 5*N values
+class CascadeOp : public Op<CascadeOp, OpTrait::OneResult, OpTrait::OneOperand,
+                            OpTrait::ZeroRegions, OpTrait::ZeroSuccessors> {
+public:
+    using Op::Op;
+    MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(CascadeOp)
+
+    static constexpr llvm::StringLiteral getOperationName() {
+        return llvm::StringLiteral("dsp.cascade");
+    }
+    static ArrayRef<StringRef> getAttributeNames() {
+        static StringRef names[] = {"coeffs", "topology"};
+        return names;
+    }
+
+    static void build(OpBuilder &builder, OperationState &state, Value input,
+                      ArrayRef<double> coeffs) {
+        state.addOperands(input);
+        state.addAttribute("coeffs", builder.getDenseF64ArrayAttr(coeffs));
+        state.addTypes(input.getType());
+    }
+
+    Value getInput() { return getOperation()->getOperand(0); }
+    ArrayRef<double> getCoeffs() {
+        return cast<DenseF64ArrayAttr>(getOperation()->getAttr("coeffs"))
+            .asArrayRef();
+    }
+
+    LogicalResult verify() {
+        auto coeffs = dyn_cast_or_null<DenseF64ArrayAttr>(
+            getOperation()->getAttr("coeffs"));
+        if (!coeffs || coeffs.empty() ||
+            coeffs.size() % (int64_t)kSectionCoeffs != 0) {
+            return emitOpError("requires 5 coefficients per section");
+        }
+        if (!getInput().getType().isF64()) {
+            return emitOpError("operates on f64 samples");
+        }
+        return success();
+    }
+};
+
+// dsp.gain: y = gain * x
+class GainOp : public Op<GainOp, OpTrait::OneResult, OpTrait::OneOperand,
+                         OpTrait::ZeroRegions, OpTrait::ZeroSuccessors> {
+public:
+    using Op::Op;
+    MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(GainOp)
+
+    static constexpr llvm::StringLiteral getOperationName() {
+        return llvm::StringLiteral("dsp.gain");
+    }
+    static ArrayRef<StringRef> getAttributeNames() {
+        static StringRef names[] = {"gain"};
+        return names;
+    }
+
+    static void build(OpBuilder &builder, OperationState &state, Value input,
+                      double gain) {
+        state.addOperands(input);
+        state.addAttribute("gain", builder.getF64FloatAttr(gain));
+        state.addTypes(input.getType());
+    }
+
+    Value getInput() { return getOperation()->getOperand(0); }
+    double getGain() {
+        return cast<FloatAttr>(getOperation()->getAttr("gain"))
+            .getValueAsDouble();
+    }
+
+    LogicalResult verify() {
+        if (!isa_and_nonnull<FloatAttr>(getOperation()->getAttr("gain"))) {
+            return emitOpError("requires a float gain attribute");
+        }
+        return success();
+    }
+};
+
+// dsp.mix: y = weights[0] * a + weights[1] * b (wet/dry and bus sums)
+class MixOp : public Op<MixOp, OpTrait::OneResult, OpTrait::NOperands<2>::Impl,
+                        OpTrait::ZeroRegions, OpTrait::ZeroSuccessors> {
+public:
+    using Op::Op;
+    MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(MixOp)
+
+    static constexpr llvm::StringLiteral getOperationName() {
+        return llvm::StringLiteral("dsp.mix");
+    }
+    static ArrayRef<StringRef> getAttributeNames() {
+        static StringRef names[] = {"weights"};
+        return names;
+    }
+
+    static void build(OpBuilder &builder, OperationState &state, Value a,
+                      Value b, double weightA, double weightB) {
+        state.addOperands({a, b});
+        state.addAttribute("weights",
+                           builder.getDenseF64ArrayAttr({weightA, weightB}));
+        state.addTypes(a.getType());
+    }
+
+    ArrayRef<double> getWeights() {
+        return cast<DenseF64ArrayAttr>(getOperation()->getAttr("weights"))
+            .asArrayRef();
+    }
+
+    LogicalResult verify() {
+        auto weights = dyn_cast_or_null<DenseF64ArrayAttr>(
+            getOperation()->getAttr("weights"));
+        if (!weights || weights.size() != 2) {
+            return emitOpError("requires two mix weights");
+        }
+        return success();
+    }
+};
+// dsp.convert_pcm: integer PCM <-> normalized f64
+// int -> f64 decodes (x / 2^(bits-1)); f64 -> int clamps and quantizes
+// (x * (2^(bits-1) - 1), truncating like float64_to_pcm), optionally adding
+// TPDF dither of +-1 LSB first
+class ConvertPcmOp
+    : public Op<ConvertPcmOp, OpTrait::OneResult, OpTrait::OneOperand,
+                OpTrait::ZeroRegions, OpTrait::ZeroSuccessors> {
+public:
+    using Op::Op;
+    MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(ConvertPcmOp)
+
+    static constexpr llvm::StringLiteral getOperationName() {
+        return llvm::StringLiteral("dsp.convert_pcm");
+    }
+    static ArrayRef<StringRef> getAttributeNames() {
+        static StringRef names[] = {"bits", "dither"};
+        return names;
+    }
+
+    static void build(OpBuilder &builder, OperationState &state, Value input,
+                      Type resultType, int bits, bool dither = false) {
+        state.addOperands(input);
+        state.addAttribute("bits", builder.getI32IntegerAttr(bits));
+        if (dither) {
+            state.addAttribute("dither", builder.getUnitAttr());
+        }
+        state.addTypes(resultType);
+    }
+
+    Value getInput() { return getOperation()->getOperand(0); }
+    int getBits() {
+        return (int)cast<IntegerAttr>(getOperation()->getAttr("bits")).getInt();
+    }
+    bool getDither() { return getOperation()->hasAttr("dither"); }
+
+    LogicalResult verify() {
+        auto bits = dyn_cast_or_null<IntegerAttr>(getOperation()->getAttr("bits"));
+        if (!bits || bits.getInt() < 8 || bits.getInt() > 32) {
+            return emitOpError("requires bits in [8, 32]");
+        }
+        Type in = getInput().getType();
+        Type out = getOperation()->getResult(0).getType();
+        bool decode = isa<IntegerType>(in) && out.isF64();
+        bool encode = in.isF64() && isa<IntegerType>(out);
+        if (!decode && !encode) {
+            return emitOpError("converts between integer PCM and f64");
+        }
+        if (decode && getDither()) {
+            return emitOpError("dither only applies when quantizing");
+        }
+        return success();
+    }
+};
+
+// dsp.meter: y = x, accumulating peak and sum of squares of x
+class MeterOp : public Op<MeterOp, OpTrait::OneResult, OpTrait::OneOperand,
+                          OpTrait::ZeroRegions, OpTrait::ZeroSuccessors> {
+public:
+    using Op::Op;
+    MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(MeterOp)
+
+    static constexpr llvm::StringLiteral getOperationName() {
+        return llvm::StringLiteral("dsp.meter");
+    }
+    static ArrayRef<StringRef> getAttributeNames() { return {}; }
+
+    static void build(OpBuilder &, OperationState &state, Value input) {
+        state.addOperands(input);
+        state.addTypes(input.getType());
+    }
+
+    Value getInput() { return getOperation()->getOperand(0); }
+
+    LogicalResult verify() {
+        if (!getInput().getType().isF64()) {
+            return emitOpError("meters f64 samples");
+        }
+        return success();
+    }
+};
+
+// The dsp dialect
+class DspDialect : public Dialect {
+public:
+    MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(DspDialect)
+
+    explicit DspDialect(MLIRContext *context)
+        : Dialect(getDialectNamespace(), context, TypeID::get<DspDialect>()) {
+        addOperations<BiquadOp, CascadeOp, GainOp, MixOp, ConvertPcmOp,
+                      MeterOp>();
+    }
+
+    static constexpr llvm::StringLiteral getDialectNamespace() {
+        return llvm::StringLiteral("dsp");
+    }
+};
+
+// Helpers shared by the rewrite patterns
+
+static bool isSectionOp(Operation *op) {
+    return op && isa<BiquadOp, CascadeOp>(op);
+}
+
+static SmallVector<double> sectionCoeffs(Operation *op) {
+    if (auto biquad = dyn_cast<BiquadOp>(op)) {
+        return SmallVector<double>(biquad.getCoeffs());
+    }
+    return SmallVector<double>(cast<CascadeOp>(op).getCoeffs());
+}
+
+// Create a biquad (one section) or cascade (several) op
+static Value createSections(PatternRewriter &rewriter, Location loc,
+                            Value input, ArrayRef<double> coeffs) {
+    if (coeffs.size() == kSectionCoeffs) {
+        return rewriter.create<BiquadOp>(loc, input, coeffs)->getResult(0);
+    }
+    return rewriter.create<CascadeOp>(loc, input, coeffs)->getResult(0);
+}
+
+// Scale the feedforward taps of the first section (the cascade is linear, so
+// a gain anywhere in it is equivalent)
+static void scaleFeedforward(SmallVectorImpl<double> &coeffs, double gain) {
+    coeffs[0] *= gain;
+    coeffs[1] *= gain;
+    coeffs[2] *= gain;
+}
+
+// Largest pole radius of one section (roots of z^2 + b1*z + b2)
+static double poleRadius(const double *section) {
+    double b1 = section[3];
+    double b2 = section[4];
+    double disc = b1 * b1 - 4.0 * b2;
+    if (disc < 0.0) {
+        return std::sqrt(b2);
+    }
+    double root = std::sqrt(disc);
+    return std::max(std::fabs((-b1 + root) * 0.5),
+                    std::fabs((-b1 - root) * 0.5));
+}
+
+// gain(gain(x, g1), g2) -> gain(x, g1 * g2), gain(x, 1) -> x
+struct FoldGainChain : public OpRewritePattern<GainOp> {
+    using OpRewritePattern<GainOp>::OpRewritePattern;
+
+    LogicalResult matchAndRewrite(GainOp op,
+                                  PatternRewriter &rewriter) const override {
+        if (op.getGain() == 1.0) {
+            rewriter.replaceOp(op, op.getInput());
+            return success();
+        }
+
+        auto inner = op.getInput().getDefiningOp<GainOp>();
+        if (!inner || !inner->hasOneUse()) {
+            return failure();
+        }
+
+        auto fused = rewriter.create<GainOp>(op.getLoc(), inner.getInput(),
+                                             inner.getGain() * op.getGain());
+        rewriter.replaceOp(op, fused->getResults());
+        rewriter.eraseOp(inner);
+        return success();
+    }
+};
+
+// gain(sections(x)) -> sections'(x) with scaled feedforward taps
+struct FoldGainIntoSections : public OpRewritePattern<GainOp> {
+    using OpRewritePattern<GainOp>::OpRewritePattern;
+
+    LogicalResult matchAndRewrite(GainOp op,
+                                  PatternRewriter &rewriter) const override {
+        Operation *producer = op.getInput().getDefiningOp();
+        if (!isSectionOp(producer) || !producer->hasOneUse()) {
+            return failure();
+        }
+
+        SmallVector<double> coeffs = sectionCoeffs(producer);
+        scaleFeedforward(coeffs, op.getGain());
+        Value fused = createSections(rewriter, op.getLoc(),
+                                     producer->getOperand(0), coeffs);
+        rewriter.replaceOp(op, fused);
+        rewriter.eraseOp(producer);
+        return success();
+    }
+};
+
+// sections(gain(x)) -> sections'(x) with scaled feedforward taps
+template <typename SectionOp>
+struct FoldInputGainIntoSections : public OpRewritePattern<SectionOp> {
+    using OpRewritePattern<SectionOp>::OpRewritePattern;
+
+    LogicalResult matchAndRewrite(SectionOp op,
+                                  PatternRewriter &rewriter) const override {
+        auto gain = op.getInput().template getDefiningOp<GainOp>();
+        if (!gain || !gain->hasOneUse()) {
+            return failure();
+        }
+
+        SmallVector<double> coeffs = sectionCoeffs(op.getOperation());
+        scaleFeedforward(coeffs, gain.getGain());
+        Value fused =
+            createSections(rewriter, op.getLoc(), gain.getInput(), coeffs);
+        rewriter.replaceOp(op, fused);
+        rewriter.eraseOp(gain);
+        return success();
+    }
+};
+
+// mix(a, a) -> gain(a, wa + wb)
+struct FoldMixOfSameValue : public OpRewritePattern<MixOp> {
+    using OpRewritePattern<MixOp>::OpRewritePattern;
+
+    LogicalResult matchAndRewrite(MixOp op,
+                                  PatternRewriter &rewriter) const override {
+        Operation *mix = op.getOperation();
+        if (mix->getOperand(0) != mix->getOperand(1)) {
+            return failure();
+        }
+
+        ArrayRef<double> weights = op.getWeights();
+        auto gain = rewriter.create<GainOp>(op.getLoc(), mix->getOperand(0),
+                                            weights[0] + weights[1]);
+        rewriter.replaceOp(op, gain->getResults());
+        return success();
+    }
+};
+
+// sections(sections(x)) -> cascade(x)
+template <typename SectionOp>
+struct FuseSections : public OpRewritePattern<SectionOp> {
+    using OpRewritePattern<SectionOp>::OpRewritePattern;
+
+    LogicalResult matchAndRewrite(SectionOp op,
+                                  PatternRewriter &rewriter) const override {
+        Operation *producer = op.getInput().getDefiningOp();
+        if (!isSectionOp(producer) || !producer->hasOneUse()) {
+            return failure();
+        }
+
+        SmallVector<double> coeffs = sectionCoeffs(producer);
+        coeffs.append(sectionCoeffs(op.getOperation()));
+        Value fused = createSections(rewriter, op.getLoc(),
+                                     producer->getOperand(0), coeffs);
+        rewriter.replaceOp(op, fused);
+        rewriter.eraseOp(producer);
+        return success();
+    }
+};
+
+// dsp-fold-gains
+struct DspFoldGainsPass
+    : public PassWrapper<DspFoldGainsPass, OperationPass<func::FuncOp>> {
+    MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(DspFoldGainsPass)
+
+    StringRef getArgument() const final { return "dsp-fold-gains"; }
+    StringRef getDescription() const final {
+        return "Merge gains and fold them into biquad coefficients";
+    }
+
+    void runOnOperation() override {
+        RewritePatternSet patterns(&getContext());
+        patterns.add<FoldGainChain, FoldGainIntoSections,
+                     FoldInputGainIntoSections<BiquadOp>,
+                     FoldInputGainIntoSections<CascadeOp>,
+                     FoldMixOfSameValue>(&getContext());
+        if (failed(applyPatternsGreedily(getOperation(), std::move(patterns)))) {
+            signalPassFailure();
+        }
+    }
+};
+
+// dsp-fuse-sections
+struct DspFuseSectionsPass
+    : public PassWrapper<DspFuseSectionsPass, OperationPass<func::FuncOp>> {
+    MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(DspFuseSectionsPass)
+
+    StringRef getArgument() const final { return "dsp-fuse-sections"; }
+    StringRef getDescription() const final {
+        return "Fuse adjacent biquad/cascade ops into one cascade";
+    }
+
+    void runOnOperation() override {
+        RewritePatternSet patterns(&getContext());
+        patterns.add<FuseSections<BiquadOp>, FuseSections<CascadeOp>>(
+            &getContext());
+        if (failed(applyPatternsGreedily(getOperation(), std::move(patterns)))) {
+            signalPassFailure();
+        }
+    }
+};
+
+// dsp-select-topology
+struct DspSelectTopologyPass
+    : public PassWrapper<DspSelectTopologyPass, OperationPass<func::FuncOp>> {
+    MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(DspSelectTopologyPass)
+
+    StringRef getArgument() const final { return "dsp-select-topology"; }
+    StringRef getDescription() const final {
+        return "Choose DF1 or TDF2 per cascade from its pole radii";
+    }
+
+    void runOnOperation() override {
+        getOperation().walk([](Operation *op) {
+            if (!isSectionOp(op)) {
+                return;
+            }
+
+            // TDF2 halves the loop-carried state (2 vs 4 values per
+            // section), DF1 is kept for poles close to the unit circle
+            SmallVector<double> coeffs = sectionCoeffs(op);
+            double radius = 0.0;
+            for (size_t s = 0; s < coeffs.size(); s += kSectionCoeffs) {
+                radius = std::max(radius, poleRadius(&coeffs[s]));
+            }
+            const char *topology = radius > kDf1PoleRadius ? "df1" : "tdf2";
+            op->setAttr("topology",
+                        StringAttr::get(op->getContext(), topology));
+        });
+    }
+};
+
+
+// Values threaded through one iteration of a kernel loop while a chain body
+// is cloned into it. Slot indices address `state`/`next`.
+struct ChainEmitter {
+    OpBuilder &builder;
+    Location loc;
+    ValueRange state;              // Slot values at the top of the iteration
+    SmallVectorImpl<Value> &next;  // Slot values yielded to the next one
+    int section;                   // Next section (slots section * 4 ...)
+    int meterSlot;                 // Next peak/sum slot pair, -1 if none
+    int rngSlot;                   // Dither RNG slot, -1 if none
+};
+
+// Emit the per-sample arithmetic of `coeffs` sections
+static Value emitSections(ChainEmitter &em, Value x, ArrayRef<double> coeffs,
+                          bool tdf2) {
+    OpBuilder &builder = em.builder;
+    Location loc = em.loc;
+    auto f64Type = builder.getF64Type();
+    auto constant = [&](double value) -> Value {
+        return builder.create<arith::ConstantOp>(
+            loc, f64Type, builder.getF64FloatAttr(value));
+    };
+    auto mul = [&](Value a, Value b) -> Value {
+        return builder.create<arith::MulFOp>(loc, a, b);
+    };
+    auto add = [&](Value a, Value b) -> Value {
+        return builder.create<arith::AddFOp>(loc, a, b);
+    };
+    auto sub = [&](Value a, Value b) -> Value {
+        return builder.create<arith::SubFOp>(loc, a, b);
+    };
+
+    for (size_t s = 0; s < coeffs.size(); s += kSectionCoeffs, em.section++) {
+        Value a0 = constant(coeffs[s]);
+        Value a1 = constant(coeffs[s + 1]);
+        Value a2 = constant(coeffs[s + 2]);
+        Value b1 = constant(coeffs[s + 3]);
+        Value b2 = constant(coeffs[s + 4]);
+        int base = em.section * kStateSlots;
+
+        Value y;
+        if (tdf2) {
+            // y = a0*x + s1; s1' = a1*x - b1*y + s2; s2' = a2*x - b2*y
+            Value s1 = em.state[base];
+            Value s2 = em.state[base + 1];
+            y = add(mul(a0, x), s1);
+            em.next[base] = add(sub(mul(a1, x), mul(b1, y)), s2);
+            em.next[base + 1] = sub(mul(a2, x), mul(b2, y));
+        } else {
+            // y = a0*x + a1*xz1 + a2*xz2 - b1*yz1 - b2*yz2
+            Value xz1 = em.state[base];
+            Value xz2 = em.state[base + 1];
+            Value yz1 = em.state[base + 2];
+            Value yz2 = em.state[base + 3];
+            y = sub(sub(add(add(mul(a0, x), mul(a1, xz1)), mul(a2, xz2)),
+                        mul(b1, yz1)),
+                    mul(b2, yz2));
+            em.next[base] = x;
+            em.next[base + 1] = xz1;
+            em.next[base + 2] = y;
+            em.next[base + 3] = yz1;
+        }
+        x = y;
+    }
+    return x;
+}
+
+// Emit dsp.meter: peak = max(peak, |x|), sum += x*x
+static LogicalResult emitMeter(ChainEmitter &em, Value x) {
+    if (em.meterSlot < 0) {
+        return failure();
+    }
+
+    OpBuilder &builder = em.builder;
+    int slot = em.meterSlot;
+    Value magnitude = builder.create<arith::MaximumFOp>(
+        em.loc, x, builder.create<arith::NegFOp>(em.loc, x));
+    em.next[slot] =
+        builder.create<arith::MaximumFOp>(em.loc, em.state[slot], magnitude);
+    em.next[slot + 1] = builder.create<arith::AddFOp>(
+        em.loc, em.state[slot + 1],
+        builder.create<arith::MulFOp>(em.loc, x, x));
+    em.meterSlot += 2;
+    return success();
+}
+
+// Draw a uniform value in [0, 1) from the 64-bit LCG in the RNG slot
+static Value emitUniform(ChainEmitter &em) {
+    OpBuilder &builder = em.builder;
+    Location loc = em.loc;
+    auto i64Type = builder.getI64Type();
+
+    // Knuth's MMIX constants; the top 53 bits form the mantissa
+    Value mul = builder.create<arith::ConstantOp>(
+        loc, i64Type, builder.getI64IntegerAttr(6364136223846793005LL));
+    Value inc = builder.create<arith::ConstantOp>(
+        loc, i64Type, builder.getI64IntegerAttr(1442695040888963407LL));
+    Value shift = builder.create<arith::ConstantOp>(
+        loc, i64Type, builder.getI64IntegerAttr(11));
+    Value seed = em.next[em.rngSlot];
+    seed = builder.create<arith::AddIOp>(
+        loc, builder.create<arith::MulIOp>(loc, seed, mul), inc);
+    em.next[em.rngSlot] = seed;
+
+    Value bits = builder.create<arith::ShRUIOp>(loc, seed, shift);
+    Value asFloat =
+        builder.create<arith::UIToFPOp>(loc, builder.getF64Type(), bits);
+    Value scale = builder.create<arith::ConstantOp>(
+        loc, builder.getF64Type(), builder.getF64FloatAttr(std::ldexp(1.0, -53)));
+    return builder.create<arith::MulFOp>(loc, asFloat, scale);
+}
+
+// Emit dsp.convert_pcm arithmetic
+static FailureOr<Value> emitConvertPcm(ChainEmitter &em, Value x,
+                                       Type resultType, int bits,
+                                       bool dither) {
+    OpBuilder &builder = em.builder;
+    Location loc = em.loc;
+    auto f64Type = builder.getF64Type();
+    auto constant = [&](double value) -> Value {
+        return builder.create<arith::ConstantOp>(
+            loc, f64Type, builder.getF64FloatAttr(value));
+    };
+    double scale = std::ldexp(1.0, bits - 1);
+
+    if (isa<IntegerType>(x.getType())) {
+        Value asFloat = builder.create<arith::SIToFPOp>(loc, f64Type, x);
+        return Value(builder.create<arith::MulFOp>(loc, asFloat,
+                                                   constant(1.0 / scale)));
+    }
+
+    Value clamped = builder.create<arith::MinimumFOp>(
+        loc, builder.create<arith::MaximumFOp>(loc, x, constant(-1.0)),
+        constant(1.0));
+    Value scaled =
+        builder.create<arith::MulFOp>(loc, clamped, constant(scale - 1.0));
+    if (dither) {
+        if (em.rngSlot < 0) {
+            return failure();
+        }
+        // TPDF: difference of two uniforms, +-1 LSB
+        Value u1 = emitUniform(em);
+        Value u2 = emitUniform(em);
+        Value noise = builder.create<arith::SubFOp>(loc, u1, u2);
+        scaled = builder.create<arith::AddFOp>(loc, scaled, noise);
+
+        // Keep full-scale samples in range after the noise is added
+        scaled = builder.create<arith::MinimumFOp>(
+            loc,
+            builder.create<arith::MaximumFOp>(loc, scaled,
+                                              constant(1.0 - scale)),
+            constant(scale - 1.0));
+    }
+    return Value(builder.create<arith::FPToSIOp>(loc, resultType, scaled));
+}
+
+// Clone the dataflow of a chain function into the current iteration
+static FailureOr<Value> emitChainBody(ChainEmitter &em, func::FuncOp chain,
+                                      Value input) {
+    OpBuilder &builder = em.builder;
+    Location loc = em.loc;
+    auto f64Type = builder.getF64Type();
+
+    IRMapping mapping;
+    mapping.map(chain.getArgument(0), input);
+    for (Operation &op : chain.getBody().front()) {
+        if (auto ret = dyn_cast<func::ReturnOp>(op)) {
+            return mapping.lookup(ret.getOperand(0));
+        }
+
+        Value out;
+        if (isSectionOp(&op)) {
+            auto topology = op.getAttrOfType<StringAttr>("topology");
+            bool tdf2 = topology && topology.getValue() == "tdf2";
+            SmallVector<double> coeffs = sectionCoeffs(&op);
+            out = emitSections(em, mapping.lookup(op.getOperand(0)), coeffs,
+                               tdf2);
+        } else if (auto gain = dyn_cast<GainOp>(op)) {
+            Value g = builder.create<arith::ConstantOp>(
+                loc, f64Type, builder.getF64FloatAttr(gain.getGain()));
+            out = builder.create<arith::MulFOp>(
+                loc, mapping.lookup(gain.getInput()), g);
+        } else if (auto mix = dyn_cast<MixOp>(op)) {
+            ArrayRef<double> weights = mix.getWeights();
+            Value wa = builder.create<arith::ConstantOp>(
+                loc, f64Type, builder.getF64FloatAttr(weights[0]));
+            Value wb = builder.create<arith::ConstantOp>(
+                loc, f64Type, builder.getF64FloatAttr(weights[1]));
+            Value a = builder.create<arith::MulFOp>(
+                loc, mapping.lookup(op.getOperand(0)), wa);
+            Value b = builder.create<arith::MulFOp>(
+                loc, mapping.lookup(op.getOperand(1)), wb);
+            out = builder.create<arith::AddFOp>(loc, a, b);
+        } else if (auto meter = dyn_cast<MeterOp>(op)) {
+            out = mapping.lookup(meter.getInput());
+            if (failed(emitMeter(em, out))) {
+                op.emitError("dsp.meter needs a pipeline kernel");
+                return failure();
+            }
+        } else if (auto convert = dyn_cast<ConvertPcmOp>(op)) {
+            auto converted = emitConvertPcm(
+                em, mapping.lookup(convert.getInput()),
+                op.getResult(0).getType(), convert.getBits(),
+                convert.getDither());
+            if (failed(converted)) {
+                op.emitError("dither needs a pipeline kernel");
+                return failure();
+            }
+            out = *converted;
+        } else {
+            op.emitError("unsupported op in dsp chain");
+            return failure();
+        }
+        mapping.map(op.getResult(0), out);
+    }
+
+    chain.emitError("dsp chain has no return");
+    return failure();
+}
+
+// Pointer to element `index` of `base`
+static Value elementPtr(OpBuilder &builder, Location loc, Value base,
+                        Type elemType, Value index) {
+    auto ptrType = LLVM::LLVMPointerType::get(builder.getContext());
+    return builder.create<LLVM::GEPOp>(loc, ptrType, elemType, base,
+                                       ValueRange{index});
+}
+
+static Value elementPtr(OpBuilder &builder, Location loc, Value base,
+                        Type elemType, int64_t index) {
+    Value indexValue = builder.create<arith::ConstantOp>(
+        loc, builder.getI64Type(), builder.getI64IntegerAttr(index));
+    return elementPtr(builder, loc, base, elemType, indexValue);
+}
+
+// Emit `for (i = 0; i < length; i++)` with the values behind `slotPtrs`
+// loaded into iter_args before the loop and stored back after it.
+// `body(i, state, next)` emits one iteration and fills `next`.
+static LogicalResult emitCarriedLoop(
+    OpBuilder &builder, Location loc, Value length, ArrayRef<Value> slotPtrs,
+    ArrayRef<Type> slotTypes,
+    function_ref<LogicalResult(Value, ValueRange, SmallVectorImpl<Value> &)>
+        body) {
+    auto i64Type = builder.getI64Type();
+
+    SmallVector<Value> initState;
+    for (size_t k = 0; k < slotPtrs.size(); k++) {
+        initState.push_back(
+            builder.create<LLVM::LoadOp>(loc, slotTypes[k], slotPtrs[k]));
+    }
+
+    Value loopZero = builder.create<arith::ConstantOp>(
+        loc, i64Type, builder.getI64IntegerAttr(0));
+    Value loopOne = builder.create<arith::ConstantOp>(
+        loc, i64Type, builder.getI64IntegerAttr(1));
+    auto loop =
+        builder.create<scf::ForOp>(loc, loopZero, length, loopOne, initState);
+
+    // Without iter_args the builder already added the yield
+    Block *loopBody = loop.getBody();
+    bool hasYield = loopBody->mightHaveTerminator();
+    if (hasYield) {
+        builder.setInsertionPoint(loopBody->getTerminator());
+    } else {
+        builder.setInsertionPointToStart(loopBody);
+    }
+
+    ValueRange state = loop.getRegionIterArgs();
+    SmallVector<Value> next(state.begin(), state.end());
+    if (failed(body(loop.getInductionVar(), state, next))) {
+        return failure();
+    }
+    if (!hasYield) {
+        builder.create<scf::YieldOp>(loc, next);
+    }
+
+    builder.setInsertionPointAfter(loop);
+    for (size_t k = 0; k < slotPtrs.size(); k++) {
+        builder.create<LLVM::StoreOp>(loc, loop.getResult(k), slotPtrs[k]);
+    }
+    return success();
+}
+
+// Number of biquad sections in a chain body
+static int countSections(func::FuncOp chain) {
+    int sections = 0;
+    for (Operation &op : chain.getBody().front()) {
+        if (isSectionOp(&op)) {
+            sections += (int)(sectionCoeffs(&op).size() / kSectionCoeffs);
+        }
+    }
+    return sections;
+}
+
+// Lower one chain function `name` (f64) -> f64 into `name_buffer`:
+//   func @name_buffer(%in: !llvm.ptr, %out: !llvm.ptr, %len: i64,
+//                     %state: !llvm.ptr)
+// with the same scf.for structure as biquad_process_buffer
+static LogicalResult lowerChain(func::FuncOp chain) {
+    MLIRContext *context = chain.getContext();
+    OpBuilder builder(context);
+    Location loc = chain.getLoc();
+    builder.setInsertionPoint(chain);
+
+    auto f64Type = builder.getF64Type();
+    auto i64Type = builder.getI64Type();
+    auto ptrType = LLVM::LLVMPointerType::get(context);
+    int numSlots = countSections(chain) * kStateSlots;
+
+    auto fnType =
+        builder.getFunctionType({ptrType, ptrType, i64Type, ptrType}, {});
+    auto fn = builder.create<func::FuncOp>(
+        loc, (chain.getSymName() + "_buffer").str(), fnType);
+    fn.setPublic();
+    fn->setAttr("dsp.state_slots", builder.getI64IntegerAttr(numSlots));
+
+    Block *entry = fn.addEntryBlock();
+    builder.setInsertionPointToStart(entry);
+    Value inputPtr = entry->getArgument(0);
+    Value outputPtr = entry->getArgument(1);
+    Value length = entry->getArgument(2);
+    Value statePtr = entry->getArgument(3);
+
+    SmallVector<Value> slotPtrs;
+    SmallVector<Type> slotTypes(numSlots, f64Type);
+    for (int k = 0; k < numSlots; k++) {
+        slotPtrs.push_back(elementPtr(builder, loc, statePtr, f64Type, k));
+    }
+
+    auto body = [&](Value i, ValueRange state,
+                    SmallVectorImpl<Value> &next) -> LogicalResult {
+        ChainEmitter em{builder, loc, state, next, 0, -1, -1};
+        Value x = builder.create<LLVM::LoadOp>(
+            loc, f64Type, elementPtr(builder, loc, inputPtr, f64Type, i));
+        auto y = emitChainBody(em, chain, x);
+        if (failed(y)) {
+            return failure();
+        }
+        builder.create<LLVM::StoreOp>(
+            loc, *y, elementPtr(builder, loc, outputPtr, f64Type, i));
+        return success();
+    };
+    if (failed(emitCarriedLoop(builder, loc, length, slotPtrs, slotTypes,
+                               body))) {
+        return failure();
+    }
+    builder.create<func::ReturnOp>(loc);
+
+    chain.erase();
+    return success();
+}
+
+// Register type carrying one PCM sample of `bits`
+static Type pcmCarrierType(OpBuilder &builder, int bits) {
+    return bits == 16 ? builder.getI16Type() : builder.getI32Type();
+}
+
+// Load interleaved PCM sample `index` (24-bit is packed little-endian)
+static Value loadPcm(OpBuilder &builder, Location loc, Value base, Value index,
+                     int bits) {
+    if (bits != 24) {
+        Type type = pcmCarrierType(builder, bits);
+        return builder.create<LLVM::LoadOp>(
+            loc, type, elementPtr(builder, loc, base, type, index));
+    }
+
+    auto i8Type = builder.getI8Type();
+    auto i32Type = builder.getI32Type();
+    auto i64Type = builder.getI64Type();
+    auto i64 = [&](int64_t v) -> Value {
+        return builder.create<arith::ConstantOp>(loc, i64Type,
+                                                 builder.getI64IntegerAttr(v));
+    };
+    auto i32 = [&](int32_t v) -> Value {
+        return builder.create<arith::ConstantOp>(loc, i32Type,
+                                                 builder.getI32IntegerAttr(v));
+    };
+
+    Value byteIndex = builder.create<arith::MulIOp>(loc, index, i64(3));
+    Value sample = i32(0);
+    for (int k = 0; k < 3; k++) {
+        Value offset = builder.create<arith::AddIOp>(loc, byteIndex, i64(k));
+        Value byte = builder.create<LLVM::LoadOp>(
+            loc, i8Type, elementPtr(builder, loc, base, i8Type, offset));
+        Value wide = builder.create<arith::ExtUIOp>(loc, i32Type, byte);
+        wide = builder.create<arith::ShLIOp>(loc, wide, i32(8 * k));
+        sample = builder.create<arith::OrIOp>(loc, sample, wide);
+    }
+    // Sign-extend from 24 bits
+    sample = builder.create<arith::ShLIOp>(loc, sample, i32(8));
+    return builder.create<arith::ShRSIOp>(loc, sample, i32(8));
+}
+
+// Store interleaved PCM sample `index`
+static void storePcm(OpBuilder &builder, Location loc, Value base, Value index,
+                     Value sample, int bits) {
+    if (bits != 24) {
+        builder.create<LLVM::StoreOp>(
+            loc, sample,
+            elementPtr(builder, loc, base, sample.getType(), index));
+        return;
+    }
+
+    auto i8Type = builder.getI8Type();
+    auto i64Type = builder.getI64Type();
+    Value three = builder.create<arith::ConstantOp>(
+        loc, i64Type, builder.getI64IntegerAttr(3));
+    Value byteIndex = builder.create<arith::MulIOp>(loc, index, three);
+    for (int k = 0; k < 3; k++) {
+        Value offset = builder.create<arith::AddIOp>(
+            loc, byteIndex,
+            builder.create<arith::ConstantOp>(loc, i64Type,
+                                              builder.getI64IntegerAttr(k)));
+        Value shifted = builder.create<arith::ShRUIOp>(
+            loc, sample,
+            builder.create<arith::ConstantOp>(
+                loc, sample.getType(),
+                builder.getIntegerAttr(sample.getType(), 8 * k)));
+        Value byte = builder.create<arith::TruncIOp>(loc, i8Type, shifted);
+        builder.create<LLVM::StoreOp>(
+            loc, byte, elementPtr(builder, loc, base, i8Type, offset));
+    }
+}
+
+// Lower a pipeline chain `name` (PCM) -> PCM into `name_pipeline`:
+//   func @name_pipeline(%in: !llvm.ptr, %out: !llvm.ptr, %frames: i64,
+//                       %state: !llvm.ptr, %meters: !llvm.ptr,
+//                       %rng: !llvm.ptr)
+// One loop over frames; every channel runs its own copy of the chain body
+// (decode, sections, meter, dither, quantize) with values kept in registers
+static LogicalResult lowerPipeline(func::FuncOp chain) {
+    MLIRContext *context = chain.getContext();
+    OpBuilder builder(context);
+    Location loc = chain.getLoc();
+    builder.setInsertionPoint(chain);
+
+    auto f64Type = builder.getF64Type();
+    auto i64Type = builder.getI64Type();
+    auto ptrType = LLVM::LLVMPointerType::get(context);
+
+    int channels = (int)chain->getAttrOfType<IntegerAttr>("dsp.channels")
+                       .getInt();
+    int inputBits = (int)chain->getAttrOfType<IntegerAttr>("dsp.input_bits")
+                        .getInt();
+    int outputBits = (int)chain->getAttrOfType<IntegerAttr>("dsp.output_bits")
+                         .getInt();
+
+    int numSections = countSections(chain);
+    int numMeters = 0;
+    bool dither = false;
+    for (Operation &op : chain.getBody().front()) {
+        if (isa<MeterOp>(op)) {
+            numMeters++;
+        } else if (auto convert = dyn_cast<ConvertPcmOp>(op)) {
+            dither |= convert.getDither();
+        }
+    }
+
+    int sectionSlots = channels * numSections * kStateSlots;
+    int meterSlots = channels * numMeters * 2;
+
+    auto fnType = builder.getFunctionType(
+        {ptrType, ptrType, i64Type, ptrType, ptrType, ptrType}, {});
+    auto fn = builder.create<func::FuncOp>(
+        loc, (chain.getSymName() + "_pipeline").str(), fnType);
+    fn.setPublic();
+    fn->setAttr("dsp.state_slots", builder.getI64IntegerAttr(sectionSlots));
+
+    Block *entry = fn.addEntryBlock();
+    builder.setInsertionPointToStart(entry);
+    Value inputPtr = entry->getArgument(0);
+    Value outputPtr = entry->getArgument(1);
+    Value frames = entry->getArgument(2);
+    Value statePtr = entry->getArgument(3);
+    Value metersPtr = entry->getArgument(4);
+    Value rngPtr = entry->getArgument(5);
+
+    // Slots: [section state][peak, sum per channel and meter][rng]
+    SmallVector<Value> slotPtrs;
+    SmallVector<Type> slotTypes;
+    for (int k = 0; k < sectionSlots; k++) {
+        slotPtrs.push_back(elementPtr(builder, loc, statePtr, f64Type, k));
+        slotTypes.push_back(f64Type);
+    }
+    for (int k = 0; k < meterSlots; k++) {
+        slotPtrs.push_back(elementPtr(builder, loc, metersPtr, f64Type, k));
+        slotTypes.push_back(f64Type);
+    }
+    int rngSlot = -1;
+    if (dither) {
+        rngSlot = (int)slotPtrs.size();
+        slotPtrs.push_back(rngPtr);
+        slotTypes.push_back(i64Type);
+    }
+
+    Value numChannels = builder.create<arith::ConstantOp>(
+        loc, i64Type, builder.getI64IntegerAttr(channels));
+    auto body = [&](Value frame, ValueRange state,
+                    SmallVectorImpl<Value> &next) -> LogicalResult {
+        Value frameBase = builder.create<arith::MulIOp>(loc, frame, numChannels);
+        for (int c = 0; c < channels; c++) {
+            Value index = builder.create<arith::AddIOp>(
+                loc, frameBase,
+                builder.create<arith::ConstantOp>(
+                    loc, i64Type, builder.getI64IntegerAttr(c)));
+            ChainEmitter em{builder,
+                            loc,
+                            state,
+                            next,
+                            c * numSections,
+                            numMeters ? sectionSlots + c * numMeters * 2 : -1,
+                            rngSlot};
+            Value x = loadPcm(builder, loc, inputPtr, index, inputBits);
+            auto y = emitChainBody(em, chain, x);
+            if (failed(y)) {
+                return failure();
+            }
+            storePcm(builder, loc, outputPtr, index, *y, outputBits);
+        }
+        return success();
+    };
+    if (failed(emitCarriedLoop(builder, loc, frames, slotPtrs, slotTypes,
+                               body))) {
+        return failure();
+    }
+    builder.create<func::ReturnOp>(loc);
+
+    chain.erase();
+    return success();
+}
+
+// dsp-lower-to-loops
+struct DspLowerToLoopsPass
+    : public PassWrapper<DspLowerToLoopsPass, OperationPass<ModuleOp>> {
+    MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(DspLowerToLoopsPass)
+
+    StringRef getArgument() const final { return "dsp-lower-to-loops"; }
+    StringRef getDescription() const final {
+        return "Lower dsp chains to scf.for buffer and pipeline kernels";
+    }
+    void getDependentDialects(DialectRegistry &registry) const override {
+        registry.insert<arith::ArithDialect, scf::SCFDialect,
+                        LLVM::LLVMDialect>();
+    }
+
+    void runOnOperation() override {
+        SmallVector<func::FuncOp> chains;
+        getOperation().walk([&](func::FuncOp fn) {
+            if (fn->hasAttr("dsp.chain")) {
+                chains.push_back(fn);
+            }
+        });
+        for (func::FuncOp chain : chains) {
+            LogicalResult lowered = chain->hasAttr("dsp.input_bits")
+                                        ? lowerPipeline(chain)
+                                        : lowerChain(chain);
+            if (failed(lowered)) {
+                return signalPassFailure();
+            }
+        }
+    }
+};
+
+// Append the ops for a stage list to the current block
+static Value buildStages(OpBuilder &builder, Location loc, Value x,
+                         const DspStageSpec *stages, int num_stages) {
+    for (int s = 0; s < num_stages; s++) {
+        const DspStageSpec &stage = stages[s];
+        if (stage.type == DSP_STAGE_GAIN) {
+            x = builder.create<GainOp>(loc, x, stage.gain)->getResult(0);
+            continue;
+        }
+
+        const BiQuad &bq = stage.biquad;
+        Value y = builder
+                      .create<BiquadOp>(loc, x,
+                                        ArrayRef<double>{bq.a0, bq.a1, bq.a2,
+                                                         bq.b1, bq.b2})
+                      ->getResult(0);
+        // Wet/dry mix, omitted for the usual full-wet case
+        if (bq.c0 != 1.0 || bq.d0 != 0.0) {
+            y = builder.create<MixOp>(loc, y, x, bq.c0, bq.d0)->getResult(0);
+        }
+        x = y;
+    }
+    return x;
+}
+
+// Build `name` (f64) -> f64 from a stage list
+static void buildChainFunction(ModuleOp module, StringRef name,
+                               const DspStageSpec *stages, int num_stages) {
+    OpBuilder builder(module.getContext());
+    auto loc = builder.getUnknownLoc();
+    builder.setInsertionPointToEnd(module.getBody());
+
+    auto f64Type = builder.getF64Type();
+    auto fn = builder.create<func::FuncOp>(
+        loc, name, builder.getFunctionType({f64Type}, {f64Type}));
+    fn->setAttr("dsp.chain", builder.getUnitAttr());
+
+    Block *entry = fn.addEntryBlock();
+    builder.setInsertionPointToStart(entry);
+    Value x = buildStages(builder, loc, entry->getArgument(0), stages,
+                          num_stages);
+    builder.create<func::ReturnOp>(loc, x);
+}
+
+// Build `name` (PCM) -> PCM: decode, stages, meter, (dither,) quantize
+static void buildPipelineFunction(ModuleOp module, StringRef name,
+                                  const DspPipelineSpec *spec) {
+    OpBuilder builder(module.getContext());
+    auto loc = builder.getUnknownLoc();
+    builder.setInsertionPointToEnd(module.getBody());
+
+    auto f64Type = builder.getF64Type();
+    Type inType = pcmCarrierType(builder, spec->input_bits);
+    Type outType = pcmCarrierType(builder, spec->output_bits);
+    auto fn = builder.create<func::FuncOp>(
+        loc, name, builder.getFunctionType({inType}, {outType}));
+    fn->setAttr("dsp.chain", builder.getUnitAttr());
+    fn->setAttr("dsp.channels", builder.getI64IntegerAttr(spec->channels));
+    fn->setAttr("dsp.input_bits", builder.getI64IntegerAttr(spec->input_bits));
+    fn->setAttr("dsp.output_bits",
+                builder.getI64IntegerAttr(spec->output_bits));
+
+    Block *entry = fn.addEntryBlock();
+    builder.setInsertionPointToStart(entry);
+    Value x = builder
+                  .create<ConvertPcmOp>(loc, entry->getArgument(0), f64Type,
+                                        spec->input_bits)
+                  ->getResult(0);
+    x = buildStages(builder, loc, x, spec->stages, spec->num_stages);
+    x = builder.create<MeterOp>(loc, x)->getResult(0);
+    Value y = builder
+                  .create<ConvertPcmOp>(loc, x, outType, spec->output_bits,
+                                        spec->dither != 0)
+                  ->getResult(0);
+    builder.create<func::ReturnOp>(loc, y);
+}
+
+// Register the dsp passes in optimization order
+static void addDspPasses(PassManager &pm) {
+    pm.addNestedPass<func::FuncOp>(std::make_unique<DspFoldGainsPass>());
+    pm.addNestedPass<func::FuncOp>(std::make_unique<DspFuseSectionsPass>());
+    pm.addNestedPass<func::FuncOp>(std::make_unique<DspSelectTopologyPass>());
+    pm.addPass(std::make_unique<DspLowerToLoopsPass>());
+}
+
+// A lowered kernel to fetch from a compiled module
+struct DspKernelRef {
+    std::string symbol;    // Lowered function name (e.g. dsp_chain_buffer)
+    void *fn = nullptr;
+    size_t state_slots = 0;
+};
+
+// Run the dsp passes over `module` and JIT-compile every kernel in it with a
+// single engine. Fills in the address and state size of each entry of
+// `kernels`.
+static std::unique_ptr<ExecutionEngine> compileDspModule(
+    MLIRContext *context, OwningOpRef<ModuleOp> &module,
+    std::vector<DspKernelRef> &kernels) {
+    // ModuleOp::verify only checks the module op itself; the dsp op
+    // verifiers run from the recursive mlir::verify
+    if (failed(mlir::verify(module->getOperation()))) {
+        fprintf(stderr, "dsp chain verification failed\n");
+        return nullptr;
+    }
+
+    // Whole-chain optimization and lowering to the loop kernels
+    PassManager pm(context);
+    addDspPasses(pm);
+    if (failed(pm.run(module.get()))) {
+        fprintf(stderr, "dsp pass pipeline failed\n");
+        return nullptr;
+    }
+
+    // State sizes live on the lowered functions, so read them before the
+    // module is translated to LLVM
+    for (DspKernelRef &kernel : kernels) {
+        auto kernelFn = module->lookupSymbol<func::FuncOp>(kernel.symbol);
+        if (!kernelFn) {
+            return nullptr;
+        }
+        auto slots = kernelFn->getAttrOfType<IntegerAttr>("dsp.state_slots");
+        kernel.state_slots = slots ? (size_t)slots.getInt() : 0;
+    }
+
+    auto engine = createExecutionEngine(module, context);
+    if (!engine) {
+        return nullptr;
+    }
+
+    for (DspKernelRef &kernel : kernels) {
+        auto maybeFn = engine->lookup(kernel.symbol);
+        if (!maybeFn) {
+            fprintf(stderr, "Failed to lookup %s function\n",
+                    kernel.symbol.c_str());
+            return nullptr;
+        }
+        kernel.fn = *maybeFn;
+    }
+    return engine;
+}
+
+// Compiled pipeline kernel, shared by every pipeline with the same plan
+struct DspPlan {
+    std::string key;       // Serialized spec (coefficients, formats)
+    uint64_t hash;         // FNV-1a of `key`
+    int channels;
+    // Compiled code only; shared with the other kernels of a library
+    std::shared_ptr<ExecutionEngine> engine;
+
+    // Signature: (input, output, frames, state, meters, rng)
+    typedef void (*PipelineFn)(const void *input, void *output,
+                               int64_t frames, double *state, double *meters,
+                               uint64_t *rng);
+    PipelineFn process_fn;
+    size_t state_slots;
+};
+
+// Plans by hash; an entry expires with the last pipeline using it
+static std::mutex planCacheMutex;
+static std::unordered_map<uint64_t, std::weak_ptr<DspPlan>> planCache;
+
+// Serialize everything that affects the generated code
+static std::string planKey(const DspPipelineSpec *spec) {
+    std::string key;
+    auto append = [&key](const void *data, size_t size) {
+        key.append(static_cast<const char *>(data), size);
+    };
+
+    int header[4] = {spec->channels, spec->input_bits, spec->output_bits,
+                     spec->dither ? 1 : 0};
+    append(header, sizeof(header));
+    for (int s = 0; s < spec->num_stages; s++) {
+        const DspStageSpec &stage = spec->stages[s];
+        int type = (int)stage.type;
+        append(&type, sizeof(type));
+        if (stage.type == DSP_STAGE_GAIN) {
+            append(&stage.gain, sizeof(stage.gain));
+        } else {
+            const BiQuad &bq = stage.biquad;
+            double coeffs[7] = {bq.a0, bq.a1, bq.a2, bq.b1,
+                                bq.b2, bq.c0, bq.d0};
+            append(coeffs, sizeof(coeffs));
+        }
+    }
+    return key;
+}
+
+static uint64_t planHash(const std::string &key) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char byte : key) {
+        hash = (hash ^ byte) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static std::shared_ptr<DspPlan> compilePlan(const DspPipelineSpec *spec,
+                                            const std::string &key,
+                                            uint64_t hash) {
+    auto plan = std::make_shared<DspPlan>();
+    plan->key = key;
+    plan->hash = hash;
+    plan->channels = spec->channels;
+
+    // The context only lives for the duration of the compile
+    std::unique_ptr<MLIRContext> context = createJitContext();
+    context->getOrLoadDialect<DspDialect>();
+
+    OpBuilder builder(context.get());
+    OwningOpRef<ModuleOp> module = ModuleOp::create(builder.getUnknownLoc());
+    buildPipelineFunction(module.get(), "dsp_chain", spec);
+
+    std::vector<DspKernelRef> kernels(1);
+    kernels[0].symbol = "dsp_chain_pipeline";
+    plan->engine = compileDspModule(context.get(), module, kernels);
+    if (!plan->engine) {
+        return nullptr;
+    }
+    plan->process_fn = reinterpret_cast<DspPlan::PipelineFn>(kernels[0].fn);
+    plan->state_slots = kernels[0].state_slots;
+    return plan;
+}
+
+// Cached plan for `hash` if it was built from `key`
+static std::shared_ptr<DspPlan> lookupPlan(uint64_t hash,
+                                           const std::string &key) {
+    auto it = planCache.find(hash);
+    if (it == planCache.end()) {
+        return nullptr;
+    }
+    std::shared_ptr<DspPlan> plan = it->second.lock();
+    return plan && plan->key == key ? plan : nullptr;
+}
+
+// Cache a freshly compiled plan, or return the equal plan that beat it
+// Caller holds planCacheMutex
+static std::shared_ptr<DspPlan> publishPlan(std::shared_ptr<DspPlan> compiled) {
+    if (auto plan = lookupPlan(compiled->hash, compiled->key)) {
+        return plan;
+    }
+    // Only replace expired entries; a live colliding plan keeps its slot
+    auto it = planCache.find(compiled->hash);
+    if (it == planCache.end() || it->second.expired()) {
+        planCache[compiled->hash] = compiled;
+    }
+    return compiled;
+}
+
+// Find a compiled plan for `spec` or compile and cache a new one
+// Compilation runs outside the cache lock so threads building different
+// plans do not serialize; if two threads race on the same plan, the first
+// one cached wins and the other compile is dropped.
+static std::shared_ptr<DspPlan> acquirePlan(const DspPipelineSpec *spec) {
+    std::string key = planKey(spec);
+    uint64_t hash = planHash(key);
+
+    {
+        std::lock_guard<std::mutex> lock(planCacheMutex);
+        if (auto plan = lookupPlan(hash, key)) {
+            return plan;
+        }
+    }
+
+    std::shared_ptr<DspPlan> compiled = compilePlan(spec, key, hash);
+    if (!compiled) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(planCacheMutex);
+    return publishPlan(compiled);
+}
+
+static bool validStages(const DspStageSpec *stages, int num_stages) {
+    return num_stages >= 0 && (stages || num_stages == 0);
+}
+
+static bool validPipelineSpec(const DspPipelineSpec *spec) {
+    if (!spec || !validStages(spec->stages, spec->num_stages) ||
+        spec->channels < 1 || spec->channels > AUDIO_METER_MAX_CHANNELS) {
+        return false;
+    }
+    for (int bits : {spec->input_bits, spec->output_bits}) {
+        if (bits != 16 && bits != 24 && bits != 32) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Initial dither RNG state
+constexpr uint64_t kDitherSeed = 0x853c49e6748fea9bULL;
+
+} // namespace
+
+// Compiled chain (coefficients are baked in, so the code is per chain)
+struct MLIRDspChain {
+    // Compiled code only; shared with the other kernels of a library
+    std::shared_ptr<ExecutionEngine> engine;
+
+    // Signature: (input_ptr, output_ptr, length, state_ptr)
+    typedef void (*ChainBufferFn)(const double *input, double *output,
+                                  int64_t length, double *state);
+    ChainBufferFn process_fn;
+
+    std::vector<double> state;
+    int num_sections;
+
+    MLIRDspChain() : engine(nullptr), process_fn(nullptr), num_sections(0) {}
+};
+
+// Pipeline instance: shared plan plus per-stream state
+struct MLIRDspPipeline {
+    std::shared_ptr<DspPlan> plan;
+    std::vector<double> state;
+    std::vector<double> meters;   // [peak, sum_squares] per channel
+    uint64_t rng;
+    size_t metered_frames;
+    int channels;
+};
+
+// Kernels compiled by one engine, by name
+struct MLIRDspLibrary {
+    struct Kernel {
+        DspKernelKind kind;
+        void *fn;                        // Chain kernels
+        size_t state_slots;              // Chain kernels
+        std::shared_ptr<DspPlan> plan;   // Pipeline kernels
+    };
+
+    std::shared_ptr<ExecutionEngine> engine;
+    std::unordered_map<std::string, Kernel> kernels;
+};
+
+static MLIRDspChain *newChain(std::shared_ptr<ExecutionEngine> engine,
+                              void *fn, size_t state_slots) {
+    auto chain = new MLIRDspChain();
+    chain->engine = std::move(engine);
+    chain->process_fn = reinterpret_cast<MLIRDspChain::ChainBufferFn>(fn);
+    chain->state.assign(state_slots, 0.0);
+    chain->num_sections = (int)(state_slots / kStateSlots);
+    return chain;
+}
+
+static MLIRDspPipeline *newPipeline(std::shared_ptr<DspPlan> plan) {
+    auto pipeline = new MLIRDspPipeline();
+    pipeline->state.assign(plan->state_slots, 0.0);
+    pipeline->meters.assign((size_t)plan->channels * 2, 0.0);
+    pipeline->rng = kDitherSeed;
+    pipeline->metered_frames = 0;
+    pipeline->channels = plan->channels;
+    pipeline->plan = std::move(plan);
+    return pipeline;
+}
+
+extern "C" {
+
+MLIRDspChain* mlir_dsp_chain_create(const DspStageSpec *stages,
+                                    int num_stages) {
+    if (!stages || num_stages < 0) {
+        return nullptr;
+    }
+
+    // The context only lives for the duration of the compile
+    std::unique_ptr<MLIRContext> context = createJitContext();
+    context->getOrLoadDialect<DspDialect>();
+
+    OpBuilder builder(context.get());
+    OwningOpRef<ModuleOp> module = ModuleOp::create(builder.getUnknownLoc());
+    buildChainFunction(module.get(), "dsp_chain", stages, num_stages);
+
+    std::vector<DspKernelRef> kernels(1);
+    kernels[0].symbol = "dsp_chain_buffer";
+    std::shared_ptr<ExecutionEngine> engine =
+        compileDspModule(context.get(), module, kernels);
+    if (!engine) {
+        return nullptr;
+    }
+    return newChain(std::move(engine), kernels[0].fn, kernels[0].state_slots);
+}
+
+void mlir_dsp_chain_process(MLIRDspChain *chain, const double *input,
+                            double *output, size_t length) {
+    if (!chain || !chain->process_fn || !input || !output) {
+        return;
+    }
+
+    chain->process_fn(input, output, (int64_t)length, chain->state.data());
+}
+
+void mlir_dsp_chain_reset(MLIRDspChain *chain) {
+    if (chain) {
+        std::fill(chain->state.begin(), chain->state.end(), 0.0);
+    }
+}
+
+int mlir_dsp_chain_num_sections(const MLIRDspChain *chain) {
+    return chain ? chain->num_sections : 0;
+}
+
+void mlir_dsp_chain_destroy(MLIRDspChain *chain) {
+    delete chain;
+}
+
+MLIRDspPipeline* mlir_dsp_pipeline_create(const DspPipelineSpec *spec) {
+    if (!validPipelineSpec(spec)) {
+        return nullptr;
+    }
+
+    std::shared_ptr<DspPlan> plan = acquirePlan(spec);
+    if (!plan) {
+        return nullptr;
+    }
+    return newPipeline(std::move(plan));
+}
+
+void mlir_dsp_pipeline_process(MLIRDspPipeline *pipeline, const void *input,
+                               void *output, size_t frames) {
+    if (!pipeline || !input || !output) {
+        return;
+    }
+
+    pipeline->plan->process_fn(input, output, (int64_t)frames,
+                               pipeline->state.data(),
+                               pipeline->meters.data(), &pipeline->rng);
+    pipeline->metered_frames += frames;
+}
+
+void mlir_dsp_pipeline_get_meter(const MLIRDspPipeline *pipeline,
+                                 AudioMeter *meter) {
+    if (!pipeline || !meter) {
+        return;
+    }
+
+    std::memset(meter, 0, sizeof(AudioMeter));
+    for (int c = 0; c < pipeline->channels; c++) {
+        meter->peak[c] = pipeline->meters[(size_t)c * 2];
+        meter->sum_squares[c] = pipeline->meters[(size_t)c * 2 + 1];
+    }
+    meter->frames = pipeline->metered_frames;
+}
+
+void mlir_dsp_pipeline_reset(MLIRDspPipeline *pipeline) {
+    if (!pipeline) {
+        return;
+    }
+
+    std::fill(pipeline->state.begin(), pipeline->state.end(), 0.0);
+    std::fill(pipeline->meters.begin(), pipeline->meters.end(), 0.0);
+    pipeline->rng = kDitherSeed;
+    pipeline->metered_frames = 0;
+}
+
+uint64_t mlir_dsp_pipeline_plan_hash(const MLIRDspPipeline *pipeline) {
+    return pipeline ? pipeline->plan->hash : 0;
+}
+
+int mlir_dsp_plan_cache_size(void) {
+    std::lock_guard<std::mutex> lock(planCacheMutex);
+    int live = 0;
+    for (auto &entry : planCache) {
+        if (!entry.second.expired()) {
+            live++;
+        }
+    }
+    return live;
+}
+
+void mlir_dsp_pipeline_destroy(MLIRDspPipeline *pipeline) {
+    delete pipeline;
+}
+
+MLIRDspLibrary* mlir_dsp_library_create(const DspKernelSpec *kernels,
+                                        int num_kernels) {
+    if (!kernels || num_kernels < 1) {
+        return nullptr;
+    }
+
+    // Validate everything up front; names only need to be unique because
+    // the module uses generated symbols
+    std::unordered_map<std::string, int> index;
+    for (int k = 0; k < num_kernels; k++) {
+        const DspKernelSpec &kernel = kernels[k];
+        bool valid = kernel.kind == DSP_KERNEL_PIPELINE
+                         ? validPipelineSpec(&kernel.spec)
+                         : validStages(kernel.spec.stages,
+                                       kernel.spec.num_stages);
+        if (!valid || !kernel.name || !kernel.name[0] ||
+            !index.emplace(kernel.name, k).second) {
+            return nullptr;
+        }
+    }
+
+    // The context only lives for the duration of the compile
+    std::unique_ptr<MLIRContext> context = createJitContext();
+    context->getOrLoadDialect<DspDialect>();
+
+    OpBuilder builder(context.get());
+    OwningOpRef<ModuleOp> module = ModuleOp::create(builder.getUnknownLoc());
+    std::vector<DspKernelRef> refs(num_kernels);
+    for (int k = 0; k < num_kernels; k++) {
+        const DspKernelSpec &kernel = kernels[k];
+        std::string symbol = "dsp_kernel_" + std::to_string(k);
+        if (kernel.kind == DSP_KERNEL_PIPELINE) {
+            buildPipelineFunction(module.get(), symbol, &kernel.spec);
+            refs[k].symbol = symbol + "_pipeline";
+        } else {
+            buildChainFunction(module.get(), symbol, kernel.spec.stages,
+                               kernel.spec.num_stages);
+            refs[k].symbol = symbol + "_buffer";
+        }
+    }
+
+    std::shared_ptr<ExecutionEngine> engine =
+        compileDspModule(context.get(), module, refs);
+    if (!engine) {
+        return nullptr;
+    }
+
+    auto library = new MLIRDspLibrary();
+    library->engine = engine;
+    std::lock_guard<std::mutex> lock(planCacheMutex);
+    for (int k = 0; k < num_kernels; k++) {
+        const DspKernelSpec &kernel = kernels[k];
+        MLIRDspLibrary::Kernel entry{kernel.kind, refs[k].fn,
+                                     refs[k].state_slots, nullptr};
+        if (kernel.kind == DSP_KERNEL_PIPELINE) {
+            auto plan = std::make_shared<DspPlan>();
+            plan->key = planKey(&kernel.spec);
+            plan->hash = planHash(plan->key);
+            plan->channels = kernel.spec.channels;
+            plan->engine = engine;
+            plan->process_fn =
+                reinterpret_cast<DspPlan::PipelineFn>(refs[k].fn);
+            plan->state_slots = refs[k].state_slots;
+            entry.plan = publishPlan(plan);
+        }
+        library->kernels.emplace(kernel.name, std::move(entry));
+    }
+    return library;
+}
+
+int mlir_dsp_library_size(const MLIRDspLibrary *library) {
+    return library ? (int)library->kernels.size() : 0;
+}
+
+MLIRDspChain* mlir_dsp_library_chain(MLIRDspLibrary *library,
+                                     const char *name) {
+    if (!library || !name) {
+        return nullptr;
+    }
+
+    auto it = library->kernels.find(name);
+    if (it == library->kernels.end() || it->second.kind != DSP_KERNEL_CHAIN) {
+        return nullptr;
+    }
+    return newChain(library->engine, it->second.fn, it->second.state_slots);
+}
+
+MLIRDspPipeline* mlir_dsp_library_pipeline(MLIRDspLibrary *library,
+                                           const char *name) {
+    if (!library || !name) {
+        return nullptr;
+    }
+
+    auto it = library->kernels.find(name);
+    if (it == library->kernels.end() ||
+        it->second.kind != DSP_KERNEL_PIPELINE) {
+        return nullptr;
+    }
+    return newPipeline(it->second.plan);
+}
+
+void mlir_dsp_library_destroy(MLIRDspLibrary *library) {
+    delete library;
+}
+
+} // extern "C"
@@ -0,0 +1,26 @@
+// Shared helpers for the MLIR JIT backends (C++ only, not a public header)
+
+#ifndef MLIR_JIT_H
+#define MLIR_JIT_H
+
+#include <mlir/ExecutionEngine/ExecutionEngine.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/MLIRContext.h>
+#include <mlir/IR/OwningOpRef.h>
+
+#include <memory>
+
+// Thread safety: both functions may be called concurrently from any thread.
+// LLVM target setup happens once (std::call_once) and every context shares
+// one compile thread pool; a context itself must stay with one thread.
+
+// New context with LLVM IR translations registered and func/arith/scf/llvm
+// loaded, using the shared JIT thread pool
+std::unique_ptr<mlir::MLIRContext> createJitContext();
+
+// Lower a module built from func/arith/scf/llvm ops to the LLVM dialect and
+// JIT-compile it at -O3. Returns nullptr on failure.
+std::unique_ptr<mlir::ExecutionEngine> createExecutionEngine(
+    mlir::OwningOpRef<mlir::ModuleOp> &module, mlir::MLIRContext *context);
+
+#endif // MLIR_JIT_H
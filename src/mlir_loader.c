@@ -0,0 +1,132 @@
+// mlir_biquad.h implemented on top of the dlopen'ed MLIR backend plugin
+// Programs linking this instead of mlir_biquad start like the plain C build:
+// the plugin (and with it MLIR/LLVM) is only mapped when a handle first
+// processes audio. If the plugin cannot be loaded, processing falls back to
+// the C BiQuad, exactly as when JIT compilation fails.
+
+#define _GNU_SOURCE
+#include "mlir_biquad.h"
+#include "mlir_plugin.h"
+#include <dlfcn.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+struct MLIRBiQuadJIT {
+  void *backend; // Plugin handle, created on first use
+};
+
+static pthread_once_t plugin_once = PTHREAD_ONCE_INIT;
+static const MLIRPluginAPI *plugin_api = NULL;
+
+// Try one candidate path; returns the function table or NULL
+static const MLIRPluginAPI *open_plugin(const char *path) {
+  void *library = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+  if (!library)
+    return NULL;
+
+  MLIRPluginEntryFn entry =
+      (MLIRPluginEntryFn)dlsym(library, MLIR_PLUGIN_ENTRY);
+  const MLIRPluginAPI *api = entry ? entry() : NULL;
+  if (!api || api->abi_version != MLIR_PLUGIN_ABI_VERSION) {
+    dlclose(library);
+    return NULL;
+  }
+
+  // The library stays mapped for the life of the process
+  return api;
+}
+
+static void load_plugin(void) {
+  const char *override = getenv(MLIR_PLUGIN_ENV);
+  if (override && override[0]) {
+    plugin_api = open_plugin(override);
+  } else {
+#ifdef MLIR_PLUGIN_PATH
+    // Build tree location, so tests and uninstalled binaries find it
+    plugin_api = open_plugin(MLIR_PLUGIN_PATH);
+#endif
+    if (!plugin_api)
+      plugin_api = open_plugin(MLIR_PLUGIN_LIBRARY);
+  }
+
+  if (!plugin_api) {
+    const char *error = dlerror();
+    fprintf(stderr, "MLIR plugin unavailable (%s), using C BiQuad\n",
+            error ? error : "incompatible plugin");
+  }
+}
+
+// Function table of the plugin, loading it on the first call
+static const MLIRPluginAPI *plugin(void) {
+  pthread_once(&plugin_once, load_plugin);
+  return plugin_api;
+}
+
+// Backend handle for `jit`, created on first use (NULL: use C)
+static void *backend(MLIRBiQuadJIT *jit, const BiQuad *bq) {
+  if (!jit->backend && plugin())
+    jit->backend = plugin_api->jit_create(bq);
+  return jit->backend;
+}
+
+MLIRBiQuadJIT *mlir_biquad_jit_create(const BiQuad *bq) {
+  if (!bq)
+    return NULL;
+
+  // Nothing is loaded here: the plugin is opened on first processing
+  return calloc(1, sizeof(MLIRBiQuadJIT));
+}
+
+double mlir_biquad_process(MLIRBiQuadJIT *jit, BiQuad *bq, double input) {
+  if (!jit || !bq)
+    return 0.0;
+
+  void *handle = backend(jit, bq);
+  if (handle)
+    return plugin_api->process(handle, bq, input);
+  return biquad_process(bq, input);
+}
+
+void mlir_biquad_process_buffer(MLIRBiQuadJIT *jit, BiQuad *bq,
+                                const double *input, double *output,
+                                size_t length) {
+  if (!jit || !bq || !input || !output)
+    return;
+
+  void *handle = backend(jit, bq);
+  if (handle) {
+    plugin_api->process_buffer(handle, bq, input, output, length);
+    return;
+  }
+  for (size_t i = 0; i < length; i++) {
+    output[i] = biquad_process(bq, input[i]);
+  }
+}
+
+void mlir_biquad_process_strided(MLIRBiQuadJIT *jit, BiQuad *bq,
+                                 double *data, size_t frames, size_t stride) {
+  if (!jit || !bq || !data)
+    return;
+
+  void *handle = backend(jit, bq);
+  if (handle) {
+    plugin_api->process_strided(handle, bq, data, frames, stride);
+    return;
+  }
+  biquad_process_strided(bq, data, frames, stride);
+}
+
+void mlir_biquad_jit_destroy(MLIRBiQuadJIT *jit) {
+  if (!jit)
+    return;
+
+  // A backend handle only exists if the plugin was loaded
+  if (jit->backend)
+    plugin_api->jit_destroy(jit->backend);
+  free(jit);
+}
+
+int mlir_biquad_available(void) {
+  return 1; // Decided lazily; a missing plugin falls back to C
+}
@@ -0,0 +1,45 @@
+// MLIR backend plugin: exports the BiQuad JIT as a function table
+// Built as a shared module with hidden visibility, so the statically linked
+// mlir_biquad symbols stay private and cannot clash with the loader's
+// mlir_biquad_* wrappers in the host program.
+
+#include "mlir_biquad.h"
+#include "mlir_plugin.h"
+
+namespace {
+
+void *jitCreate(const BiQuad *bq) {
+    return mlir_biquad_jit_create(bq);
+}
+
+double process(void *jit, BiQuad *bq, double input) {
+    return mlir_biquad_process(static_cast<MLIRBiQuadJIT *>(jit), bq, input);
+}
+
+void processBuffer(void *jit, BiQuad *bq, const double *input, double *output,
+                   size_t length) {
+    mlir_biquad_process_buffer(static_cast<MLIRBiQuadJIT *>(jit), bq, input,
+                               output, length);
+}
+
+void processStrided(void *jit, BiQuad *bq, double *data, size_t frames,
+                    size_t stride) {
+    mlir_biquad_process_strided(static_cast<MLIRBiQuadJIT *>(jit), bq, data,
+                                frames, stride);
+}
+
+void jitDestroy(void *jit) {
+    mlir_biquad_jit_destroy(static_cast<MLIRBiQuadJIT *>(jit));
+}
+
+const MLIRPluginAPI pluginApi = {
+    MLIR_PLUGIN_ABI_VERSION, jitCreate, process, processBuffer,
+    processStrided, jitDestroy,
+};
+
+} // namespace
+
+extern "C" __attribute__((visibility("default")))
+const MLIRPluginAPI *audio_mlir_plugin_api(void) {
+    return &pluginApi;
+}
@@ -0,0 +1,43 @@
+// Interface between the MLIR backend plugin and its loader (not a public
+// header). The plugin carries the BiQuad JIT and all of MLIR/LLVM; programs
+// link the small loader instead and only map the plugin on first JIT use.
+
+#ifndef MLIR_PLUGIN_H
+#define MLIR_PLUGIN_H
+
+#include <stddef.h>
+#include "biquad.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Bumped whenever the table below changes
+#define MLIR_PLUGIN_ABI_VERSION 1
+
+// Plugin file name (searched on the library path) and exported entry point
+#define MLIR_PLUGIN_LIBRARY "libaudio_mlir_plugin.so"
+#define MLIR_PLUGIN_ENTRY "audio_mlir_plugin_api"
+
+// Environment variable overriding the plugin path
+#define MLIR_PLUGIN_ENV "AUDIO_MLIR_PLUGIN"
+
+// mlir_biquad.h entry points; handles are the plugin's MLIRBiQuadJIT
+typedef struct {
+  int abi_version;
+  void *(*jit_create)(const BiQuad *bq);
+  double (*process)(void *jit, BiQuad *bq, double input);
+  void (*process_buffer)(void *jit, BiQuad *bq, const double *input,
+                         double *output, size_t length);
+  void (*process_strided)(void *jit, BiQuad *bq, double *data, size_t frames,
+                          size_t stride);
+  void (*jit_destroy)(void *jit);
+} MLIRPluginAPI;
+
+typedef const MLIRPluginAPI *(*MLIRPluginEntryFn)(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MLIR_PLUGIN_H
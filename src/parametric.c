@@ -47,6 +47,13 @@ static void calculate_parametric_coefficients(BiQuad *bq, double sample_rate,
   biquad_flush_delays(bq);
 }
 
+// Give the channels beyond stereo the (freshly flushed) left filter
+static void reset_extra_channels(ParametricFilter *peq) {
+  for (int c = 0; c < BIQUAD_MAX_CHANNELS - 2; c++) {
+    peq->extra[c] = peq->left;
+  }
+}
+
 // Initialize parametric EQ filter
 void parametric_init(ParametricFilter *peq, double sample_rate, double freq,
                      double gain, double q) {
@@ -65,6 +72,7 @@ void parametric_init(ParametricFilter *peq, double sample_rate, double freq,
   // Calculate and set coefficients for both channels
   calculate_parametric_coefficients(&peq->left, sample_rate, freq, gain, q);
   calculate_parametric_coefficients(&peq->right, sample_rate, freq, gain, q);
+  reset_extra_channels(peq);
 
 #ifdef USE_MLIR
   // Create MLIR JIT contexts for optimized processing
@@ -89,6 +97,7 @@ void parametric_update_coefficients(ParametricFilter *peq, double sample_rate,
   peq->q = q;
   calculate_parametric_coefficients(&peq->left, sample_rate, freq, gain, q);
   calculate_parametric_coefficients(&peq->right, sample_rate, freq, gain, q);
+  reset_extra_channels(peq);
 
 #ifdef USE_MLIR
   // Recreate JIT contexts with new coefficients
@@ -103,6 +112,26 @@ void parametric_update_coefficients(ParametricFilter *peq, double sample_rate,
 #endif
 }
 
+// Retune without touching filter state
+void parametric_retune(ParametricFilter *peq, double sample_rate, double freq,
+                       double gain, double q) {
+  if (!peq)
+    return;
+
+  BiQuad design;
+  biquad_init(&design);
+  calculate_parametric_coefficients(&design, sample_rate, freq, gain, q);
+
+  peq->frequency = freq;
+  peq->gain = gain;
+  peq->q = q;
+  biquad_copy_coefficients(&peq->left, &design);
+  biquad_copy_coefficients(&peq->right, &design);
+  for (int c = 0; c < BIQUAD_MAX_CHANNELS - 2; c++) {
+    biquad_copy_coefficients(&peq->extra[c], &design);
+  }
+}
+
 // Process a single channel of audio
 void parametric_process_channel(ParametricFilter *peq, double *data,
                                 size_t length, int channel) {
@@ -192,13 +221,60 @@ void parametric_process_buffer(ParametricFilter *peq, AudioBuffer *buffer) {
       }
     }
   } else {
-    // Multi-channel: alternate between left and right filters
+    // Multi-channel: one filter per channel
     for (size_t i = 0; i < buffer->length; i++) {
-      int channel = i % buffer->channels;
-      BiQuad *filter = (channel % 2 == 0) ? &peq->left : &peq->right;
+      BiQuad *filter =
+          parametric_channel_filter(peq, (int)(i % buffer->channels));
+      if (!filter)
+        continue;
       double input = buffer->data[i];
       double filtered = biquad_process(filter, input);
       buffer->data[i] = filtered * filter->c0 + input * filter->d0;
     }
   }
 }
+
+// Process a view of an audio buffer
+void parametric_process_view(ParametricFilter *peq, const AudioBufferView *view) {
+  if (!peq || !view || !view->data)
+    return;
+
+  for (int c = 0; c < view->channels; c++) {
+    int channel = view->first_channel + c;
+    BiQuad *filter = parametric_channel_filter(peq, channel);
+    if (!filter)
+      break;
+
+#ifdef USE_MLIR
+    // Kernels take the state per call, so the pair serves every channel
+    MLIRBiQuadJIT *jit = (channel % 2 == 0) ? peq->left_jit : peq->right_jit;
+    if (jit) {
+      mlir_biquad_process_strided(jit, filter, view->data + c, view->frames,
+                                  view->stride);
+      continue;
+    }
+#endif
+
+    biquad_process_strided(filter, view->data + c, view->frames, view->stride);
+  }
+}
+
+// Filter state of a source channel
+BiQuad *parametric_channel_filter(ParametricFilter *peq, int channel) {
+  if (!peq || channel < 0 || channel >= BIQUAD_MAX_CHANNELS)
+    return NULL;
+  if (channel == 0)
+    return &peq->left;
+  if (channel == 1)
+    return &peq->right;
+  return &peq->extra[channel - 2];
+}
+
+// Frames needed to settle the filter state
+size_t parametric_warmup_frames(double sample_rate, double freq,
+                                double gain, double q) {
+  BiQuad bq;
+  biquad_init(&bq);
+  calculate_parametric_coefficients(&bq, sample_rate, freq, gain, q);
+  return biquad_decay_length(&bq, BIQUAD_SETTLE_THRESHOLD);
+}
@@ -0,0 +1,376 @@
+#include "pipeline.h"
+#include "audio_alloc.h"
+#include "audio_view.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Ring entry marking the end of the stream
+#define END_OF_STREAM ((size_t)-1)
+
+// A waiting stage retries this many times, then yields this many times,
+// then sleeps between retries
+#define WAIT_SPINS 64
+#define WAIT_YIELDS 256
+#define WAIT_SLEEP_NS 50000
+
+// Cache line size, to keep the producer and consumer indices apart
+#define CACHE_LINE 64
+
+// Bounded single-producer/single-consumer ring of block indices
+// tail is written only by the producer and head only by the consumer; both
+// count up forever and are masked on access. Each sits on its own cache
+// line so the two sides do not false-share.
+typedef struct {
+  size_t tail;           // Next slot to fill
+  char tail_pad[CACHE_LINE - sizeof(size_t)];
+  size_t head;           // Next slot to drain
+  char head_pad[CACHE_LINE - sizeof(size_t)];
+  size_t mask;           // Capacity - 1 (capacity is a power of two)
+  size_t *slots;
+} Ring;
+
+typedef struct Pipeline Pipeline;
+
+// One filter thread and its rings
+typedef struct {
+  Pipeline *pipeline;
+  const AudioPipelineGroup *group;
+  Ring input;            // Decoded blocks
+  Ring output;           // Filtered blocks
+  double busy;
+} FilterStage;
+
+struct Pipeline {
+  AudioReader *reader;
+  AudioWriter *writer;
+  int num_groups;
+  int channels;
+  int sample_rate;
+  size_t block_frames;
+  size_t num_blocks;
+  double *samples;       // num_blocks blocks of interleaved samples
+  size_t *frames;        // Frames held by each block
+  Ring free_blocks;      // Encode -> decode
+  Ring decoded;          // Decode -> encode when there are no groups
+  FilterStage filters[AUDIO_PIPELINE_MAX_GROUPS];
+  int abort;             // Set once by the first failing stage
+  AudioError error;
+  double decode_busy;
+  double encode_busy;
+  size_t frames_written;
+  size_t blocks_written;
+};
+
+static double now_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int ring_init(Ring *ring, size_t entries) {
+  size_t capacity = 1;
+  while (capacity < entries)
+    capacity <<= 1;
+  memset(ring, 0, sizeof(Ring));
+  ring->mask = capacity - 1;
+  ring->slots = malloc(capacity * sizeof(size_t));
+  return ring->slots != NULL;
+}
+
+static int ring_push(Ring *ring, size_t value) {
+  size_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+  size_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+  if (tail - head > ring->mask)
+    return 0;
+  ring->slots[tail & ring->mask] = value;
+  __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+  return 1;
+}
+
+static int ring_pop(Ring *ring, size_t *value) {
+  size_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+  size_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+  if (head == tail)
+    return 0;
+  *value = ring->slots[head & ring->mask];
+  __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+  return 1;
+}
+
+// Back off while a ring is full or empty
+static void wait_step(unsigned *attempt) {
+  if (*attempt < WAIT_SPINS) {
+    (*attempt)++;
+  } else if (*attempt < WAIT_SPINS + WAIT_YIELDS) {
+    (*attempt)++;
+    sched_yield();
+  } else {
+    struct timespec delay = {0, WAIT_SLEEP_NS};
+    nanosleep(&delay, NULL);
+  }
+}
+
+static int aborted(Pipeline *pipeline) {
+  return __atomic_load_n(&pipeline->abort, __ATOMIC_ACQUIRE);
+}
+
+// Record the first error and make every stage give up
+static void fail(Pipeline *pipeline, AudioError error) {
+  int expected = 0;
+  if (__atomic_compare_exchange_n(&pipeline->abort, &expected, 1, 0,
+                                  __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+    pipeline->error = error;
+}
+
+// Blocking push/pop; return 0 once the pipeline has been aborted
+static int wait_push(Pipeline *pipeline, Ring *ring, size_t value) {
+  unsigned attempt = 0;
+  while (!ring_push(ring, value)) {
+    if (aborted(pipeline))
+      return 0;
+    wait_step(&attempt);
+  }
+  return 1;
+}
+
+static int wait_pop(Pipeline *pipeline, Ring *ring, size_t *value) {
+  unsigned attempt = 0;
+  while (!ring_pop(ring, value)) {
+    if (aborted(pipeline))
+      return 0;
+    wait_step(&attempt);
+  }
+  return 1;
+}
+
+static double *block_data(const Pipeline *pipeline, size_t block) {
+  return pipeline->samples +
+         block * pipeline->block_frames * (size_t)pipeline->channels;
+}
+
+// Hand a decoded block (or the end marker) to every filter
+static int publish(Pipeline *pipeline, size_t block) {
+  if (pipeline->num_groups == 0)
+    return wait_push(pipeline, &pipeline->decoded, block);
+  for (int g = 0; g < pipeline->num_groups; g++) {
+    if (!wait_push(pipeline, &pipeline->filters[g].input, block))
+      return 0;
+  }
+  return 1;
+}
+
+static void *decode_main(void *arg) {
+  Pipeline *pipeline = (Pipeline *)arg;
+  for (;;) {
+    size_t block;
+    if (!wait_pop(pipeline, &pipeline->free_blocks, &block))
+      return NULL;
+
+    double start = now_seconds();
+    size_t frames = audio_reader_read(pipeline->reader,
+                                      block_data(pipeline, block),
+                                      pipeline->block_frames);
+    pipeline->decode_busy += now_seconds() - start;
+
+    // A corrupt or truncated input must not pass for a shorter stream
+    AudioError error = audio_reader_status(pipeline->reader);
+    if (error != AUDIO_SUCCESS) {
+      fail(pipeline, error);
+      return NULL;
+    }
+    if (frames == 0) {
+      publish(pipeline, END_OF_STREAM);
+      return NULL;
+    }
+    pipeline->frames[block] = frames;
+    if (!publish(pipeline, block))
+      return NULL;
+  }
+}
+
+static void *filter_main(void *arg) {
+  FilterStage *stage = (FilterStage *)arg;
+  Pipeline *pipeline = stage->pipeline;
+  const AudioPipelineGroup *group = stage->group;
+  for (;;) {
+    size_t block;
+    if (!wait_pop(pipeline, &stage->input, &block))
+      return NULL;
+
+    if (block != END_OF_STREAM) {
+      double start = now_seconds();
+      AudioBufferView whole, view;
+      audio_view_wrap(&whole, block_data(pipeline, block),
+                      pipeline->frames[block], pipeline->channels,
+                      pipeline->sample_rate);
+      audio_view_select_channels(&whole, group->first_channel,
+                                 group->channels, &view);
+      audio_chain_process_view(group->chain, &view);
+      stage->busy += now_seconds() - start;
+    }
+
+    if (!wait_push(pipeline, &stage->output, block) ||
+        block == END_OF_STREAM)
+      return NULL;
+  }
+}
+
+// Runs on the calling thread
+static void encode_main(Pipeline *pipeline) {
+  for (;;) {
+    // Every filter hands over the same sequence of blocks
+    size_t block = END_OF_STREAM;
+    if (pipeline->num_groups == 0) {
+      if (!wait_pop(pipeline, &pipeline->decoded, &block))
+        return;
+    }
+    for (int g = 0; g < pipeline->num_groups; g++) {
+      if (!wait_pop(pipeline, &pipeline->filters[g].output, &block))
+        return;
+    }
+    if (block == END_OF_STREAM)
+      return;
+
+    double start = now_seconds();
+    AudioError error = audio_writer_write(
+        pipeline->writer, block_data(pipeline, block), pipeline->frames[block]);
+    pipeline->encode_busy += now_seconds() - start;
+    if (error != AUDIO_SUCCESS) {
+      fail(pipeline, error);
+      return;
+    }
+    pipeline->frames_written += pipeline->frames[block];
+    pipeline->blocks_written++;
+
+    if (!wait_push(pipeline, &pipeline->free_blocks, block))
+      return;
+  }
+}
+
+// Groups must be inside the stream and must not share channels
+static int groups_valid(const AudioPipelineGroup *groups, int num_groups,
+                        int channels) {
+  if (num_groups < 0 || num_groups > AUDIO_PIPELINE_MAX_GROUPS ||
+      (num_groups > 0 && !groups))
+    return 0;
+
+  for (int g = 0; g < num_groups; g++) {
+    const AudioPipelineGroup *group = &groups[g];
+    if (!group->chain || group->first_channel < 0 || group->channels < 1 ||
+        group->first_channel + group->channels > channels)
+      return 0;
+    for (int h = 0; h < g; h++) {
+      const AudioPipelineGroup *other = &groups[h];
+      if (group->first_channel < other->first_channel + other->channels &&
+          other->first_channel < group->first_channel + group->channels)
+        return 0;
+    }
+  }
+  return 1;
+}
+
+static void pipeline_free(Pipeline *pipeline) {
+  free(pipeline->free_blocks.slots);
+  free(pipeline->decoded.slots);
+  for (int g = 0; g < AUDIO_PIPELINE_MAX_GROUPS; g++) {
+    free(pipeline->filters[g].input.slots);
+    free(pipeline->filters[g].output.slots);
+  }
+  free(pipeline->frames);
+  audio_free(pipeline->samples);
+  audio_free(pipeline);
+}
+
+AudioError audio_pipeline_run(AudioReader *reader, AudioWriter *writer,
+                              const AudioPipelineGroup *groups, int num_groups,
+                              size_t block_frames, size_t ring_blocks,
+                              AudioPipelineStats *stats) {
+  if (!reader || !writer)
+    return AUDIO_ERROR_INVALID_PARAMETER;
+
+  const AudioFileInfo *info = audio_reader_info(reader);
+  if (!groups_valid(groups, num_groups, info->channels))
+    return AUDIO_ERROR_INVALID_PARAMETER;
+
+  // Cache-line aligned, for the ring indices
+  Pipeline *pipeline = audio_alloc(sizeof(Pipeline));
+  if (!pipeline)
+    return AUDIO_ERROR_MEMORY_ERROR;
+  memset(pipeline, 0, sizeof(Pipeline));
+  pipeline->reader = reader;
+  pipeline->writer = writer;
+  pipeline->num_groups = num_groups;
+  pipeline->channels = info->channels;
+  pipeline->sample_rate = info->sample_rate;
+  pipeline->block_frames = block_frames ? block_frames
+                                        : AUDIO_PIPELINE_BLOCK_FRAMES;
+  pipeline->num_blocks = ring_blocks ? ring_blocks : AUDIO_PIPELINE_RING_BLOCKS;
+  pipeline->error = AUDIO_SUCCESS;
+
+  // Rings between stages also carry the end marker
+  size_t entries = pipeline->num_blocks + 1;
+  int ok = ring_init(&pipeline->free_blocks, pipeline->num_blocks) &&
+           ring_init(&pipeline->decoded, entries);
+  for (int g = 0; g < num_groups && ok; g++) {
+    FilterStage *stage = &pipeline->filters[g];
+    stage->pipeline = pipeline;
+    stage->group = &groups[g];
+    ok = ring_init(&stage->input, entries) &&
+         ring_init(&stage->output, entries);
+  }
+  pipeline->frames = malloc(pipeline->num_blocks * sizeof(size_t));
+  pipeline->samples =
+      audio_alloc(pipeline->num_blocks * pipeline->block_frames *
+                  (size_t)pipeline->channels * sizeof(double));
+  if (!ok || !pipeline->frames || !pipeline->samples) {
+    pipeline_free(pipeline);
+    return AUDIO_ERROR_MEMORY_ERROR;
+  }
+  for (size_t b = 0; b < pipeline->num_blocks; b++)
+    ring_push(&pipeline->free_blocks, b);
+
+  double start = now_seconds();
+  pthread_t decoder, filters[AUDIO_PIPELINE_MAX_GROUPS];
+  int started[AUDIO_PIPELINE_MAX_GROUPS] = {0};
+  int decoding =
+      pthread_create(&decoder, NULL, decode_main, pipeline) == 0;
+  for (int g = 0; g < num_groups && decoding; g++) {
+    started[g] = pthread_create(&filters[g], NULL, filter_main,
+                                &pipeline->filters[g]) == 0;
+    if (!started[g])
+      break;
+  }
+
+  int complete = decoding;
+  for (int g = 0; g < num_groups; g++)
+    complete = complete && started[g];
+  if (complete)
+    encode_main(pipeline);
+  else
+    fail(pipeline, AUDIO_ERROR_MEMORY_ERROR);
+
+  if (decoding)
+    pthread_join(decoder, NULL);
+  for (int g = 0; g < num_groups; g++) {
+    if (started[g])
+      pthread_join(filters[g], NULL);
+  }
+
+  if (stats) {
+    memset(stats, 0, sizeof(AudioPipelineStats));
+    stats->frames = pipeline->frames_written;
+    stats->blocks = pipeline->blocks_written;
+    stats->wall_seconds = now_seconds() - start;
+    stats->decode_seconds = pipeline->decode_busy;
+    stats->encode_seconds = pipeline->encode_busy;
+    for (int g = 0; g < num_groups; g++)
+      stats->filter_seconds[g] = pipeline->filters[g].busy;
+  }
+
+  AudioError error = pipeline->error;
+  pipeline_free(pipeline);
+  return error;
+}
@@ -0,0 +1,133 @@
+#define _GNU_SOURCE
+#include "prefork.h"
+#include "audio_alloc.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+AudioError audio_shared_arena_create(AudioSharedArena *arena, const char *name,
+                                     size_t size) {
+  if (!arena || size == 0)
+    return AUDIO_ERROR_INVALID_PARAMETER;
+
+  memset(arena, 0, sizeof(AudioSharedArena));
+  arena->fd = -1;
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  size = (size + page - 1) / page * page;
+
+#ifdef MFD_ALLOW_SEALING
+  int fd = memfd_create(name ? name : "audio-arena",
+                        MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (fd >= 0) {
+    if (ftruncate(fd, (off_t)size) != 0) {
+      close(fd);
+      return AUDIO_ERROR_MEMORY_ERROR;
+    }
+    arena->fd = fd;
+  }
+#else
+  (void)name;
+#endif
+
+  void *base;
+  if (arena->fd >= 0)
+    base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, arena->fd, 0);
+  else
+    base = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) {
+    if (arena->fd >= 0)
+      close(arena->fd);
+    arena->fd = -1;
+    return AUDIO_ERROR_MEMORY_ERROR;
+  }
+
+  arena->base = base;
+  arena->size = size;
+  return AUDIO_SUCCESS;
+}
+
+void *audio_shared_arena_alloc(AudioSharedArena *arena, size_t size) {
+  if (!arena || !arena->base || arena->sealed)
+    return NULL;
+
+  size_t offset = (arena->used + AUDIO_ALLOC_ALIGNMENT - 1) &
+                  ~(size_t)(AUDIO_ALLOC_ALIGNMENT - 1);
+  if (offset > arena->size || size > arena->size - offset)
+    return NULL;
+  arena->used = offset + size;
+  return arena->base + offset;
+}
+
+AudioError audio_shared_arena_seal(AudioSharedArena *arena) {
+  if (!arena || !arena->base)
+    return AUDIO_ERROR_INVALID_PARAMETER;
+
+  if (mprotect(arena->base, arena->size, PROT_READ) != 0)
+    return AUDIO_ERROR_INVALID_PARAMETER;
+#ifdef F_ADD_SEALS
+  // Best effort: the mapping is what protects the data
+  if (arena->fd >= 0)
+    fcntl(arena->fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+#endif
+  arena->sealed = 1;
+  return AUDIO_SUCCESS;
+}
+
+void audio_shared_arena_destroy(AudioSharedArena *arena) {
+  if (!arena)
+    return;
+
+  if (arena->base)
+    munmap(arena->base, arena->size);
+  if (arena->fd >= 0)
+    close(arena->fd);
+  memset(arena, 0, sizeof(AudioSharedArena));
+  arena->fd = -1;
+}
+
+AudioError audio_prefork_run(int workers, AudioWorkerFn fn, void *user,
+                             int *failed) {
+  if (failed)
+    *failed = 0;
+  if (!fn || workers < 1 || workers > AUDIO_PREFORK_MAX_WORKERS)
+    return AUDIO_ERROR_INVALID_PARAMETER;
+
+  pid_t pids[AUDIO_PREFORK_MAX_WORKERS];
+  int started = 0;
+  AudioError status = AUDIO_SUCCESS;
+
+  fflush(NULL);
+  for (int w = 0; w < workers; w++) {
+    pid_t pid = fork();
+    if (pid < 0) {
+      status = AUDIO_ERROR_MEMORY_ERROR;
+      break;
+    }
+    if (pid == 0) {
+      int result = fn(user, w);
+      fflush(NULL);
+      _exit(result & 0xFF);
+    }
+    pids[started++] = pid;
+  }
+
+  int bad = 0;
+  for (int w = 0; w < started; w++) {
+    int wstatus;
+    pid_t done;
+    do {
+      done = waitpid(pids[w], &wstatus, 0);
+    } while (done < 0 && errno == EINTR);
+    if (done < 0 || !WIFEXITED(wstatus) || WEXITSTATUS(wstatus) != 0)
+      bad++;
+  }
+
+  if (failed)
+    *failed = bad;
+  return status;
+}
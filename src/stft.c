@@ -0,0 +1,873 @@
+#include "stft.h"
+#include "audio_alloc.h"
+#include "audio_numa.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Analysis frames each worker computes per batch
+#define STFT_FRAMES_PER_THREAD 32
+
+// DB16 encoding: hundredths of a dB, with a floor that decodes to 0
+#define DB16_SCALE 100.0
+#define DB16_FLOOR -30000
+
+// Real FFT of size n computed as a complex FFT of n/2 points (even samples
+// in the real part, odd in the imaginary part) plus a split step
+struct FFTPlan {
+  size_t size;         // Real input length n
+  size_t half;         // Complex length m = n / 2
+  size_t *reverse;     // Bit-reversal permutation of 0..m-1
+  double *twiddle_re;  // e^(-2 pi i k / m), k < m / 2
+  double *twiddle_im;
+  double *split_re;    // e^(-2 pi i k / n), k <= m
+  double *split_im;
+  int node;            // NUMA node holding the tables
+  FFTPlan *next;       // Cache list
+};
+
+static pthread_mutex_t plan_lock = PTHREAD_MUTEX_INITIALIZER;
+static FFTPlan *plan_cache = NULL;
+
+static void fft_plan_destroy(FFTPlan *plan) {
+  if (!plan)
+    return;
+
+  audio_free(plan->reverse);
+  audio_free(plan->twiddle_re);
+  audio_free(plan->twiddle_im);
+  audio_free(plan->split_re);
+  audio_free(plan->split_im);
+  free(plan);
+}
+
+static FFTPlan *fft_plan_create(size_t size, int node) {
+  FFTPlan *plan = calloc(1, sizeof(FFTPlan));
+  if (!plan)
+    return NULL;
+
+  size_t m = size / 2;
+  plan->size = size;
+  plan->half = m;
+  plan->node = node;
+  plan->reverse = audio_alloc_on_node(m * sizeof(size_t), node);
+  plan->twiddle_re = audio_alloc_on_node((m / 2) * sizeof(double), node);
+  plan->twiddle_im = audio_alloc_on_node((m / 2) * sizeof(double), node);
+  plan->split_re = audio_alloc_on_node((m + 1) * sizeof(double), node);
+  plan->split_im = audio_alloc_on_node((m + 1) * sizeof(double), node);
+  if (!plan->reverse || !plan->twiddle_re || !plan->twiddle_im ||
+      !plan->split_re || !plan->split_im) {
+    fft_plan_destroy(plan);
+    return NULL;
+  }
+
+  int bits = 0;
+  while (((size_t)1 << bits) < m)
+    bits++;
+  for (size_t k = 0; k < m; k++) {
+    size_t r = 0;
+    for (int b = 0; b < bits; b++) {
+      r |= ((k >> b) & 1) << (bits - 1 - b);
+    }
+    plan->reverse[k] = r;
+  }
+
+  for (size_t k = 0; k < m / 2; k++) {
+    double angle = -2.0 * M_PI * (double)k / (double)m;
+    plan->twiddle_re[k] = cos(angle);
+    plan->twiddle_im[k] = sin(angle);
+  }
+  for (size_t k = 0; k <= m; k++) {
+    double angle = -2.0 * M_PI * (double)k / (double)size;
+    plan->split_re[k] = cos(angle);
+    plan->split_im[k] = sin(angle);
+  }
+  return plan;
+}
+
+// Cached plan of a size with its tables on a NUMA node
+static const FFTPlan *plan_get_on_node(size_t size, int node) {
+  if (size < STFT_MIN_FFT_SIZE || size > STFT_MAX_FFT_SIZE ||
+      (size & (size - 1)) != 0)
+    return NULL;
+
+  pthread_mutex_lock(&plan_lock);
+  FFTPlan *plan = plan_cache;
+  while (plan && (plan->size != size || plan->node != node))
+    plan = plan->next;
+  if (!plan) {
+    plan = fft_plan_create(size, node);
+    if (plan) {
+      plan->next = plan_cache;
+      plan_cache = plan;
+    }
+  }
+  pthread_mutex_unlock(&plan_lock);
+  return plan;
+}
+
+const FFTPlan *fft_plan_get(size_t size) {
+  return plan_get_on_node(size, audio_numa_current_node());
+}
+
+void fft_plan_cache_clear(void) {
+  pthread_mutex_lock(&plan_lock);
+  while (plan_cache) {
+    FFTPlan *next = plan_cache->next;
+    fft_plan_destroy(plan_cache);
+    plan_cache = next;
+  }
+  pthread_mutex_unlock(&plan_lock);
+}
+
+void fft_plan_execute(const FFTPlan *plan, const double *input, double *re,
+                      double *im) {
+  if (!plan || !input || !re || !im)
+    return;
+
+  size_t m = plan->half;
+
+  // Pack even/odd samples as complex values in bit-reversed order
+  for (size_t k = 0; k < m; k++) {
+    size_t r = plan->reverse[k];
+    re[r] = input[2 * k];
+    im[r] = input[2 * k + 1];
+  }
+
+  // Iterative radix-2 decimation-in-time butterflies
+  for (size_t len = 2; len <= m; len <<= 1) {
+    size_t half = len / 2;
+    size_t step = m / len;
+    for (size_t i = 0; i < m; i += len) {
+      for (size_t j = 0; j < half; j++) {
+        double wr = plan->twiddle_re[j * step];
+        double wi = plan->twiddle_im[j * step];
+        size_t a = i + j, b = a + half;
+        double vr = re[b] * wr - im[b] * wi;
+        double vi = re[b] * wi + im[b] * wr;
+        re[b] = re[a] - vr;
+        im[b] = im[a] - vi;
+        re[a] += vr;
+        im[a] += vi;
+      }
+    }
+  }
+
+  // Split: with A = Z[k], B = Z[m - k], the even and odd halves are
+  // E = (A + conj B) / 2 and O = (A - conj B) / 2i, X[k] = E + W^k O and
+  // X[m - k] = conj(E) + W^(m - k) conj(O)
+  double r0 = re[0], i0 = im[0];
+  re[0] = r0 + i0;
+  im[0] = 0.0;
+  re[m] = r0 - i0;
+  im[m] = 0.0;
+  for (size_t k = 1; k <= m / 2; k++) {
+    size_t j = m - k;
+    double ar = re[k], ai = im[k], br = re[j], bi = im[j];
+    double er = 0.5 * (ar + br), ei = 0.5 * (ai - bi);
+    double odd_re = 0.5 * (ai + bi), odd_im = -0.5 * (ar - br);
+
+    double wr = plan->split_re[k], wi = plan->split_im[k];
+    re[k] = er + wr * odd_re - wi * odd_im;
+    im[k] = ei + wr * odd_im + wi * odd_re;
+    if (j != k) {
+      double vr = plan->split_re[j], vi = plan->split_im[j];
+      re[j] = er + vr * odd_re + vi * odd_im;
+      im[j] = -ei + vi * odd_re - vr * odd_im;
+    }
+  }
+}
+
+void stft_config_default(StftConfig *config) {
+  if (!config)
+    return;
+
+  config->fft_size = 2048;
+  config->hop = 512;
+  config->window = STFT_WINDOW_HANN;
+  config->threads = 0;
+}
+
+// Audio available to a batch: `frames` interleaved frames starting at
+// absolute frame `start`; anything outside reads as silence
+typedef struct {
+  const double *data;
+  size_t start;
+  size_t frames;
+} StftSource;
+
+// One worker's share of a batch
+typedef struct {
+  const StftEngine *engine;
+  const StftSource *source;
+  size_t first_frame;    // Absolute index of the batch's first frame
+  size_t begin, end;     // Batch-relative frames for this worker
+  const FFTPlan *plan;
+  double *scratch;
+} StftJob;
+
+// Argument of a persistent worker thread
+typedef struct {
+  StftEngine *engine;
+  int index;
+} StftWorker;
+
+struct StftEngine {
+  StftConfig config;
+  int channels;
+  int sample_rate;
+  int threads;
+  size_t bins;
+  int nodes[STFT_MAX_THREADS];             // NUMA node of each worker
+  const FFTPlan *plans[STFT_MAX_THREADS];  // Each worker's node-local plan
+  double *scratch[STFT_MAX_THREADS];       // Each worker's node-local scratch
+  int pin;               // Pin workers 1.. to their nodes (multi-node only)
+  double *window;        // fft_size window coefficients
+  double edge_scale;     // Magnitude scale of DC and Nyquist
+  double bin_scale;      // Magnitude scale of the other bins
+  size_t batch_frames;   // Analysis frames per batch
+  float *batch;          // batch_frames * channels * bins magnitudes
+
+  // Workers 1..spawned live as long as the engine (worker 0 is the caller).
+  // Each batch bumps `generation` under the lock; the last worker to finish
+  // its job signals `done`.
+  StftJob jobs[STFT_MAX_THREADS];
+  StftWorker args[STFT_MAX_THREADS];
+  pthread_t workers[STFT_MAX_THREADS];
+  int spawned;
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+  pthread_cond_t done;
+  unsigned long generation;
+  int pending;           // Workers still busy on the current batch
+  int quit;
+};
+
+// Window coefficient i of n (periodic form)
+static double window_value(StftWindow window, size_t i, size_t n) {
+  double phase = 2.0 * M_PI * (double)i / (double)n;
+  switch (window) {
+  case STFT_WINDOW_HANN:
+    return 0.5 - 0.5 * cos(phase);
+  case STFT_WINDOW_HAMMING:
+    return 0.54 - 0.46 * cos(phase);
+  case STFT_WINDOW_BLACKMAN:
+    return 0.42 - 0.5 * cos(phase) + 0.08 * cos(2.0 * phase);
+  case STFT_WINDOW_RECTANGULAR:
+  default:
+    return 1.0;
+  }
+}
+
+static size_t scratch_doubles(const StftEngine *engine) {
+  return engine->config.fft_size + 2 * engine->bins;
+}
+
+static void *stft_worker_main(void *arg);
+
+StftEngine *stft_engine_create(const StftConfig *config, int channels,
+                               int sample_rate, AudioError *error) {
+  const FFTPlan *plan = config ? fft_plan_get(config->fft_size) : NULL;
+  if (!plan || config->hop == 0 || channels < 1 || sample_rate <= 0 ||
+      (int)config->window < 0 || config->window > STFT_WINDOW_BLACKMAN) {
+    if (error)
+      *error = AUDIO_ERROR_INVALID_PARAMETER;
+    return NULL;
+  }
+
+  StftEngine *engine = calloc(1, sizeof(StftEngine));
+  if (!engine) {
+    if (error)
+      *error = AUDIO_ERROR_MEMORY_ERROR;
+    return NULL;
+  }
+  pthread_mutex_init(&engine->lock, NULL);
+  pthread_cond_init(&engine->wake, NULL);
+  pthread_cond_init(&engine->done, NULL);
+
+  engine->config = *config;
+  engine->channels = channels;
+  engine->sample_rate = sample_rate;
+  engine->bins = config->fft_size / 2 + 1;
+
+  int threads = config->threads;
+  if (threads <= 0)
+    threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (threads < 1)
+    threads = 1;
+  if (threads > STFT_MAX_THREADS)
+    threads = STFT_MAX_THREADS;
+  engine->threads = threads;
+  engine->batch_frames = (size_t)threads * STFT_FRAMES_PER_THREAD;
+
+  // Worker 0 runs on the calling thread's node; the spawned workers are
+  // dealt round-robin over the nodes from there, each with its plan tables
+  // and scratch on its own node so FFTs never reach across sockets
+  int num_nodes = audio_numa_topology()->num_nodes;
+  int home = audio_numa_current_node();
+  engine->pin = num_nodes > 1;
+  int failed = 0;
+  for (int t = 0; t < threads; t++) {
+    engine->nodes[t] = (home + t) % num_nodes;
+    engine->plans[t] = plan_get_on_node(config->fft_size, engine->nodes[t]);
+    engine->scratch[t] = audio_alloc_on_node(
+        scratch_doubles(engine) * sizeof(double), engine->nodes[t]);
+    if (!engine->plans[t] || !engine->scratch[t])
+      failed = 1;
+  }
+
+  size_t n = config->fft_size;
+  engine->window = malloc(n * sizeof(double));
+  engine->batch =
+      malloc(engine->batch_frames * channels * engine->bins * sizeof(float));
+  if (failed || !engine->window || !engine->batch) {
+    stft_engine_destroy(engine);
+    if (error)
+      *error = AUDIO_ERROR_MEMORY_ERROR;
+    return NULL;
+  }
+
+  // A full-scale sine peaks at sum(w) / 2 in its bin
+  double sum = 0.0;
+  for (size_t i = 0; i < n; i++) {
+    engine->window[i] = window_value(config->window, i, n);
+    sum += engine->window[i];
+  }
+  engine->edge_scale = 1.0 / sum;
+  engine->bin_scale = 2.0 / sum;
+
+  // Start the workers once; if a spawn fails, the caller runs the jobs of
+  // the workers that are missing
+  for (int t = 1; t < threads; t++) {
+    engine->args[t].engine = engine;
+    engine->args[t].index = t;
+    if (pthread_create(&engine->workers[t], NULL, stft_worker_main,
+                       &engine->args[t]) != 0)
+      break;
+    engine->spawned = t;
+  }
+
+  if (error)
+    *error = AUDIO_SUCCESS;
+  return engine;
+}
+
+void stft_engine_destroy(StftEngine *engine) {
+  if (!engine)
+    return;
+
+  pthread_mutex_lock(&engine->lock);
+  engine->quit = 1;
+  pthread_cond_broadcast(&engine->wake);
+  pthread_mutex_unlock(&engine->lock);
+  for (int t = 1; t <= engine->spawned; t++)
+    pthread_join(engine->workers[t], NULL);
+  pthread_mutex_destroy(&engine->lock);
+  pthread_cond_destroy(&engine->wake);
+  pthread_cond_destroy(&engine->done);
+
+  for (int t = 0; t < engine->threads; t++)
+    audio_free(engine->scratch[t]);
+  free(engine->window);
+  free(engine->batch);
+  free(engine);
+}
+
+size_t stft_engine_bins(const StftEngine *engine) {
+  return engine ? engine->bins : 0;
+}
+
+// Window, transform and take magnitudes of every channel of one frame
+static void analyze_frame(const StftEngine *engine, const StftJob *job,
+                          size_t frame, float *output) {
+  const StftSource *source = job->source;
+  double *scratch = job->scratch;
+  size_t n = engine->config.fft_size;
+  size_t bins = engine->bins;
+  int channels = engine->channels;
+  double *input = scratch;
+  double *re = scratch + n;
+  double *im = re + bins;
+
+  size_t first = frame * engine->config.hop;
+  for (int c = 0; c < channels; c++) {
+    for (size_t i = 0; i < n; i++) {
+      size_t s = first + i - source->start;
+      double x = s < source->frames ? source->data[s * channels + c] : 0.0;
+      input[i] = x * engine->window[i];
+    }
+
+    fft_plan_execute(job->plan, input, re, im);
+
+    float *magnitudes = output + (size_t)c * bins;
+    for (size_t k = 0; k < bins; k++) {
+      double scale =
+          (k == 0 || k == bins - 1) ? engine->edge_scale : engine->bin_scale;
+      magnitudes[k] = (float)(sqrt(re[k] * re[k] + im[k] * im[k]) * scale);
+    }
+  }
+}
+
+static void run_job(const StftJob *job) {
+  const StftEngine *engine = job->engine;
+  size_t record = (size_t)engine->channels * engine->bins;
+  for (size_t i = job->begin; i < job->end; i++) {
+    analyze_frame(engine, job, job->first_frame + i,
+                  engine->batch + i * record);
+  }
+}
+
+// Persistent worker: run this worker's job of every batch until shutdown
+static void *stft_worker_main(void *arg) {
+  StftWorker *worker = (StftWorker *)arg;
+  StftEngine *engine = worker->engine;
+  if (engine->pin)
+    audio_numa_pin_thread(engine->nodes[worker->index]);
+
+  unsigned long seen = 0;
+  pthread_mutex_lock(&engine->lock);
+  for (;;) {
+    while (!engine->quit && engine->generation == seen)
+      pthread_cond_wait(&engine->wake, &engine->lock);
+    if (engine->quit)
+      break;
+    seen = engine->generation;
+    pthread_mutex_unlock(&engine->lock);
+
+    run_job(&engine->jobs[worker->index]);
+
+    pthread_mutex_lock(&engine->lock);
+    if (--engine->pending == 0)
+      pthread_cond_signal(&engine->done);
+  }
+  pthread_mutex_unlock(&engine->lock);
+  return NULL;
+}
+
+// Compute `count` frames from `first_frame` in parallel, then emit in order
+static AudioError run_batch(StftEngine *engine, const StftSource *source,
+                            size_t first_frame, size_t count, StftSink sink,
+                            void *user) {
+  // Workers past the frame count get empty ranges
+  int workers = engine->threads;
+  if ((size_t)workers > count)
+    workers = (int)count;
+  size_t share = (count + workers - 1) / workers;
+
+  for (int t = 0; t < engine->threads; t++) {
+    StftJob *job = &engine->jobs[t];
+    job->engine = engine;
+    job->source = source;
+    job->first_frame = first_frame;
+    job->begin = t * share < count ? t * share : count;
+    job->end = (t + 1) * share < count ? (t + 1) * share : count;
+    job->plan = engine->plans[t];
+    job->scratch = engine->scratch[t];
+  }
+
+  if (engine->spawned > 0) {
+    pthread_mutex_lock(&engine->lock);
+    engine->generation++;
+    engine->pending = engine->spawned;
+    pthread_cond_broadcast(&engine->wake);
+    pthread_mutex_unlock(&engine->lock);
+  }
+
+  // Worker 0, and any worker that could not be started, run here
+  run_job(&engine->jobs[0]);
+  for (int t = engine->spawned + 1; t < engine->threads; t++)
+    run_job(&engine->jobs[t]);
+
+  if (engine->spawned > 0) {
+    pthread_mutex_lock(&engine->lock);
+    while (engine->pending > 0)
+      pthread_cond_wait(&engine->done, &engine->lock);
+    pthread_mutex_unlock(&engine->lock);
+  }
+
+  size_t record = (size_t)engine->channels * engine->bins;
+  for (size_t i = 0; i < count; i++) {
+    if (sink && sink(user, first_frame + i, engine->batch + i * record) != 0)
+      return AUDIO_ERROR_WRITE_ERROR;
+  }
+  return AUDIO_SUCCESS;
+}
+
+// Number of analysis frames for a signal length
+static size_t frame_count(const StftEngine *engine, size_t samples) {
+  size_t hop = engine->config.hop;
+  return (samples + hop - 1) / hop;
+}
+
+AudioError stft_process_buffer(StftEngine *engine, const AudioBuffer *buffer,
+                               StftSink sink, void *user) {
+  if (!engine || !buffer || !buffer->data)
+    return AUDIO_ERROR_INVALID_PARAMETER;
+  if (buffer->channels != engine->channels ||
+      buffer->sample_rate != engine->sample_rate)
+    return AUDIO_ERROR_UNSUPPORTED_FORMAT;
+
+  StftSource source = {buffer->data, 0, buffer->length / buffer->channels};
+  size_t frames = frame_count(engine, source.frames);
+  for (size_t f = 0; f < frames; f += engine->batch_frames) {
+    size_t count = frames - f;
+    if (count > engine->batch_frames)
+      count = engine->batch_frames;
+    AudioError error = run_batch(engine, &source, f, count, sink, user);
+    if (error != AUDIO_SUCCESS)
+      return error;
+  }
+  return AUDIO_SUCCESS;
+}
+
+AudioError stft_process_reader(StftEngine *engine, AudioReader *reader,
+                               StftSink sink, void *user) {
+  if (!engine || !reader)
+    return AUDIO_ERROR_INVALID_PARAMETER;
+
+  const AudioFileInfo *info = audio_reader_info(reader);
+  if (info->channels != engine->channels ||
+      info->sample_rate != engine->sample_rate)
+    return AUDIO_ERROR_UNSUPPORTED_FORMAT;
+
+  AudioError error = audio_reader_seek(reader, 0);
+  if (error != AUDIO_SUCCESS)
+    return error;
+
+  // One batch of frames spans (batch - 1) * hop + fft_size samples
+  size_t hop = engine->config.hop;
+  size_t span = (engine->batch_frames - 1) * hop + engine->config.fft_size;
+  int channels = engine->channels;
+  double *data = malloc(span * channels * sizeof(double));
+  if (!data)
+    return AUDIO_ERROR_MEMORY_ERROR;
+
+  StftSource source = {data, 0, 0};
+  size_t frames = frame_count(engine, info->frames);
+  for (size_t f = 0; f < frames && error == AUDIO_SUCCESS;
+       f += engine->batch_frames) {
+    size_t count = frames - f;
+    if (count > engine->batch_frames)
+      count = engine->batch_frames;
+
+    // Drop samples before this batch, keeping the overlap with the last one
+    size_t start = f * hop;
+    size_t drop = start - source.start;
+    if (drop > source.frames)
+      drop = source.frames;
+    memmove(data, data + drop * channels,
+            (source.frames - drop) * channels * sizeof(double));
+    source.frames -= drop;
+    source.start += drop;
+
+    // Skip input between frames when the hop exceeds the FFT size
+    while (source.start < start) {
+      size_t skip = start - source.start;
+      size_t read = audio_reader_read(reader, data, skip < span ? skip : span);
+      if (read == 0)
+        break;
+      source.start += read;
+    }
+    if (source.start < start)
+      source.start = start;
+
+    while (source.frames < span) {
+      size_t read = audio_reader_read(reader, data + source.frames * channels,
+                                      span - source.frames);
+      if (read == 0)
+        break;
+      source.frames += read;
+    }
+
+    // A short read is only the end of the input if the reader says so
+    error = audio_reader_status(reader);
+    if (error == AUDIO_SUCCESS)
+      error = run_batch(engine, &source, f, count, sink, user);
+  }
+
+  free(data);
+  return error;
+}
+
+// Spectrogram file writer state
+struct StftFile {
+  FILE *file;
+  StftFileHeader header;
+  size_t values;         // Magnitudes per frame
+  void *record;          // One encoded frame
+  AudioError status;
+};
+
+static void fill_header(StftFileHeader *header, const StftEngine *engine,
+                        StftEncoding encoding) {
+  memset(header, 0, sizeof(StftFileHeader));
+  memcpy(header->magic, "STFT", 4);
+  header->version = STFT_FILE_VERSION;
+  header->encoding = encoding;
+  header->sample_rate = engine->sample_rate;
+  header->channels = engine->channels;
+  header->window = engine->config.window;
+  header->fft_size = engine->config.fft_size;
+  header->hop = engine->config.hop;
+  header->bins = engine->bins;
+  header->frames = 0;
+}
+
+static size_t encoded_size(StftEncoding encoding) {
+  return encoding == STFT_ENCODING_DB16 ? sizeof(int16_t) : sizeof(float);
+}
+
+StftFile *stft_file_open(const char *filepath, const StftEngine *engine,
+                         StftEncoding encoding, AudioError *error) {
+  if (!filepath || !engine ||
+      (encoding != STFT_ENCODING_FLOAT32 && encoding != STFT_ENCODING_DB16)) {
+    if (error)
+      *error = AUDIO_ERROR_INVALID_PARAMETER;
+    return NULL;
+  }
+
+  StftFile *file = calloc(1, sizeof(StftFile));
+  if (!file) {
+    if (error)
+      *error = AUDIO_ERROR_MEMORY_ERROR;
+    return NULL;
+  }
+
+  fill_header(&file->header, engine, encoding);
+  file->values = (size_t)engine->channels * engine->bins;
+  file->record = malloc(file->values * encoded_size(encoding));
+  file->status = AUDIO_SUCCESS;
+  if (!file->record) {
+    stft_file_close(file);
+    if (error)
+      *error = AUDIO_ERROR_MEMORY_ERROR;
+    return NULL;
+  }
+
+  file->file = fopen(filepath, "wb");
+  if (!file->file ||
+      fwrite(&file->header, sizeof(StftFileHeader), 1, file->file) != 1) {
+    stft_file_close(file);
+    if (error)
+      *error = AUDIO_ERROR_WRITE_ERROR;
+    return NULL;
+  }
+
+  if (error)
+    *error = AUDIO_SUCCESS;
+  return file;
+}
+
+int stft_file_sink(void *user, size_t frame, const float *magnitudes) {
+  StftFile *file = (StftFile *)user;
+  (void)frame;
+  if (file->status != AUDIO_SUCCESS)
+    return 1;
+
+  if (file->header.encoding == STFT_ENCODING_DB16) {
+    int16_t *out = (int16_t *)file->record;
+    for (size_t i = 0; i < file->values; i++) {
+      double db = magnitudes[i] > 0.0f
+                      ? 20.0 * log10(magnitudes[i]) * DB16_SCALE
+                      : DB16_FLOOR;
+      if (db < DB16_FLOOR)
+        db = DB16_FLOOR;
+      if (db > INT16_MAX)
+        db = INT16_MAX;
+      out[i] = (int16_t)lrint(db);
+    }
+  } else {
+    memcpy(file->record, magnitudes, file->values * sizeof(float));
+  }
+
+  size_t bytes = file->values * encoded_size(file->header.encoding);
+  if (fwrite(file->record, 1, bytes, file->file) != bytes) {
+    file->status = AUDIO_ERROR_WRITE_ERROR;
+    return 1;
+  }
+  file->header.frames++;
+  return 0;
+}
+
+AudioError stft_file_close(StftFile *file) {
+  if (!file)
+    return AUDIO_ERROR_INVALID_PARAMETER;
+
+  AudioError status = file->status;
+  if (file->file) {
+    if (status == AUDIO_SUCCESS &&
+        (fseek(file->file, 0, SEEK_SET) != 0 ||
+         fwrite(&file->header, sizeof(StftFileHeader), 1, file->file) != 1)) {
+      status = AUDIO_ERROR_WRITE_ERROR;
+    }
+    if (fclose(file->file) != 0 && status == AUDIO_SUCCESS)
+      status = AUDIO_ERROR_WRITE_ERROR;
+  }
+
+  free(file->record);
+  free(file);
+  return status;
+}
+
+Spectrogram *spectrogram_read(const char *filepath, AudioError *error) {
+  AudioError status = AUDIO_SUCCESS;
+  Spectrogram *spec = NULL;
+  void *record = NULL;
+
+  FILE *file = filepath ? fopen(filepath, "rb") : NULL;
+  if (!file) {
+    if (error)
+      *error = filepath ? AUDIO_ERROR_FILE_NOT_FOUND
+                        : AUDIO_ERROR_INVALID_PARAMETER;
+    return NULL;
+  }
+
+  StftFileHeader header;
+  if (fread(&header, sizeof(StftFileHeader), 1, file) != 1 ||
+      memcmp(header.magic, "STFT", 4) != 0 ||
+      header.version != STFT_FILE_VERSION ||
+      (header.encoding != STFT_ENCODING_FLOAT32 &&
+       header.encoding != STFT_ENCODING_DB16) ||
+      header.channels < 1 || header.bins != header.fft_size / 2 + 1) {
+    status = AUDIO_ERROR_INVALID_FORMAT;
+  }
+
+  size_t values = (size_t)header.channels * header.bins;
+  size_t bytes = values * encoded_size(header.encoding);
+
+  // A crafted frame count must not wrap the magnitude allocation
+  if (status == AUDIO_SUCCESS &&
+      header.frames > (SIZE_MAX / sizeof(float) - 1) / values)
+    status = AUDIO_ERROR_INVALID_FORMAT;
+
+  if (status == AUDIO_SUCCESS) {
+    spec = calloc(1, sizeof(Spectrogram));
+    record = malloc(bytes);
+    if (spec) {
+      spec->header = header;
+      spec->capacity = header.frames;
+      spec->magnitudes = malloc((header.frames * values + 1) * sizeof(float));
+    }
+    if (!spec || !record || !spec->magnitudes)
+      status = AUDIO_ERROR_MEMORY_ERROR;
+  }
+
+  for (size_t f = 0; status == AUDIO_SUCCESS && f < header.frames; f++) {
+    if (fread(record, 1, bytes, file) != bytes) {
+      status = AUDIO_ERROR_READ_ERROR;
+      break;
+    }
+    float *out = spec->magnitudes + f * values;
+    if (header.encoding == STFT_ENCODING_DB16) {
+      const int16_t *in = (const int16_t *)record;
+      for (size_t i = 0; i < values; i++) {
+        out[i] = in[i] <= DB16_FLOOR
+                     ? 0.0f
+                     : (float)pow(10.0, in[i] / (20.0 * DB16_SCALE));
+      }
+    } else {
+      memcpy(out, record, bytes);
+    }
+  }
+
+  fclose(file);
+  free(record);
+  if (status != AUDIO_SUCCESS) {
+    spectrogram_free(spec);
+    spec = NULL;
+  }
+  if (error)
+    *error = status;
+  return spec;
+}
+
+AudioError spectrogram_init(Spectrogram *spec, const StftEngine *engine) {
+  if (!spec || !engine)
+    return AUDIO_ERROR_INVALID_PARAMETER;
+
+  fill_header(&spec->header, engine, STFT_ENCODING_FLOAT32);
+  spec->magnitudes = NULL;
+  spec->capacity = 0;
+  return AUDIO_SUCCESS;
+}
+
+int spectrogram_sink(void *user, size_t frame, const float *magnitudes) {
+  Spectrogram *spec = (Spectrogram *)user;
+  size_t values = (size_t)spec->header.channels * spec->header.bins;
+
+  if (frame >= spec->capacity) {
+    size_t capacity = spec->capacity ? spec->capacity * 2 : 64;
+    while (capacity <= frame)
+      capacity *= 2;
+    float *grown =
+        realloc(spec->magnitudes, capacity * values * sizeof(float));
+    if (!grown)
+      return 1;
+    spec->magnitudes = grown;
+    spec->capacity = capacity;
+  }
+
+  memcpy(spec->magnitudes + frame * values, magnitudes,
+         values * sizeof(float));
+  if (frame + 1 > spec->header.frames)
+    spec->header.frames = frame + 1;
+  return 0;
+}
+
+float spectrogram_at(const Spectrogram *spec, size_t frame, int channel,
+                     size_t bin) {
+  if (!spec || !spec->magnitudes || frame >= spec->header.frames ||
+      channel < 0 || channel >= spec->header.channels ||
+      bin >= spec->header.bins)
+    return 0.0f;
+
+  size_t bins = spec->header.bins;
+  return spec->magnitudes[(frame * spec->header.channels + channel) * bins +
+                          bin];
+}
+
+void spectrogram_clear(Spectrogram *spec) {
+  if (!spec)
+    return;
+
+  free(spec->magnitudes);
+  spec->magnitudes = NULL;
+  spec->capacity = 0;
+  spec->header.frames = 0;
+}
+
+void spectrogram_free(Spectrogram *spec) {
+  spectrogram_clear(spec);
+  free(spec);
+}
+
+AudioError stft_analyze_file(const char *wav_path, const char *output_path,
+                             const StftConfig *config, StftEncoding encoding) {
+  AudioError error;
+  AudioReader *reader = audio_reader_open(wav_path, &error);
+  if (!reader)
+    return error;
+
+  const AudioFileInfo *info = audio_reader_info(reader);
+  StftEngine *engine =
+      stft_engine_create(config, info->channels, info->sample_rate, &error);
+  if (!engine) {
+    audio_reader_close(reader);
+    return error;
+  }
+
+  StftFile *file = stft_file_open(output_path, engine, encoding, &error);
+  if (file) {
+    error = stft_process_reader(engine, reader, stft_file_sink, file);
+    AudioError close_error = stft_file_close(file);
+    if (error == AUDIO_SUCCESS)
+      error = close_error;
+  }
+
+  stft_engine_destroy(engine);
+  audio_reader_close(reader);
+  return error;
+}
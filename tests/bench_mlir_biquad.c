@@ -4,9 +4,23 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
+#include <unistd.h>
 
 #define BUFFER_SIZE 1000000 // 1 million samples
 #define NUM_ITERATIONS 10
+#define NUM_HANDLES 1000 // Filter objects for the memory report
+
+// Resident set size in KiB (0 if unavailable)
+static long resident_kib(void) {
+  long pages = 0, resident = 0;
+  FILE *statm = fopen("/proc/self/statm", "r");
+  if (!statm)
+    return 0;
+  if (fscanf(statm, "%ld %ld", &pages, &resident) != 2)
+    resident = 0;
+  fclose(statm);
+  return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
 
 // Get time in seconds
 static double get_time(void) {
@@ -135,6 +149,41 @@ int main(void) {
     printf("✗ Found %d mismatches (max diff: %.2e)\n", mismatches, max_diff);
   }
 
+  // Memory held per additional filter object (kernels are shared, so this
+  // should be a handle, not a compiler context). Each handle processes a
+  // block, so lazily compiled code is counted the same way as code compiled
+  // in mlir_biquad_jit_create and the figure compares across revisions.
+  printf("\n=== Per-Kernel Memory ===\n");
+  MLIRBiQuadJIT **handles = malloc(NUM_HANDLES * sizeof(MLIRBiQuadJIT *));
+  BiQuad *filters = malloc(NUM_HANDLES * sizeof(BiQuad));
+  if (!handles || !filters) {
+    fprintf(stderr, "Failed to allocate memory\n");
+    free(handles);
+    free(filters);
+    mlir_biquad_jit_destroy(jit);
+    free(input);
+    free(output_c);
+    free(output_mlir);
+    return 1;
+  }
+  long rss_before = resident_kib();
+  for (int h = 0; h < NUM_HANDLES; h++) {
+    filters[h] = bq_mlir;
+    handles[h] = mlir_biquad_jit_create(&filters[h]);
+    mlir_biquad_process_buffer(handles[h], &filters[h], input, output_mlir,
+                               64);
+  }
+  long rss_after = resident_kib();
+  printf("%d handles: %ld KiB resident (%.2f KiB per kernel)\n", NUM_HANDLES,
+         rss_after - rss_before, (double)(rss_after - rss_before) / NUM_HANDLES);
+  for (int h = 0; h < NUM_HANDLES; h++) {
+    mlir_biquad_jit_destroy(handles[h]);
+  }
+  printf("After destroying them: %ld KiB still resident\n",
+         resident_kib() - rss_before);
+  free(filters);
+  free(handles);
+
   // Cleanup
   mlir_biquad_jit_destroy(jit);
   free(input);
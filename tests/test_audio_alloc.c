@@ -0,0 +1,176 @@
+#include "audio_alloc.h"
+#include "audio_io.h"
+#include "audio_numa.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// Test alignment of small and huge allocations
+void test_alignment() {
+  printf("Test 1: Allocation Alignment\n");
+
+  size_t sizes[] = {1,    63,        64,
+                    1000, 48000 * 8, AUDIO_ALLOC_HUGE_THRESHOLD * 3};
+  for (int i = 0; i < 6; i++) {
+    uint8_t *ptr = audio_alloc(sizes[i]);
+    assert(ptr != NULL);
+    assert((uintptr_t)ptr % AUDIO_ALLOC_ALIGNMENT == 0);
+    // Touch every byte to catch undersized blocks
+    memset(ptr, 0xAB, sizes[i]);
+    audio_free(ptr);
+    printf("  %zu bytes: aligned\n", sizes[i]);
+  }
+
+  AudioBuffer *buffer = audio_buffer_create(4096, 48000, 2, 16);
+  assert(buffer != NULL);
+  assert((uintptr_t)buffer->data % AUDIO_ALLOC_ALIGNMENT == 0);
+  audio_buffer_free(buffer);
+
+  PCMBuffer *pcm = pcm_buffer_create(4096 * 3, 24);
+  assert(pcm != NULL);
+  assert((uintptr_t)pcm->data % AUDIO_ALLOC_ALIGNMENT == 0);
+  pcm_buffer_free(pcm);
+
+  printf("  ✓ All buffers are %d-byte aligned\n\n", AUDIO_ALLOC_ALIGNMENT);
+}
+
+// Test that the pool recycles freed buffers
+void test_pool_reuse() {
+  printf("Test 2: Buffer Pool Recycling\n");
+
+  audio_pool_enable((size_t)64 << 20);
+
+  AudioAllocStats stats;
+  void *first = audio_alloc(1 << 20);
+  assert(first != NULL);
+  audio_free(first);
+  audio_alloc_stats(&stats);
+  assert(stats.cached_blocks == 1);
+
+  // Same-sized request must reuse the cached block
+  void *second = audio_alloc(1 << 20);
+  assert(second == first);
+  audio_alloc_stats(&stats);
+  assert(stats.pool_hits == 1);
+  assert(stats.cached_blocks == 0);
+
+  // Much smaller request must not consume the large block
+  audio_free(second);
+  void *small = audio_alloc(1024);
+  assert(small != second);
+  audio_free(small);
+
+  // Simulated batch: every file after the first is served from the pool
+  for (int file = 0; file < 8; file++) {
+    AudioBuffer *buffer = audio_buffer_create(48000 * 2 * 10, 48000, 2, 16);
+    assert(buffer != NULL);
+    audio_buffer_free(buffer);
+  }
+  audio_alloc_stats(&stats);
+  printf("  Hits: %zu, misses: %zu, cached: %zu bytes\n", stats.pool_hits,
+         stats.pool_misses, stats.cached_bytes);
+  assert(stats.pool_hits >= 8);
+
+  audio_pool_disable();
+  audio_alloc_stats(&stats);
+  assert(stats.cached_blocks == 0);
+  assert(stats.cached_bytes == 0);
+
+  printf("  ✓ Pool reuses warmed buffers\n\n");
+}
+
+// Test that the pool respects its byte budget
+void test_pool_limit() {
+  printf("Test 3: Buffer Pool Budget\n");
+
+  audio_pool_enable(1 << 20);
+  void *a = audio_alloc(768 << 10);
+  void *b = audio_alloc(768 << 10);
+  audio_free(a);
+  audio_free(b);
+
+  AudioAllocStats stats;
+  audio_alloc_stats(&stats);
+  assert(stats.cached_blocks == 1);
+  assert(stats.cached_bytes <= (1 << 20));
+
+  audio_pool_disable();
+  printf("  ✓ Pool never caches beyond its budget\n\n");
+}
+
+// Test topology discovery and node pinning
+void test_numa_topology() {
+  printf("Test 4: NUMA Topology\n");
+
+  const AudioNumaTopology *topology = audio_numa_topology();
+  assert(topology->num_nodes >= 1);
+  assert(topology->num_nodes <= AUDIO_NUMA_MAX_NODES);
+  for (int n = 0; n < topology->num_nodes; n++) {
+    assert(topology->nodes[n].num_cpus > 0);
+    if (n > 0) {
+      assert(topology->nodes[n].id > topology->nodes[n - 1].id);
+    }
+    printf("  Node %d: %d CPU(s)\n", topology->nodes[n].id,
+           topology->nodes[n].num_cpus);
+  }
+
+  int last = topology->num_nodes - 1;
+  assert(audio_numa_pin_thread(last) == 0);
+  assert(audio_numa_current_node() == last);
+  assert(audio_numa_pin_thread(topology->num_nodes) == -1);
+  assert(audio_numa_pin_thread(-1) == -1);
+
+  // Binding is advisory, but bad arguments are rejected
+  void *ptr = audio_alloc(1 << 16);
+  assert(audio_numa_bind(ptr, 1 << 16, -1) == -1);
+  assert(audio_numa_bind(NULL, 1 << 16, 0) == -1);
+  audio_free(ptr);
+
+  printf("  ✓ Pinned to node %d\n\n", last);
+}
+
+// Test that blocks return to the pool of their own node
+void test_node_pools() {
+  printf("Test 5: Per-Node Pools\n");
+
+  const AudioNumaTopology *topology = audio_numa_topology();
+  int last = topology->num_nodes - 1;
+  audio_pool_enable((size_t)16 << 20);
+
+  void *block = audio_alloc_on_node(1 << 20, last);
+  assert(block != NULL);
+  assert((uintptr_t)block % AUDIO_ALLOC_ALIGNMENT == 0);
+  memset(block, 0, 1 << 20);
+  audio_free(block);
+
+  // Same node: recycled
+  assert(audio_alloc_on_node(1 << 20, last) == block);
+  audio_free(block);
+
+  // Another node never receives it
+  if (topology->num_nodes > 1) {
+    void *other = audio_alloc_on_node(1 << 20, 0);
+    assert(other != block);
+    audio_free(other);
+  }
+
+  assert(audio_alloc_on_node(1024, topology->num_nodes) == NULL);
+  assert(audio_alloc_on_node(1024, -1) == NULL);
+
+  audio_pool_disable();
+  printf("  ✓ Blocks recycled on the node they were placed for\n\n");
+}
+
+int main() {
+  printf("\n=== Audio Allocator Tests ===\n\n");
+
+  test_alignment();
+  test_pool_reuse();
+  test_pool_limit();
+  test_numa_topology();
+  test_node_pools();
+
+  printf("=== All allocator tests passed! ===\n\n");
+  return 0;
+}
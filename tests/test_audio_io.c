@@ -244,11 +244,251 @@ int test_error_handling() {
     return 1;
 }
 
+// Test 6: Header-only info and region reads
+int test_region_read() {
+    printf("Test 6: Testing header info and region reads...\n");
+    
+    AudioError error;
+    AudioFileInfo info;
+    error = read_wave_info("tests/test_data/sine_wave.wav", &info);
+    if (error != AUDIO_SUCCESS) {
+        printf("  FAILED: Could not read header: %s\n", audio_error_string(error));
+        return 0;
+    }
+    
+    AudioBuffer *full = read_wave("tests/test_data/sine_wave.wav", &error);
+    if (!full) {
+        printf("  FAILED: Could not read full file\n");
+        return 0;
+    }
+    
+    if (info.sample_rate != full->sample_rate || info.channels != full->channels ||
+        info.frames * info.channels != full->length) {
+        printf("  FAILED: Header info does not match decoded file\n");
+        audio_buffer_free(full);
+        return 0;
+    }
+    printf("  Frames: %zu, data offset: %ld\n", info.frames, info.data_offset);
+    
+    // Region from the middle must match the same frames of the full decode
+    size_t start = 12345;
+    size_t frames = 1000;
+    AudioBuffer *region = read_wave_region("tests/test_data/sine_wave.wav",
+                                           start, frames, &error);
+    if (!region || region->length != frames * info.channels) {
+        printf("  FAILED: Region read returned wrong size\n");
+        audio_buffer_free(full);
+        if (region) audio_buffer_free(region);
+        return 0;
+    }
+    
+    for (size_t i = 0; i < region->length; i++) {
+        if (region->data[i] != full->data[start * info.channels + i]) {
+            printf("  FAILED: Region sample %zu mismatch\n", i);
+            audio_buffer_free(full);
+            audio_buffer_free(region);
+            return 0;
+        }
+    }
+    audio_buffer_free(region);
+    
+    // Regions past the end are clamped
+    region = read_wave_region("tests/test_data/sine_wave.wav",
+                              info.frames - 10, 100, &error);
+    if (!region || region->length != 10 * (size_t)info.channels) {
+        printf("  FAILED: Region past end was not clamped\n");
+        audio_buffer_free(full);
+        if (region) audio_buffer_free(region);
+        return 0;
+    }
+    
+    audio_buffer_free(region);
+    audio_buffer_free(full);
+    printf("  PASSED: Region reads match full decode\n");
+    return 1;
+}
+
+// Test 7: Streaming writer output matches write_wave byte for byte
+int test_streaming_writer() {
+    printf("Test 7: Testing streaming writer...\n");
+    
+    AudioError error;
+    AudioBuffer *full = read_wave("tests/test_data/sine_wave.wav", &error);
+    if (!full) {
+        printf("  FAILED: Could not read full file\n");
+        return 0;
+    }
+    
+    AudioWriter *writer = audio_writer_open("tests/test_data/sine_stream.wav",
+                                            full->sample_rate, full->channels,
+                                            full->bit_depth, &error);
+    if (!writer) {
+        printf("  FAILED: Could not open writer: %s\n", audio_error_string(error));
+        audio_buffer_free(full);
+        return 0;
+    }
+    
+    // Uneven block sizes; the header is only finalized on close
+    size_t frames = full->length / full->channels;
+    size_t block = 1;
+    for (size_t f = 0; f < frames; f += block, block = block * 3 + 1) {
+        size_t n = (frames - f < block) ? frames - f : block;
+        audio_writer_write(writer, full->data + f * full->channels, n);
+    }
+    error = audio_writer_close(writer);
+    if (error != AUDIO_SUCCESS) {
+        printf("  FAILED: Writer close: %s\n", audio_error_string(error));
+        audio_buffer_free(full);
+        return 0;
+    }
+    
+    write_wave("tests/test_data/sine_whole.wav", full);
+    audio_buffer_free(full);
+    
+    FILE *a = fopen("tests/test_data/sine_stream.wav", "rb");
+    FILE *b = fopen("tests/test_data/sine_whole.wav", "rb");
+    int same = a && b;
+    while (same) {
+        int ca = fgetc(a), cb = fgetc(b);
+        same = ca == cb;
+        if (ca == EOF || cb == EOF)
+            break;
+    }
+    if (a) fclose(a);
+    if (b) fclose(b);
+    if (!same) {
+        printf("  FAILED: Streamed file differs from write_wave output\n");
+        return 0;
+    }
+    
+    // Invalid formats are rejected up front
+    if (audio_writer_open("tests/test_data/bad.wav", 44100, 2, 12, &error) ||
+        error != AUDIO_ERROR_INVALID_PARAMETER) {
+        printf("  FAILED: 12-bit writer was accepted\n");
+        return 0;
+    }
+    
+    printf("  PASSED: Streamed file matches write_wave output\n");
+    return 1;
+}
+
+// Nonzero if both files have the same contents
+static int files_identical(const char *path_a, const char *path_b) {
+    FILE *a = fopen(path_a, "rb");
+    FILE *b = fopen(path_b, "rb");
+    int same = a && b;
+    while (same) {
+        int ca = fgetc(a), cb = fgetc(b);
+        same = ca == cb;
+        if (ca == EOF || cb == EOF)
+            break;
+    }
+    if (a) fclose(a);
+    if (b) fclose(b);
+    return same;
+}
+
+// Size of a file in bytes (-1 if it cannot be opened)
+static long file_size(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return -1;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+// Test 8: Large-file mode gives the same files and samples, and trims
+// preallocated outputs to what was written
+int test_large_file_mode() {
+    printf("Test 8: Testing large-file I/O mode...\n");
+    
+    // Several I/O windows of 16-bit stereo
+    size_t frames = 3 * AUDIO_IO_WINDOW / 4 + 123;
+    AudioBuffer *buffer = audio_buffer_create(frames * 2, 48000, 2, 16);
+    if (!buffer) {
+        printf("  FAILED: Could not create audio buffer\n");
+        return 0;
+    }
+    for (size_t i = 0; i < frames * 2; i++) {
+        buffer->data[i] = 0.5 * sin(0.001 * i) + 0.25 * sin(0.37 * i);
+    }
+    
+    AudioError error = write_wave("tests/test_data/large_ref.wav", buffer);
+    audio_io_set_large_files(1);
+    if (error == AUDIO_SUCCESS) {
+        error = write_wave("tests/test_data/large_mode.wav", buffer);
+    }
+    if (error != AUDIO_SUCCESS ||
+        !files_identical("tests/test_data/large_ref.wav",
+                         "tests/test_data/large_mode.wav")) {
+        printf("  FAILED: Large-mode output differs from write_wave output\n");
+        audio_io_set_large_files(0);
+        audio_buffer_free(buffer);
+        return 0;
+    }
+    
+    // Whole-file and region reads match the normal path
+    AudioBuffer *whole = read_wave("tests/test_data/large_mode.wav", &error);
+    AudioBuffer *region = read_wave_region("tests/test_data/large_mode.wav",
+                                           frames - 1000, 5000, &error);
+    audio_io_set_large_files(0);
+    AudioBuffer *reference = read_wave("tests/test_data/large_ref.wav", &error);
+    int ok = whole && region && reference &&
+             whole->length == reference->length && region->length == 2000 &&
+             memcmp(whole->data, reference->data,
+                    whole->length * sizeof(double)) == 0 &&
+             memcmp(region->data, reference->data + (frames - 1000) * 2,
+                    region->length * sizeof(double)) == 0;
+    audio_buffer_free(whole);
+    audio_buffer_free(region);
+    audio_buffer_free(reference);
+    if (!ok) {
+        printf("  FAILED: Large-mode reads differ\n");
+        audio_buffer_free(buffer);
+        return 0;
+    }
+    
+    // A reservation larger than the data is trimmed on close
+    audio_io_set_large_files(1);
+    AudioWriter *writer = audio_writer_open("tests/test_data/large_reserved.wav",
+                                            48000, 2, 16, &error);
+    if (!writer || audio_writer_reserve(writer, frames) != AUDIO_SUCCESS) {
+        printf("  FAILED: Could not open and reserve output\n");
+        audio_io_set_large_files(0);
+        audio_buffer_free(buffer);
+        return 0;
+    }
+    audio_writer_write(writer, buffer->data, frames / 3);
+    error = audio_writer_close(writer);
+    audio_io_set_large_files(0);
+    audio_buffer_free(buffer);
+    
+    AudioFileInfo info;
+    long expected = 44 + (long)(frames / 3) * 4;
+    if (error != AUDIO_SUCCESS ||
+        file_size("tests/test_data/large_reserved.wav") != expected ||
+        read_wave_info("tests/test_data/large_reserved.wav", &info) !=
+            AUDIO_SUCCESS ||
+        info.frames != frames / 3) {
+        printf("  FAILED: Reserved output was not trimmed\n");
+        return 0;
+    }
+    
+    remove("tests/test_data/large_ref.wav");
+    remove("tests/test_data/large_mode.wav");
+    remove("tests/test_data/large_reserved.wav");
+    
+    printf("  PASSED: Large-file mode matches normal I/O, reservation trimmed\n");
+    return 1;
+}
+
 int main() {
     printf("=== Audio I/O Test Suite ===\n\n");
     
     int passed = 0;
-    int total = 5;
+    int total = 8;
     
     passed += test_write_sine_wave();
     printf("\n");
@@ -265,6 +505,15 @@ int main() {
     passed += test_error_handling();
     printf("\n");
     
+    passed += test_region_read();
+    printf("\n");
+    
+    passed += test_streaming_writer();
+    printf("\n");
+    
+    passed += test_large_file_mode();
+    printf("\n");
+    
     printf("=== Results: %d/%d tests passed ===\n", passed, total);
     
     return (passed == total) ? 0 : 1;
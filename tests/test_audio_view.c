@@ -0,0 +1,223 @@
+#include "audio_io.h"
+#include "audio_view.h"
+#include "hpf.h"
+#include "lpf.h"
+#include "parametric.h"
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+
+#define SAMPLE_RATE 48000.0
+#define NUM_FRAMES 9600
+
+// Fill an interleaved buffer with a different tone per channel
+static void generate_tones(AudioBuffer *buffer) {
+  size_t frames = buffer->length / buffer->channels;
+  for (size_t f = 0; f < frames; f++) {
+    double t = f / (double)buffer->sample_rate;
+    for (int c = 0; c < buffer->channels; c++) {
+      buffer->data[f * buffer->channels + c] =
+          0.5 * sin(2.0 * M_PI * (50.0 + 300.0 * c) * t);
+    }
+  }
+}
+
+// Test slicing and channel selection geometry
+void test_view_geometry() {
+  printf("Test 1: View Slicing and Channel Selection\n");
+
+  AudioBuffer *buffer =
+      audio_buffer_create(NUM_FRAMES * 4, SAMPLE_RATE, 4, 16);
+  assert(buffer != NULL);
+  for (size_t i = 0; i < buffer->length; i++) {
+    buffer->data[i] = (double)i;
+  }
+
+  AudioBufferView whole, slice, pair;
+  assert(audio_view_from_buffer(buffer, &whole) == AUDIO_SUCCESS);
+  assert(whole.frames == NUM_FRAMES);
+  assert(whole.stride == 4);
+
+  assert(audio_view_slice(&whole, 100, 50, &slice) == AUDIO_SUCCESS);
+  assert(slice.frames == 50);
+  assert(slice.data[0] == 400.0);
+
+  assert(audio_view_select_channels(&slice, 2, 2, &pair) == AUDIO_SUCCESS);
+  assert(pair.channels == 2);
+  assert(pair.first_channel == 2);
+  assert(pair.data[0] == 402.0);
+  assert(pair.data[pair.stride + 1] == 407.0);
+
+  // Out-of-range requests
+  assert(audio_view_select_channels(&slice, 3, 2, &pair) != AUDIO_SUCCESS);
+  AudioBufferView tail;
+  assert(audio_view_slice(&whole, NUM_FRAMES - 10, 100, &tail) ==
+         AUDIO_SUCCESS);
+  assert(tail.frames == 10);
+
+  audio_view_release(&tail);
+  audio_view_release(&pair);
+  audio_view_release(&slice);
+  audio_view_release(&whole);
+  audio_buffer_free(buffer);
+  printf("  ✓ Views address the expected samples\n\n");
+}
+
+// Test that views keep storage alive after the buffer is freed
+void test_view_refcount() {
+  printf("Test 2: Shared Storage Reference Counting\n");
+
+  AudioBuffer *buffer = audio_buffer_create(1024, SAMPLE_RATE, 1, 16);
+  assert(buffer != NULL);
+  buffer->data[1000] = 0.25;
+
+  AudioStorage *storage = buffer->storage;
+  AudioBufferView view;
+  assert(audio_view_from_buffer(buffer, &view) == AUDIO_SUCCESS);
+  assert(storage->refcount == 2);
+
+  audio_buffer_free(buffer);
+  assert(storage->refcount == 1);
+  assert(view.data[1000] == 0.25);
+
+  audio_view_release(&view);
+  printf("  ✓ Storage outlives its buffer while views exist\n\n");
+}
+
+// Test that processing slices matches processing the whole buffer
+void test_view_processing_matches_buffer() {
+  printf("Test 3: Sliced Processing Matches Whole Buffer\n");
+
+  AudioBuffer *reference =
+      audio_buffer_create(NUM_FRAMES * 2, SAMPLE_RATE, 2, 16);
+  AudioBuffer *sliced = audio_buffer_create(NUM_FRAMES * 2, SAMPLE_RATE, 2, 16);
+  assert(reference != NULL && sliced != NULL);
+  generate_tones(reference);
+  generate_tones(sliced);
+
+  HPFFilter hpf_ref, hpf_view;
+  LPFFilter lpf_ref, lpf_view;
+  ParametricFilter peq_ref, peq_view;
+  hpf_init(&hpf_ref, SAMPLE_RATE, 120.0);
+  hpf_init(&hpf_view, SAMPLE_RATE, 120.0);
+  lpf_init(&lpf_ref, SAMPLE_RATE, 3000.0);
+  lpf_init(&lpf_view, SAMPLE_RATE, 3000.0);
+  parametric_init(&peq_ref, SAMPLE_RATE, 1000.0, 6.0, 1.0);
+  parametric_init(&peq_view, SAMPLE_RATE, 1000.0, 6.0, 1.0);
+
+  hpf_process_buffer(&hpf_ref, reference);
+  lpf_process_buffer(&lpf_ref, reference);
+  parametric_process_buffer(&peq_ref, reference);
+
+  // Uneven slices, each channel processed through its own view
+  AudioBufferView whole;
+  assert(audio_view_from_buffer(sliced, &whole) == AUDIO_SUCCESS);
+  size_t sizes[] = {1, 511, 1000, 3000, 5088};
+  size_t offset = 0;
+  for (int s = 0; s < 5; s++) {
+    AudioBufferView slice;
+    assert(audio_view_slice(&whole, offset, sizes[s], &slice) ==
+           AUDIO_SUCCESS);
+    for (int c = 0; c < 2; c++) {
+      AudioBufferView channel;
+      assert(audio_view_select_channels(&slice, c, 1, &channel) ==
+             AUDIO_SUCCESS);
+      hpf_process_view(&hpf_view, &channel);
+      lpf_process_view(&lpf_view, &channel);
+      parametric_process_view(&peq_view, &channel);
+      audio_view_release(&channel);
+    }
+    audio_view_release(&slice);
+    offset += sizes[s];
+  }
+  assert(offset == NUM_FRAMES);
+  audio_view_release(&whole);
+
+  double max_diff = 0.0;
+  for (size_t i = 0; i < reference->length; i++) {
+    double diff = fabs(reference->data[i] - sliced->data[i]);
+    if (diff > max_diff)
+      max_diff = diff;
+  }
+  printf("  Max difference: %.3e\n", max_diff);
+  assert(max_diff < 1e-9);
+
+  audio_buffer_free(reference);
+  audio_buffer_free(sliced);
+  printf("  ✓ View processing carries filter state across slices\n\n");
+}
+
+// Test that channels beyond stereo keep their own filter state
+void test_view_multichannel_state() {
+  printf("Test 4: Multichannel Views Keep Per-Channel State\n");
+
+  const int channels = 6;
+  AudioBuffer *buffered =
+      audio_buffer_create(NUM_FRAMES * channels, SAMPLE_RATE, channels, 16);
+  AudioBuffer *tiled =
+      audio_buffer_create(NUM_FRAMES * channels, SAMPLE_RATE, channels, 16);
+  assert(buffered != NULL && tiled != NULL);
+  generate_tones(buffered);
+  generate_tones(tiled);
+
+  HPFFilter hpf_buf, hpf_view;
+  hpf_init(&hpf_buf, SAMPLE_RATE, 400.0);
+  hpf_init(&hpf_view, SAMPLE_RATE, 400.0);
+  hpf_process_buffer(&hpf_buf, buffered);
+
+  // Tiles of all channels, as the chain executor issues them
+  AudioBufferView whole;
+  assert(audio_view_from_buffer(tiled, &whole) == AUDIO_SUCCESS);
+  for (size_t offset = 0; offset < NUM_FRAMES; offset += 1000) {
+    AudioBufferView tile;
+    assert(audio_view_slice(&whole, offset, 1000, &tile) == AUDIO_SUCCESS);
+    hpf_process_view(&hpf_view, &tile);
+    audio_view_release(&tile);
+  }
+  audio_view_release(&whole);
+
+  // Reference: every channel through a fresh mono filter
+  double max_diff = 0.0;
+  double mono[NUM_FRAMES];
+  for (int c = 0; c < channels; c++) {
+    HPFFilter hpf_mono;
+    hpf_init(&hpf_mono, SAMPLE_RATE, 400.0);
+    for (size_t f = 0; f < NUM_FRAMES; f++) {
+      double t = f / SAMPLE_RATE;
+      mono[f] = 0.5 * sin(2.0 * M_PI * (50.0 + 300.0 * c) * t);
+    }
+    hpf_process_channel(&hpf_mono, mono, NUM_FRAMES, 0);
+
+    for (size_t f = 0; f < NUM_FRAMES; f++) {
+      double expected = mono[f];
+      double a = fabs(buffered->data[f * channels + c] - expected);
+      double b = fabs(tiled->data[f * channels + c] - expected);
+      if (a > max_diff)
+        max_diff = a;
+      if (b > max_diff)
+        max_diff = b;
+    }
+  }
+  printf("  Max difference from per-channel reference: %.3e\n", max_diff);
+  assert(max_diff < 1e-9);
+
+  // Channels past BIQUAD_MAX_CHANNELS have no state and are left untouched
+  assert(hpf_channel_filter(&hpf_view, BIQUAD_MAX_CHANNELS - 1) != NULL);
+  assert(hpf_channel_filter(&hpf_view, BIQUAD_MAX_CHANNELS) == NULL);
+
+  audio_buffer_free(buffered);
+  audio_buffer_free(tiled);
+  printf("  ✓ Buffer and tiled views filter each channel independently\n\n");
+}
+
+int main() {
+  printf("\n=== Audio Buffer View Tests ===\n\n");
+
+  test_view_geometry();
+  test_view_refcount();
+  test_view_processing_matches_buffer();
+  test_view_multichannel_state();
+
+  printf("=== All buffer view tests passed! ===\n\n");
+  return 0;
+}
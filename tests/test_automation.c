@@ -0,0 +1,205 @@
+#include "audio_io.h"
+#include "automation.h"
+#include "chain.h"
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SAMPLE_RATE 48000.0
+#define FRAMES 48000
+
+static void generate_signal(AudioBuffer *buffer) {
+  size_t frames = buffer->length / buffer->channels;
+  for (size_t f = 0; f < frames; f++) {
+    double t = f / SAMPLE_RATE;
+    for (int c = 0; c < buffer->channels; c++) {
+      buffer->data[f * buffer->channels + c] =
+          0.4 * sin(2.0 * M_PI * (60.0 + 5.0 * c) * t) +
+          0.3 * sin(2.0 * M_PI * 3000.0 * t);
+    }
+  }
+}
+
+static double max_difference(const AudioBuffer *a, const AudioBuffer *b) {
+  double max_diff = 0.0;
+  for (size_t i = 0; i < a->length; i++) {
+    double diff = fabs(a->data[i] - b->data[i]);
+    if (diff > max_diff)
+      max_diff = diff;
+  }
+  return max_diff;
+}
+
+// Process `buffer` through an automated filter in blocks of `block` frames
+static void render_automated(AudioBuffer *buffer, size_t block,
+                             void (*add_events)(AutomatedFilter *)) {
+  ParametricFilter peq;
+  parametric_init(&peq, SAMPLE_RATE, 1000.0, 0.0, 1.0);
+  AutomatedFilter af;
+  automation_init(&af, AUTOMATION_FILTER_PARAMETRIC, &peq, SAMPLE_RATE);
+  add_events(&af);
+
+  AudioBufferView view;
+  assert(audio_view_from_buffer(buffer, &view) == AUDIO_SUCCESS);
+  for (size_t start = 0; start < view.frames; start += block) {
+    size_t frames = view.frames - start < block ? view.frames - start : block;
+    AudioBufferView part;
+    assert(audio_view_slice(&view, start, frames, &part) == AUDIO_SUCCESS);
+    automation_process_view(&af, &part);
+    audio_view_release(&part);
+  }
+  audio_view_release(&view);
+  automation_free(&af);
+}
+
+static void step_events(AutomatedFilter *af) {
+  assert(automation_add_event(af, AUTOMATION_GAIN_DB, 12345, 9.0,
+                              AUTOMATION_STEP) == 0);
+}
+
+static void ramp_events(AutomatedFilter *af) {
+  // Added out of order on purpose
+  assert(automation_add_event(af, AUTOMATION_FREQUENCY, 30000, 4000.0,
+                              AUTOMATION_EXPONENTIAL) == 0);
+  assert(automation_add_event(af, AUTOMATION_FREQUENCY, 5000, 1000.0,
+                              AUTOMATION_STEP) == 0);
+  assert(automation_add_event(af, AUTOMATION_GAIN_DB, 20000, -6.0,
+                              AUTOMATION_LINEAR) == 0);
+}
+
+// Test that a step lands on its exact frame without resetting state
+void test_step_is_sample_accurate() {
+  printf("Test 1: Step Events Are Sample-Accurate\n");
+
+  AudioBuffer *automated = audio_buffer_create(FRAMES * 2, SAMPLE_RATE, 2, 16);
+  AudioBuffer *reference = audio_buffer_create(FRAMES * 2, SAMPLE_RATE, 2, 16);
+  assert(automated != NULL && reference != NULL);
+  generate_signal(automated);
+  generate_signal(reference);
+
+  render_automated(automated, FRAMES, step_events);
+
+  // Reference: plain C filter, retuned by hand at frame 12345
+  ParametricFilter peq;
+  parametric_init(&peq, SAMPLE_RATE, 1000.0, 0.0, 1.0);
+  for (size_t f = 0; f < FRAMES; f++) {
+    if (f == 12345)
+      parametric_retune(&peq, SAMPLE_RATE, 1000.0, 9.0, 1.0);
+    for (int c = 0; c < 2; c++) {
+      BiQuad *bq = c == 0 ? &peq.left : &peq.right;
+      double x = reference->data[f * 2 + c];
+      reference->data[f * 2 + c] = biquad_process(bq, x) * bq->c0 + x * bq->d0;
+    }
+  }
+
+  double diff = max_difference(automated, reference);
+  printf("  Max diff vs. hand-retuned reference: %.3e\n", diff);
+  assert(diff < 1e-9);
+
+  audio_buffer_free(automated);
+  audio_buffer_free(reference);
+  printf("  ✓ Step applied at its frame with state carried over\n\n");
+}
+
+// Test ramp interpolation
+void test_ramp_values() {
+  printf("Test 2: Ramp Interpolation\n");
+
+  ParametricFilter peq;
+  parametric_init(&peq, SAMPLE_RATE, 1000.0, 0.0, 1.0);
+  AutomatedFilter af;
+  automation_init(&af, AUTOMATION_FILTER_PARAMETRIC, &peq, SAMPLE_RATE);
+  ramp_events(&af);
+
+  // Linear gain ramp from the initial 0 dB at frame 0 to -6 dB at 20000
+  assert(automation_value_at(&af, AUTOMATION_GAIN_DB, 0) == 0.0);
+  assert(fabs(automation_value_at(&af, AUTOMATION_GAIN_DB, 10000) + 3.0) <
+         1e-12);
+  assert(automation_value_at(&af, AUTOMATION_GAIN_DB, 40000) == -6.0);
+
+  // Exponential frequency ramp 1000 -> 4000 Hz over 5000..30000
+  assert(automation_value_at(&af, AUTOMATION_FREQUENCY, 5000) == 1000.0);
+  assert(fabs(automation_value_at(&af, AUTOMATION_FREQUENCY, 17500) - 2000.0) <
+         1e-9);
+  assert(automation_value_at(&af, AUTOMATION_FREQUENCY, 30000) == 4000.0);
+
+  // Q has no events
+  assert(automation_value_at(&af, AUTOMATION_Q, 25000) == 1.0);
+
+  // Replacing an event at the same frame
+  assert(automation_add_event(&af, AUTOMATION_GAIN_DB, 20000, -12.0,
+                              AUTOMATION_LINEAR) == 0);
+  assert(af.lanes[AUTOMATION_GAIN_DB].count == 1);
+  assert(automation_value_at(&af, AUTOMATION_GAIN_DB, 20000) == -12.0);
+
+  automation_free(&af);
+  printf("  ✓ Linear and exponential ramps interpolate between breakpoints\n\n");
+}
+
+// Test that the output does not depend on how the stream is blocked
+void test_block_independence() {
+  printf("Test 3: Output Independent of Block Size\n");
+
+  AudioBuffer *whole = audio_buffer_create(FRAMES * 2, SAMPLE_RATE, 2, 16);
+  AudioBuffer *blocked = audio_buffer_create(FRAMES * 2, SAMPLE_RATE, 2, 16);
+  assert(whole != NULL && blocked != NULL);
+  generate_signal(whole);
+  render_automated(whole, FRAMES, ramp_events);
+
+  size_t blocks[] = {1, 37, 512, 4096};
+  for (int b = 0; b < 4; b++) {
+    generate_signal(blocked);
+    render_automated(blocked, blocks[b], ramp_events);
+    double diff = max_difference(whole, blocked);
+    printf("  Block %4zu frames: max diff %.3e\n", blocks[b], diff);
+    assert(diff == 0.0);
+  }
+
+  audio_buffer_free(whole);
+  audio_buffer_free(blocked);
+  printf("  ✓ Splits land on the same frames for every block size\n\n");
+}
+
+// Test automation as a chain stage
+void test_chain_stage() {
+  printf("Test 4: Automation as a Chain Stage\n");
+
+  AudioBuffer *direct = audio_buffer_create(FRAMES * 2, SAMPLE_RATE, 2, 16);
+  AudioBuffer *chained = audio_buffer_create(FRAMES * 2, SAMPLE_RATE, 2, 16);
+  assert(direct != NULL && chained != NULL);
+  generate_signal(direct);
+  generate_signal(chained);
+  render_automated(direct, FRAMES, ramp_events);
+
+  ParametricFilter peq;
+  parametric_init(&peq, SAMPLE_RATE, 1000.0, 0.0, 1.0);
+  AutomatedFilter af;
+  automation_init(&af, AUTOMATION_FILTER_PARAMETRIC, &peq, SAMPLE_RATE);
+  ramp_events(&af);
+
+  AudioChain chain;
+  audio_chain_init(&chain);
+  assert(audio_chain_add(&chain, "automation", automation_stage, &af) == 0);
+  audio_chain_set_tile_frames(&chain, 1000);
+  audio_chain_process(&chain, chained);
+  assert(af.position == FRAMES);
+  assert(max_difference(direct, chained) == 0.0);
+
+  automation_free(&af);
+  audio_buffer_free(direct);
+  audio_buffer_free(chained);
+  printf("  ✓ Tiled chain output matches direct processing\n\n");
+}
+
+int main() {
+  printf("\n=== Automation Tests ===\n\n");
+
+  test_step_is_sample_accurate();
+  test_ramp_values();
+  test_block_independence();
+  test_chain_stage();
+
+  printf("=== All automation tests passed! ===\n\n");
+  return 0;
+}
@@ -0,0 +1,334 @@
+#include "audio_io.h"
+#include "batch.h"
+#include "hpf.h"
+#include <assert.h>
+#include <dirent.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define SAMPLE_RATE 48000
+#define JOB_FRAMES 4800
+
+// Remove every file in a directory (one level), creating it if needed
+static void clean_dir(const char *path) {
+  mkdir(path, 0755);
+  DIR *dir = opendir(path);
+  assert(dir != NULL);
+  struct dirent *entry;
+  char file[1024];
+  while ((entry = readdir(dir)) != NULL) {
+    if (entry->d_name[0] == '.')
+      continue;
+    snprintf(file, sizeof(file), "%s/%s", path, entry->d_name);
+    unlink(file);
+  }
+  closedir(dir);
+}
+
+// Count files in a directory whose names contain `needle`
+static int count_files(const char *path, const char *needle) {
+  DIR *dir = opendir(path);
+  if (!dir)
+    return 0;
+  int count = 0;
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != NULL) {
+    if (entry->d_name[0] != '.' && strstr(entry->d_name, needle))
+      count++;
+  }
+  closedir(dir);
+  return count;
+}
+
+static void write_input(const char *path, double frequency) {
+  AudioBuffer *buffer = audio_buffer_create(JOB_FRAMES, SAMPLE_RATE, 1, 24);
+  for (size_t i = 0; i < JOB_FRAMES; i++) {
+    buffer->data[i] = 0.5 * sin(2.0 * M_PI * frequency * i / SAMPLE_RATE) + 0.2;
+  }
+  assert(write_wave(path, buffer) == AUDIO_SUCCESS);
+  audio_buffer_free(buffer);
+}
+
+// Create `count` inputs and a manifest with relative paths
+static void make_batch(const char *dir, int count, int missing) {
+  char leases[512], path[512];
+  snprintf(leases, sizeof(leases), "%s/manifest.txt.leases", dir);
+  clean_dir(dir);
+  clean_dir(leases);
+
+  snprintf(path, sizeof(path), "%s/manifest.txt", dir);
+  FILE *manifest = fopen(path, "w");
+  assert(manifest != NULL);
+  fprintf(manifest, "# input\toutput\n\n");
+  for (int i = 0; i < count; i++) {
+    snprintf(path, sizeof(path), "%s/in-%02d.wav", dir, i);
+    if (i != missing)
+      write_input(path, 100.0 * (i + 1));
+    fprintf(manifest, "in-%02d.wav\tout-%02d.wav\n", i, i);
+  }
+  fclose(manifest);
+}
+
+typedef struct {
+  int delay_us;          // Simulated work per job
+  int crash;             // _exit() inside the job, leaving the lease behind
+} JobSettings;
+
+// 100 Hz high-pass, like a real batch
+static AudioError filter_job(void *user, const BatchJob *job,
+                             const char *temp_path) {
+  const JobSettings *settings = (const JobSettings *)user;
+  if (settings->crash)
+    _exit(3);
+
+  AudioError error;
+  AudioBuffer *buffer = read_wave(job->input, &error);
+  if (!buffer)
+    return error;
+
+  HPFFilter hpf;
+  hpf_init(&hpf, buffer->sample_rate, 100.0);
+  hpf_process_buffer(&hpf, buffer);
+  if (settings->delay_us > 0)
+    usleep(settings->delay_us);
+
+  error = write_wave(temp_path, buffer);
+  audio_buffer_free(buffer);
+  return error;
+}
+
+// Fork a worker; its exit status is the number of jobs it completed
+static pid_t spawn_worker(const char *manifest_path, const BatchOptions *options,
+                          JobSettings settings) {
+  pid_t pid = fork();
+  assert(pid >= 0);
+  if (pid == 0) {
+    BatchManifest manifest;
+    if (batch_manifest_load(manifest_path, &manifest) != AUDIO_SUCCESS)
+      _exit(255);
+    BatchStats stats;
+    AudioError error =
+        batch_run(&manifest, options, filter_job, &settings, &stats);
+    batch_manifest_free(&manifest);
+    _exit(error == AUDIO_SUCCESS ? (int)stats.completed : 255);
+  }
+  return pid;
+}
+
+static void fast_options(BatchOptions *options) {
+  batch_options_default(options);
+  options->lease_timeout = 0.5;
+  options->heartbeat_interval = 0.1;
+  options->poll_interval = 0.02;
+}
+
+// Test 1: Manifest parsing
+static void test_manifest(void) {
+  printf("Test 1: Manifest parsing...\n");
+
+  const char *dir = "tests/test_data/batch_manifest";
+  make_batch(dir, 3, -1);
+
+  BatchManifest manifest;
+  assert(batch_manifest_load("tests/test_data/batch_manifest/manifest.txt",
+                             &manifest) == AUDIO_SUCCESS);
+  assert(manifest.num_jobs == 3);
+  assert(strcmp(manifest.jobs[1].input,
+                "tests/test_data/batch_manifest/in-01.wav") == 0);
+  assert(strcmp(manifest.jobs[2].output,
+                "tests/test_data/batch_manifest/out-02.wav") == 0);
+  assert(strcmp(manifest.lease_dir,
+                "tests/test_data/batch_manifest/manifest.txt.leases") == 0);
+  batch_manifest_free(&manifest);
+
+  FILE *file = fopen("tests/test_data/batch_manifest/bad.txt", "w");
+  fprintf(file, "# header\n/abs/in.wav\t/abs/out.wav\nno-output.wav\n");
+  fclose(file);
+  assert(batch_manifest_load("tests/test_data/batch_manifest/bad.txt",
+                             &manifest) == AUDIO_ERROR_INVALID_FORMAT);
+  assert(manifest.error_line == 3 && manifest.num_jobs == 0);
+
+  assert(batch_manifest_load("tests/test_data/batch_manifest/none.txt",
+                             &manifest) == AUDIO_ERROR_FILE_NOT_FOUND);
+  printf("  ✓ Relative paths resolved, bad lines reported\n");
+}
+
+// Test 2: Several processes split the jobs without overlap
+static void test_parallel_workers(void) {
+  printf("Test 2: Four worker processes...\n");
+
+  const char *dir = "tests/test_data/batch_parallel";
+  const char *leases = "tests/test_data/batch_parallel/manifest.txt.leases";
+  const char *path = "tests/test_data/batch_parallel/manifest.txt";
+  make_batch(dir, 16, -1);
+
+  BatchOptions options;
+  fast_options(&options);
+  JobSettings settings = {.delay_us = 20000, .crash = 0};
+  pid_t workers[4];
+  for (int w = 0; w < 4; w++)
+    workers[w] = spawn_worker(path, &options, settings);
+
+  int total = 0, busy = 0;
+  for (int w = 0; w < 4; w++) {
+    int status;
+    assert(waitpid(workers[w], &status, 0) == workers[w]);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) != 255);
+    total += WEXITSTATUS(status);
+    busy += WEXITSTATUS(status) > 0;
+  }
+  printf("  %d jobs over %d workers\n", total, busy);
+  assert(total == 16);
+  assert(busy > 1);
+
+  assert(count_files(dir, "out-") == 16);
+  assert(count_files(dir, ".tmp-") == 0);
+  assert(count_files(leases, ".done") == 16);
+  assert(count_files(leases, ".lease") == 0);
+
+  // Committed output matches a direct render
+  AudioError error;
+  AudioBuffer *expected =
+      read_wave("tests/test_data/batch_parallel/in-05.wav", &error);
+  HPFFilter hpf;
+  hpf_init(&hpf, SAMPLE_RATE, 100.0);
+  hpf_process_buffer(&hpf, expected);
+  AudioBuffer *output =
+      read_wave("tests/test_data/batch_parallel/out-05.wav", &error);
+  assert(output && output->length == expected->length);
+  for (size_t i = 0; i < output->length; i++)
+    assert(fabs(output->data[i] - expected->data[i]) < 1e-6);
+  audio_buffer_free(expected);
+  audio_buffer_free(output);
+
+  // A second run has nothing to do
+  BatchManifest manifest;
+  batch_manifest_load(path, &manifest);
+  BatchStats stats;
+  assert(batch_run(&manifest, &options, filter_job, &settings, &stats) ==
+         AUDIO_SUCCESS);
+  assert(stats.completed == 0 && stats.skipped == 16);
+  batch_manifest_free(&manifest);
+  printf("  ✓ Every job committed exactly once, rerun skips all\n");
+}
+
+// Test 3: A crashed worker's lease expires and the job is reclaimed
+static void test_crash_recovery(void) {
+  printf("Test 3: Crashed worker recovery...\n");
+
+  const char *dir = "tests/test_data/batch_crash";
+  const char *leases = "tests/test_data/batch_crash/manifest.txt.leases";
+  const char *path = "tests/test_data/batch_crash/manifest.txt";
+  make_batch(dir, 4, -1);
+
+  BatchOptions options;
+  fast_options(&options);
+  JobSettings crash = {.delay_us = 0, .crash = 1};
+  pid_t pid = spawn_worker(path, &options, crash);
+  int status;
+  assert(waitpid(pid, &status, 0) == pid);
+  assert(WIFEXITED(status) && WEXITSTATUS(status) == 3);
+  assert(count_files(leases, ".lease") == 1);
+
+  BatchManifest manifest;
+  batch_manifest_load(path, &manifest);
+  JobSettings settings = {.delay_us = 0, .crash = 0};
+  BatchStats stats;
+  assert(batch_run(&manifest, &options, filter_job, &settings, &stats) ==
+         AUDIO_SUCCESS);
+  batch_manifest_free(&manifest);
+
+  assert(stats.completed == 4);
+  assert(count_files(dir, "out-") == 4);
+  assert(count_files(leases, ".lease") == 0);
+  assert(count_files(leases, ".broken") == 0);
+  printf("  ✓ Orphaned lease broken after the timeout\n");
+}
+
+// Test 4: A failing job is marked and not retried
+static void test_failed_job(void) {
+  printf("Test 4: Failed job...\n");
+
+  const char *dir = "tests/test_data/batch_failed";
+  const char *leases = "tests/test_data/batch_failed/manifest.txt.leases";
+  const char *path = "tests/test_data/batch_failed/manifest.txt";
+  make_batch(dir, 5, 2);
+
+  BatchManifest manifest;
+  batch_manifest_load(path, &manifest);
+  BatchOptions options;
+  fast_options(&options);
+  JobSettings settings = {.delay_us = 0, .crash = 0};
+  BatchStats stats;
+  assert(batch_run(&manifest, &options, filter_job, &settings, &stats) ==
+         AUDIO_SUCCESS);
+  assert(stats.completed == 4 && stats.failed == 1);
+  assert(count_files(leases, "job-2.failed") == 1);
+  assert(count_files(dir, "out-02") == 0);
+  assert(count_files(dir, ".tmp-") == 0);
+
+  assert(batch_run(&manifest, &options, filter_job, &settings, &stats) ==
+         AUDIO_SUCCESS);
+  assert(stats.completed == 0 && stats.failed == 0 && stats.skipped == 5);
+  batch_manifest_free(&manifest);
+  printf("  ✓ Failure recorded, rerun leaves it alone\n");
+}
+
+// Test 5: Worker threads in one process split the jobs
+static void test_threads(void) {
+  printf("Test 5: Four worker threads...\n");
+
+  const char *dir = "tests/test_data/batch_threads";
+  const char *leases = "tests/test_data/batch_threads/manifest.txt.leases";
+  const char *path = "tests/test_data/batch_threads/manifest.txt";
+  make_batch(dir, 12, -1);
+
+  BatchManifest manifest;
+  batch_manifest_load(path, &manifest);
+  BatchOptions options;
+  fast_options(&options);
+  options.threads = 4;
+  JobSettings settings = {.delay_us = 10000, .crash = 0};
+  BatchStats stats;
+  assert(batch_run(&manifest, &options, filter_job, &settings, &stats) ==
+         AUDIO_SUCCESS);
+  assert(stats.completed == 12 && stats.failed == 0 && stats.skipped == 0);
+  assert(count_files(dir, "out-") == 12);
+  assert(count_files(dir, ".tmp-") == 0);
+  assert(count_files(leases, ".done") == 12);
+  assert(count_files(leases, ".lease") == 0);
+
+  // Each thread leaves its own id on the markers it writes
+  char marker[512], owner[512];
+  snprintf(marker, sizeof(marker), "%s/job-0.done", leases);
+  FILE *file = fopen(marker, "r");
+  assert(file != NULL && fgets(owner, sizeof(owner), file) != NULL);
+  fclose(file);
+  char suffix[32];
+  snprintf(suffix, sizeof(suffix), "-%ld-", (long)getpid());
+  assert(strstr(owner, suffix) != NULL);
+
+  assert(batch_run(&manifest, &options, filter_job, &settings, &stats) ==
+         AUDIO_SUCCESS);
+  assert(stats.completed == 0 && stats.skipped == 12);
+  batch_manifest_free(&manifest);
+  printf("  ✓ Every job committed once, skips counted once\n");
+}
+
+int main(void) {
+  printf("=== Batch Test Suite ===\n\n");
+
+  test_manifest();
+  test_parallel_workers();
+  test_crash_recovery();
+  test_failed_job();
+  test_threads();
+
+  printf("\n=== All batch tests passed ===\n");
+  return 0;
+}
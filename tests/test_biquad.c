@@ -147,6 +147,44 @@ void test_biquad_underflow() {
   printf("  ✓ Underflow prevention working\n\n");
 }
 
+// Test impulse response decay estimate
+void test_biquad_decay_length() {
+  printf("Test 7: Impulse Response Decay Length\n");
+
+  BiQuad bq;
+  biquad_init(&bq);
+
+  // FIR section settles once the feedforward delays are filled
+  bq.a0 = 0.5;
+  bq.a1 = 0.5;
+  assert(biquad_decay_length(&bq, 1e-9) == 2);
+
+  // Resonant section (poles at radius 0.9)
+  bq.b1 = -1.6;
+  bq.b2 = 0.81;
+  size_t n = biquad_decay_length(&bq, 1e-9);
+  printf("  Poles at r=0.9 -> %zu samples\n", n);
+
+  // After n samples the impulse response must be below the threshold
+  biquad_flush_delays(&bq);
+  double peak = 0.0;
+  double tail = 0.0;
+  for (size_t i = 0; i < n + 100; i++) {
+    double y = fabs(biquad_process(&bq, i == 0 ? 1.0 : 0.0));
+    if (y > peak)
+      peak = y;
+    if (i >= n && y > tail)
+      tail = y;
+  }
+  assert(tail < peak * 1e-9);
+
+  // Unstable section never settles
+  bq.b2 = 1.2;
+  assert(biquad_decay_length(&bq, 1e-9) == (size_t)-1);
+
+  printf("  ✓ Decay length estimate bounds the impulse response\n\n");
+}
+
 int main() {
   printf("\n=== BiQuad Filter Unit Tests ===\n\n");
 
@@ -156,6 +194,7 @@ int main() {
   test_biquad_delays();
   test_biquad_lowpass();
   test_biquad_underflow();
+  test_biquad_decay_length();
 
   printf("=== All BiQuad tests passed! ===\n\n");
   return 0;
@@ -0,0 +1,426 @@
+// Differential test: every BiQuad backend against a long double reference
+//
+// Random stable coefficient sets, lengths, block splits, channel counts and
+// edge-case signals (DC, impulses, denormals, full scale) are run through
+// each backend. The worst error of each backend, relative to the signal
+// level, must stay inside that backend's budget.
+//
+// Usage: test_differential [seed] [cases]
+
+#include "audio_io.h"
+#include "biquad.h"
+#include "chain.h"
+#ifdef USE_MLIR
+#include "mlir_biquad.h"
+#include "mlir_dsp.h"
+#endif
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PASS "\033[32m✓\033[0m"
+#define FAIL "\033[31m✗\033[0m"
+#define MAX_CHANNELS 8
+#define MAX_FRAMES 4096
+#define DEFAULT_SEED 0x5eed1234u
+#define DEFAULT_CASES 300
+
+// One randomized scenario
+typedef struct {
+  BiQuad filters[MAX_CHANNELS]; // Coefficients per channel, zeroed state
+  int channels;
+  size_t frames;
+  size_t block;                 // Frames per call for block-split backends
+  int signal;                   // Signal kind (for failure reports)
+  double *input;                // Interleaved, frames * channels
+} DiffCase;
+
+typedef void (*BackendFn)(const DiffCase *c, double *output);
+
+// A backend and its error budget (max error / signal level)
+typedef struct {
+  const char *name;
+  BackendFn run;
+  double budget;
+  int every;                    // Run on every Nth case (slow compilers)
+  double worst;
+  int cases;
+  int worst_case;
+} Backend;
+
+static const char *signal_names[] = {"noise", "dc", "impulse", "denormal",
+                                     "full-scale", "burst"};
+
+// xorshift64*, so runs are reproducible from the seed
+static uint64_t rng_state;
+
+static uint64_t rng_next(void) {
+  rng_state ^= rng_state >> 12;
+  rng_state ^= rng_state << 25;
+  rng_state ^= rng_state >> 27;
+  return rng_state * 2685821657736338717ULL;
+}
+
+static double rng_uniform(double lo, double hi) {
+  return lo + (hi - lo) * ((rng_next() >> 11) * (1.0 / 9007199254740992.0));
+}
+
+static size_t rng_range(size_t lo, size_t hi) {
+  return lo + (size_t)(rng_next() % (hi - lo + 1));
+}
+
+// Random stable section: poles strictly inside the unit circle
+static void random_filter(BiQuad *bq) {
+  biquad_init(bq);
+
+  if (rng_next() & 1) {
+    double r = rng_uniform(0.0, 0.995);
+    double theta = rng_uniform(0.0, M_PI);
+    bq->b1 = -2.0 * r * cos(theta);
+    bq->b2 = r * r;
+  } else {
+    double p1 = rng_uniform(-0.995, 0.995);
+    double p2 = rng_uniform(-0.995, 0.995);
+    bq->b1 = -(p1 + p2);
+    bq->b2 = p1 * p2;
+  }
+
+  double rz = rng_uniform(0.0, 1.2);
+  double theta_z = rng_uniform(0.0, M_PI);
+  double gain = rng_uniform(0.05, 1.0);
+  bq->a0 = gain;
+  bq->a1 = -2.0 * rz * cos(theta_z) * gain;
+  bq->a2 = rz * rz * gain;
+
+  // Mostly fully wet, sometimes a wet/dry blend
+  if (rng_next() % 4 == 0) {
+    bq->c0 = rng_uniform(0.0, 1.0);
+    bq->d0 = rng_uniform(0.0, 1.0);
+  }
+}
+
+static void fill_signal(double *data, size_t frames, int channels, int kind) {
+  size_t position = rng_range(0, frames - 1);
+  for (size_t f = 0; f < frames; f++) {
+    for (int c = 0; c < channels; c++) {
+      double x = 0.0;
+      switch (kind) {
+      case 0:
+        x = rng_uniform(-1.0, 1.0);
+        break;
+      case 1:
+        x = c % 2 ? -1.0 : 1.0;
+        break;
+      case 2:
+        x = f == position ? 1.0 : 0.0;
+        break;
+      case 3:
+        x = rng_uniform(-1.0, 1.0) * 1e-310;
+        break;
+      case 4:
+        x = (f + c) % 2 ? -1.0 : 1.0;
+        break;
+      case 5:
+        x = f >= position && f < position + 64 ? rng_uniform(-1.0, 1.0) : 0.0;
+        break;
+      }
+      data[f * channels + c] = x;
+    }
+  }
+}
+
+static void random_case(DiffCase *c, int index) {
+  // Edge lengths first, then random ones
+  static const size_t edge_frames[] = {1, 2, 3, 4, 63, 64, 65, 1024, 1025};
+  size_t num_edges = sizeof(edge_frames) / sizeof(edge_frames[0]);
+
+  c->channels = (int)rng_range(1, MAX_CHANNELS);
+  c->frames = (size_t)index < num_edges ? edge_frames[index]
+                                        : rng_range(1, MAX_FRAMES);
+  c->block = rng_next() % 8 == 0 ? 1 : rng_range(1, c->frames);
+  c->signal = (int)rng_range(0, 5);
+  for (int ch = 0; ch < c->channels; ch++) {
+    random_filter(&c->filters[ch]);
+  }
+  fill_signal(c->input, c->frames, c->channels, c->signal);
+}
+
+// Exact-as-possible Direct Form I in long double, no denormal flushing
+static void reference(const DiffCase *c, long double *output) {
+  for (int ch = 0; ch < c->channels; ch++) {
+    const BiQuad *bq = &c->filters[ch];
+    long double x1 = 0.0L, x2 = 0.0L, y1 = 0.0L, y2 = 0.0L;
+    for (size_t f = 0; f < c->frames; f++) {
+      long double x = c->input[f * c->channels + ch];
+      long double y = (long double)bq->a0 * x + (long double)bq->a1 * x1 +
+                      (long double)bq->a2 * x2 - (long double)bq->b1 * y1 -
+                      (long double)bq->b2 * y2;
+      x2 = x1;
+      x1 = x;
+      y2 = y1;
+      y1 = y;
+      output[f * c->channels + ch] =
+          y * (long double)bq->c0 + x * (long double)bq->d0;
+    }
+  }
+}
+
+// Per-sample C
+static void run_c_scalar(const DiffCase *c, double *output) {
+  for (int ch = 0; ch < c->channels; ch++) {
+    BiQuad bq = c->filters[ch];
+    for (size_t f = 0; f < c->frames; f++) {
+      double x = c->input[f * c->channels + ch];
+      output[f * c->channels + ch] = biquad_process(&bq, x) * bq.c0 + x * bq.d0;
+    }
+  }
+}
+
+// Strided C over interleaved data, split into blocks
+static void run_c_strided(const DiffCase *c, double *output) {
+  BiQuad filters[MAX_CHANNELS];
+  memcpy(filters, c->filters, sizeof(filters));
+  memcpy(output, c->input, c->frames * c->channels * sizeof(double));
+
+  for (size_t start = 0; start < c->frames; start += c->block) {
+    size_t n = c->frames - start < c->block ? c->frames - start : c->block;
+    for (int ch = 0; ch < c->channels; ch++) {
+      biquad_process_strided(&filters[ch], output + start * c->channels + ch,
+                             n, c->channels);
+    }
+  }
+}
+
+static void strided_stage(void *state, const AudioBufferView *tile) {
+  BiQuad *filters = state;
+  for (int ch = 0; ch < tile->channels; ch++) {
+    biquad_process_strided(&filters[tile->first_channel + ch], tile->data + ch,
+                           tile->frames, tile->stride);
+  }
+}
+
+// Cache-blocked chain executor with the block size as tile size
+static void run_chain(const DiffCase *c, double *output) {
+  BiQuad filters[MAX_CHANNELS];
+  memcpy(filters, c->filters, sizeof(filters));
+
+  size_t samples = c->frames * c->channels;
+  AudioBuffer *buffer = audio_buffer_create(samples, 48000, c->channels, 16);
+  if (!buffer)
+    return;
+  memcpy(buffer->data, c->input, samples * sizeof(double));
+
+  AudioChain chain;
+  audio_chain_init(&chain);
+  audio_chain_add(&chain, "biquad", strided_stage, filters);
+  audio_chain_set_tile_frames(&chain, c->block);
+  audio_chain_process(&chain, buffer);
+
+  memcpy(output, buffer->data, samples * sizeof(double));
+  audio_buffer_free(buffer);
+}
+
+#ifdef USE_MLIR
+// Per-sample JIT kernel
+static void run_mlir_sample(const DiffCase *c, double *output) {
+  for (int ch = 0; ch < c->channels; ch++) {
+    BiQuad bq = c->filters[ch];
+    MLIRBiQuadJIT *jit = mlir_biquad_jit_create(&bq);
+    for (size_t f = 0; f < c->frames; f++) {
+      double x = c->input[f * c->channels + ch];
+      output[f * c->channels + ch] =
+          mlir_biquad_process(jit, &bq, x) * bq.c0 + x * bq.d0;
+    }
+    mlir_biquad_jit_destroy(jit);
+  }
+}
+
+// Buffer JIT kernel on deinterleaved channels, split into blocks
+static void run_mlir_buffer(const DiffCase *c, double *output) {
+  double *dry = malloc(c->frames * sizeof(double));
+  double *wet = malloc(c->frames * sizeof(double));
+
+  for (int ch = 0; ch < c->channels; ch++) {
+    BiQuad bq = c->filters[ch];
+    MLIRBiQuadJIT *jit = mlir_biquad_jit_create(&bq);
+    for (size_t f = 0; f < c->frames; f++) {
+      dry[f] = c->input[f * c->channels + ch];
+    }
+    for (size_t start = 0; start < c->frames; start += c->block) {
+      size_t n = c->frames - start < c->block ? c->frames - start : c->block;
+      mlir_biquad_process_buffer(jit, &bq, dry + start, wet + start, n);
+    }
+    for (size_t f = 0; f < c->frames; f++) {
+      output[f * c->channels + ch] = wet[f] * bq.c0 + dry[f] * bq.d0;
+    }
+    mlir_biquad_jit_destroy(jit);
+  }
+
+  free(dry);
+  free(wet);
+}
+
+// Strided JIT kernel over interleaved data, split into blocks
+static void run_mlir_strided(const DiffCase *c, double *output) {
+  BiQuad filters[MAX_CHANNELS];
+  MLIRBiQuadJIT *jits[MAX_CHANNELS];
+  memcpy(filters, c->filters, sizeof(filters));
+  memcpy(output, c->input, c->frames * c->channels * sizeof(double));
+  for (int ch = 0; ch < c->channels; ch++) {
+    jits[ch] = mlir_biquad_jit_create(&filters[ch]);
+  }
+
+  for (size_t start = 0; start < c->frames; start += c->block) {
+    size_t n = c->frames - start < c->block ? c->frames - start : c->block;
+    for (int ch = 0; ch < c->channels; ch++) {
+      mlir_biquad_process_strided(jits[ch], &filters[ch],
+                                  output + start * c->channels + ch, n,
+                                  c->channels);
+    }
+  }
+
+  for (int ch = 0; ch < c->channels; ch++) {
+    mlir_biquad_jit_destroy(jits[ch]);
+  }
+}
+
+// dsp dialect chains (topology picked per section), one library per case
+static void run_mlir_dsp(const DiffCase *c, double *output) {
+  DspStageSpec stages[MAX_CHANNELS];
+  DspKernelSpec kernels[MAX_CHANNELS];
+  char names[MAX_CHANNELS][16];
+  memset(stages, 0, sizeof(stages));
+  memset(kernels, 0, sizeof(kernels));
+  for (int ch = 0; ch < c->channels; ch++) {
+    stages[ch].type = DSP_STAGE_BIQUAD;
+    stages[ch].biquad = c->filters[ch];
+    snprintf(names[ch], sizeof(names[ch]), "ch%d", ch);
+    kernels[ch].name = names[ch];
+    kernels[ch].kind = DSP_KERNEL_CHAIN;
+    kernels[ch].spec.stages = &stages[ch];
+    kernels[ch].spec.num_stages = 1;
+  }
+
+  MLIRDspLibrary *library = mlir_dsp_library_create(kernels, c->channels);
+  double *dry = malloc(c->frames * sizeof(double));
+  double *wet = malloc(c->frames * sizeof(double));
+  for (int ch = 0; ch < c->channels; ch++) {
+    MLIRDspChain *chain = mlir_dsp_library_chain(library, names[ch]);
+    for (size_t f = 0; f < c->frames; f++) {
+      dry[f] = c->input[f * c->channels + ch];
+    }
+    for (size_t start = 0; chain && start < c->frames; start += c->block) {
+      size_t n = c->frames - start < c->block ? c->frames - start : c->block;
+      mlir_dsp_chain_process(chain, dry + start, wet + start, n);
+    }
+    for (size_t f = 0; f < c->frames; f++) {
+      // A failed compile shows up as an error, not a skipped case
+      output[f * c->channels + ch] = chain ? wet[f] : NAN;
+    }
+    mlir_dsp_chain_destroy(chain);
+  }
+
+  mlir_dsp_library_destroy(library);
+  free(dry);
+  free(wet);
+}
+#endif
+
+// Max error relative to the signal level (at least 1.0, so silence and
+// denormal inputs are judged in absolute terms)
+static double relative_error(const DiffCase *c, const long double *expected,
+                             const double *actual) {
+  size_t samples = c->frames * c->channels;
+  long double level = 1.0L;
+  for (size_t i = 0; i < samples; i++) {
+    if (fabsl(expected[i]) > level)
+      level = fabsl(expected[i]);
+  }
+
+  double worst = 0.0;
+  for (size_t i = 0; i < samples; i++) {
+    double error = (double)(fabsl((long double)actual[i] - expected[i]) / level);
+    if (!(error <= worst)) // Also catches NaN
+      worst = isnan(error) ? INFINITY : error;
+  }
+  return worst;
+}
+
+int main(int argc, char **argv) {
+  uint64_t seed = argc > 1 ? strtoull(argv[1], NULL, 0) : DEFAULT_SEED;
+  int num_cases = argc > 2 ? atoi(argv[2]) : DEFAULT_CASES;
+  rng_state = seed ? seed : DEFAULT_SEED;
+
+  // Budgets: same-structure double paths only differ from the reference by
+  // double rounding (the JIT kernels keep the C operation order and emit no
+  // FP contraction). The dsp dialect runs every section here as TDF2, since
+  // poles stay within 0.995 and it only keeps DF1 past 0.999; TDF2 rounds
+  // differently, so it gets more headroom
+  Backend backends[] = {
+      {"c-scalar", run_c_scalar, 1e-11, 1, 0.0, 0, -1},
+      {"c-strided", run_c_strided, 1e-11, 1, 0.0, 0, -1},
+      {"chain-tiles", run_chain, 1e-11, 1, 0.0, 0, -1},
+#ifdef USE_MLIR
+      {"mlir-sample", run_mlir_sample, 1e-10, 1, 0.0, 0, -1},
+      {"mlir-buffer", run_mlir_buffer, 1e-10, 1, 0.0, 0, -1},
+      {"mlir-strided", run_mlir_strided, 1e-10, 1, 0.0, 0, -1},
+      {"mlir-dsp-chain", run_mlir_dsp, 1e-9, 10, 0.0, 0, -1},
+#endif
+  };
+  int num_backends = sizeof(backends) / sizeof(backends[0]);
+
+  printf("\n=== Differential Backend Tests ===\n");
+  printf("  seed 0x%llx, %d cases\n\n", (unsigned long long)rng_state,
+         num_cases);
+
+  size_t max_samples = MAX_FRAMES * MAX_CHANNELS;
+  DiffCase c;
+  c.input = malloc(max_samples * sizeof(double));
+  long double *expected = malloc(max_samples * sizeof(long double));
+  double *actual = malloc(max_samples * sizeof(double));
+
+  for (int i = 0; i < num_cases; i++) {
+    random_case(&c, i);
+    reference(&c, expected);
+
+    for (int b = 0; b < num_backends; b++) {
+      Backend *backend = &backends[b];
+      if (i % backend->every)
+        continue;
+
+      backend->run(&c, actual);
+      double error = relative_error(&c, expected, actual);
+      backend->cases++;
+      if (error > backend->worst || backend->worst_case < 0) {
+        backend->worst = error;
+        backend->worst_case = i;
+      }
+      if (error > backend->budget) {
+        printf("  %s %s case %d: %d ch, %zu frames, block %zu, %s: "
+               "error %.3e\n",
+               FAIL, backend->name, i, c.channels, c.frames, c.block,
+               signal_names[c.signal], error);
+      }
+    }
+  }
+
+  int failed = 0;
+  printf("  %-16s %10s %10s %6s\n", "backend", "budget", "worst", "cases");
+  for (int b = 0; b < num_backends; b++) {
+    const Backend *backend = &backends[b];
+    int ok = backend->worst <= backend->budget;
+    printf("  %s %-14s %10.1e %10.3e %6d\n", ok ? PASS : FAIL, backend->name,
+           backend->budget, backend->worst, backend->cases);
+    failed += !ok;
+  }
+
+  free(c.input);
+  free(expected);
+  free(actual);
+
+  printf("\n=== %s ===\n\n",
+         failed ? "Differential tests FAILED" : "All backends within budget");
+  return failed ? 1 : 0;
+}
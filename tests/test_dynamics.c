@@ -0,0 +1,401 @@
+#include "audio_io.h"
+#include "chain.h"
+#include "dynamics.h"
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SAMPLE_RATE 48000.0
+#define FRAMES 48000
+
+static double db_to_linear(double db) { return pow(10.0, db / 20.0); }
+
+// Square wave: constant |x| so the detector sees a steady level
+static void fill_square(AudioBuffer *buffer, int channel, double amplitude) {
+  size_t frames = buffer->length / buffer->channels;
+  for (size_t f = 0; f < frames; f++) {
+    buffer->data[f * buffer->channels + channel] =
+        ((f / 24) % 2) ? -amplitude : amplitude;
+  }
+}
+
+// Noise with occasional loud bursts
+static void fill_bursts(AudioBuffer *buffer) {
+  unsigned int seed = 777;
+  size_t frames = buffer->length / buffer->channels;
+  for (size_t f = 0; f < frames; f++) {
+    double burst = (f % 6000) < 300 ? 4.0 : 0.5;
+    for (int c = 0; c < buffer->channels; c++) {
+      seed = seed * 1103515245u + 12345u;
+      double noise = ((seed >> 8) & 0xFFFF) / 32768.0 - 1.0;
+      buffer->data[f * buffer->channels + c] = burst * noise;
+    }
+  }
+}
+
+// Test 1: Steady-state compression follows the static curve
+static void test_compressor_curve(void) {
+  printf("Test 1: Compressor static curve...\n");
+
+  AudioBuffer *buffer = audio_buffer_create(FRAMES, SAMPLE_RATE, 1, 24);
+  fill_square(buffer, 0, 0.5); // -6.02 dBFS
+
+  Compressor comp;
+  compressor_init(&comp, SAMPLE_RATE, -20.0, 4.0, 1.0, 50.0);
+  compressor_process_buffer(&comp, buffer);
+
+  // 13.98 dB over the threshold at 4:1 keeps a quarter of it
+  double input_db = 20.0 * log10(0.5);
+  double expected_db = -20.0 + (input_db + 20.0) / 4.0;
+  double output_db = 20.0 * log10(fabs(buffer->data[FRAMES - 1]));
+  printf("  Input %.2f dB -> output %.4f dB (expected %.4f)\n", input_db,
+         output_db, expected_db);
+  assert(fabs(output_db - expected_db) < 0.001);
+
+  // Below the knee nothing changes
+  fill_square(buffer, 0, 0.01); // -40 dBFS
+  compressor_reset(&comp);
+  compressor_process_buffer(&comp, buffer);
+  assert(fabs(fabs(buffer->data[FRAMES - 1]) - 0.01) < 1e-6);
+
+  audio_buffer_free(buffer);
+  printf("  ✓ Gain reduction matches threshold and ratio within 0.001 dB\n");
+}
+
+// Test 2: Channels are linked, so a quiet channel gets the loud one's gain
+static void test_stereo_link(void) {
+  printf("Test 2: Stereo-linked detection...\n");
+
+  AudioBuffer *buffer = audio_buffer_create(FRAMES * 2, SAMPLE_RATE, 2, 24);
+  fill_square(buffer, 0, 0.8);
+  fill_square(buffer, 1, 0.05);
+
+  Compressor comp;
+  compressor_init(&comp, SAMPLE_RATE, -24.0, 8.0, 5.0, 100.0);
+  compressor_process_buffer(&comp, buffer);
+
+  for (size_t f = 0; f < FRAMES; f++) {
+    double left = fabs(buffer->data[2 * f]) / 0.8;
+    double right = fabs(buffer->data[2 * f + 1]) / 0.05;
+    assert(fabs(left - right) < 1e-12);
+  }
+  printf("  Final gain: %.2f dB on both channels\n",
+         20.0 * log10(fabs(buffer->data[2 * FRAMES - 2]) / 0.8));
+
+  audio_buffer_free(buffer);
+  printf("  ✓ Both channels share one gain\n");
+}
+
+// Test 3: The limiter never exceeds the ceiling and delays by its lookahead
+static void test_limiter_ceiling(void) {
+  printf("Test 3: Limiter ceiling and latency...\n");
+
+  AudioBuffer *buffer = audio_buffer_create(FRAMES * 2, SAMPLE_RATE, 2, 24);
+  fill_bursts(buffer);
+
+  Limiter lim;
+  assert(limiter_init(&lim, SAMPLE_RATE, 2, -1.0, 2.0, 50.0) == 0);
+  assert(lim.lookahead == 96);
+  limiter_process_buffer(&lim, buffer);
+
+  double ceiling = db_to_linear(-1.0);
+  double peak = 0.0;
+  for (size_t i = 0; i < buffer->length; i++) {
+    peak = fmax(peak, fabs(buffer->data[i]));
+  }
+  printf("  Input peak +12.04 dB -> output peak %.4f dB (ceiling -1 dB)\n",
+         20.0 * log10(peak));
+  assert(peak <= ceiling * (1.0 + 1e-12));
+
+  // Material under the ceiling passes unchanged, delayed by the lookahead
+  AudioBuffer *quiet = audio_buffer_create(1000 * 2, SAMPLE_RATE, 2, 24);
+  for (size_t i = 0; i < quiet->length; i++) {
+    quiet->data[i] = 0.5 * sin(0.01 * i);
+  }
+  AudioBuffer *copy = audio_buffer_create(1000 * 2, SAMPLE_RATE, 2, 24);
+  memcpy(copy->data, quiet->data, quiet->length * sizeof(double));
+
+  AudioBufferView view;
+  limiter_reset(&lim);
+  audio_view_from_buffer(quiet, &view);
+  limiter_process_view(&lim, &view);
+  audio_view_release(&view);
+  for (size_t i = 0; i < quiet->length; i++) {
+    double expected = i < 2 * lim.lookahead
+                          ? 0.0
+                          : copy->data[i - 2 * lim.lookahead];
+    assert(quiet->data[i] == expected);
+  }
+
+  // The buffer helper removes the latency
+  memcpy(quiet->data, copy->data, quiet->length * sizeof(double));
+  limiter_reset(&lim);
+  limiter_process_buffer(&lim, quiet);
+  assert(memcmp(quiet->data, copy->data, quiet->length * sizeof(double)) ==
+         0);
+
+  limiter_free(&lim);
+  audio_buffer_free(quiet);
+  audio_buffer_free(copy);
+  audio_buffer_free(buffer);
+  printf("  ✓ Peaks held under the ceiling, latency %d frames\n", 96);
+}
+
+// Run HPF -> compressor -> limiter as one chain with a given tile size
+static void render_chain(AudioBuffer *buffer, size_t tile_frames) {
+  HPFFilter hpf;
+  Compressor comp;
+  Limiter lim;
+  hpf_init(&hpf, SAMPLE_RATE, 60.0);
+  compressor_init(&comp, SAMPLE_RATE, -18.0, 3.0, 2.0, 80.0);
+  assert(limiter_init(&lim, SAMPLE_RATE, 2, -0.3, 1.5, 40.0) == 0);
+
+  AudioChain chain;
+  audio_chain_init(&chain);
+  assert(audio_chain_add_hpf(&chain, &hpf) == 0);
+  assert(audio_chain_add(&chain, "compressor", compressor_stage, &comp) == 0);
+  assert(audio_chain_add(&chain, "limiter", limiter_stage, &lim) == 0);
+  audio_chain_set_tile_frames(&chain, tile_frames);
+  audio_chain_process(&chain, buffer);
+  limiter_free(&lim);
+}
+
+// Test 4: Fused into a chain, output does not depend on the tile size
+static void test_chain_fusion(void) {
+  printf("Test 4: Fused chain tile independence...\n");
+
+  AudioBuffer *ref = audio_buffer_create(FRAMES * 2, SAMPLE_RATE, 2, 24);
+  fill_bursts(ref);
+  AudioBuffer *buffer = audio_buffer_create(FRAMES * 2, SAMPLE_RATE, 2, 24);
+  render_chain(ref, FRAMES);
+
+  size_t tiles[] = {1, 64, 255, 1000, 4096};
+  for (size_t t = 0; t < sizeof(tiles) / sizeof(tiles[0]); t++) {
+    fill_bursts(buffer);
+    render_chain(buffer, tiles[t]);
+    assert(memcmp(buffer->data, ref->data, ref->length * sizeof(double)) ==
+           0);
+    printf("  Tile %4zu frames: identical\n", tiles[t]);
+  }
+
+  audio_buffer_free(buffer);
+  audio_buffer_free(ref);
+  printf("  ✓ Dynamics stages fuse with the filters in one pass\n");
+}
+
+// Voice-like test signal: 150 Hz bursts over 20 Hz rumble and a low hiss
+static void fill_voice(AudioBuffer *buffer, double burst_amplitude,
+                       double rumble_amplitude) {
+  unsigned int seed = 4242;
+  size_t frames = buffer->length / buffer->channels;
+  for (size_t f = 0; f < frames; f++) {
+    double t = f / SAMPLE_RATE;
+    int talking = (f % 24000) < 9000;
+    for (int c = 0; c < buffer->channels; c++) {
+      seed = seed * 1103515245u + 12345u;
+      double hiss = (((seed >> 8) & 0xFFFF) / 32768.0 - 1.0) * 0.002;
+      buffer->data[f * buffer->channels + c] =
+          rumble_amplitude * sin(2.0 * M_PI * 20.0 * t) + hiss +
+          (talking ? burst_amplitude * sin(2.0 * M_PI * 150.0 * t) : 0.0);
+    }
+  }
+}
+
+// Test 5: The fused HPF + gate matches the two passes run separately
+static void test_gate_fused(void) {
+  printf("Test 5: Fused HPF + gate matches separate passes...\n");
+
+  AudioBuffer *fused = audio_buffer_create(FRAMES * 2, SAMPLE_RATE, 2, 24);
+  AudioBuffer *separate = audio_buffer_create(FRAMES * 2, SAMPLE_RATE, 2, 24);
+  fill_voice(fused, 0.3, 0.05);
+  fill_voice(separate, 0.3, 0.05);
+
+  // A -40 dB range keeps the filter running, so the paths are comparable
+  HPFFilter hpf_fused, hpf_separate;
+  NoiseGate gate_fused, gate_separate;
+  hpf_init(&hpf_fused, SAMPLE_RATE, 80.0);
+  hpf_init(&hpf_separate, SAMPLE_RATE, 80.0);
+  gate_init(&gate_fused, SAMPLE_RATE, -30.0, -36.0, 1.0, 20.0, 50.0);
+  gate_init(&gate_separate, SAMPLE_RATE, -30.0, -36.0, 1.0, 20.0, 50.0);
+  gate_fused.floor = gate_separate.floor = db_to_linear(-40.0);
+  gate_reset(&gate_fused);
+  gate_reset(&gate_separate);
+  gate_fused.hpf = &hpf_fused;
+
+  // Fused stage inside a tiled chain vs. two whole-buffer passes
+  AudioChain chain;
+  audio_chain_init(&chain);
+  assert(audio_chain_add(&chain, "hpf+gate", gate_stage, &gate_fused) == 0);
+  audio_chain_set_tile_frames(&chain, 333);
+  audio_chain_process(&chain, fused);
+
+  hpf_process_buffer(&hpf_separate, separate);
+  gate_process_buffer(&gate_separate, separate);
+
+  assert(memcmp(fused->data, separate->data,
+                fused->length * sizeof(double)) == 0);
+
+  audio_buffer_free(fused);
+  audio_buffer_free(separate);
+  printf("  ✓ One pass gives identical output\n");
+}
+
+// Test 6: Hysteresis between the open and close thresholds
+static void test_gate_hysteresis(void) {
+  printf("Test 6: Gate hysteresis...\n");
+
+  // Loud square, then a level between the thresholds (-33 dB)
+  AudioBuffer *buffer = audio_buffer_create(FRAMES, SAMPLE_RATE, 1, 24);
+  double middle = db_to_linear(-33.0);
+  for (size_t f = 0; f < FRAMES; f++) {
+    double amplitude = f < FRAMES / 2 ? 0.5 : middle;
+    buffer->data[f] = ((f / 24) % 2) ? -amplitude : amplitude;
+  }
+
+  NoiseGate gate;
+  gate_init(&gate, SAMPLE_RATE, -30.0, -36.0, 0.5, 10.0, 20.0);
+  gate_process_buffer(&gate, buffer);
+  assert(gate.channels[0].open);
+  assert(fabs(fabs(buffer->data[FRAMES - 1]) - middle) < 1e-9);
+
+  // The same level from a closed gate stays closed (exact silence)
+  for (size_t f = 0; f < FRAMES; f++) {
+    buffer->data[f] = ((f / 24) % 2) ? -middle : middle;
+  }
+  gate_reset(&gate);
+  gate_process_buffer(&gate, buffer);
+  assert(!gate.channels[0].open);
+  for (size_t f = 0; f < FRAMES; f++) {
+    assert(buffer->data[f] == 0.0);
+  }
+
+  // Channels are independent
+  AudioBuffer *stereo = audio_buffer_create(FRAMES * 2, SAMPLE_RATE, 2, 24);
+  fill_square(stereo, 0, 0.5);
+  fill_square(stereo, 1, 0.001);
+  gate_reset(&gate);
+  gate_process_buffer(&gate, stereo);
+  assert(gate.channels[0].open && !gate.channels[1].open);
+
+  audio_buffer_free(stereo);
+  audio_buffer_free(buffer);
+  printf("  ✓ -33 dB stays open after -6 dB and closed after silence\n");
+}
+
+// Test 7: A closed hard gate writes zeros and freezes the filter
+static void test_gate_freeze(void) {
+  printf("Test 7: Closed regions freeze the filter...\n");
+
+  AudioBuffer *buffer = audio_buffer_create(FRAMES * 2, SAMPLE_RATE, 2, 24);
+  fill_voice(buffer, 0.3, 0.02);
+
+  HPFFilter hpf;
+  NoiseGate gate;
+  hpf_init(&hpf, SAMPLE_RATE, 80.0);
+  gate_init(&gate, SAMPLE_RATE, -30.0, -36.0, 1.0, 20.0, 10.0);
+  gate.hpf = &hpf;
+
+  // Run through the first burst and its release, then snapshot the filter
+  AudioBufferView view, part;
+  audio_view_from_buffer(buffer, &view);
+  audio_view_slice(&view, 0, 20000, &part);
+  gate_process_view(&gate, &part);
+  audio_view_release(&part);
+  assert(!gate.channels[0].open && gate.channels[0].gain == 0.0);
+  BiQuad frozen = hpf.left;
+
+  // Rumble + hiss until the next burst: silence, filter untouched
+  audio_view_slice(&view, 20000, 24000 - 20000, &part);
+  gate_process_view(&gate, &part);
+  audio_view_release(&part);
+  assert(memcmp(&frozen, &hpf.left, sizeof(BiQuad)) == 0);
+  for (size_t i = 20000 * 2; i < 24000 * 2; i++) {
+    assert(buffer->data[i] == 0.0);
+  }
+
+  // The next burst reopens the gate and the filter resumes
+  audio_view_slice(&view, 24000, 4000, &part);
+  gate_process_view(&gate, &part);
+  audio_view_release(&part);
+  audio_view_release(&view);
+  assert(gate.channels[0].open && gate.channels[1].open);
+  assert(memcmp(&frozen, &hpf.left, sizeof(BiQuad)) != 0);
+
+  // Rumble above the open threshold wakes the filter, which restarts
+  // without a step, so the gate stays shut through the gap
+  fill_voice(buffer, 0.3, 0.05);
+  hpf_init(&hpf, SAMPLE_RATE, 80.0);
+  gate_reset(&gate);
+  audio_view_from_buffer(buffer, &view);
+  audio_view_slice(&view, 0, 24000, &part);
+  gate_process_view(&gate, &part);
+  audio_view_release(&part);
+  audio_view_release(&view);
+  assert(!gate.channels[0].open && !gate.channels[1].open);
+  for (size_t i = 20000 * 2; i < 24000 * 2; i++) {
+    assert(buffer->data[i] == 0.0);
+  }
+
+  audio_buffer_free(buffer);
+  printf("  ✓ Gated stretch is exact silence with the HPF state frozen\n");
+}
+
+// Test 8: The compensated limiter stage matches a separate limiter pass
+static void test_limiter_stage_compensated(void) {
+  printf("Test 8: Latency-compensated limiter stage...\n");
+
+  AudioBuffer *ref = audio_buffer_create(FRAMES * 2, SAMPLE_RATE, 2, 24);
+  AudioBuffer *buffer = audio_buffer_create(FRAMES * 2, SAMPLE_RATE, 2, 24);
+  HPFFilter hpf;
+  Limiter lim;
+  assert(limiter_init(&lim, SAMPLE_RATE, 2, -0.3, 1.5, 40.0) == 0);
+
+  // Reference: filter pass, then limiter_process_buffer
+  fill_bursts(ref);
+  hpf_init(&hpf, SAMPLE_RATE, 60.0);
+  hpf_process_buffer(&hpf, ref);
+  limiter_process_buffer(&lim, ref);
+
+  size_t tiles[] = {1, 64, 255, 4096, FRAMES};
+  for (size_t t = 0; t < sizeof(tiles) / sizeof(tiles[0]); t++) {
+    fill_bursts(buffer);
+    hpf_init(&hpf, SAMPLE_RATE, 60.0);
+    limiter_reset(&lim);
+
+    AudioChain chain;
+    audio_chain_init(&chain);
+    assert(audio_chain_add_hpf(&chain, &hpf) == 0);
+    assert(audio_chain_add(&chain, "limiter", limiter_buffer_stage, &lim) ==
+           0);
+    audio_chain_set_tile_frames(&chain, tiles[t]);
+    audio_chain_process(&chain, buffer);
+    limiter_finish_buffer(&lim, buffer);
+
+    assert(memcmp(buffer->data, ref->data, ref->length * sizeof(double)) ==
+           0);
+    printf("  Tile %5zu frames: identical\n", tiles[t]);
+  }
+
+  limiter_free(&lim);
+  audio_buffer_free(buffer);
+  audio_buffer_free(ref);
+  printf("  ✓ Limiter fused into the filter pass without latency\n");
+}
+
+int main(void) {
+  printf("=== Dynamics Test Suite ===\n\n");
+
+  test_compressor_curve();
+  test_stereo_link();
+  test_limiter_ceiling();
+  test_chain_fusion();
+  test_gate_fused();
+  test_gate_hysteresis();
+  test_gate_freeze();
+  test_limiter_stage_compensated();
+
+  printf("\n=== All dynamics tests passed ===\n");
+  return 0;
+}
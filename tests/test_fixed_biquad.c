@@ -0,0 +1,195 @@
+#include "audio_io.h"
+#include "fixed_biquad.h"
+#include "lpf.h"
+#include "parametric.h"
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SAMPLE_RATE 48000.0
+#define FRAMES 48000
+
+// Interleaved PCM test signal (two tones per channel)
+static PCMBuffer *make_pcm(int channels, int bits, double level) {
+  size_t samples = (size_t)FRAMES * channels;
+  double *data = malloc(samples * sizeof(double));
+  for (size_t f = 0; f < FRAMES; f++) {
+    double t = f / SAMPLE_RATE;
+    for (int c = 0; c < channels; c++) {
+      data[f * channels + c] =
+          level * (0.6 * sin(2.0 * M_PI * (100.0 + 50.0 * c) * t) +
+                   0.4 * sin(2.0 * M_PI * 7000.0 * t));
+    }
+  }
+  PCMBuffer *pcm = pcm_buffer_create(samples * (bits / 8), bits);
+  float64_to_pcm(data, pcm, samples);
+  free(data);
+  return pcm;
+}
+
+static uint64_t fnv1a(const uint8_t *data, size_t length) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < length; i++) {
+    hash = (hash ^ data[i]) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+// Test quantization accuracy against the double-precision filter
+void test_matches_float() {
+  printf("Test 1: Fixed Point Tracks the Float Filter (24-bit)\n");
+
+  LPFFilter lpf;
+  lpf_init(&lpf, SAMPLE_RATE, 1000.0);
+  FixedBiQuad fixed[2];
+  assert(fixed_biquad_init(&fixed[0], &lpf.left) == 0);
+  assert(fixed_biquad_init(&fixed[1], &lpf.right) == 0);
+  printf("  Coefficients: Q%d.%d\n", 32 - fixed[0].frac_bits,
+         fixed[0].frac_bits);
+  assert(fixed[0].frac_bits == 30);
+
+  PCMBuffer *pcm = make_pcm(2, 24, 0.5);
+  size_t samples = (size_t)FRAMES * 2;
+  double *reference = malloc(samples * sizeof(double));
+  double *actual = malloc(samples * sizeof(double));
+  pcm_to_float64(pcm, reference, samples);
+  for (size_t f = 0; f < FRAMES; f++) {
+    reference[f * 2] = biquad_process(&lpf.left, reference[f * 2]);
+    reference[f * 2 + 1] = biquad_process(&lpf.right, reference[f * 2 + 1]);
+  }
+
+  assert(fixed_biquad_process_pcm(fixed, 2, pcm) == AUDIO_SUCCESS);
+  pcm_to_float64(pcm, actual, samples);
+
+  double max_lsb = 0.0;
+  for (size_t i = 0; i < samples; i++) {
+    double lsb = fabs(actual[i] - reference[i]) * 8388608.0;
+    if (lsb > max_lsb)
+      max_lsb = lsb;
+  }
+  printf("  Max error vs. double: %.2f LSB\n", max_lsb);
+  // Plain truncation of the accumulator is off by ~40 LSB here
+  assert(max_lsb <= 4.0);
+
+  free(reference);
+  free(actual);
+  pcm_buffer_free(pcm);
+  printf("  ✓ Within 4 LSB of the double-precision filter\n\n");
+}
+
+// Test bit-exact output for pinned integer coefficients
+void test_bit_exact() {
+  printf("Test 2: Bit-Exact Golden Output\n");
+
+  // 1 kHz Butterworth low-pass at 48 kHz, pinned in Q2.30
+  static const int32_t coeffs[5] = {4411276, 8822553, 4411276, -1955505548,
+                                    899416830};
+  FixedBiQuad fixed[2];
+  fixed_biquad_init_q(&fixed[0], coeffs, 30);
+  fixed_biquad_init_q(&fixed[1], coeffs, 30);
+
+  // Integer-only input: a sawtooth and a square wave, full 16-bit range
+  PCMBuffer *pcm = pcm_buffer_create((size_t)FRAMES * 2 * 2, 16);
+  for (size_t f = 0; f < FRAMES; f++) {
+    int32_t saw = (int32_t)((f * 331) % 65536) - 32768;
+    int32_t square = (f / 120) % 2 ? 30000 : -30000;
+    uint8_t *frame = pcm->data + f * 4;
+    frame[0] = (uint8_t)(saw & 0xFF);
+    frame[1] = (uint8_t)((saw >> 8) & 0xFF);
+    frame[2] = (uint8_t)(square & 0xFF);
+    frame[3] = (uint8_t)((square >> 8) & 0xFF);
+  }
+
+  assert(fixed_biquad_process_pcm(fixed, 2, pcm) == AUDIO_SUCCESS);
+  uint64_t hash = fnv1a(pcm->data, pcm->length);
+  printf("  Output hash: %016llx\n", (unsigned long long)hash);
+  assert(hash == 0x87eae66611ed606fULL);
+
+  pcm_buffer_free(pcm);
+  printf("  ✓ Output matches the golden hash\n\n");
+}
+
+// Test that error feedback keeps the DC gain exact for tiny signals
+void test_error_feedback() {
+  printf("Test 3: Error Feedback at Low Levels\n");
+
+  LPFFilter lpf;
+  lpf_init(&lpf, SAMPLE_RATE, 20.0);
+  FixedBiQuad fixed;
+  assert(fixed_biquad_init(&fixed, &lpf.left) == 0);
+
+  // A 3 LSB DC input through a 20 Hz low-pass: plain truncation of the
+  // accumulator gets stuck in a dead band, the saved fraction keeps the mean
+  // at the designed DC gain
+  int64_t sum = 0;
+  for (int i = 0; i < FRAMES * 5; i++) {
+    int32_t y = fixed_biquad_process(&fixed, 3);
+    if (i >= FRAMES * 4)
+      sum += y;
+  }
+  double mean = (double)sum / FRAMES;
+  printf("  Mean output for 3 LSB DC: %.6f\n", mean);
+  assert(fabs(mean - 3.0) < 1e-3);
+
+  printf("  ✓ DC gain preserved below 1 LSB\n\n");
+}
+
+// Test block independence and saturation on 16-bit PCM
+void test_blocks_and_saturation() {
+  printf("Test 4: Block Splits and Saturation (16-bit)\n");
+
+  // +12 dB boost on a near full-scale signal must clip, not wrap
+  ParametricFilter peq;
+  parametric_init(&peq, SAMPLE_RATE, 100.0, 12.0, 1.0);
+  FixedBiQuad whole[2], split[2];
+  assert(fixed_biquad_init(&whole[0], &peq.left) == 0);
+  assert(fixed_biquad_init(&whole[1], &peq.right) == 0);
+  printf("  Coefficients: Q%d.%d\n", 32 - whole[0].frac_bits,
+         whole[0].frac_bits);
+  memcpy(split, whole, sizeof(whole));
+
+  PCMBuffer *a = make_pcm(2, 16, 0.9);
+  PCMBuffer *b = make_pcm(2, 16, 0.9);
+  assert(fixed_biquad_process_pcm(whole, 2, a) == AUDIO_SUCCESS);
+
+  // Same stream in 3 uneven pieces
+  size_t cuts[4] = {0, 1001, 30000, FRAMES};
+  for (int k = 0; k < 3; k++) {
+    PCMBuffer piece = {b->data + cuts[k] * 4, (cuts[k + 1] - cuts[k]) * 4, 16};
+    assert(fixed_biquad_process_pcm(split, 2, &piece) == AUDIO_SUCCESS);
+  }
+  assert(memcmp(a->data, b->data, a->length) == 0);
+
+  int clipped = 0;
+  const int16_t *samples = (const int16_t *)a->data;
+  for (size_t i = 1; i < (size_t)FRAMES * 2; i++) {
+    clipped += samples[i] == INT16_MAX || samples[i] == INT16_MIN;
+    // A wrap shows up as a jump across the whole range
+    assert(abs(samples[i] - samples[i > 1 ? i - 2 : 0]) < 40000);
+  }
+  printf("  Clipped samples: %d\n", clipped);
+  assert(clipped > 0);
+
+  PCMBuffer *pcm8 = pcm_buffer_create(16, 8);
+  assert(fixed_biquad_process_pcm(whole, 2, pcm8) ==
+         AUDIO_ERROR_UNSUPPORTED_FORMAT);
+
+  pcm_buffer_free(a);
+  pcm_buffer_free(b);
+  pcm_buffer_free(pcm8);
+  printf("  ✓ Block-independent and saturating\n\n");
+}
+
+int main() {
+  printf("\n=== Fixed-Point BiQuad Tests ===\n\n");
+
+  test_matches_float();
+  test_bit_exact();
+  test_error_feedback();
+  test_blocks_and_saturation();
+
+  printf("=== All fixed-point tests passed! ===\n\n");
+  return 0;
+}
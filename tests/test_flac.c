@@ -0,0 +1,506 @@
+#include "audio_io.h"
+#include "flac.h"
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define SAMPLE_RATE 44100
+
+// Kinds of test signal
+enum { TONE, NOISE, SILENCE, CLIPPED, MONO_IN_STEREO };
+
+static double signal_value(int kind, size_t frame, int channel,
+                           unsigned int *seed) {
+  *seed = *seed * 1103515245u + 12345u;
+  double noise = ((*seed >> 8) & 0xFFFF) / 32768.0 - 1.0;
+  double tone = sin(2.0 * M_PI * 220.0 * (channel + 1) * frame / SAMPLE_RATE);
+  switch (kind) {
+  case TONE:
+    return 0.5 * tone + 0.0001 * noise;
+  case NOISE:
+    return noise;
+  case SILENCE:
+    return 0.0;
+  case CLIPPED:
+    return 1.5 * tone;
+  default:
+    return 0.5 * sin(2.0 * M_PI * 220.0 * frame / SAMPLE_RATE);
+  }
+}
+
+static AudioBuffer *make_signal(int kind, size_t frames, int channels,
+                                int bits) {
+  AudioBuffer *buffer =
+      audio_buffer_create(frames * channels, SAMPLE_RATE, channels, bits);
+  assert(buffer != NULL);
+  unsigned int seed = 99;
+  for (size_t f = 0; f < frames; f++) {
+    for (int c = 0; c < channels; c++)
+      buffer->data[f * channels + c] = signal_value(kind, f, c, &seed);
+  }
+  return buffer;
+}
+
+static long file_size(const char *path) {
+  struct stat st;
+  assert(stat(path, &st) == 0);
+  return (long)st.st_size;
+}
+
+static void assert_same(const AudioBuffer *a, const AudioBuffer *b) {
+  assert(a->length == b->length && a->channels == b->channels);
+  assert(a->sample_rate == b->sample_rate && a->bit_depth == b->bit_depth);
+  for (size_t i = 0; i < a->length; i++)
+    assert(a->data[i] == b->data[i]);
+}
+
+// Encode as FLAC and WAV; both must decode to the same samples
+static void check_round_trip(int kind, size_t frames, int channels,
+                             int bits) {
+  const char *wav = "tests/test_data/flac_ref.wav";
+  const char *flac = "tests/test_data/flac_out.flac";
+  AudioBuffer *buffer = make_signal(kind, frames, channels, bits);
+  assert(write_wave(wav, buffer) == AUDIO_SUCCESS);
+  assert(write_wave(flac, buffer) == AUDIO_SUCCESS);
+  audio_buffer_free(buffer);
+
+  AudioError error;
+  AudioBuffer *expected = read_wave(wav, &error);
+  AudioBuffer *decoded = read_wave(flac, &error);
+  assert(expected && decoded && error == AUDIO_SUCCESS);
+  assert_same(decoded, expected);
+  audio_buffer_free(expected);
+  audio_buffer_free(decoded);
+}
+
+// Test 1: Encoder output decodes to exactly the WAV samples
+static void test_round_trip(void) {
+  printf("Test 1: Round trip...\n");
+
+  int depths[3] = {8, 16, 24};
+  int layouts[3] = {1, 2, 6};
+  // FLAC_BLOCK_SIZE + 1..4 leave a final block too short for any predictor
+  size_t lengths[6] = {FLAC_BLOCK_SIZE * 3, 10007, FLAC_BLOCK_SIZE + 1,
+                       FLAC_BLOCK_SIZE + 4, 3, 1};
+  for (int d = 0; d < 3; d++) {
+    for (int l = 0; l < 3; l++) {
+      for (int n = 0; n < 6; n++)
+        check_round_trip(TONE, lengths[n], layouts[l], depths[d]);
+    }
+  }
+  printf("  8/16/24-bit, 1/2/6 channels, partial and tiny blocks\n");
+
+  int kinds[4] = {NOISE, SILENCE, CLIPPED, MONO_IN_STEREO};
+  for (int k = 0; k < 4; k++) {
+    check_round_trip(kinds[k], 9000, 2, 16);
+    check_round_trip(kinds[k], 9000, 2, 24);
+  }
+  printf("  ✓ Bit-identical, including noise, silence, clipping\n");
+}
+
+// Test 2: Tonal material compresses well, noise does not grow
+static void test_compression(void) {
+  printf("Test 2: Compression...\n");
+
+  int kinds[2] = {TONE, NOISE};
+  for (int k = 0; k < 2; k++) {
+    AudioBuffer *buffer = make_signal(kinds[k], 5 * SAMPLE_RATE, 2, 16);
+    assert(write_wave("tests/test_data/flac_ref.wav", buffer) ==
+           AUDIO_SUCCESS);
+    assert(write_wave("tests/test_data/flac_out.flac", buffer) ==
+           AUDIO_SUCCESS);
+    audio_buffer_free(buffer);
+
+    double ratio = (double)file_size("tests/test_data/flac_out.flac") /
+                   file_size("tests/test_data/flac_ref.wav");
+    printf("  %s: %.1f%% of WAV\n", kinds[k] == TONE ? "tone" : "noise",
+           ratio * 100.0);
+    assert(ratio < (kinds[k] == TONE ? 0.5 : 1.01));
+  }
+  printf("  ✓ Smaller than WAV, verbatim fallback bounds noise\n");
+}
+
+// Test 3: Block reads, seeks and regions match the whole-file decode
+static void test_streaming(void) {
+  printf("Test 3: Streaming reader...\n");
+
+  const char *path = "tests/test_data/flac_stream.flac";
+  const size_t frames = 50000;
+  const int channels = 2;
+  AudioBuffer *buffer = make_signal(TONE, frames, channels, 24);
+  assert(write_wave(path, buffer) == AUDIO_SUCCESS);
+  audio_buffer_free(buffer);
+  AudioBuffer *whole = read_wave(path, NULL);
+  assert(whole != NULL && whole->length == frames * channels);
+
+  AudioFileInfo info;
+  assert(read_wave_info(path, &info) == AUDIO_SUCCESS);
+  assert(info.audio_format == AUDIO_FORMAT_FLAC);
+  assert(info.frames == frames && info.channels == channels);
+  assert(info.bit_depth == 24 && info.block_align == 6);
+
+  // Odd-sized blocks
+  AudioReader *reader = audio_reader_open(path, NULL);
+  assert(reader != NULL);
+  double *block = malloc(1237 * channels * sizeof(double));
+  size_t position = 0, got;
+  while ((got = audio_reader_read(reader, block, 1237)) > 0) {
+    for (size_t i = 0; i < got * channels; i++)
+      assert(block[i] == whole->data[position * channels + i]);
+    position += got;
+  }
+  assert(position == frames);
+
+  // Backwards, forwards, inside the current block and at the end
+  size_t targets[6] = {0, 30001, 30002, 4095, 49999, 4096};
+  for (int t = 0; t < 6; t++) {
+    assert(audio_reader_seek(reader, targets[t]) == AUDIO_SUCCESS);
+    got = audio_reader_read(reader, block, 10);
+    assert(got == (frames - targets[t] < 10 ? frames - targets[t] : 10));
+    for (size_t i = 0; i < got * channels; i++)
+      assert(block[i] == whole->data[targets[t] * channels + i]);
+  }
+  assert(audio_reader_seek(reader, frames + 100) == AUDIO_SUCCESS);
+  assert(audio_reader_read(reader, block, 10) == 0);
+  audio_reader_close(reader);
+  free(block);
+
+  AudioBuffer *region = read_wave_region(path, 12345, 678, NULL);
+  assert(region != NULL && region->length == 678 * (size_t)channels);
+  for (size_t i = 0; i < region->length; i++)
+    assert(region->data[i] == whole->data[12345 * channels + i]);
+  audio_buffer_free(region);
+  audio_buffer_free(whole);
+  printf("  ✓ Blocks, seeks and regions match\n");
+}
+
+// Hand-assembled stream exercising what the encoder never produces
+typedef struct {
+  uint8_t data[4096];
+  size_t bits;
+} Bits;
+
+static void put(Bits *b, uint32_t value, int n) {
+  for (int i = n - 1; i >= 0; i--) {
+    if ((value >> i) & 1)
+      b->data[b->bits >> 3] |= 0x80 >> (b->bits & 7);
+    b->bits++;
+  }
+}
+
+static void put_rice(Bits *b, int32_t value, int k) {
+  uint32_t u = value < 0 ? ((uint32_t)-value << 1) - 1 : (uint32_t)value << 1;
+  for (uint32_t q = u >> k; q > 0; q--)
+    put(b, 0, 1);
+  put(b, 1, 1);
+  put(b, u, k);
+}
+
+// Bitwise CRCs straight from the format description
+static void put_crc8(Bits *b, size_t start) {
+  uint8_t crc = 0;
+  for (size_t i = start; i < b->bits / 8; i++) {
+    crc ^= b->data[i];
+    for (int bit = 0; bit < 8; bit++)
+      crc = (uint8_t)((crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1);
+  }
+  put(b, crc, 8);
+}
+
+static void put_crc16(Bits *b, size_t start) {
+  b->bits = (b->bits + 7) & ~(size_t)7;
+  uint16_t crc = 0;
+  for (size_t i = start; i < b->bits / 8; i++) {
+    crc ^= (uint16_t)(b->data[i] << 8);
+    for (int bit = 0; bit < 8; bit++)
+      crc = (uint16_t)((crc & 0x8000) ? (crc << 1) ^ 0x8005 : crc << 1);
+  }
+  put(b, crc, 16);
+}
+
+// Variable-blocksize header: 8-bit block size, rate and depth explicit
+static void put_frame_header(Bits *b, uint32_t sample, int block,
+                             int assignment) {
+  size_t start = b->bits / 8;
+  put(b, 0xFFF9, 16);
+  put(b, 6, 4);
+  put(b, 9, 4);  // 44.1 kHz
+  put(b, assignment, 4);
+  put(b, 4, 3);  // 16 bits
+  put(b, 0, 1);
+  put(b, sample, 8);  // < 128: one byte
+  put(b, block - 1, 8);
+  put_crc8(b, start);
+}
+
+#define REF_FRAME0 20
+#define REF_FRAME1 7
+#define REF_FRAMES (REF_FRAME0 + REF_FRAME1)
+
+// Build the reference file and its expected samples (planar, 16-bit)
+static size_t build_reference(uint8_t *file, int32_t expected[2][REF_FRAMES],
+                              int unknown_length) {
+  static Bits frames;
+  memset(&frames, 0, sizeof(frames));
+
+  // Frame 0: mid/side. Mid is LPC order 3 with one wasted bit; side is
+  // fixed order 2 with an escaped partition and a 5-bit Rice partition.
+  int32_t mid[REF_FRAME0], side[REF_FRAME0];
+  for (int i = 0; i < REF_FRAME0; i++) {
+    mid[i] = 2 * (int32_t)lround(6000.0 * sin(0.3 * i));
+    side[i] = (i * 37) % 23 - 11;
+    int32_t m = mid[i] * 2 | (side[i] & 1);
+    expected[0][i] = (m + side[i]) >> 1;
+    expected[1][i] = (m - side[i]) >> 1;
+  }
+  put_frame_header(&frames, 0, REF_FRAME0, 10);
+
+  const int32_t coefs[3] = {1957, -1024, 16};
+  const int precision = 12, shift = 10;
+  put(&frames, (32 + 2) << 1 | 1, 8);  // LPC order 3, wasted bits
+  put(&frames, 1, 1);                         // Unary 0: one wasted bit
+  int32_t x[REF_FRAME0];
+  for (int i = 0; i < REF_FRAME0; i++)
+    x[i] = mid[i] >> 1;
+  for (int i = 0; i < 3; i++)
+    put(&frames, (uint32_t)x[i], 15);
+  put(&frames, precision - 1, 4);
+  put(&frames, shift, 5);
+  for (int j = 0; j < 3; j++)
+    put(&frames, (uint32_t)coefs[j], precision);
+  put(&frames, 0, 2);  // 4-bit parameters
+  put(&frames, 0, 4);  // One partition
+  put(&frames, 6, 4);
+  for (int i = 3; i < REF_FRAME0; i++) {
+    int64_t sum = 0;
+    for (int j = 0; j < 3; j++)
+      sum += (int64_t)coefs[j] * x[i - 1 - j];
+    put_rice(&frames, x[i] - (int32_t)(sum >> shift), 6);
+  }
+
+  put(&frames, (8 + 2) << 1, 8);  // Fixed order 2
+  put(&frames, (uint32_t)side[0], 17);
+  put(&frames, (uint32_t)side[1], 17);
+  put(&frames, 1, 2);   // 5-bit parameters
+  put(&frames, 1, 4);   // Two partitions of 10
+  put(&frames, 31, 5);  // Escape: 8-bit residuals
+  put(&frames, 8, 5);
+  for (int i = 2; i < REF_FRAME0; i++) {
+    if (i == 10)
+      put(&frames, 2, 5);
+    int32_t r = side[i] - 2 * side[i - 1] + side[i - 2];
+    if (i < 10)
+      put(&frames, (uint32_t)r, 8);
+    else
+      put_rice(&frames, r, 2);
+  }
+  put_crc16(&frames, 0);
+  size_t frame1 = frames.bits / 8;
+
+  // Frame 1: independent, verbatim and constant
+  put_frame_header(&frames, REF_FRAME0, REF_FRAME1, 1);
+  put(&frames, 1 << 1, 8);
+  for (int i = 0; i < REF_FRAME1; i++) {
+    expected[0][REF_FRAME0 + i] = (i % 2 ? -1 : 1) * (32767 - i * 1000);
+    put(&frames, (uint32_t)expected[0][REF_FRAME0 + i], 16);
+  }
+  put(&frames, 0, 8);
+  put(&frames, (uint32_t)-5, 16);
+  for (int i = 0; i < REF_FRAME1; i++)
+    expected[1][REF_FRAME0 + i] = -5;
+  put_crc16(&frames, frame1);
+
+  // STREAMINFO, a SEEKTABLE pointing at frame 1 (plus a placeholder), and
+  // a PADDING block
+  static Bits header;
+  memset(&header, 0, sizeof(header));
+  put(&header, 0x664C6143, 32);  // "fLaC"
+  put(&header, 0, 8);
+  put(&header, 34, 24);
+  put(&header, 16, 16);
+  put(&header, REF_FRAME0, 16);
+  put(&header, 0, 24);
+  put(&header, 0, 24);
+  put(&header, SAMPLE_RATE, 20);
+  put(&header, 1, 3);
+  put(&header, 15, 5);
+  put(&header, 0, 4);
+  put(&header, unknown_length ? 0 : REF_FRAMES, 32);
+  for (int i = 0; i < 4; i++)
+    put(&header, 0, 32);  // MD5 unset
+  put(&header, 3, 8);
+  put(&header, 36, 24);
+  put(&header, 0, 32);
+  put(&header, REF_FRAME0, 32);
+  put(&header, 0, 32);
+  put(&header, (uint32_t)frame1, 32);
+  put(&header, REF_FRAME1, 16);
+  put(&header, 0xFFFFFFFF, 32);
+  put(&header, 0xFFFFFFFF, 32);
+  put(&header, 0, 32);
+  put(&header, 0, 32);
+  put(&header, 0, 16);
+  put(&header, 0x81, 8);
+  put(&header, 5, 24);
+  put(&header, 0, 32);
+  put(&header, 0, 8);
+
+  memcpy(file, header.data, header.bits / 8);
+  memcpy(file + header.bits / 8, frames.data, frames.bits / 8);
+  return header.bits / 8 + frames.bits / 8;
+}
+
+static void write_bytes(const char *path, const uint8_t *data, size_t size) {
+  FILE *file = fopen(path, "wb");
+  assert(file != NULL);
+  assert(fwrite(data, 1, size, file) == size);
+  fclose(file);
+}
+
+// Test 4: Decode a hand-assembled stream
+static void test_reference_stream(void) {
+  printf("Test 4: Reference stream...\n");
+
+  const char *path = "tests/test_data/flac_reference.flac";
+  static uint8_t file[8192];
+  int32_t expected[2][REF_FRAMES];
+  size_t size = build_reference(file, expected, 0);
+  write_bytes(path, file, size);
+
+  AudioError error;
+  AudioBuffer *buffer = read_wave(path, &error);
+  assert(buffer != NULL && error == AUDIO_SUCCESS);
+  assert(buffer->length == 2 * REF_FRAMES && buffer->bit_depth == 16);
+  for (int f = 0; f < REF_FRAMES; f++) {
+    for (int c = 0; c < 2; c++)
+      assert(buffer->data[f * 2 + c] == expected[c][f] / 32768.0);
+  }
+  printf("  LPC, wasted bits, escape codes, mid/side, verbatim, constant\n");
+
+  // The seek table takes the reader straight to frame 1
+  AudioReader *reader = audio_reader_open(path, NULL);
+  assert(reader != NULL);
+  double out[4];
+  assert(audio_reader_seek(reader, REF_FRAME0 + 3) == AUDIO_SUCCESS);
+  assert(audio_reader_read(reader, out, 2) == 2);
+  assert(out[0] == expected[0][REF_FRAME0 + 3] / 32768.0);
+  assert(out[3] == expected[1][REF_FRAME0 + 4] / 32768.0);
+  audio_reader_close(reader);
+
+  // Without a length in STREAMINFO the frames are counted
+  size = build_reference(file, expected, 1);
+  write_bytes(path, file, size);
+  AudioFileInfo info;
+  assert(read_wave_info(path, &info) == AUDIO_SUCCESS);
+  assert(info.frames == REF_FRAMES);
+  AudioBuffer *counted = read_wave(path, NULL);
+  assert(counted != NULL);
+  assert_same(counted, buffer);
+  audio_buffer_free(counted);
+  audio_buffer_free(buffer);
+  printf("  ✓ Decoded exactly, seek table used, length counted\n");
+}
+
+// Test 5: Corrupt and truncated input is reported, not decoded
+static void test_corruption(void) {
+  printf("Test 5: Corrupt input...\n");
+
+  const char *path = "tests/test_data/flac_corrupt.flac";
+  AudioBuffer *buffer = make_signal(TONE, 20000, 2, 16);
+  assert(write_wave(path, buffer) == AUDIO_SUCCESS);
+  audio_buffer_free(buffer);
+
+  long size = file_size(path);
+  uint8_t *data = malloc(size);
+  FILE *file = fopen(path, "rb");
+  assert(file && fread(data, 1, size, file) == (size_t)size);
+  fclose(file);
+
+  // One flipped bit in the middle of a frame
+  data[size / 2] ^= 0x10;
+  write_bytes(path, data, size);
+  AudioError error;
+  assert(read_wave(path, &error) == NULL);
+  assert(error == AUDIO_ERROR_INVALID_FORMAT ||
+         error == AUDIO_ERROR_READ_ERROR);
+  AudioReader *reader = audio_reader_open(path, NULL);
+  assert(reader != NULL);
+  double *block = malloc(20000 * 2 * sizeof(double));
+  size_t got = audio_reader_read(reader, block, 20000);
+  assert(got > 0 && got < 20000 && got % FLAC_BLOCK_SIZE == 0);
+  assert(audio_reader_status(reader) == error);
+  assert(audio_reader_read(reader, block, 20000) == 0);
+  audio_reader_close(reader);
+  data[size / 2] ^= 0x10;
+
+  // Cut short
+  write_bytes(path, data, size - 100);
+  assert(read_wave(path, &error) == NULL);
+  reader = audio_reader_open(path, NULL);
+  assert(reader != NULL);
+  got = audio_reader_read(reader, block, 20000);
+  assert(got < 20000 && audio_reader_status(reader) != AUDIO_SUCCESS);
+  audio_reader_close(reader);
+  free(block);
+
+  // Damaged STREAMINFO
+  data[8 + 10] = 0;
+  data[8 + 11] = 0;
+  data[8 + 12] &= 0x0F;
+  write_bytes(path, data, size);
+  assert(read_wave(path, &error) == NULL);
+  assert(error == AUDIO_ERROR_INVALID_FORMAT);
+  free(data);
+
+  // Not encodable
+  assert(audio_writer_open("tests/test_data/flac_bad.flac", SAMPLE_RATE, 2,
+                           32, &error) == NULL);
+  assert(error == AUDIO_ERROR_UNSUPPORTED_FORMAT);
+  AudioFileInfo info;
+  assert(read_wave_pcm("tests/test_data/flac_stream.flac", &info, &error) ==
+         NULL);
+  assert(error == AUDIO_ERROR_UNSUPPORTED_FORMAT);
+  printf("  ✓ CRC mismatch, truncation and bad headers rejected\n");
+}
+
+// Test 6: Decode throughput
+static void test_throughput(void) {
+  printf("Test 6: Throughput...\n");
+
+  const char *path = "tests/test_data/flac_stream.flac";
+  AudioBuffer *buffer = make_signal(TONE, 30 * SAMPLE_RATE, 2, 16);
+  assert(write_wave(path, buffer) == AUDIO_SUCCESS);
+  audio_buffer_free(buffer);
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  buffer = read_wave(path, NULL);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  assert(buffer != NULL);
+  audio_buffer_free(buffer);
+
+  double seconds =
+      (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+  printf("  30 s of 16-bit stereo decoded in %.1f ms (%.0fx realtime)\n",
+         seconds * 1e3, 30.0 / seconds);
+  printf("  ✓ Decoded\n");
+}
+
+int main(void) {
+  printf("=== FLAC Test Suite ===\n\n");
+
+  test_round_trip();
+  test_compression();
+  test_streaming();
+  test_reference_stream();
+  test_corruption();
+  test_throughput();
+
+  printf("\n=== All FLAC tests passed ===\n");
+  return 0;
+}
@@ -251,6 +251,54 @@ void test_hpf_wav_roundtrip() {
   printf("  ✓ WAV roundtrip with HPF working\n\n");
 }
 
+// Test region processing with warm-up against a full render
+void test_hpf_region_warmup() {
+  printf("Test 7: Region Processing with Warm-up\n");
+
+  const char *input_file = "tests/test_data/hpf_region_input.wav";
+
+  int num_samples = (int)(SAMPLE_RATE * 1.0) * 2;
+  AudioBuffer *buffer = audio_buffer_create(num_samples, SAMPLE_RATE, 2, 24);
+  assert(buffer != NULL);
+  generate_mixed_signal(buffer, 30.0, 440.0);
+  assert(write_wave(input_file, buffer) == AUDIO_SUCCESS);
+  audio_buffer_free(buffer);
+
+  // Reference: filter the whole file
+  AudioError error;
+  AudioBuffer *full = read_wave(input_file, &error);
+  assert(full != NULL);
+  HPFFilter hpf;
+  hpf_init(&hpf, SAMPLE_RATE, HPF_FREQ);
+  hpf_process_buffer(&hpf, full);
+
+  // Region: read only warm-up + region frames
+  size_t start = 30000;
+  size_t frames = 4096;
+  size_t warmup = hpf_warmup_frames(SAMPLE_RATE, HPF_FREQ);
+  assert(warmup < start);
+  printf("  Warm-up: %zu frames\n", warmup);
+
+  AudioBuffer *region =
+      read_wave_region(input_file, start - warmup, warmup + frames, &error);
+  assert(region != NULL);
+  hpf_init(&hpf, SAMPLE_RATE, HPF_FREQ);
+  hpf_process_buffer(&hpf, region);
+
+  double max_diff = 0.0;
+  for (size_t i = 0; i < frames * 2; i++) {
+    double diff = fabs(region->data[warmup * 2 + i] - full->data[start * 2 + i]);
+    if (diff > max_diff)
+      max_diff = diff;
+  }
+  printf("  Max difference vs full render: %.3e\n", max_diff);
+  assert(max_diff < 1e-8);
+
+  audio_buffer_free(full);
+  audio_buffer_free(region);
+  printf("  ✓ Region output matches full render\n\n");
+}
+
 int main() {
   printf("\n=== High-Pass Filter Tests ===\n\n");
 
@@ -260,6 +308,7 @@ int main() {
   test_hpf_process_stereo();
   test_hpf_dc_removal();
   test_hpf_wav_roundtrip();
+  test_hpf_region_warmup();
 
   printf("=== All HPF tests passed! ===\n\n");
   return 0;
@@ -0,0 +1,242 @@
+#include "audio_io.h"
+#include "chain.h"
+#include "mix.h"
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define SAMPLE_RATE 48000
+#define CHANNELS 2
+
+// Write a two-channel test file (tone plus deterministic noise)
+static void write_input(const char *path, size_t frames, double freq,
+                        unsigned int seed, int sample_rate) {
+  AudioBuffer *buffer =
+      audio_buffer_create(frames * CHANNELS, sample_rate, CHANNELS, 24);
+  assert(buffer != NULL);
+  for (size_t f = 0; f < frames; f++) {
+    for (int c = 0; c < CHANNELS; c++) {
+      seed = seed * 1103515245u + 12345u;
+      double noise = ((seed >> 8) & 0xFFFF) / 65536.0 - 0.5;
+      buffer->data[f * CHANNELS + c] =
+          0.4 * sin(2.0 * M_PI * freq * f / sample_rate) + 0.1 * noise;
+    }
+  }
+  assert(write_wave(path, buffer) == AUDIO_SUCCESS);
+  audio_buffer_free(buffer);
+}
+
+// Mix the inputs to memory with the given block size
+static double *mix_to_memory(const char **paths, const double *gains_db,
+                             int count, size_t block_frames, int filter_first,
+                             size_t *frames_out) {
+  AudioReader *readers[4];
+  HPFFilter hpf;
+  AudioChain chain;
+  AudioMixer mixer;
+
+  hpf_init(&hpf, SAMPLE_RATE, 120.0);
+  audio_chain_init(&chain);
+  assert(audio_chain_add_hpf(&chain, &hpf) == 0);
+
+  audio_mixer_init(&mixer, block_frames);
+  for (int i = 0; i < count; i++) {
+    readers[i] = audio_reader_open(paths[i], NULL);
+    assert(readers[i] != NULL);
+    AudioChain *input_chain = (filter_first && i == 0) ? &chain : NULL;
+    assert(audio_mixer_add_input(&mixer, readers[i], gains_db[i],
+                                 input_chain) == AUDIO_SUCCESS);
+  }
+
+  size_t capacity = 1 << 16, total = 0;
+  double *out = malloc(capacity * CHANNELS * sizeof(double));
+  const double *block;
+  size_t frames;
+  while ((frames = audio_mixer_process(&mixer, &block)) > 0) {
+    assert(frames <= block_frames);
+    if (total + frames > capacity) {
+      capacity *= 2;
+      out = realloc(out, capacity * CHANNELS * sizeof(double));
+    }
+    memcpy(out + total * CHANNELS, block, frames * CHANNELS * sizeof(double));
+    total += frames;
+  }
+
+  audio_mixer_free(&mixer);
+  for (int i = 0; i < count; i++)
+    audio_reader_close(readers[i]);
+  *frames_out = total;
+  return out;
+}
+
+// Test 1: Mix equals the gained sum of the decoded inputs
+static void test_mix_matches_sum(void) {
+  printf("Test 1: Mix matches the gained sum...\n");
+
+  const char *paths[2] = {"tests/test_data/mix_a.wav",
+                          "tests/test_data/mix_b.wav"};
+  double gains_db[2] = {-6.0, 3.0};
+  write_input(paths[0], 30000, 220.0, 1, SAMPLE_RATE);
+  write_input(paths[1], 30000, 1500.0, 2, SAMPLE_RATE);
+
+  size_t frames;
+  double *mix = mix_to_memory(paths, gains_db, 2, 1024, 1, &frames);
+  assert(frames == 30000);
+
+  AudioBuffer *a = read_wave(paths[0], NULL);
+  AudioBuffer *b = read_wave(paths[1], NULL);
+  HPFFilter hpf;
+  hpf_init(&hpf, SAMPLE_RATE, 120.0);
+  hpf_process_buffer(&hpf, a);
+
+  double ga = pow(10.0, gains_db[0] / 20.0);
+  double gb = pow(10.0, gains_db[1] / 20.0);
+  double max_diff = 0.0;
+  for (size_t i = 0; i < a->length; i++) {
+    double expected = (0.0 + ga * a->data[i]) + gb * b->data[i];
+    max_diff = fmax(max_diff, fabs(mix[i] - expected));
+  }
+  printf("  Max difference vs reference: %.3e\n", max_diff);
+  assert(max_diff < 1e-12);
+
+  audio_buffer_free(a);
+  audio_buffer_free(b);
+  free(mix);
+  printf("  ✓ Filtered and gained inputs match the reference\n");
+}
+
+// Test 2: Inputs of different lengths; the mix runs to the longest
+static void test_mix_lengths(void) {
+  printf("Test 2: Inputs of different lengths...\n");
+
+  const char *paths[2] = {"tests/test_data/mix_short.wav",
+                          "tests/test_data/mix_long.wav"};
+  double gains_db[2] = {0.0, 0.0};
+  write_input(paths[0], 5000, 440.0, 3, SAMPLE_RATE);
+  write_input(paths[1], 12345, 660.0, 4, SAMPLE_RATE);
+
+  size_t frames;
+  double *mix = mix_to_memory(paths, gains_db, 2, 4096, 0, &frames);
+  assert(frames == 12345);
+
+  // Past the short input only the long one is heard
+  AudioBuffer *b = read_wave(paths[1], NULL);
+  for (size_t i = 5000 * CHANNELS; i < b->length; i++) {
+    assert(mix[i] == b->data[i]);
+  }
+
+  audio_buffer_free(b);
+  free(mix);
+  printf("  ✓ Mix is %zu frames, tail is the longer input\n", frames);
+}
+
+// Test 3: Output does not depend on the block size
+static void test_block_independence(void) {
+  printf("Test 3: Block-size independence...\n");
+
+  const char *paths[2] = {"tests/test_data/mix_a.wav",
+                          "tests/test_data/mix_short.wav"};
+  double gains_db[2] = {-3.0, -9.0};
+
+  size_t ref_frames;
+  double *ref = mix_to_memory(paths, gains_db, 2, 30000, 1, &ref_frames);
+
+  size_t sizes[] = {1, 97, 512, 4096};
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    size_t frames;
+    double *mix = mix_to_memory(paths, gains_db, 2, sizes[s], 1, &frames);
+    assert(frames == ref_frames);
+    assert(memcmp(mix, ref, frames * CHANNELS * sizeof(double)) == 0);
+    free(mix);
+    printf("  Block %4zu frames: identical\n", sizes[s]);
+  }
+
+  free(ref);
+  printf("  ✓ Output is identical for every block size\n");
+}
+
+// Test 4: Streaming to a writer, and format mismatches
+static void test_mix_to_file(void) {
+  printf("Test 4: Mixing to a file...\n");
+
+  AudioReader *a = audio_reader_open("tests/test_data/mix_a.wav", NULL);
+  AudioReader *b = audio_reader_open("tests/test_data/mix_long.wav", NULL);
+  assert(a && b);
+
+  AudioMixer mixer;
+  audio_mixer_init(&mixer, 0);
+  assert(audio_mixer_add_input(&mixer, a, -6.0, NULL) == AUDIO_SUCCESS);
+  assert(audio_mixer_add_input(&mixer, b, -6.0, NULL) == AUDIO_SUCCESS);
+
+  // A different sample rate cannot be summed
+  write_input("tests/test_data/mix_44k.wav", 1000, 440.0, 5, 44100);
+  AudioReader *c = audio_reader_open("tests/test_data/mix_44k.wav", NULL);
+  assert(c != NULL);
+  assert(audio_mixer_add_input(&mixer, c, 0.0, NULL) ==
+         AUDIO_ERROR_UNSUPPORTED_FORMAT);
+  audio_reader_close(c);
+
+  AudioWriter *writer = audio_writer_open("tests/test_data/mix_out.wav",
+                                          SAMPLE_RATE, CHANNELS, 24, NULL);
+  assert(writer != NULL);
+  assert(audio_mixer_run(&mixer, writer) == AUDIO_SUCCESS);
+  assert(audio_writer_close(writer) == AUDIO_SUCCESS);
+  audio_mixer_free(&mixer);
+  audio_reader_close(a);
+  audio_reader_close(b);
+
+  AudioFileInfo info;
+  assert(read_wave_info("tests/test_data/mix_out.wav", &info) ==
+         AUDIO_SUCCESS);
+  assert(info.frames == 30000);
+  assert(info.channels == CHANNELS && info.bit_depth == 24);
+  printf("  ✓ Wrote %zu frames, sample-rate mismatch rejected\n",
+         info.frames);
+}
+
+// Test 5: A truncated input stops the mix with an error
+static void test_input_error(void) {
+  printf("Test 5: Truncated input...\n");
+
+  // The data chunk promises 20000 frames, the file holds 5000
+  const char *path = "tests/test_data/mix_cut.wav";
+  write_input(path, 20000, 330.0, 9, SAMPLE_RATE);
+  assert(truncate(path, 44 + 5000 * CHANNELS * 3) == 0);
+
+  AudioReader *a = audio_reader_open(path, NULL);
+  AudioReader *b = audio_reader_open("tests/test_data/mix_long.wav", NULL);
+  assert(a && b);
+  AudioMixer mixer;
+  audio_mixer_init(&mixer, 1024);
+  assert(audio_mixer_add_input(&mixer, a, 0.0, NULL) == AUDIO_SUCCESS);
+  assert(audio_mixer_add_input(&mixer, b, 0.0, NULL) == AUDIO_SUCCESS);
+
+  AudioWriter *writer = audio_writer_open("tests/test_data/mix_out.wav",
+                                          SAMPLE_RATE, CHANNELS, 24, NULL);
+  assert(writer != NULL);
+  assert(audio_mixer_run(&mixer, writer) == AUDIO_ERROR_READ_ERROR);
+  assert(mixer.error == AUDIO_ERROR_READ_ERROR);
+  const double *block;
+  assert(audio_mixer_process(&mixer, &block) == 0);
+  audio_writer_close(writer);
+  audio_mixer_free(&mixer);
+  audio_reader_close(a);
+  audio_reader_close(b);
+  printf("  ✓ Reported as a read error, not mixed as silence\n");
+}
+
+int main(void) {
+  printf("=== Mixer Test Suite ===\n\n");
+
+  test_mix_matches_sum();
+  test_mix_lengths();
+  test_block_independence();
+  test_mix_to_file();
+  test_input_error();
+
+  printf("\n=== All mixer tests passed ===\n");
+  return 0;
+}
@@ -0,0 +1,492 @@
+#include "audio_io.h"
+#include "biquad.h"
+#include "mlir_dsp.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define EPSILON 1e-9
+#define PASS "\033[32m✓\033[0m"
+#define FAIL "\033[31m✗\033[0m"
+#define SAMPLE_RATE 48000.0
+#define NUM_SAMPLES 4096
+#define NUM_FRAMES 4096
+
+// Test result tracking
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void check(const char *test_name, int ok) {
+  printf("  %s %s\n", ok ? PASS : FAIL, test_name);
+  if (ok)
+    tests_passed++;
+  else
+    tests_failed++;
+}
+
+// RBJ low-pass section
+static void make_lowpass(BiQuad *bq, double freq, double q) {
+  double w0 = 2.0 * M_PI * freq / SAMPLE_RATE;
+  double alpha = sin(w0) / (2.0 * q);
+  double norm = 1.0 + alpha;
+  biquad_init(bq);
+  bq->a0 = (1.0 - cos(w0)) / 2.0 / norm;
+  bq->a1 = (1.0 - cos(w0)) / norm;
+  bq->a2 = bq->a0;
+  bq->b1 = -2.0 * cos(w0) / norm;
+  bq->b2 = (1.0 - alpha) / norm;
+  bq->c0 = 1.0;
+  bq->d0 = 0.0;
+}
+
+static void fill_input(double *input, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    double t = i / SAMPLE_RATE;
+    input[i] = 0.5 * sin(2.0 * M_PI * 440.0 * t) +
+               0.3 * sin(2.0 * M_PI * 9000.0 * t);
+  }
+}
+
+// Apply stages one by one with the scalar C implementation
+static void process_reference(const DspStageSpec *stages, int num_stages,
+                              const double *input, double *output,
+                              size_t length) {
+  BiQuad state[8];
+  for (int s = 0; s < num_stages; s++) {
+    state[s] = stages[s].biquad;
+  }
+
+  for (size_t i = 0; i < length; i++) {
+    double x = input[i];
+    for (int s = 0; s < num_stages; s++) {
+      if (stages[s].type == DSP_STAGE_GAIN)
+        x *= stages[s].gain;
+      else
+        x = biquad_process(&state[s], x) * state[s].c0 + x * state[s].d0;
+    }
+    output[i] = x;
+  }
+}
+
+static double max_difference(const double *a, const double *b, size_t n) {
+  double max_diff = 0.0;
+  for (size_t i = 0; i < n; i++) {
+    double diff = fabs(a[i] - b[i]);
+    if (diff > max_diff)
+      max_diff = diff;
+  }
+  return max_diff;
+}
+
+// Test that gains fold away and biquads fuse into one cascade
+void test_chain_fusion(void) {
+  printf("\nTest 1: Gain Folding and Section Fusion\n");
+
+  DspStageSpec stages[5];
+  memset(stages, 0, sizeof(stages));
+  stages[0].type = DSP_STAGE_BIQUAD;
+  make_lowpass(&stages[0].biquad, 2000.0, 0.707);
+  stages[1].type = DSP_STAGE_GAIN;
+  stages[1].gain = 0.5;
+  stages[2].type = DSP_STAGE_BIQUAD;
+  make_lowpass(&stages[2].biquad, 5000.0, 1.2);
+  stages[3].type = DSP_STAGE_GAIN;
+  stages[3].gain = 2.0;
+  stages[4].type = DSP_STAGE_GAIN;
+  stages[4].gain = 1.0;
+
+  MLIRDspChain *chain = mlir_dsp_chain_create(stages, 5);
+  if (!chain) {
+    check("Chain compiled", 0);
+    return;
+  }
+  check("Chain compiled", 1);
+  check("Five stages fused into two sections",
+        mlir_dsp_chain_num_sections(chain) == 2);
+
+  double *input = malloc(NUM_SAMPLES * sizeof(double));
+  double *expected = malloc(NUM_SAMPLES * sizeof(double));
+  double *actual = malloc(NUM_SAMPLES * sizeof(double));
+  fill_input(input, NUM_SAMPLES);
+  process_reference(stages, 5, input, expected, NUM_SAMPLES);
+
+  // Two calls: state must carry across blocks
+  mlir_dsp_chain_process(chain, input, actual, NUM_SAMPLES / 2);
+  mlir_dsp_chain_process(chain, input + NUM_SAMPLES / 2,
+                         actual + NUM_SAMPLES / 2, NUM_SAMPLES / 2);
+  double diff = max_difference(expected, actual, NUM_SAMPLES);
+  printf("    max diff vs. C reference: %.3e\n", diff);
+  check("Fused chain matches stage-by-stage C", diff < EPSILON);
+
+  // Reset restarts from silence
+  mlir_dsp_chain_reset(chain);
+  mlir_dsp_chain_process(chain, input, actual, NUM_SAMPLES);
+  check("Reset clears section state",
+        max_difference(expected, actual, NUM_SAMPLES) < EPSILON);
+
+  free(input);
+  free(expected);
+  free(actual);
+  mlir_dsp_chain_destroy(chain);
+}
+
+// Test wet/dry mix and in-place processing
+void test_chain_wet_dry(void) {
+  printf("\nTest 2: Wet/Dry Mix In Place\n");
+
+  DspStageSpec stage;
+  memset(&stage, 0, sizeof(stage));
+  stage.type = DSP_STAGE_BIQUAD;
+  make_lowpass(&stage.biquad, 1000.0, 0.707);
+  stage.biquad.c0 = 0.7;
+  stage.biquad.d0 = 0.3;
+
+  MLIRDspChain *chain = mlir_dsp_chain_create(&stage, 1);
+  if (!chain) {
+    check("Chain compiled", 0);
+    return;
+  }
+
+  double *data = malloc(NUM_SAMPLES * sizeof(double));
+  double *expected = malloc(NUM_SAMPLES * sizeof(double));
+  fill_input(data, NUM_SAMPLES);
+  process_reference(&stage, 1, data, expected, NUM_SAMPLES);
+
+  mlir_dsp_chain_process(chain, data, data, NUM_SAMPLES);
+  check("Wet/dry chain matches C in place",
+        max_difference(expected, data, NUM_SAMPLES) < EPSILON);
+
+  free(data);
+  free(expected);
+  mlir_dsp_chain_destroy(chain);
+}
+
+// Two-stage stereo pipeline spec used by the pipeline tests
+static void make_pipeline_stages(DspStageSpec *stages) {
+  memset(stages, 0, 3 * sizeof(DspStageSpec));
+  stages[0].type = DSP_STAGE_BIQUAD;
+  make_lowpass(&stages[0].biquad, 3000.0, 0.707);
+  stages[1].type = DSP_STAGE_BIQUAD;
+  make_lowpass(&stages[1].biquad, 6000.0, 0.9);
+  stages[2].type = DSP_STAGE_GAIN;
+  stages[2].gain = 0.8;
+}
+
+// Decode, filter per channel and encode with the C building blocks
+static void pipeline_reference(const DspStageSpec *stages, int num_stages,
+                               PCMBuffer *in, PCMBuffer *out, int channels,
+                               AudioMeter *meter) {
+  size_t samples = NUM_FRAMES * channels;
+  double *data = malloc(samples * sizeof(double));
+  pcm_to_float64(in, data, samples);
+
+  audio_meter_reset(meter);
+  for (int c = 0; c < channels; c++) {
+    double channel[NUM_FRAMES];
+    for (size_t f = 0; f < NUM_FRAMES; f++)
+      channel[f] = data[f * channels + c];
+    process_reference(stages, num_stages, channel, channel, NUM_FRAMES);
+    for (size_t f = 0; f < NUM_FRAMES; f++) {
+      double x = channel[f];
+      data[f * channels + c] = x;
+      meter->peak[c] = fmax(meter->peak[c], fabs(x));
+      meter->sum_squares[c] += x * x;
+    }
+  }
+  meter->frames = NUM_FRAMES;
+
+  float64_to_pcm(data, out, samples);
+  free(data);
+}
+
+// Fill a PCM buffer from the float test signal (per channel phase offset)
+static PCMBuffer *make_pcm_input(int channels, int bits) {
+  size_t samples = NUM_FRAMES * channels;
+  double *data = malloc(samples * sizeof(double));
+  for (size_t f = 0; f < NUM_FRAMES; f++) {
+    double t = f / SAMPLE_RATE;
+    for (int c = 0; c < channels; c++) {
+      data[f * channels + c] = 0.5 * sin(2.0 * M_PI * 440.0 * t + c) +
+                               0.3 * sin(2.0 * M_PI * 9000.0 * t);
+    }
+  }
+  PCMBuffer *pcm = pcm_buffer_create(samples * (bits / 8), bits);
+  float64_to_pcm(data, pcm, samples);
+  free(data);
+  return pcm;
+}
+
+// Largest difference between two PCM buffers, in LSBs
+static int max_pcm_difference(PCMBuffer *a, PCMBuffer *b, size_t samples) {
+  double *da = malloc(samples * sizeof(double));
+  double *db = malloc(samples * sizeof(double));
+  pcm_to_float64(a, da, samples);
+  pcm_to_float64(b, db, samples);
+  double lsb = 1.0 / (double)(1 << (a->bit_depth - 1));
+  int max_lsb = (int)lround(max_difference(da, db, samples) / lsb);
+  free(da);
+  free(db);
+  return max_lsb;
+}
+
+// Test the fused decode/filter/meter/encode pipeline against the C path
+void test_pipeline_matches_reference(void) {
+  printf("\nTest 3: Whole-Pipeline Kernel (16-bit stereo)\n");
+
+  DspStageSpec stages[3];
+  make_pipeline_stages(stages);
+  DspPipelineSpec spec = {stages, 3, 2, 16, 16, 0};
+
+  MLIRDspPipeline *pipeline = mlir_dsp_pipeline_create(&spec);
+  if (!pipeline) {
+    check("Pipeline compiled", 0);
+    return;
+  }
+  check("Pipeline compiled", 1);
+
+  PCMBuffer *in = make_pcm_input(2, 16);
+  PCMBuffer *expected = pcm_buffer_create(in->length, 16);
+  PCMBuffer *actual = pcm_buffer_create(in->length, 16);
+  AudioMeter ref_meter, meter;
+  pipeline_reference(stages, 3, in, expected, 2, &ref_meter);
+
+  // Two blocks: filter state and meters carry over
+  mlir_dsp_pipeline_process(pipeline, in->data, actual->data, NUM_FRAMES / 2);
+  mlir_dsp_pipeline_process(pipeline, in->data + in->length / 2,
+                            actual->data + in->length / 2, NUM_FRAMES / 2);
+
+  // TDF2 rounding may move a truncation boundary by one LSB
+  check("PCM output within 1 LSB of C",
+        max_pcm_difference(expected, actual, NUM_FRAMES * 2) <= 1);
+
+  mlir_dsp_pipeline_get_meter(pipeline, &meter);
+  int meter_ok = meter.frames == NUM_FRAMES;
+  for (int c = 0; c < 2; c++) {
+    meter_ok &= fabs(meter.peak[c] - ref_meter.peak[c]) < EPSILON;
+    meter_ok &= fabs(audio_meter_rms(&meter, c) -
+                     audio_meter_rms(&ref_meter, c)) < EPSILON;
+  }
+  check("Meters match C", meter_ok);
+
+  pcm_buffer_free(in);
+  pcm_buffer_free(expected);
+  pcm_buffer_free(actual);
+  mlir_dsp_pipeline_destroy(pipeline);
+}
+
+// Test 24-bit decode with dithered 16-bit output
+void test_pipeline_dither(void) {
+  printf("\nTest 4: 24-bit In, Dithered 16-bit Out\n");
+
+  DspStageSpec stages[3];
+  make_pipeline_stages(stages);
+  DspPipelineSpec plain_spec = {stages, 3, 1, 24, 16, 0};
+  DspPipelineSpec dither_spec = {stages, 3, 1, 24, 16, 1};
+
+  MLIRDspPipeline *plain = mlir_dsp_pipeline_create(&plain_spec);
+  MLIRDspPipeline *dithered = mlir_dsp_pipeline_create(&dither_spec);
+  if (!plain || !dithered) {
+    check("Pipelines compiled", 0);
+    mlir_dsp_pipeline_destroy(plain);
+    mlir_dsp_pipeline_destroy(dithered);
+    return;
+  }
+
+  PCMBuffer *in = make_pcm_input(1, 24);
+  PCMBuffer *expected = pcm_buffer_create(NUM_FRAMES * 2, 16);
+  PCMBuffer *plain_out = pcm_buffer_create(NUM_FRAMES * 2, 16);
+  PCMBuffer *dither_out = pcm_buffer_create(NUM_FRAMES * 2, 16);
+  AudioMeter ref_meter;
+  pipeline_reference(stages, 3, in, expected, 1, &ref_meter);
+
+  mlir_dsp_pipeline_process(plain, in->data, plain_out->data, NUM_FRAMES);
+  mlir_dsp_pipeline_process(dithered, in->data, dither_out->data, NUM_FRAMES);
+
+  check("Undithered 24-bit decode within 1 LSB of C",
+        max_pcm_difference(expected, plain_out, NUM_FRAMES) <= 1);
+  check("Dither stays within 2 LSB",
+        max_pcm_difference(expected, dither_out, NUM_FRAMES) <= 2);
+  check("Dither changes the output",
+        memcmp(plain_out->data, dither_out->data, plain_out->length) != 0);
+
+  pcm_buffer_free(in);
+  pcm_buffer_free(expected);
+  pcm_buffer_free(plain_out);
+  pcm_buffer_free(dither_out);
+  mlir_dsp_pipeline_destroy(plain);
+  mlir_dsp_pipeline_destroy(dithered);
+}
+
+// Test that identical specs share one compiled plan
+void test_plan_cache(void) {
+  printf("\nTest 5: Plan Cache\n");
+
+  DspStageSpec stages[3];
+  make_pipeline_stages(stages);
+  DspPipelineSpec spec = {stages, 3, 2, 16, 16, 0};
+
+  int before = mlir_dsp_plan_cache_size();
+  MLIRDspPipeline *a = mlir_dsp_pipeline_create(&spec);
+  MLIRDspPipeline *b = mlir_dsp_pipeline_create(&spec);
+  if (!a || !b) {
+    check("Pipelines compiled", 0);
+    mlir_dsp_pipeline_destroy(a);
+    mlir_dsp_pipeline_destroy(b);
+    return;
+  }
+  check("Same spec, same plan hash",
+        mlir_dsp_pipeline_plan_hash(a) == mlir_dsp_pipeline_plan_hash(b));
+  check("Second pipeline reused the cached plan",
+        mlir_dsp_plan_cache_size() == before + 1);
+
+  stages[2].gain = 0.5;
+  MLIRDspPipeline *c = mlir_dsp_pipeline_create(&spec);
+  check("Different coefficients, different plan",
+        c && mlir_dsp_pipeline_plan_hash(c) != mlir_dsp_pipeline_plan_hash(a));
+
+  mlir_dsp_pipeline_destroy(a);
+  mlir_dsp_pipeline_destroy(b);
+  mlir_dsp_pipeline_destroy(c);
+  check("Plans freed with their last pipeline",
+        mlir_dsp_plan_cache_size() == before);
+}
+
+// Test many variants compiled into one engine and looked up by name
+void test_kernel_library(void) {
+  printf("\nTest 6: Kernel Library (one engine, many variants)\n");
+
+  static const double freqs[4] = {1000.0, 2500.0, 5000.0, 8000.0};
+  static const int channel_counts[3] = {1, 2, 4};
+  static const int formats[2] = {16, 24};
+  DspStageSpec chain_stages[4][2];
+  DspStageSpec stages[3];
+  make_pipeline_stages(stages);
+
+  DspKernelSpec kernels[10];
+  char names[10][32];
+  int n = 0;
+  memset(kernels, 0, sizeof(kernels));
+  for (int v = 0; v < 4; v++, n++) {
+    memset(chain_stages[v], 0, sizeof(chain_stages[v]));
+    chain_stages[v][0].type = DSP_STAGE_BIQUAD;
+    make_lowpass(&chain_stages[v][0].biquad, freqs[v], 0.707);
+    chain_stages[v][1].type = DSP_STAGE_GAIN;
+    chain_stages[v][1].gain = 0.5 + v;
+    snprintf(names[n], sizeof(names[n]), "lowpass_%d", (int)freqs[v]);
+    kernels[n].name = names[n];
+    kernels[n].kind = DSP_KERNEL_CHAIN;
+    kernels[n].spec.stages = chain_stages[v];
+    kernels[n].spec.num_stages = 2;
+  }
+  for (int c = 0; c < 3; c++) {
+    for (int f = 0; f < 2; f++, n++) {
+      snprintf(names[n], sizeof(names[n]), "pcm%d_%dch", formats[f],
+               channel_counts[c]);
+      kernels[n].name = names[n];
+      kernels[n].kind = DSP_KERNEL_PIPELINE;
+      DspPipelineSpec spec = {stages, 3, channel_counts[c], formats[f], 16, 0};
+      kernels[n].spec = spec;
+    }
+  }
+
+  int cached_before = mlir_dsp_plan_cache_size();
+  MLIRDspLibrary *library = mlir_dsp_library_create(kernels, n);
+  if (!library) {
+    check("Library compiled", 0);
+    return;
+  }
+  check("Ten variants compiled in one library",
+        mlir_dsp_library_size(library) == 10);
+  check("Pipeline variants entered the plan cache",
+        mlir_dsp_plan_cache_size() == cached_before + 6);
+
+  // Every chain variant matches the C reference
+  double *input = malloc(NUM_SAMPLES * sizeof(double));
+  double *expected = malloc(NUM_SAMPLES * sizeof(double));
+  double *actual = malloc(NUM_SAMPLES * sizeof(double));
+  fill_input(input, NUM_SAMPLES);
+  int chains_ok = 1;
+  for (int v = 0; v < 4; v++) {
+    MLIRDspChain *chain = mlir_dsp_library_chain(library, names[v]);
+    if (!chain) {
+      chains_ok = 0;
+      continue;
+    }
+    process_reference(chain_stages[v], 2, input, expected, NUM_SAMPLES);
+    mlir_dsp_chain_process(chain, input, actual, NUM_SAMPLES);
+    chains_ok &= max_difference(expected, actual, NUM_SAMPLES) < EPSILON;
+    mlir_dsp_chain_destroy(chain);
+  }
+  check("Chain variants match C", chains_ok);
+
+  // The stereo 16-bit variant is the plan mlir_dsp_pipeline_create uses
+  DspPipelineSpec stereo = {stages, 3, 2, 16, 16, 0};
+  MLIRDspPipeline *from_library =
+      mlir_dsp_library_pipeline(library, "pcm16_2ch");
+  MLIRDspPipeline *from_cache = mlir_dsp_pipeline_create(&stereo);
+  check("Pipeline looked up by name", from_library != NULL);
+  check("Standalone create reused the library plan",
+        from_library && from_cache &&
+            mlir_dsp_pipeline_plan_hash(from_library) ==
+                mlir_dsp_pipeline_plan_hash(from_cache) &&
+            mlir_dsp_plan_cache_size() == cached_before + 6);
+
+  check("Unknown name is rejected",
+        mlir_dsp_library_pipeline(library, "pcm32_8ch") == NULL);
+  check("Kind mismatch is rejected",
+        mlir_dsp_library_chain(library, "pcm16_2ch") == NULL);
+
+  // Instances keep the shared code alive after the handle is released
+  mlir_dsp_library_destroy(library);
+  if (from_library) {
+    PCMBuffer *in = make_pcm_input(2, 16);
+    PCMBuffer *expected_pcm = pcm_buffer_create(in->length, 16);
+    PCMBuffer *actual_pcm = pcm_buffer_create(in->length, 16);
+    AudioMeter meter;
+    pipeline_reference(stages, 3, in, expected_pcm, 2, &meter);
+    mlir_dsp_pipeline_process(from_library, in->data, actual_pcm->data,
+                              NUM_FRAMES);
+    check("Pipeline runs after the library is destroyed",
+          max_pcm_difference(expected_pcm, actual_pcm, NUM_FRAMES * 2) <= 1);
+    pcm_buffer_free(in);
+    pcm_buffer_free(expected_pcm);
+    pcm_buffer_free(actual_pcm);
+  }
+  mlir_dsp_pipeline_destroy(from_library);
+  mlir_dsp_pipeline_destroy(from_cache);
+  check("Library plans freed with their last user",
+        mlir_dsp_plan_cache_size() == cached_before);
+
+  // Duplicate names fail the whole library
+  kernels[1].name = kernels[0].name;
+  check("Duplicate names are rejected",
+        mlir_dsp_library_create(kernels, n) == NULL);
+
+  free(input);
+  free(expected);
+  free(actual);
+}
+
+int main(void) {
+  printf("\n=== MLIR dsp Dialect Tests ===\n");
+
+  test_chain_fusion();
+  test_chain_wet_dry();
+  test_pipeline_matches_reference();
+  test_pipeline_dither();
+  test_plan_cache();
+  test_kernel_library();
+
+  printf("\n=== Test Summary ===\n");
+  printf("Passed: %d\n", tests_passed);
+  printf("Failed: %d\n", tests_failed);
+
+  if (tests_failed == 0) {
+    printf("\n%s All MLIR dsp tests passed!\n\n", PASS);
+    return 0;
+  } else {
+    printf("\n%s Some tests failed.\n\n", FAIL);
+    return 1;
+  }
+}
@@ -0,0 +1,122 @@
+#include "biquad.h"
+#include "mlir_biquad.h"
+#include "mlir_dsp.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_THREADS 32
+#define ROUNDS 4
+#define NUM_SAMPLES 2048
+#define EPSILON 1e-10
+#define PASS "\033[32m✓\033[0m"
+#define FAIL "\033[31m✗\033[0m"
+
+typedef struct {
+  int id;
+  int failures;
+} WorkerArgs;
+
+// Per-thread coefficients, so every kernel is distinct
+static void make_filter(BiQuad *bq, int id, int round) {
+  double w0 = 2.0 * M_PI * (200.0 + 150.0 * id + 37.0 * round) / 48000.0;
+  double alpha = sin(w0) / (2.0 * 0.707);
+  double norm = 1.0 + alpha;
+  biquad_init(bq);
+  bq->a0 = (1.0 - cos(w0)) / 2.0 / norm;
+  bq->a1 = (1.0 - cos(w0)) / norm;
+  bq->a2 = bq->a0;
+  bq->b1 = -2.0 * cos(w0) / norm;
+  bq->b2 = (1.0 - alpha) / norm;
+  bq->c0 = 1.0;
+  bq->d0 = 0.0;
+}
+
+// Create, use and destroy kernels, checking each against the C filter
+static void *worker(void *arg) {
+  WorkerArgs *args = (WorkerArgs *)arg;
+  double *input = malloc(NUM_SAMPLES * sizeof(double));
+  double *expected = malloc(NUM_SAMPLES * sizeof(double));
+  double *actual = malloc(NUM_SAMPLES * sizeof(double));
+
+  for (size_t i = 0; i < NUM_SAMPLES; i++) {
+    input[i] = sin(0.01 * (i + 1) * (args->id + 1));
+  }
+
+  for (int round = 0; round < ROUNDS; round++) {
+    BiQuad ref, bq;
+    make_filter(&ref, args->id, round);
+    bq = ref;
+    for (size_t i = 0; i < NUM_SAMPLES; i++) {
+      expected[i] = biquad_process(&ref, input[i]);
+    }
+
+    MLIRBiQuadJIT *jit = mlir_biquad_jit_create(&bq);
+    if (!jit) {
+      args->failures++;
+      continue;
+    }
+    mlir_biquad_process_buffer(jit, &bq, input, actual, NUM_SAMPLES);
+    for (size_t i = 0; i < NUM_SAMPLES; i++) {
+      if (fabs(expected[i] - actual[i]) > EPSILON) {
+        args->failures++;
+        break;
+      }
+    }
+    mlir_biquad_jit_destroy(jit);
+
+    // Odd threads also race on one shared pipeline plan
+    if (args->id % 2) {
+      DspStageSpec stage;
+      memset(&stage, 0, sizeof(stage));
+      stage.type = DSP_STAGE_BIQUAD;
+      make_filter(&stage.biquad, 0, 0);
+      DspPipelineSpec spec = {&stage, 1, 2, 16, 16, 0};
+      MLIRDspPipeline *pipeline = mlir_dsp_pipeline_create(&spec);
+      if (!pipeline)
+        args->failures++;
+      mlir_dsp_pipeline_destroy(pipeline);
+    }
+  }
+
+  free(input);
+  free(expected);
+  free(actual);
+  return NULL;
+}
+
+int main(void) {
+  printf("\n=== MLIR JIT Thread-Safety Tests ===\n");
+  printf("\nTest 1: Concurrent Kernel Creation (%d threads x %d rounds)\n",
+         NUM_THREADS, ROUNDS);
+
+  pthread_t threads[NUM_THREADS];
+  WorkerArgs args[NUM_THREADS];
+  for (int t = 0; t < NUM_THREADS; t++) {
+    args[t].id = t;
+    args[t].failures = 0;
+    if (pthread_create(&threads[t], NULL, worker, &args[t]) != 0) {
+      printf("  %s Failed to start thread %d\n", FAIL, t);
+      return 1;
+    }
+  }
+
+  int failures = 0;
+  for (int t = 0; t < NUM_THREADS; t++) {
+    pthread_join(threads[t], NULL);
+    failures += args[t].failures;
+  }
+
+  if (failures == 0 && mlir_dsp_plan_cache_size() == 0) {
+    printf("  %s All kernels compiled and matched the C filter\n", PASS);
+    printf("\n%s All MLIR JIT thread-safety tests passed!\n\n", PASS);
+    return 0;
+  }
+
+  printf("  %s %d failures (live plans: %d)\n", FAIL, failures,
+         mlir_dsp_plan_cache_size());
+  printf("\n%s Some tests failed.\n\n", FAIL);
+  return 1;
+}
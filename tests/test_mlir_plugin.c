@@ -0,0 +1,116 @@
+#include "audio_io.h"
+#include "hpf.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define EPSILON 1e-9
+#define PASS "\033[32m✓\033[0m"
+#define FAIL "\033[31m✗\033[0m"
+#define SAMPLE_RATE 48000.0
+#define NUM_SAMPLES 4096
+
+// Test result tracking
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void check(const char *test_name, int ok) {
+  printf("  %s %s\n", ok ? PASS : FAIL, test_name);
+  if (ok)
+    tests_passed++;
+  else
+    tests_failed++;
+}
+
+// True if the backend plugin is mapped into this process
+static int plugin_mapped(void) {
+  FILE *maps = fopen("/proc/self/maps", "r");
+  if (!maps)
+    return 0;
+
+  char line[4096];
+  int found = 0;
+  while (!found && fgets(line, sizeof(line), maps)) {
+    found = strstr(line, "libaudio_mlir_plugin") != NULL;
+  }
+  fclose(maps);
+  return found;
+}
+
+// Run the HPF through the mlir_biquad API and compare with the C BiQuad
+static double jit_vs_c_difference(void) {
+  HPFFilter hpf;
+  hpf_init(&hpf, SAMPLE_RATE, 200.0);
+  BiQuad reference = hpf.left;
+
+  double *data = malloc(NUM_SAMPLES * sizeof(double));
+  double max_diff = 0.0;
+  for (size_t i = 0; i < NUM_SAMPLES; i++) {
+    data[i] = 0.5 * sin(2.0 * M_PI * 50.0 * i / SAMPLE_RATE) +
+              0.3 * sin(2.0 * M_PI * 3000.0 * i / SAMPLE_RATE);
+  }
+  mlir_biquad_process_strided(hpf.left_jit, &hpf.left, data, NUM_SAMPLES, 1);
+  for (size_t i = 0; i < NUM_SAMPLES; i++) {
+    double x = 0.5 * sin(2.0 * M_PI * 50.0 * i / SAMPLE_RATE) +
+               0.3 * sin(2.0 * M_PI * 3000.0 * i / SAMPLE_RATE);
+    double diff = fabs(data[i] - biquad_process(&reference, x));
+    if (diff > max_diff)
+      max_diff = diff;
+  }
+
+  free(data);
+  mlir_biquad_jit_destroy(hpf.left_jit);
+  mlir_biquad_jit_destroy(hpf.right_jit);
+  return max_diff;
+}
+
+// Test the C fallback when the plugin cannot be loaded
+void test_missing_plugin(void) {
+  printf("\nTest 1: Missing Plugin Falls Back to C\n");
+
+  // The plugin is loaded once per process, so try in a child forked before
+  // this process loads it
+  pid_t pid = fork();
+  if (pid == 0) {
+    setenv("AUDIO_MLIR_PLUGIN", "/nonexistent/libaudio_mlir_plugin.so", 1);
+    int ok = jit_vs_c_difference() == 0.0 && !plugin_mapped();
+    _exit(ok ? 0 : 1);
+  }
+
+  int status = 0;
+  waitpid(pid, &status, 0);
+  check("Output identical to C without the plugin",
+        WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+// Test that the plugin is only loaded on first JIT use
+void test_lazy_load(void) {
+  printf("\nTest 2: Plugin Loaded on First JIT Use\n");
+
+  check("Plugin not mapped at startup", !plugin_mapped());
+
+  HPFFilter hpf;
+  hpf_init(&hpf, SAMPLE_RATE, 200.0);
+  check("Creating JIT handles does not load it", !plugin_mapped());
+  mlir_biquad_jit_destroy(hpf.left_jit);
+  mlir_biquad_jit_destroy(hpf.right_jit);
+
+  double diff = jit_vs_c_difference();
+  printf("    max diff vs. C reference: %.3e\n", diff);
+  check("Plugin mapped after processing", plugin_mapped());
+  check("Plugin output matches C", diff < EPSILON);
+}
+
+int main(void) {
+  printf("\n=== MLIR Backend Plugin Tests ===\n");
+
+  test_missing_plugin();
+  test_lazy_load();
+
+  printf("\n=== Results: %d passed, %d failed ===\n\n", tests_passed,
+         tests_failed);
+  return tests_failed > 0 ? 1 : 0;
+}
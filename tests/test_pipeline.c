@@ -0,0 +1,269 @@
+#include "audio_io.h"
+#include "audio_view.h"
+#include "chain.h"
+#include "pipeline.h"
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SAMPLE_RATE 48000
+#define CHANNELS 4
+#define FRAMES 20011
+
+// Write a four-channel test file (a different tone per channel plus noise)
+static void write_input(const char *path) {
+  AudioBuffer *buffer =
+      audio_buffer_create(FRAMES * CHANNELS, SAMPLE_RATE, CHANNELS, 24);
+  assert(buffer != NULL);
+  unsigned int seed = 7;
+  for (size_t f = 0; f < FRAMES; f++) {
+    for (int c = 0; c < CHANNELS; c++) {
+      seed = seed * 1103515245u + 12345u;
+      double noise = ((seed >> 8) & 0xFFFF) / 65536.0 - 0.5;
+      buffer->data[f * CHANNELS + c] =
+          0.4 * sin(2.0 * M_PI * 60.0 * (c + 1) * f / SAMPLE_RATE) +
+          0.1 * noise;
+    }
+  }
+  assert(write_wave(path, buffer) == AUDIO_SUCCESS);
+  audio_buffer_free(buffer);
+}
+
+// Filters of the two test groups: HPF on channels 0-1, LPF on channel 2
+typedef struct {
+  HPFFilter hpf;
+  LPFFilter lpf;
+  AudioChain hpf_chain;
+  AudioChain lpf_chain;
+  AudioPipelineGroup groups[2];
+} TestGroups;
+
+static void groups_init(TestGroups *tg) {
+  hpf_init(&tg->hpf, SAMPLE_RATE, 150.0);
+  lpf_init(&tg->lpf, SAMPLE_RATE, 2000.0);
+  audio_chain_init(&tg->hpf_chain);
+  audio_chain_init(&tg->lpf_chain);
+  assert(audio_chain_add_hpf(&tg->hpf_chain, &tg->hpf) == 0);
+  assert(audio_chain_add_lpf(&tg->lpf_chain, &tg->lpf) == 0);
+  tg->groups[0] = (AudioPipelineGroup){0, 2, &tg->hpf_chain};
+  tg->groups[1] = (AudioPipelineGroup){2, 1, &tg->lpf_chain};
+}
+
+// Stream a file through the pipeline into another file
+static AudioError run_pipeline(const char *input, const char *output,
+                               const AudioPipelineGroup *groups,
+                               int num_groups, size_t block_frames,
+                               size_t ring_blocks, AudioPipelineStats *stats) {
+  AudioReader *reader = audio_reader_open(input, NULL);
+  assert(reader != NULL);
+  const AudioFileInfo *info = audio_reader_info(reader);
+  AudioWriter *writer = audio_writer_open(output, info->sample_rate,
+                                          info->channels, info->bit_depth,
+                                          NULL);
+  assert(writer != NULL);
+
+  AudioError error = audio_pipeline_run(reader, writer, groups, num_groups,
+                                        block_frames, ring_blocks, stats);
+  AudioError close_error = audio_writer_close(writer);
+  audio_reader_close(reader);
+  return error != AUDIO_SUCCESS ? error : close_error;
+}
+
+// Single-threaded reference: the same chains over views of the whole file
+static AudioBuffer *reference_output(const char *input, const char *output) {
+  AudioBuffer *buffer = read_wave(input, NULL);
+  assert(buffer != NULL);
+  TestGroups tg;
+  groups_init(&tg);
+
+  AudioBufferView whole, view;
+  audio_view_wrap(&whole, buffer->data, FRAMES, CHANNELS, SAMPLE_RATE);
+  for (int g = 0; g < 2; g++) {
+    assert(audio_view_select_channels(&whole, tg.groups[g].first_channel,
+                                      tg.groups[g].channels,
+                                      &view) == AUDIO_SUCCESS);
+    audio_chain_process_view(tg.groups[g].chain, &view);
+  }
+
+  // Round-trip through the encoder so both sides are quantized alike
+  assert(write_wave(output, buffer) == AUDIO_SUCCESS);
+  audio_buffer_free(buffer);
+  buffer = read_wave(output, NULL);
+  assert(buffer != NULL);
+  return buffer;
+}
+
+static void assert_same(const AudioBuffer *a, const AudioBuffer *b) {
+  assert(a->length == b->length && a->channels == b->channels);
+  for (size_t i = 0; i < a->length; i++)
+    assert(a->data[i] == b->data[i]);
+}
+
+// Test 1: Staged output matches the single-threaded chains
+static void test_matches_reference(void) {
+  printf("Test 1: Pipeline matches single-threaded processing...\n");
+
+  const char *input = "tests/test_data/pipeline_in.wav";
+  write_input(input);
+  AudioBuffer *expected =
+      reference_output(input, "tests/test_data/pipeline_ref.wav");
+
+  TestGroups tg;
+  groups_init(&tg);
+  AudioPipelineStats stats;
+  assert(run_pipeline(input, "tests/test_data/pipeline_out.wav", tg.groups, 2,
+                      0, 0, &stats) == AUDIO_SUCCESS);
+  assert(stats.frames == FRAMES);
+  assert(stats.blocks == (FRAMES + AUDIO_PIPELINE_BLOCK_FRAMES - 1) /
+                             AUDIO_PIPELINE_BLOCK_FRAMES);
+  printf("  decode %.2f ms, filter %.2f/%.2f ms, encode %.2f ms\n",
+         stats.decode_seconds * 1e3, stats.filter_seconds[0] * 1e3,
+         stats.filter_seconds[1] * 1e3, stats.encode_seconds * 1e3);
+
+  AudioBuffer *output = read_wave("tests/test_data/pipeline_out.wav", NULL);
+  assert(output != NULL);
+  assert_same(output, expected);
+
+  // Channel 3 belongs to no group and passes through (re-encoding may move
+  // a sample by one LSB)
+  AudioBuffer *original = read_wave(input, NULL);
+  for (size_t f = 0; f < FRAMES; f++) {
+    double diff =
+        output->data[f * CHANNELS + 3] - original->data[f * CHANNELS + 3];
+    assert(fabs(diff) <= 1.5 / 8388608.0);
+  }
+
+  audio_buffer_free(original);
+  audio_buffer_free(output);
+  audio_buffer_free(expected);
+  printf("  ✓ Bit-identical, ungrouped channel passed through\n");
+}
+
+// Test 2: Tiny blocks and rings force constant backpressure
+static void test_backpressure(void) {
+  printf("Test 2: Tiny rings...\n");
+
+  const char *input = "tests/test_data/pipeline_in.wav";
+  AudioBuffer *expected =
+      reference_output(input, "tests/test_data/pipeline_ref.wav");
+
+  size_t blocks[] = {1, 2, 3};
+  size_t block_frames[] = {64, 333, 1000};
+  for (int i = 0; i < 3; i++) {
+    TestGroups tg;
+    groups_init(&tg);
+    AudioPipelineStats stats;
+    assert(run_pipeline(input, "tests/test_data/pipeline_out.wav", tg.groups,
+                        2, block_frames[i], blocks[i],
+                        &stats) == AUDIO_SUCCESS);
+    assert(stats.frames == FRAMES);
+
+    AudioBuffer *output = read_wave("tests/test_data/pipeline_out.wav", NULL);
+    assert(output != NULL);
+    assert_same(output, expected);
+    audio_buffer_free(output);
+    printf("  %zu-frame blocks, %zu in flight: identical\n", block_frames[i],
+           blocks[i]);
+  }
+
+  audio_buffer_free(expected);
+  printf("  ✓ Output independent of block and ring size\n");
+}
+
+// Test 3: Without groups the pipeline is a threaded copy
+static void test_no_groups(void) {
+  printf("Test 3: Decode/encode only...\n");
+
+  const char *input = "tests/test_data/pipeline_in.wav";
+  assert(run_pipeline(input, "tests/test_data/pipeline_out.wav", NULL, 0, 500,
+                      4, NULL) == AUDIO_SUCCESS);
+
+  AudioBuffer *original = read_wave(input, NULL);
+  AudioBuffer *output = read_wave("tests/test_data/pipeline_out.wav", NULL);
+  assert(original && output);
+  assert(output->length == original->length);
+  for (size_t i = 0; i < output->length; i++)
+    assert(fabs(output->data[i] - original->data[i]) <= 1.5 / 8388608.0);
+  audio_buffer_free(original);
+  audio_buffer_free(output);
+  printf("  ✓ Copy within one LSB\n");
+}
+
+// Test 4: Bad groups are rejected before any thread starts
+static void test_invalid_groups(void) {
+  printf("Test 4: Invalid groups...\n");
+
+  const char *input = "tests/test_data/pipeline_in.wav";
+  const char *output = "tests/test_data/pipeline_bad.wav";
+  TestGroups tg;
+  groups_init(&tg);
+
+  // Overlapping
+  tg.groups[1].first_channel = 1;
+  assert(run_pipeline(input, output, tg.groups, 2, 0, 0, NULL) ==
+         AUDIO_ERROR_INVALID_PARAMETER);
+
+  // Past the last channel
+  tg.groups[1].first_channel = 3;
+  tg.groups[1].channels = 2;
+  assert(run_pipeline(input, output, tg.groups, 2, 0, 0, NULL) ==
+         AUDIO_ERROR_INVALID_PARAMETER);
+
+  // Missing chain
+  tg.groups[1].channels = 1;
+  tg.groups[1].chain = NULL;
+  assert(run_pipeline(input, output, tg.groups, 2, 0, 0, NULL) ==
+         AUDIO_ERROR_INVALID_PARAMETER);
+
+  assert(run_pipeline(input, output, tg.groups, AUDIO_PIPELINE_MAX_GROUPS + 1,
+                      0, 0, NULL) == AUDIO_ERROR_INVALID_PARAMETER);
+  printf("  ✓ Overlap, range and missing chains rejected\n");
+}
+
+// Test 5: A decode error aborts the run instead of ending the stream
+static void test_decode_error(void) {
+  printf("Test 5: Corrupt input...\n");
+
+  const char *input = "tests/test_data/pipeline_corrupt.flac";
+  AudioBuffer *buffer = read_wave("tests/test_data/pipeline_in.wav", NULL);
+  assert(buffer != NULL);
+  assert(write_wave(input, buffer) == AUDIO_SUCCESS);
+  audio_buffer_free(buffer);
+
+  // Damage one byte in the middle of the stream
+  FILE *file = fopen(input, "r+b");
+  assert(file != NULL);
+  fseek(file, 0, SEEK_END);
+  long middle = ftell(file) / 2;
+  fseek(file, middle, SEEK_SET);
+  int byte = fgetc(file);
+  fseek(file, middle, SEEK_SET);
+  fputc(byte ^ 0x5A, file);
+  fclose(file);
+
+  TestGroups tg;
+  groups_init(&tg);
+  AudioPipelineStats stats;
+  AudioError error = run_pipeline(input, "tests/test_data/pipeline_bad.wav",
+                                  tg.groups, 2, 1024, 4, &stats);
+  assert(error == AUDIO_ERROR_INVALID_FORMAT ||
+         error == AUDIO_ERROR_READ_ERROR);
+  assert(stats.frames < FRAMES);
+  printf("  ✓ Reported as %s after %zu frames\n", audio_error_string(error),
+         stats.frames);
+}
+
+int main(void) {
+  printf("=== Pipeline Test Suite ===\n\n");
+
+  test_matches_reference();
+  test_backpressure();
+  test_no_groups();
+  test_invalid_groups();
+  test_decode_error();
+
+  printf("\n=== All pipeline tests passed ===\n");
+  return 0;
+}
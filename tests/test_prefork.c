@@ -0,0 +1,145 @@
+#include "audio_alloc.h"
+#include "hpf.h"
+#include "prefork.h"
+#include <assert.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define WORKERS 4
+#define TABLE_SIZE 4096
+
+// Shared by the workers of the tests
+typedef struct {
+  const double *table;   // Sealed, read-only
+  const HPFFilter *hpf;  // Designed by the parent
+  double *results;       // Writable arena, one slot per worker
+} SharedState;
+
+// Test 1: Arena allocation and sealing
+static void test_arena(void) {
+  printf("Test 1: Shared arena...\n");
+
+  AudioSharedArena arena;
+  assert(audio_shared_arena_create(&arena, "test-arena", 10000) ==
+         AUDIO_SUCCESS);
+  assert(arena.size >= 10000 && arena.base != NULL);
+
+  void *a = audio_shared_arena_alloc(&arena, 100);
+  void *b = audio_shared_arena_alloc(&arena, 100);
+  assert(a && b && a != b);
+  assert((uintptr_t)a % AUDIO_ALLOC_ALIGNMENT == 0);
+  assert((uintptr_t)b % AUDIO_ALLOC_ALIGNMENT == 0);
+  assert(((unsigned char *)a)[0] == 0);
+  assert(audio_shared_arena_alloc(&arena, arena.size) == NULL);
+
+  memset(a, 0x5A, 100);
+  assert(audio_shared_arena_seal(&arena) == AUDIO_SUCCESS);
+  assert(audio_shared_arena_alloc(&arena, 16) == NULL);
+  assert(((unsigned char *)a)[99] == 0x5A);
+
+  // A write after sealing faults
+  fflush(NULL);
+  pid_t pid = fork();
+  assert(pid >= 0);
+  if (pid == 0) {
+    signal(SIGSEGV, SIG_DFL);
+    ((volatile unsigned char *)a)[0] = 1;
+    _exit(0);
+  }
+  int status;
+  assert(waitpid(pid, &status, 0) == pid);
+  assert(WIFSIGNALED(status) && WTERMSIG(status) == SIGSEGV);
+
+  printf("  memfd: %s\n", arena.fd >= 0 ? "yes" : "no (anonymous)");
+  audio_shared_arena_destroy(&arena);
+  printf("  ✓ Aligned bump allocation, sealed arena is read-only\n");
+}
+
+// Sum the sealed table and filter an impulse with the parent's filter
+static int worker_body(void *user, int worker) {
+  SharedState *state = (SharedState *)user;
+  double sum = 0.0;
+  for (int i = 0; i < TABLE_SIZE; i++)
+    sum += state->table[i];
+
+  // Private copy of the shared design: the state is per worker
+  HPFFilter hpf = *state->hpf;
+  double impulse[64] = {1.0};
+  hpf_process_channel(&hpf, impulse, 64, 0);
+
+  state->results[worker] = sum + impulse[0] + worker;
+  return 0;
+}
+
+static int failing_worker(void *user, int worker) {
+  (void)user;
+  if (worker == 1)
+    return 3;
+  if (worker == 2)
+    raise(SIGKILL);
+  return 0;
+}
+
+// Test 2: Workers see the parent's tables and report through the arena
+static void test_workers(void) {
+  printf("Test 2: Pre-forked workers...\n");
+
+  AudioSharedArena tables, results;
+  assert(audio_shared_arena_create(&tables, "test-tables",
+                                   TABLE_SIZE * sizeof(double) +
+                                       sizeof(HPFFilter) + 256) ==
+         AUDIO_SUCCESS);
+  assert(audio_shared_arena_create(&results, "test-results",
+                                   WORKERS * sizeof(double)) ==
+         AUDIO_SUCCESS);
+
+  double *table = audio_shared_arena_alloc(&tables, TABLE_SIZE * sizeof(double));
+  HPFFilter *hpf = audio_shared_arena_alloc(&tables, sizeof(HPFFilter));
+  assert(table && hpf);
+  double expected_sum = 0.0;
+  for (int i = 0; i < TABLE_SIZE; i++) {
+    table[i] = i * 0.5;
+    expected_sum += table[i];
+  }
+  hpf_init(hpf, 48000, 100.0);
+  assert(audio_shared_arena_seal(&tables) == AUDIO_SUCCESS);
+
+  SharedState state = {table, hpf,
+                       audio_shared_arena_alloc(&results,
+                                                WORKERS * sizeof(double))};
+  int failed = -1;
+  assert(audio_prefork_run(WORKERS, worker_body, &state, &failed) ==
+         AUDIO_SUCCESS);
+  assert(failed == 0);
+
+  HPFFilter local = *hpf;
+  double impulse[64] = {1.0};
+  hpf_process_channel(&local, impulse, 64, 0);
+  for (int w = 0; w < WORKERS; w++)
+    assert(state.results[w] == expected_sum + impulse[0] + w);
+
+  // Failures and crashes are counted
+  assert(audio_prefork_run(WORKERS, failing_worker, NULL, &failed) ==
+         AUDIO_SUCCESS);
+  assert(failed == 2);
+  assert(audio_prefork_run(0, failing_worker, NULL, &failed) ==
+         AUDIO_ERROR_INVALID_PARAMETER);
+
+  audio_shared_arena_destroy(&tables);
+  audio_shared_arena_destroy(&results);
+  printf("  ✓ %d workers used the sealed tables, failures counted\n", WORKERS);
+}
+
+int main(void) {
+  printf("=== Prefork Test Suite ===\n\n");
+
+  test_arena();
+  test_workers();
+
+  printf("\n=== All prefork tests passed ===\n");
+  return 0;
+}
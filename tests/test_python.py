@@ -0,0 +1,237 @@
+"""Tests for the audiofilter Python extension module."""
+
+import array
+import math
+import os
+import threading
+
+import audiofilter
+
+SAMPLE_RATE = 48000
+TEST_DATA = os.path.join("tests", "test_data")
+
+
+def sine(frames, frequency, channels=1):
+    return array.array(
+        "d",
+        (0.5 * math.sin(2.0 * math.pi * frequency * (i // channels) / SAMPLE_RATE)
+         for i in range(frames * channels)))
+
+
+# Test 1: Filters work in place on the caller's memory
+def test_in_place():
+    print("Test 1: In-place HPF on array.array...")
+
+    data = array.array("d", [1.0] * SAMPLE_RATE)
+    hpf = audiofilter.HPF(SAMPLE_RATE, 100.0)
+    result = hpf.process(data)
+
+    assert result is data
+    assert abs(data[0] - 1.0) < 0.01
+    assert abs(data[-1]) < 1e-6, data[-1]
+    assert hpf.frequency == 100.0 and hpf.sample_rate == SAMPLE_RATE
+    print("  ✓ DC removed in the original array")
+
+
+# Test 2: State persists across calls
+def test_state_persists():
+    print("Test 2: Filter state across calls...")
+
+    whole = sine(10000, 440.0)
+    split = array.array("d", whole)
+
+    audiofilter.PEQ(SAMPLE_RATE, 1000.0, 6.0, 2.0).process(whole)
+    peq = audiofilter.PEQ(SAMPLE_RATE, 1000.0, gain=6.0, q=2.0)
+    first, second = memoryview(split)[:3333], memoryview(split)[3333:]
+    peq.process(first)
+    peq.process(second)
+    assert whole == split
+
+    peq.reset()
+    peq.retune(2000.0, gain=-3.0)
+    assert peq.frequency == 2000.0
+    print("  ✓ Split processing matches one pass")
+
+
+# Test 3: 2-D buffers are (frames, channels)
+def test_shapes():
+    print("Test 3: Buffer shapes and channels...")
+
+    interleaved = sine(4096, 300.0, channels=2)
+    raw = bytearray(interleaved.tobytes())
+    frames = memoryview(raw).cast("B").cast("d", [4096, 2])
+
+    audiofilter.LPF(SAMPLE_RATE, 1000.0).process(interleaved, channels=2)
+    audiofilter.LPF(SAMPLE_RATE, 1000.0).process(frames)
+    assert array.array("d", raw) == interleaved
+
+    try:
+        audiofilter.LPF(SAMPLE_RATE, 1000.0).process(frames, channels=3)
+        assert False, "channel mismatch accepted"
+    except ValueError:
+        pass
+    try:
+        audiofilter.HPF(SAMPLE_RATE, 100.0).process(array.array("f", [0.0]))
+        assert False, "float32 accepted"
+    except TypeError:
+        pass
+    try:
+        audiofilter.HPF(SAMPLE_RATE, 100.0).process(bytes(8))
+        assert False, "read-only buffer accepted"
+    except (TypeError, BufferError):
+        pass
+    print("  ✓ Shapes inferred, bad buffers rejected")
+
+
+# Test 4: A chain matches running its filters one after another
+def test_chain():
+    print("Test 4: Chain...")
+
+    reference = sine(20000, 50.0, channels=2)
+    chained = array.array("d", reference)
+
+    audiofilter.HPF(SAMPLE_RATE, 80.0).process(reference, channels=2)
+    audiofilter.LPF(SAMPLE_RATE, 8000.0).process(reference, channels=2)
+
+    chain = audiofilter.Chain(tile_frames=512)
+    assert chain.add(audiofilter.HPF(SAMPLE_RATE, 80.0)) is chain
+    chain.add(audiofilter.LPF(SAMPLE_RATE, 8000.0))
+    assert len(chain.stages) == 2 and chain.tile_frames == 512
+    assert chain.process(chained, channels=2) is chained
+
+    worst = max(abs(a - b) for a, b in zip(reference, chained))
+    assert worst < 1e-12, worst
+
+    try:
+        chain.add(object())
+        assert False, "non-filter stage accepted"
+    except TypeError:
+        pass
+    print("  ✓ Chain output matches sequential filters")
+
+
+# Test 5: WAV I/O returns exportable buffers
+def test_wave_io():
+    print("Test 5: WAV round trip...")
+
+    path = os.path.join(TEST_DATA, "python_io.wav")
+    data = sine(2000, 1000.0, channels=2)
+    audiofilter.write_wave(path, data, sample_rate=SAMPLE_RATE, channels=2,
+                           bit_depth=16)
+
+    buffer = audiofilter.read_wave(path)
+    assert isinstance(buffer, audiofilter.Buffer)
+    assert (buffer.frames, buffer.channels) == (2000, 2)
+    assert buffer.sample_rate == SAMPLE_RATE and buffer.bit_depth == 16
+
+    view = memoryview(buffer)
+    assert view.format == "d" and view.shape == (2000, 2)
+    assert max(abs(view[f, c] - data[2 * f + c])
+               for f in range(2000) for c in range(2)) < 2.0 / 32768
+
+    # Processing the Buffer changes what the memoryview sees
+    audiofilter.HPF(SAMPLE_RATE, 5000.0).process(buffer)
+    assert abs(view[1000, 0] - data[2000]) > 0.01
+
+    region = audiofilter.read_wave(path, start=500, frames=100)
+    assert region.frames == 100
+    tail = audiofilter.read_wave(path, start=1900)
+    assert tail.frames == 100
+
+    # Buffers keep their settings when written back
+    audiofilter.write_wave(path, buffer)
+    assert audiofilter.read_wave(path).bit_depth == 16
+
+    blank = audiofilter.Buffer(10, 1, SAMPLE_RATE)
+    assert memoryview(blank).tolist() == [[0.0]] * 10
+
+    try:
+        audiofilter.read_wave(os.path.join(TEST_DATA, "missing.wav"))
+        assert False, "missing file accepted"
+    except FileNotFoundError:
+        pass
+    print("  ✓ Buffers share memory with memoryview")
+
+
+# Test 6: Filters on separate threads run concurrently and independently
+def test_threads():
+    print("Test 6: Threaded processing...")
+
+    inputs = [sine(200000, 100.0 * (t + 1)) for t in range(4)]
+    expected = [array.array("d", x) for x in inputs]
+    for x in expected:
+        audiofilter.HPF(SAMPLE_RATE, 150.0).process(x)
+
+    filters = [audiofilter.HPF(SAMPLE_RATE, 150.0) for _ in inputs]
+    threads = [threading.Thread(target=f.process, args=(x,))
+               for f, x in zip(filters, inputs)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+
+    assert inputs == expected
+    print("  ✓ Threaded results match sequential results")
+
+
+# Test 7: NumPy arrays are processed without copies
+def test_numpy():
+    print("Test 7: NumPy interop...")
+
+    try:
+        import numpy as np
+    except ImportError:
+        print("  - NumPy not installed, skipped")
+        return
+
+    data = np.ones((48000, 2))
+    out = audiofilter.HPF(SAMPLE_RATE, 100.0).process(data)
+    assert out is data
+    assert np.all(np.abs(data[-1]) < 1e-6)
+
+    path = os.path.join(TEST_DATA, "python_numpy.wav")
+    audiofilter.write_wave(path, data, sample_rate=SAMPLE_RATE)
+    samples = np.asarray(audiofilter.read_wave(path))
+    assert samples.shape == (48000, 2) and samples.dtype == np.float64
+    print("  ✓ NumPy arrays shared in place")
+
+
+# Test 8: __init__ may be called again; filters are freed with the object
+def test_reinit():
+    print("Test 8: Re-initialization and teardown...")
+
+    fresh = sine(4000, 440.0, channels=4)
+    reused = array.array("d", fresh)
+    audiofilter.LPF(SAMPLE_RATE, 2000.0).process(fresh, channels=4)
+
+    lpf = audiofilter.LPF(SAMPLE_RATE, 500.0)
+    lpf.process(sine(4000, 440.0, channels=4), channels=4)
+    lpf.__init__(SAMPLE_RATE, 2000.0)
+    lpf.process(reused, channels=4)
+    assert lpf.frequency == 2000.0
+    assert fresh == reused
+
+    # Each object owns its (JIT) filter handles until it is collected
+    for _ in range(1000):
+        audiofilter.PEQ(SAMPLE_RATE, 1000.0, 3.0).process(sine(64, 440.0))
+    print("  ✓ Re-init starts from a clean filter")
+
+
+def main():
+    print("=== Python Module Test Suite ===\n")
+
+    os.makedirs(TEST_DATA, exist_ok=True)
+    test_in_place()
+    test_state_persists()
+    test_shapes()
+    test_chain()
+    test_wave_io()
+    test_threads()
+    test_numpy()
+    test_reinit()
+
+    print("\n=== All Python module tests passed ===")
+
+
+if __name__ == "__main__":
+    main()
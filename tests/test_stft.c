@@ -0,0 +1,377 @@
+#include "audio_io.h"
+#include "stft.h"
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define SAMPLE_RATE 48000
+
+// Stereo test signal: a bin-centered sine on the left, noise on the right
+static AudioBuffer *make_signal(size_t frames, double frequency) {
+  AudioBuffer *buffer =
+      audio_buffer_create(frames * 2, SAMPLE_RATE, 2, 24);
+  assert(buffer != NULL);
+
+  unsigned int seed = 4242;
+  for (size_t f = 0; f < frames; f++) {
+    seed = seed * 1103515245u + 12345u;
+    buffer->data[2 * f] = 0.9 * sin(2.0 * M_PI * frequency * f / SAMPLE_RATE);
+    buffer->data[2 * f + 1] = 0.25 * (((seed >> 8) & 0xFFFF) / 32768.0 - 1.0);
+  }
+  return buffer;
+}
+
+static double max_difference(const Spectrogram *a, const Spectrogram *b) {
+  assert(a->header.frames == b->header.frames);
+  assert(a->header.channels == b->header.channels);
+  assert(a->header.bins == b->header.bins);
+
+  size_t count = a->header.frames * a->header.channels * a->header.bins;
+  double worst = 0.0;
+  for (size_t i = 0; i < count; i++) {
+    double d = fabs((double)a->magnitudes[i] - b->magnitudes[i]);
+    if (d > worst)
+      worst = d;
+  }
+  return worst;
+}
+
+// Test 1: The real FFT matches a direct DFT
+static void test_fft_accuracy(void) {
+  printf("Test 1: FFT against direct DFT...\n");
+
+  size_t sizes[] = {16, 64, 1024};
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    size_t n = sizes[s];
+    const FFTPlan *plan = fft_plan_get(n);
+    assert(plan != NULL);
+
+    double *input = malloc(n * sizeof(double));
+    double *re = malloc((n / 2 + 1) * sizeof(double));
+    double *im = malloc((n / 2 + 1) * sizeof(double));
+    unsigned int seed = 99;
+    for (size_t i = 0; i < n; i++) {
+      seed = seed * 1103515245u + 12345u;
+      input[i] = ((seed >> 8) & 0xFFFF) / 32768.0 - 1.0;
+    }
+
+    fft_plan_execute(plan, input, re, im);
+
+    double worst = 0.0;
+    for (size_t k = 0; k <= n / 2; k++) {
+      double sum_re = 0.0, sum_im = 0.0;
+      for (size_t i = 0; i < n; i++) {
+        double angle = -2.0 * M_PI * (double)((k * i) % n) / n;
+        sum_re += input[i] * cos(angle);
+        sum_im += input[i] * sin(angle);
+      }
+      worst = fmax(worst, fabs(re[k] - sum_re));
+      worst = fmax(worst, fabs(im[k] - sum_im));
+    }
+    printf("  size %zu: max error %.3e\n", n, worst);
+    assert(worst < 1e-9 * n);
+
+    free(input);
+    free(re);
+    free(im);
+  }
+
+  assert(fft_plan_get(48) == NULL);
+  assert(fft_plan_get(8) == NULL);
+  assert(fft_plan_get(1024) == fft_plan_get(1024));
+  printf("  ✓ FFT matches DFT, plans are cached per size\n");
+}
+
+// Test 2: A full-scale sine reads 1.0 in its bin, for every window
+static void test_magnitude_scale(void) {
+  printf("Test 2: Magnitude calibration...\n");
+
+  // Bin 64 of a 1024-point FFT at 48 kHz
+  double frequency = 64.0 * SAMPLE_RATE / 1024.0;
+  AudioBuffer *buffer = audio_buffer_create(8192, SAMPLE_RATE, 1, 24);
+  for (size_t f = 0; f < 8192; f++) {
+    buffer->data[f] = sin(2.0 * M_PI * frequency * f / SAMPLE_RATE);
+  }
+
+  StftWindow windows[] = {STFT_WINDOW_RECTANGULAR, STFT_WINDOW_HANN,
+                          STFT_WINDOW_HAMMING, STFT_WINDOW_BLACKMAN};
+  for (size_t w = 0; w < 4; w++) {
+    StftConfig config;
+    stft_config_default(&config);
+    config.fft_size = 1024;
+    config.hop = 256;
+    config.window = windows[w];
+
+    AudioError error;
+    StftEngine *engine = stft_engine_create(&config, 1, SAMPLE_RATE, &error);
+    assert(engine != NULL && error == AUDIO_SUCCESS);
+    assert(stft_engine_bins(engine) == 513);
+
+    Spectrogram spec;
+    assert(spectrogram_init(&spec, engine) == AUDIO_SUCCESS);
+    assert(stft_process_buffer(engine, buffer, spectrogram_sink, &spec) ==
+           AUDIO_SUCCESS);
+    assert(spec.header.frames == 32);
+
+    // Frame 10 lies fully inside the signal
+    float peak = spectrogram_at(&spec, 10, 0, 64);
+    printf("  window %d: bin 64 = %.6f, bin 200 = %.2e\n", (int)windows[w],
+           peak, spectrogram_at(&spec, 10, 0, 200));
+    assert(fabs(peak - 1.0) < 1e-4);
+    assert(spectrogram_at(&spec, 10, 0, 200) < 1e-4);
+
+    spectrogram_clear(&spec);
+    stft_engine_destroy(engine);
+  }
+
+  audio_buffer_free(buffer);
+  printf("  ✓ Sine peaks at 1.0 with every window\n");
+}
+
+// Test 3: Every thread count produces the same frames in the same order
+static void test_thread_determinism(void) {
+  printf("Test 3: Thread count independence...\n");
+
+  AudioBuffer *buffer = make_signal(50000, 1000.0);
+  Spectrogram specs[3];
+  int threads[3] = {1, 3, 8};
+
+  for (int t = 0; t < 3; t++) {
+    StftConfig config;
+    stft_config_default(&config);
+    config.fft_size = 512;
+    config.hop = 128;
+    config.threads = threads[t];
+
+    StftEngine *engine = stft_engine_create(&config, 2, SAMPLE_RATE, NULL);
+    assert(engine != NULL);
+    spectrogram_init(&specs[t], engine);
+    assert(stft_process_buffer(engine, buffer, spectrogram_sink, &specs[t]) ==
+           AUDIO_SUCCESS);
+    stft_engine_destroy(engine);
+  }
+
+  // ceil(50000 / 128) frames
+  assert(specs[0].header.frames == 391);
+  assert(max_difference(&specs[0], &specs[1]) == 0.0);
+  assert(max_difference(&specs[0], &specs[2]) == 0.0);
+
+  for (int t = 0; t < 3; t++)
+    spectrogram_clear(&specs[t]);
+  audio_buffer_free(buffer);
+  printf("  ✓ 1, 3 and 8 threads are bit-identical\n");
+}
+
+// Test 4: Streaming from a reader matches analyzing the decoded buffer
+static void test_reader_matches_buffer(void) {
+  printf("Test 4: Streaming reader path...\n");
+
+  const char *path = "tests/test_data/stft_input.wav";
+  AudioBuffer *signal = make_signal(30011, 2500.0);
+  assert(write_wave(path, signal) == AUDIO_SUCCESS);
+  audio_buffer_free(signal);
+
+  AudioError error;
+  AudioBuffer *decoded = read_wave(path, &error);
+  assert(decoded != NULL);
+
+  // Hops below, at and above the FFT size (the last skips input)
+  size_t hops[] = {100, 256, 700};
+  for (size_t h = 0; h < 3; h++) {
+    StftConfig config;
+    stft_config_default(&config);
+    config.fft_size = 256;
+    config.hop = hops[h];
+    config.threads = 2;
+
+    StftEngine *engine = stft_engine_create(&config, 2, SAMPLE_RATE, NULL);
+    assert(engine != NULL);
+
+    Spectrogram from_buffer, from_reader;
+    spectrogram_init(&from_buffer, engine);
+    spectrogram_init(&from_reader, engine);
+    assert(stft_process_buffer(engine, decoded, spectrogram_sink,
+                               &from_buffer) == AUDIO_SUCCESS);
+
+    AudioReader *reader = audio_reader_open(path, &error);
+    assert(reader != NULL);
+    assert(stft_process_reader(engine, reader, spectrogram_sink,
+                               &from_reader) == AUDIO_SUCCESS);
+    audio_reader_close(reader);
+
+    printf("  hop %zu: %llu frames\n", hops[h],
+           (unsigned long long)from_reader.header.frames);
+    assert(from_reader.header.frames == (30011 + hops[h] - 1) / hops[h]);
+    assert(max_difference(&from_buffer, &from_reader) == 0.0);
+
+    spectrogram_clear(&from_buffer);
+    spectrogram_clear(&from_reader);
+    stft_engine_destroy(engine);
+  }
+
+  audio_buffer_free(decoded);
+  printf("  ✓ Reader and buffer paths are bit-identical\n");
+}
+
+// Test 5: Spectrogram files round-trip in both encodings
+static void test_file_round_trip(void) {
+  printf("Test 5: Spectrogram file round trip...\n");
+
+  const char *wav = "tests/test_data/stft_input.wav";
+  const char *out = "tests/test_data/stft_output.stft";
+
+  StftConfig config;
+  stft_config_default(&config);
+  config.fft_size = 1024;
+  config.hop = 512;
+
+  AudioError error;
+  AudioBuffer *decoded = read_wave(wav, &error);
+  StftEngine *engine = stft_engine_create(&config, 2, SAMPLE_RATE, NULL);
+  Spectrogram reference;
+  spectrogram_init(&reference, engine);
+  stft_process_buffer(engine, decoded, spectrogram_sink, &reference);
+
+  // Float32 is exact
+  assert(stft_analyze_file(wav, out, &config, STFT_ENCODING_FLOAT32) ==
+         AUDIO_SUCCESS);
+  Spectrogram *loaded = spectrogram_read(out, &error);
+  assert(loaded != NULL && error == AUDIO_SUCCESS);
+  assert(loaded->header.fft_size == 1024 && loaded->header.hop == 512);
+  assert(loaded->header.window == STFT_WINDOW_HANN);
+  assert(loaded->header.sample_rate == SAMPLE_RATE);
+  assert(max_difference(&reference, loaded) == 0.0);
+  spectrogram_free(loaded);
+
+  // DB16 is within half a hundredth of a dB above the floor
+  assert(stft_analyze_file(wav, out, &config, STFT_ENCODING_DB16) ==
+         AUDIO_SUCCESS);
+  loaded = spectrogram_read(out, &error);
+  assert(loaded != NULL);
+  assert(loaded->header.encoding == STFT_ENCODING_DB16);
+  assert(loaded->header.frames == reference.header.frames);
+  size_t count = reference.header.frames * 2 * reference.header.bins;
+  double worst_db = 0.0;
+  for (size_t i = 0; i < count; i++) {
+    if (reference.magnitudes[i] < 1e-12f)
+      continue;
+    double db = 20.0 * log10(loaded->magnitudes[i] / reference.magnitudes[i]);
+    worst_db = fmax(worst_db, fabs(db));
+  }
+  printf("  DB16 max error %.4f dB\n", worst_db);
+  assert(worst_db < 0.006);
+  spectrogram_free(loaded);
+
+  // Not a spectrogram
+  assert(spectrogram_read(wav, &error) == NULL);
+  assert(error == AUDIO_ERROR_INVALID_FORMAT);
+
+  // A frame count whose magnitude allocation would wrap
+  StftFileHeader header;
+  FILE *file = fopen(out, "r+b");
+  assert(file && fread(&header, sizeof(header), 1, file) == 1);
+  size_t values = (size_t)header.channels * header.bins;
+  header.frames = SIZE_MAX / (values * sizeof(float)) + 1;
+  rewind(file);
+  assert(fwrite(&header, sizeof(header), 1, file) == 1);
+  fclose(file);
+  assert(spectrogram_read(out, &error) == NULL);
+  assert(error == AUDIO_ERROR_INVALID_FORMAT);
+
+  spectrogram_clear(&reference);
+  stft_engine_destroy(engine);
+  audio_buffer_free(decoded);
+  printf("  ✓ Both encodings round-trip\n");
+}
+
+// Test 6: Invalid settings are rejected
+static void test_invalid_config(void) {
+  printf("Test 6: Invalid configurations...\n");
+
+  StftConfig config;
+  stft_config_default(&config);
+  assert(config.fft_size == 2048 && config.hop == 512);
+
+  AudioError error = AUDIO_SUCCESS;
+  config.fft_size = 1000;
+  assert(stft_engine_create(&config, 1, SAMPLE_RATE, &error) == NULL);
+  assert(error == AUDIO_ERROR_INVALID_PARAMETER);
+
+  stft_config_default(&config);
+  config.hop = 0;
+  assert(stft_engine_create(&config, 1, SAMPLE_RATE, &error) == NULL);
+
+  stft_config_default(&config);
+  assert(stft_engine_create(&config, 0, SAMPLE_RATE, &error) == NULL);
+
+  // Channel mismatch
+  StftEngine *engine = stft_engine_create(&config, 1, SAMPLE_RATE, NULL);
+  AudioBuffer *stereo = make_signal(4096, 440.0);
+  assert(stft_process_buffer(engine, stereo, NULL, NULL) ==
+         AUDIO_ERROR_UNSUPPORTED_FORMAT);
+  audio_buffer_free(stereo);
+  stft_engine_destroy(engine);
+  printf("  ✓ Invalid settings rejected\n");
+}
+
+// Test 7: A truncated input fails the reader path; the engine (and its
+// parked workers) stays usable afterwards
+static void test_reader_error(void) {
+  printf("Test 7: Truncated input...\n");
+
+  // The data chunk promises 30011 frames, the file holds 10000
+  const char *path = "tests/test_data/stft_cut.wav";
+  AudioBuffer *signal = make_signal(30011, 2500.0);
+  assert(write_wave(path, signal) == AUDIO_SUCCESS);
+  assert(truncate(path, 44 + 10000 * 2 * 3) == 0);
+
+  StftConfig config;
+  stft_config_default(&config);
+  config.fft_size = 256;
+  config.hop = 64;
+  config.threads = 4;
+  StftEngine *engine = stft_engine_create(&config, 2, SAMPLE_RATE, NULL);
+  assert(engine != NULL);
+
+  Spectrogram spec;
+  spectrogram_init(&spec, engine);
+  AudioReader *reader = audio_reader_open(path, NULL);
+  assert(reader != NULL);
+  assert(stft_process_reader(engine, reader, spectrogram_sink, &spec) ==
+         AUDIO_ERROR_READ_ERROR);
+  audio_reader_close(reader);
+  assert(spec.header.frames < (30011 + 63) / 64);
+  spectrogram_clear(&spec);
+
+  for (int run = 0; run < 3; run++) {
+    spectrogram_init(&spec, engine);
+    assert(stft_process_buffer(engine, signal, spectrogram_sink, &spec) ==
+           AUDIO_SUCCESS);
+    assert(spec.header.frames == (30011 + 63) / 64);
+    spectrogram_clear(&spec);
+  }
+
+  stft_engine_destroy(engine);
+  audio_buffer_free(signal);
+  printf("  ✓ Read error reported, engine reused for 3 more runs\n");
+}
+
+int main(void) {
+  printf("=== STFT Test Suite ===\n\n");
+
+  test_fft_accuracy();
+  test_magnitude_scale();
+  test_thread_determinism();
+  test_reader_matches_buffer();
+  test_file_round_trip();
+  test_invalid_config();
+  test_reader_error();
+
+  fft_plan_cache_clear();
+  printf("\n=== All STFT tests passed ===\n");
+  return 0;
+}